@@ -0,0 +1,95 @@
+/**
+ * @file arena.c
+ * @brief Bump-pointer arena allocator usable as a ProtobufCAllocator
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "arena.h"
+
+#include <stdalign.h>
+
+// Every allocation is aligned for the strictest fundamental type
+#define ARENA_ALIGN alignof(max_align_t)
+
+/**
+ * @fn void arena_init(arena_t *arena, void *buf, size_t capacity)
+ * @brief Initialize an arena over a caller-owned buffer
+ *
+ * @param arena Arena to initialize
+ * @param buf Backing buffer, should be aligned to ARENA_ALIGN
+ * @param capacity Size of the backing buffer in bytes
+ *
+ * @return void
+ */
+void arena_init(arena_t* arena, void* buf, size_t capacity) {
+    arena->base = (uint8_t*)buf;
+    arena->capacity = capacity;
+    arena->used = 0;
+    arena->high_water = 0;
+    arena->failures = 0;
+}
+
+/**
+ * @fn void *arena_alloc(arena_t *arena, size_t size)
+ * @brief Allocate size bytes from the arena
+ *
+ * @param arena Arena to allocate from
+ * @param size Number of bytes requested
+ *
+ * @return Pointer to the allocated block, or NULL if the arena is exhausted
+ */
+void* arena_alloc(arena_t* arena, size_t size) {
+    size_t start = (arena->used + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (start > arena->capacity || size > arena->capacity - start) {
+        arena->failures++;
+        return NULL;
+    }
+
+    arena->used = start + size;
+    if (arena->used > arena->high_water) {
+        arena->high_water = arena->used;
+    }
+    return arena->base + start;
+}
+
+/**
+ * @fn void arena_reset(arena_t *arena)
+ * @brief Release every allocation made since the previous reset
+ *
+ * @param arena Arena to reset
+ *
+ * @return void
+ *
+ * @note Pointers previously returned by the arena must not be used afterwards
+ */
+void arena_reset(arena_t* arena) { arena->used = 0; }
+
+/**
+ * @fn void *arena_pb_alloc(void *allocator_data, size_t size)
+ * @brief ProtobufCAllocator alloc callback backed by an arena
+ *
+ * @param allocator_data Pointer to the arena_t to allocate from
+ * @param size Number of bytes requested
+ *
+ * @return Pointer to the allocated block, or NULL if the arena is exhausted
+ */
+void* arena_pb_alloc(void* allocator_data, size_t size) {
+    return arena_alloc((arena_t*)allocator_data, size);
+}
+
+/**
+ * @fn void arena_pb_free(void *allocator_data, void *pointer)
+ * @brief ProtobufCAllocator free callback, a no-op since memory is reclaimed by arena_reset()
+ *
+ * @param allocator_data Pointer to the arena_t the block came from
+ * @param pointer Block to free
+ *
+ * @return void
+ */
+void arena_pb_free(void* allocator_data, void* pointer) {
+    (void)allocator_data;
+    (void)pointer;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file binary_record.c
+ * @brief Length-prefixed binary records, the alternative to the JSON rendering
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "binary_record.h"
+
+#include <string.h>
+
+#include "payload_decoder.h"
+#include "pb_wire.h"
+
+static size_t varint_len(uint64_t value);
+
+/**
+ * @fn size_t binary_record_header(uint8_t *buf, uint32_t timestamp, size_t data_len)
+ * @brief Write everything a record holds before the data bytes
+ *
+ * Lets a message be forwarded in pieces, the header first and then its data as
+ * it arrives.
+ *
+ * @param buf Output buffer, at least BINARY_RECORD_HEADER_MAX_LEN bytes
+ * @param timestamp Timestamp of the message
+ * @param data_len Length of the data that will follow the header
+ *
+ * @return Length of the header
+ */
+size_t binary_record_header(uint8_t* buf, uint32_t timestamp, size_t data_len) {
+    pb_writer_t writer;
+    size_t payload_len = 2 + varint_len(timestamp) + varint_len(data_len) + data_len;
+
+    buf[0] = BINARY_RECORD_MARKER;
+    pb_writer_init(&writer, buf + 1, BINARY_RECORD_HEADER_MAX_LEN - 1);
+    pb_write_varint(&writer, payload_len);
+    pb_write_tag(&writer, PAYLOAD_FIELD_TIMESTAMP, PB_WIRE_VARINT);
+    pb_write_varint(&writer, timestamp);
+    pb_write_tag(&writer, PAYLOAD_FIELD_DATA, PB_WIRE_LEN);
+    pb_write_varint(&writer, data_len);
+    return 1 + writer.len;
+}
+
+/**
+ * @fn size_t binary_record_write(uint8_t *buf, size_t size, uint32_t timestamp,
+ *                                const char *data, size_t data_len)
+ * @brief Write the record of a decoded message
+ *
+ * @param buf Output buffer
+ * @param size Size of buf
+ * @param timestamp Timestamp of the message
+ * @param data Data bytes of the message
+ * @param data_len Length of data
+ *
+ * @return Length of the record, or 0 if it did not fit in buf
+ */
+size_t binary_record_write(uint8_t* buf, size_t size, uint32_t timestamp, char const* data,
+        size_t data_len) {
+    uint8_t header[BINARY_RECORD_HEADER_MAX_LEN];
+    size_t header_len = binary_record_header(header, timestamp, data_len);
+
+    if (header_len > size || data_len > size - header_len) {
+        return 0;
+    }
+    memcpy(buf, header, header_len);
+    memcpy(buf + header_len, data, data_len);
+    return header_len + data_len;
+}
+
+/**
+ * @fn size_t varint_len(uint64_t value)
+ * @brief Number of bytes of the varint encoding of value
+ */
+size_t varint_len(uint64_t value) {
+    size_t len = 1;
+
+    while (value >= 0x80) {
+        value >>= 7;
+        len++;
+    }
+    return len;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file chunk_pool.c
+ * @brief Fixed pool of reassembly buffers for chunked transfers
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "chunk_pool.h"
+
+#include <string.h>
+
+static chunk_slot_t* find_slot(chunk_pool_t* pool, uint32_t transfer_id);
+static chunk_slot_t* claim_slot(chunk_pool_t* pool);
+
+/**
+ * @fn void chunk_pool_init(chunk_pool_t *pool, uint8_t *buf, size_t slot_size, size_t slots,
+ *                          uint32_t timeout_ms)
+ * @brief Initialize an empty pool over a caller-owned buffer
+ *
+ * @param pool Pool to initialize
+ * @param buf Buffer of slots * slot_size bytes, or NULL to refuse every transfer
+ * @param slot_size Largest transfer in bytes of data
+ * @param slots Number of concurrent transfers, at most CHUNK_POOL_MAX_SLOTS
+ * @param timeout_ms Longest time between two chunks of a transfer
+ *
+ * @return void
+ */
+void chunk_pool_init(chunk_pool_t* pool, uint8_t* buf, size_t slot_size, size_t slots,
+        uint32_t timeout_ms) {
+    memset(pool, 0, sizeof(*pool));
+    if (buf == NULL) {
+        return;
+    }
+    pool->count = slots < CHUNK_POOL_MAX_SLOTS ? slots : CHUNK_POOL_MAX_SLOTS;
+    pool->slot_size = slot_size;
+    pool->timeout_ms = timeout_ms;
+    for (size_t i = 0; i < pool->count; i++) {
+        pool->slots[i].data = buf + i * slot_size;
+    }
+}
+
+/**
+ * @fn void chunk_pool_expire(chunk_pool_t *pool, uint32_t now_ms)
+ * @brief Drop the transfers that received no chunk for longer than the timeout
+ *
+ * @param pool Pool state
+ * @param now_ms Current time in milliseconds (wrapping at 2^32)
+ *
+ * @return void
+ */
+void chunk_pool_expire(chunk_pool_t* pool, uint32_t now_ms) {
+    for (size_t i = 0; i < pool->count; i++) {
+        chunk_slot_t* slot = &pool->slots[i];
+        if (slot->active && now_ms - slot->updated_ms > pool->timeout_ms) {
+            slot->active = false;
+            pool->stats.expired++;
+        }
+    }
+}
+
+/**
+ * @fn chunk_pool_status_t chunk_pool_add(chunk_pool_t *pool, const chunk_view_t *chunk,
+ *                                        size_t frame_len, uint32_t now_ms,
+ *                                        chunk_slot_t **slot)
+ * @brief Store the next chunk of a transfer
+ *
+ * A chunk with index 0 starts a new transfer, taking a free slot or evicting
+ * the least recently active one; it is dropped right away when its announced
+ * size does not fit in a slot.
+ *
+ * @param pool Pool state
+ * @param chunk Decoded chunk
+ * @param frame_len Length of the frame the chunk arrived in, for the stats of the transfer
+ * @param now_ms Current time in milliseconds (wrapping at 2^32)
+ * @param slot Set to the completed transfer on CHUNK_POOL_COMPLETE, to be released with
+ *             chunk_pool_release() once its data was used
+ *
+ * @return Outcome for the chunk, see chunk_pool_status_t
+ */
+chunk_pool_status_t chunk_pool_add(chunk_pool_t* pool, chunk_view_t const* chunk,
+        size_t frame_len, uint32_t now_ms, chunk_slot_t** slot) {
+    chunk_slot_t* transfer = find_slot(pool, chunk->transfer_id);
+
+    if (transfer == NULL) {
+        if (chunk->index != 0 || pool->count == 0) {
+            pool->stats.orphans++;
+            return CHUNK_POOL_ORPHAN;
+        }
+        if (chunk->size > pool->slot_size) {
+            pool->stats.dropped++;
+            return CHUNK_POOL_DROPPED;
+        }
+        transfer = claim_slot(pool);
+        transfer->active = true;
+        transfer->transfer_id = chunk->transfer_id;
+        transfer->next_index = 0;
+        transfer->timestamp = chunk->timestamp;
+        transfer->size = chunk->size;
+        transfer->len = 0;
+        transfer->frame_bytes = 0;
+    } else if (chunk->index < transfer->next_index) {
+        pool->stats.duplicates++;
+        return CHUNK_POOL_DUPLICATE;
+    }
+
+    if (chunk->index != transfer->next_index || chunk->data_len > transfer->size - transfer->len) {
+        transfer->active = false;
+        pool->stats.dropped++;
+        return CHUNK_POOL_DROPPED;
+    }
+    memcpy(transfer->data + transfer->len, chunk->data, chunk->data_len);
+    transfer->len += chunk->data_len;
+    transfer->frame_bytes += frame_len;
+    transfer->next_index++;
+    transfer->updated_ms = now_ms;
+    pool->stats.chunks++;
+
+    if (transfer->len < transfer->size) {
+        return CHUNK_POOL_MORE;
+    }
+    pool->stats.completed++;
+    *slot = transfer;
+    return CHUNK_POOL_COMPLETE;
+}
+
+/**
+ * @fn void chunk_pool_release(chunk_pool_t *pool, chunk_slot_t *slot)
+ * @brief Free the slot of a completed transfer
+ *
+ * @param pool Pool state
+ * @param slot Slot returned by chunk_pool_add()
+ *
+ * @return void
+ */
+void chunk_pool_release(chunk_pool_t* pool, chunk_slot_t* slot) { slot->active = false; }
+
+/**
+ * @fn chunk_slot_t *find_slot(chunk_pool_t *pool, uint32_t transfer_id)
+ * @brief Find the slot reassembling a transfer
+ *
+ * @return The slot, or NULL when the transfer is not in the pool
+ */
+chunk_slot_t* find_slot(chunk_pool_t* pool, uint32_t transfer_id) {
+    for (size_t i = 0; i < pool->count; i++) {
+        if (pool->slots[i].active && pool->slots[i].transfer_id == transfer_id) {
+            return &pool->slots[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @fn chunk_slot_t *claim_slot(chunk_pool_t *pool)
+ * @brief Get a free slot, evicting the least recently active transfer when there is none
+ *
+ * @return The slot, never NULL for a pool with at least one slot
+ */
+chunk_slot_t* claim_slot(chunk_pool_t* pool) {
+    chunk_slot_t* oldest = &pool->slots[0];
+
+    for (size_t i = 0; i < pool->count; i++) {
+        chunk_slot_t* slot = &pool->slots[i];
+        if (!slot->active) {
+            return slot;
+        }
+        // Compare ages rather than times, which wrap around
+        if (slot->updated_ms - oldest->updated_ms > UINT32_MAX / 2) {
+            oldest = slot;
+        }
+    }
+    pool->stats.evicted++;
+    return oldest;
+}
@@ -0,0 +1,306 @@
+/**
+ * @file cobs.c
+ * @brief Consistent Overhead Byte Stuffing (COBS) frame encoding and decoding
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "cobs.h"
+
+#include <string.h>
+
+#include "crc32.h"
+
+static bool stream_decode(cobs_decoder_t* dec, uint8_t const* src, size_t len, void* ctx);
+static bool stream_flush(cobs_decoder_t* dec, size_t len, void* ctx);
+
+/**
+ * @fn size_t cobs_encode(const uint8_t *data, size_t len, uint8_t *out, size_t out_size)
+ * @brief Encode a message as a complete COBS frame, delimiter included
+ *
+ * @param data Message to encode
+ * @param len Length of the message
+ * @param out Output buffer, COBS_ENCODED_MAX_LEN(len) bytes are always enough
+ * @param out_size Size of out
+ *
+ * @return Length of the frame written to out, or 0 if it does not fit
+ */
+size_t cobs_encode(uint8_t const* data, size_t len, uint8_t* out, size_t out_size) {
+    size_t code_pos = 0;
+    size_t write = 1;
+    uint8_t code = 1;
+
+    if (out_size < COBS_ENCODED_MAX_LEN(len)) {
+        return 0;
+    }
+    for (size_t read = 0; read < len; read++) {
+        if (data[read] != COBS_DELIMITER) {
+            out[write++] = data[read];
+            code++;
+        }
+        // Close the block at every zero, and after 254 non-zero bytes unless the message ends
+        if (data[read] == COBS_DELIMITER || (code == 0xFF && read + 1 < len)) {
+            out[code_pos] = code;
+            code_pos = write++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    out[write++] = COBS_DELIMITER;
+    return write;
+}
+
+/**
+ * @fn bool cobs_decode_in_place(uint8_t *buf, size_t len, size_t *decoded_len)
+ * @brief Decode a COBS frame inside the buffer it was received in
+ *
+ * The decoded message is never longer than its encoding and every code byte is
+ * read before the bytes it describes are written, so the output can overwrite
+ * the input and no second buffer is needed.
+ *
+ * @param buf Encoded frame, without the trailing delimiter; overwritten with the message
+ * @param len Length of the encoded frame
+ * @param decoded_len Output for the length of the decoded message at the start of buf
+ *
+ * @return true on success, false if the frame is not valid COBS
+ */
+bool cobs_decode_in_place(uint8_t* buf, size_t len, size_t* decoded_len) {
+    size_t read = 0;
+    size_t write = 0;
+
+    while (read < len) {
+        uint8_t code = buf[read++];
+        if (code == COBS_DELIMITER || (size_t)(code - 1) > len - read) {
+            return false;
+        }
+        memmove(buf + write, buf + read, code - 1);
+        write += code - 1;
+        read += code - 1;
+        // A full 254-byte run carries no implicit zero, nor does the last block
+        if (code != 0xFF && read < len) {
+            buf[write++] = 0x00;
+        }
+    }
+
+    *decoded_len = write;
+    return true;
+}
+
+/**
+ * @fn void cobs_decoder_init(cobs_decoder_t *dec, uint8_t *buf, size_t capacity)
+ * @brief Initialize a streaming COBS decoder over a caller-owned buffer
+ *
+ * @param dec Decoder to initialize
+ * @param buf Buffer the encoded frame is accumulated and decoded in
+ * @param capacity Size of buf; longer encoded frames are discarded
+ *
+ * @return void
+ */
+void cobs_decoder_init(cobs_decoder_t* dec, uint8_t* buf, size_t capacity) {
+    memset(dec, 0, sizeof(*dec));
+    dec->buf = buf;
+    dec->capacity = capacity;
+}
+
+/**
+ * @fn void cobs_decoder_set_stream(cobs_decoder_t *dec, size_t limit,
+ *                                  frame_stream_handler_t on_stream)
+ * @brief Stream frames longer than the buffer capacity instead of discarding them
+ *
+ * @param dec Decoder to configure
+ * @param limit Longest decoded frame to stream; longer frames are still discarded
+ * @param on_stream Callback receiving the pieces of streamed frames, with the feed context
+ *
+ * @return void
+ */
+void cobs_decoder_set_stream(cobs_decoder_t* dec, size_t limit, frame_stream_handler_t on_stream) {
+    dec->stream_limit = limit;
+    dec->on_stream = on_stream;
+}
+
+/**
+ * @fn void cobs_decoder_set_crc(cobs_decoder_t *dec, bool crc)
+ * @brief Expect every frame to end with a checksum, dropping the frames that fail it
+ *
+ * @param dec Decoder to configure
+ * @param crc Whether frames end with a checksum (see crc32.h)
+ *
+ * @return void
+ */
+void cobs_decoder_set_crc(cobs_decoder_t* dec, bool crc) { dec->crc = crc; }
+
+/**
+ * @fn void cobs_decoder_reset(cobs_decoder_t *dec)
+ * @brief Drop the partially received frame, keeping statistics counters
+ *
+ * @param dec Decoder to reset
+ *
+ * @return void
+ */
+void cobs_decoder_reset(cobs_decoder_t* dec) {
+    dec->len = 0;
+    dec->overflow = false;
+    dec->streaming = false;
+    dec->zero_pending = false;
+    dec->block_left = 0;
+    dec->decoded = 0;
+}
+
+/**
+ * @fn void cobs_decoder_feed(cobs_decoder_t *dec, const uint8_t *data, size_t len,
+ *                            frame_handler_t on_frame, void *ctx)
+ * @brief Consume a chunk of the byte stream and emit all frames it completes
+ *
+ * Bytes are accumulated up to the next delimiter, then the frame is decoded in
+ * place in the decoder buffer and handed to the callback. Empty frames (two
+ * consecutive delimiters) are ignored, which makes a leading delimiter usable
+ * to flush a receiver left in the middle of a frame.
+ *
+ * Once a frame outgrows the buffer it is either discarded up to its delimiter
+ * or, with a stream handler, decoded block by block through the buffer and
+ * passed on in pieces; whether it was valid COBS is only known at the
+ * delimiter, where the last piece is either completed or aborted.
+ *
+ * With checksums, frames emitted whole are checked and passed on without their
+ * checksum; streamed ones are passed on as they are.
+ *
+ * @param dec Decoder state
+ * @param data Incoming bytes
+ * @param len Number of incoming bytes
+ * @param on_frame Callback invoked once per complete, valid frame
+ * @param ctx User context forwarded to the callback
+ *
+ * @return void
+ */
+void cobs_decoder_feed(cobs_decoder_t* dec, uint8_t const* data, size_t len,
+        frame_handler_t on_frame, void* ctx) {
+    while (len > 0) {
+        uint8_t const* delimiter = memchr(data, COBS_DELIMITER, len);
+        size_t chunk = delimiter != NULL ? (size_t)(delimiter - data) : len;
+
+        if (dec->streaming) {
+            stream_decode(dec, data, chunk, ctx);
+        } else if (!dec->overflow) {
+            if (chunk > dec->capacity - dec->len && dec->on_stream != NULL) {
+                // Decode what was accumulated in place, then the rest as it comes
+                dec->streaming = true;
+                if (stream_decode(dec, dec->buf, dec->len, ctx)) {
+                    stream_decode(dec, data, chunk, ctx);
+                }
+            } else if (chunk > dec->capacity - dec->len) {
+                dec->overflow = true;
+            } else {
+                memcpy(dec->buf + dec->len, data, chunk);
+                dec->len += chunk;
+            }
+        }
+
+        if (delimiter == NULL) {
+            return;
+        }
+        data += chunk + 1;
+        len -= chunk + 1;
+
+        size_t decoded_len;
+        if (dec->overflow) {
+            dec->oversized++;
+        } else if (dec->streaming) {
+            if (dec->block_left == 0) {
+                dec->streamed++;
+                dec->on_stream(ctx, dec->buf, 0, FRAME_CHUNK_LAST);
+            } else {
+                // The delimiter came before the end of the last block
+                dec->invalid++;
+                dec->on_stream(ctx, dec->buf, 0, FRAME_CHUNK_ABORTED);
+            }
+        } else if (dec->len == 0) {
+            // Empty frame, nothing to decode
+        } else if (!cobs_decode_in_place(dec->buf, dec->len, &decoded_len)) {
+            dec->invalid++;
+        } else if (dec->crc && !frame_crc_check(dec->buf, decoded_len)) {
+            dec->crc_errors++;
+        } else {
+            decoded_len -= dec->crc ? FRAME_CRC_LEN : 0;
+            dec->frames++;
+            on_frame(ctx, dec->buf, decoded_len);
+        }
+        cobs_decoder_reset(dec);
+    }
+}
+
+/**
+ * @fn bool stream_decode(cobs_decoder_t *dec, const uint8_t *src, size_t len, void *ctx)
+ * @brief Decode the next encoded bytes of a streamed frame and pass them on
+ *
+ * The output goes through the decoder buffer, which src may be: the write
+ * position never gets ahead of the read position, as in cobs_decode_in_place().
+ * Each block's implicit zero is only written once the next block starts, since
+ * the last block of the frame carries none.
+ *
+ * @param dec Decoder state, streaming a frame
+ * @param src Encoded bytes, without delimiter
+ * @param len Number of encoded bytes
+ * @param ctx User context forwarded to the stream handler
+ *
+ * @return true to go on, false once the frame exceeded the stream limit and is discarded
+ */
+bool stream_decode(cobs_decoder_t* dec, uint8_t const* src, size_t len, void* ctx) {
+    size_t write = 0;
+
+    for (size_t read = 0; read < len;) {
+        if (write == dec->capacity) {
+            if (!stream_flush(dec, write, ctx)) {
+                return false;
+            }
+            write = 0;
+        }
+        if (dec->block_left == 0) {
+            uint8_t code = src[read++];
+            if (dec->zero_pending) {
+                dec->buf[write++] = 0x00;
+            }
+            // A full 254-byte run carries no implicit zero
+            dec->zero_pending = code != 0xFF;
+            dec->block_left = code - 1;
+            continue;
+        }
+
+        size_t run = dec->block_left;
+        if (run > len - read) {
+            run = len - read;
+        }
+        if (run > dec->capacity - write) {
+            run = dec->capacity - write;
+        }
+        memmove(dec->buf + write, src + read, run);
+        write += run;
+        read += run;
+        dec->block_left -= run;
+    }
+    return write == 0 || stream_flush(dec, write, ctx);
+}
+
+/**
+ * @fn bool stream_flush(cobs_decoder_t *dec, size_t len, void *ctx)
+ * @brief Pass the decoded bytes at the start of the buffer on to the stream handler
+ *
+ * @param dec Decoder state, streaming a frame
+ * @param len Number of decoded bytes in the buffer
+ * @param ctx User context forwarded to the stream handler
+ *
+ * @return true on success, false if the frame exceeded the stream limit: it is then
+ *         aborted and the rest of it discarded as oversized
+ */
+bool stream_flush(cobs_decoder_t* dec, size_t len, void* ctx) {
+    if (len > dec->stream_limit - dec->decoded) {
+        dec->streaming = false;
+        dec->overflow = true;
+        dec->on_stream(ctx, dec->buf, 0, FRAME_CHUNK_ABORTED);
+        return false;
+    }
+    dec->decoded += len;
+    dec->on_stream(ctx, dec->buf, len, FRAME_CHUNK_MORE);
+    return true;
+}
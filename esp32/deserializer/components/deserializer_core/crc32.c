@@ -0,0 +1,83 @@
+/**
+ * @file crc32.c
+ * @brief CRC-32 check of frames sent with a checksum
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "crc32.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_rom_crc.h"
+#else
+// CRC of each nibble value, reflected polynomial 0xEDB88320
+static uint32_t const crc_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+#endif
+
+/**
+ * @fn uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len)
+ * @brief Extend a CRC-32 with more data
+ *
+ * Chains like zlib.crc32(): start from 0, and pass the result of each call to
+ * the next one to compute the CRC of data split in pieces.
+ *
+ * @param crc CRC of the data so far, 0 for none
+ * @param data Next bytes
+ * @param len Number of bytes
+ *
+ * @return CRC of the data so far followed by data
+ */
+uint32_t crc32_update(uint32_t crc, uint8_t const* data, size_t len) {
+#ifdef ESP_PLATFORM
+    return esp_rom_crc32_le(crc, data, (uint32_t)len);
+#else
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+        crc = (crc >> 4) ^ crc_table[crc & 0x0F];
+    }
+    return ~crc;
+#endif
+}
+
+/**
+ * @fn bool frame_crc_check(const uint8_t *frame, size_t len)
+ * @brief Check the checksum that ends a frame
+ *
+ * @param frame Frame body followed by its checksum
+ * @param len Length of frame, checksum included
+ *
+ * @return true if frame ends with the CRC-32 of the rest, false otherwise
+ */
+bool frame_crc_check(uint8_t const* frame, size_t len) {
+    if (len < FRAME_CRC_LEN) {
+        return false;
+    }
+    uint8_t const* stored = frame + len - FRAME_CRC_LEN;
+    uint32_t crc = crc32_update(0, frame, len - FRAME_CRC_LEN);
+    return stored[0] == (uint8_t)crc && stored[1] == (uint8_t)(crc >> 8)
+            && stored[2] == (uint8_t)(crc >> 16) && stored[3] == (uint8_t)(crc >> 24);
+}
+
+/**
+ * @fn size_t frame_crc_append(uint8_t *frame, size_t len)
+ * @brief Append the checksum to a frame body
+ *
+ * @param frame Frame body, with room for FRAME_CRC_LEN more bytes
+ * @param len Length of the frame body
+ *
+ * @return Length of the frame with its checksum
+ */
+size_t frame_crc_append(uint8_t* frame, size_t len) {
+    uint32_t crc = crc32_update(0, frame, len);
+    for (size_t i = 0; i < FRAME_CRC_LEN; i++) {
+        frame[len + i] = (uint8_t)(crc >> (8 * i));
+    }
+    return len + FRAME_CRC_LEN;
+}
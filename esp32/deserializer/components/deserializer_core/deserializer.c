@@ -0,0 +1,1219 @@
+/**
+ * @file deserializer.c
+ * @brief Portable message pipeline: framing, Payload decoding and JSON rendering
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "deserializer.h"
+
+#include <string.h>
+
+#include "binary_record.h"
+#include "frame_protocol.h"
+#include "json_writer.h"
+
+// Longest reply frame body: a Stats with every field set, each a tag byte and a uint32 varint
+// as long as FRAME_PREFIX_MAX_BYTES, and a StageStats for every stage
+#define REPLY_FIELD_MAX_LEN (1 + FRAME_PREFIX_MAX_BYTES)
+#define STAGE_STATS_MAX_LEN (6 * REPLY_FIELD_MAX_LEN)
+#define REPLY_MAX_LEN \
+    (1 + 14 * REPLY_FIELD_MAX_LEN + DESERIALIZER_STAGE_COUNT * (2 + STAGE_STATS_MAX_LEN))
+
+static void on_frame(void* ctx, uint8_t const* frame, size_t len);
+static void on_stream(void* ctx, uint8_t const* chunk, size_t len, frame_chunk_t kind);
+static void stream_checked(deserializer_t* des, uint8_t const* chunk, size_t len);
+static bool stream_crc_valid(deserializer_stream_t const* stream);
+static void stream_bytes(deserializer_t* des, uint8_t const* chunk, size_t len);
+static void on_json_chunk(void* ctx, char const* json, size_t len, bool last);
+static void finish_stream(deserializer_t* des);
+static void abort_stream(deserializer_t* des);
+static uint32_t stage_start(deserializer_t const* des);
+static uint32_t stage_end(deserializer_t* des, deserializer_stage_t stage, uint32_t start);
+static void handle_sequenced(deserializer_t* des, uint8_t const* body, size_t len);
+static bool check_sequence(deserializer_t* des, uint8_t seq);
+static void accept_sequenced(deserializer_t* des);
+static void handle_message(deserializer_t* des, uint8_t const* frame, size_t len);
+static void handle_chunk(deserializer_t* des, uint8_t const* chunk, size_t len);
+static void emit_transfer(deserializer_t* des, chunk_slot_t const* slot);
+static void handle_compressed(deserializer_t* des, uint8_t const* body, size_t len,
+        lzss_dict_t const* dict);
+static void handle_dict_compressed(deserializer_t* des, uint8_t const* body, size_t len);
+static void handle_baud_switch(deserializer_t* des, uint8_t const* body, size_t len);
+static void handle_baud_probe(deserializer_t* des, uint8_t const* probe, size_t len);
+static void send_baud_switch(deserializer_t* des, uint32_t baud_rate);
+static void send_stats(deserializer_t* des);
+static void write_stage_stats(pb_writer_t* writer, latency_hist_t const* hist);
+static void write_counter(pb_writer_t* writer, uint32_t field, uint32_t value);
+static void send_control(deserializer_t* des, frame_type_t type, uint8_t value);
+static void send_reply_frame(deserializer_t* des, uint8_t* body, size_t len);
+static void emit_payload(deserializer_t* des, uint8_t const* payload, size_t len);
+static void emit_view(deserializer_t* des, payload_view_t const* view, size_t len);
+
+/**
+ * @fn void deserializer_init(deserializer_t *des, const deserializer_config_t *config)
+ * @brief Initialize the pipeline
+ *
+ * @param des Pipeline to initialize
+ * @param config Framing, buffers and callbacks; buffers must outlive the pipeline
+ *
+ * @return void
+ */
+void deserializer_init(deserializer_t* des, deserializer_config_t const* config) {
+    bool stream = config->callbacks.on_payload_chunk != NULL
+            && config->max_message_size > config->frame_size;
+
+    memset(des, 0, sizeof(*des));
+    des->config = *config;
+    if (config->callbacks.now_us == NULL) {
+        des->config.stage_hists = NULL;
+    }
+    if (config->framing == DESERIALIZER_FRAMING_COBS) {
+        cobs_decoder_init(&des->decoder.cobs, config->frame_buf, config->frame_size);
+        if (stream) {
+            cobs_decoder_set_stream(&des->decoder.cobs, config->max_message_size, on_stream);
+        }
+        cobs_decoder_set_crc(&des->decoder.cobs, config->frame_crc);
+    } else {
+        frame_decoder_init(&des->decoder.length_prefix, config->frame_buf, config->frame_size);
+        if (stream) {
+            frame_decoder_set_stream(
+                    &des->decoder.length_prefix, config->max_message_size, on_stream);
+        }
+        frame_decoder_set_crc(&des->decoder.length_prefix, config->frame_crc);
+    }
+    payload_stream_init(&des->stream.payload, on_json_chunk, des);
+    payload_stream_set_binary(&des->stream.payload, config->output == DESERIALIZER_OUTPUT_BINARY,
+            config->max_message_size);
+    chunk_pool_init(&des->chunks, config->chunk_buf, config->chunk_slot_size,
+            config->chunk_slots, config->chunk_timeout_ms);
+    des->baud.rate = config->baud_rate;
+    des->baud.confirmed = config->baud_rate;
+}
+
+/**
+ * @fn void deserializer_reset(deserializer_t *des)
+ * @brief Drop the partially received frame after the byte stream lost data
+ *
+ * A frame cut short while being streamed is reported as a framing error, so
+ * the output callback learns that its rendering is incomplete.
+ *
+ * @param des Pipeline to reset
+ *
+ * @return void
+ */
+void deserializer_reset(deserializer_t* des) {
+    if (des->config.framing == DESERIALIZER_FRAMING_COBS) {
+        cobs_decoder_reset(&des->decoder.cobs);
+    } else {
+        frame_decoder_reset(&des->decoder.length_prefix);
+    }
+    if (des->stream.state != DESERIALIZER_STREAM_IDLE) {
+        abort_stream(des);
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_FRAMING);
+    }
+}
+
+/**
+ * @fn void deserializer_feed(deserializer_t *des, const uint8_t *data, size_t len)
+ * @brief Consume a chunk of the received byte stream
+ *
+ * Splits the stream into frames according to the configured framing and runs
+ * deserializer_handle_frame() on each complete one. Frames discarded by the
+ * framing layer are reported through the error callback.
+ *
+ * @param des Pipeline state
+ * @param data Received bytes
+ * @param len Number of received bytes
+ *
+ * @return void
+ */
+void deserializer_feed(deserializer_t* des, uint8_t const* data, size_t len) {
+    uint32_t oversized;
+    uint32_t invalid;
+    uint32_t crc_errors;
+
+    if (des->config.framing == DESERIALIZER_FRAMING_COBS) {
+        cobs_decoder_t* dec = &des->decoder.cobs;
+        oversized = dec->oversized;
+        invalid = dec->invalid;
+        crc_errors = dec->crc_errors;
+        cobs_decoder_feed(dec, data, len, on_frame, des);
+        oversized = dec->oversized - oversized;
+        invalid = dec->invalid - invalid;
+        crc_errors = dec->crc_errors - crc_errors;
+    } else {
+        frame_decoder_t* dec = &des->decoder.length_prefix;
+        oversized = dec->oversized;
+        invalid = dec->bad_prefixes;
+        crc_errors = dec->crc_errors;
+        frame_decoder_feed(dec, data, len, on_frame, des);
+        oversized = dec->oversized - oversized;
+        invalid = dec->bad_prefixes - invalid;
+        crc_errors = dec->crc_errors - crc_errors;
+    }
+
+    for (; oversized > 0; oversized--) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_OVERSIZED);
+    }
+    for (; invalid > 0; invalid--) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_FRAMING);
+    }
+    for (; crc_errors > 0; crc_errors--) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_CRC);
+    }
+}
+
+/**
+ * @fn bool deserializer_frame_pending(const deserializer_t *des)
+ * @brief Check whether deserializer_feed() stopped in the middle of a frame
+ *
+ * Lets callers that delimit most frames themselves know when the next bytes
+ * still belong to a frame the pipeline is reassembling or streaming.
+ *
+ * @param des Pipeline state
+ *
+ * @return true if part of a frame was fed, false at a frame boundary
+ */
+bool deserializer_frame_pending(deserializer_t const* des) {
+    if (des->config.framing == DESERIALIZER_FRAMING_COBS) {
+        cobs_decoder_t const* dec = &des->decoder.cobs;
+        return dec->len > 0 || dec->overflow || dec->streaming;
+    }
+    frame_decoder_t const* dec = &des->decoder.length_prefix;
+    return dec->state != FRAME_STATE_PREFIX || dec->prefix_bytes > 0;
+}
+
+/**
+ * @fn void deserializer_handle_frame(deserializer_t *des, const uint8_t *frame, size_t len)
+ * @brief Decode one complete frame and emit the JSON rendering of its Payloads
+ *
+ * Entry point for callers that delimit frames themselves (e.g. the firmware
+ * using UART pattern detection for COBS). The first byte of the frame is its
+ * FrameType: a single Payload, a Batch or a DeltaBatch, whose entries are
+ * decoded and rendered one after the other straight from the frame buffer, or
+ * one of those wrapped in a sequenced frame, or a SYNC that restarts the
+ * sequence numbering, or a baud rate switch or probe, or a query for the
+ * counters.
+ *
+ * @param des Pipeline state
+ * @param frame Frame type byte followed by the encoded message
+ * @param len Length of the frame
+ *
+ * @return void
+ */
+void deserializer_handle_frame(deserializer_t* des, uint8_t const* frame, size_t len) {
+    des->stats.frames++;
+    des->stats.bytes += len;
+
+    if (len == 0) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+        return;
+    }
+
+    switch (frame[0]) {
+    case FRAME_TYPE_SEQUENCED:
+        handle_sequenced(des, frame + 1, len - 1);
+        break;
+    case FRAME_TYPE_SYNC:
+        if (len != 2) {
+            deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+            break;
+        }
+        des->window.expected_seq = frame[1];
+        des->window.nack_sent = false;
+        send_control(des, FRAME_TYPE_ACK, des->window.expected_seq);
+        break;
+    case FRAME_TYPE_BAUD:
+        handle_baud_switch(des, frame + 1, len - 1);
+        break;
+    case FRAME_TYPE_BAUD_PROBE:
+        handle_baud_probe(des, frame + 1, len - 1);
+        break;
+    case FRAME_TYPE_STATS:
+        if (len != 1) {
+            deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+            break;
+        }
+        send_stats(des);
+        break;
+    default:
+        handle_message(des, frame, len);
+        break;
+    }
+}
+
+/**
+ * @fn void deserializer_drop_frame(deserializer_t *des, deserializer_error_t error)
+ * @brief Account for a dropped frame and report it through the error callback
+ *
+ * Called internally for every dropped frame, and by callers that delimit frames
+ * themselves when they have to discard one before it reaches the pipeline.
+ *
+ * @param des Pipeline state
+ * @param error Reason the frame was dropped
+ *
+ * @return void
+ */
+void deserializer_drop_frame(deserializer_t* des, deserializer_error_t error) {
+    // Unpack, oversized, framing and CRC errors may come from either side (see deserializer.h)
+    switch (error) {
+    case DESERIALIZER_ERROR_UNPACK:
+        atomic_fetch_add_explicit(&des->stats.unpack_errors, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&des->baud.bad_frames, 1, memory_order_relaxed);
+        break;
+    case DESERIALIZER_ERROR_JSON:
+        des->stats.json_errors++;
+        break;
+    case DESERIALIZER_ERROR_OVERSIZED:
+        atomic_fetch_add_explicit(&des->stats.oversized, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&des->baud.bad_frames, 1, memory_order_relaxed);
+        break;
+    case DESERIALIZER_ERROR_FRAMING:
+        atomic_fetch_add_explicit(&des->stats.framing_errors, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&des->baud.bad_frames, 1, memory_order_relaxed);
+        break;
+    case DESERIALIZER_ERROR_TRANSFER:
+        des->stats.transfer_errors++;
+        break;
+    case DESERIALIZER_ERROR_DICTIONARY:
+        des->stats.dict_mismatches++;
+        break;
+    case DESERIALIZER_ERROR_CRC:
+        atomic_fetch_add_explicit(&des->stats.crc_errors, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&des->baud.bad_frames, 1, memory_order_relaxed);
+        break;
+    }
+
+    if (des->config.callbacks.on_error != NULL) {
+        des->config.callbacks.on_error(des->config.callbacks.ctx, error);
+    }
+}
+
+/**
+ * @fn void deserializer_send_credit(deserializer_t *des, uint32_t consumed, uint32_t window)
+ * @brief Advertise the receive buffer space to the sender in a Credit frame
+ *
+ * The sender may have up to consumed + window bytes written in total. Credits
+ * are absolute, so a lost Credit frame is made up for by the next one.
+ *
+ * @param des Pipeline state
+ * @param consumed Bytes read out of the receive buffer so far (wrapping at 2^32)
+ * @param window Size of the receive buffer in bytes
+ *
+ * @return void
+ */
+void deserializer_send_credit(deserializer_t* des, uint32_t consumed, uint32_t window) {
+    // Type byte and two uint32 fields, then the checksum
+    uint8_t body[1 + 2 * REPLY_FIELD_MAX_LEN + FRAME_CRC_LEN];
+    pb_writer_t writer;
+
+    body[0] = FRAME_TYPE_CREDIT;
+    pb_writer_init(&writer, body + 1, 2 * REPLY_FIELD_MAX_LEN);
+    pb_write_tag(&writer, CREDIT_FIELD_CONSUMED, PB_WIRE_VARINT);
+    pb_write_varint(&writer, consumed);
+    pb_write_tag(&writer, CREDIT_FIELD_WINDOW, PB_WIRE_VARINT);
+    pb_write_varint(&writer, window);
+    send_reply_frame(des, body, 1 + writer.len);
+}
+
+/**
+ * @fn bool deserializer_check_baud(deserializer_t *des)
+ * @brief Restore the last confirmed baud rate if the sender did not confirm the new one in time
+ *
+ * Must be called periodically while des->baud.probation is set, whether frames
+ * arrive or not: after a switch to a rate that does not work, none will. The
+ * bytes received at the rate undone are garbage, so after a revert the caller
+ * should flush its input and resynchronize the framing (deserializer_reset()).
+ *
+ * Otherwise, after autobaud_errors bad frames in a row, switches to the rate
+ * measure_baud_rate finds the sender using, which also calls for a flush; with
+ * auto-baud, it must be called after the frames are handled as well.
+ *
+ * @param des Pipeline state
+ *
+ * @return true if the baud rate was just changed, false otherwise
+ */
+bool deserializer_check_baud(deserializer_t* des) {
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+
+    if (atomic_load_explicit(&des->baud.probation, memory_order_relaxed)) {
+        if (cb->now_ms(cb->ctx) - des->baud.switched_ms < des->config.baud_timeout_ms) {
+            return false;
+        }
+        atomic_store_explicit(&des->baud.probation, false, memory_order_relaxed);
+        des->baud.rate = des->baud.confirmed;
+        // Received at the rate undone
+        atomic_store_explicit(&des->baud.bad_frames, 0, memory_order_relaxed);
+        des->stats.baud_reverts++;
+        cb->set_baud_rate(cb->ctx, des->baud.rate);
+        return true;
+    }
+    uint32_t bad_frames = atomic_load_explicit(&des->baud.bad_frames, memory_order_relaxed);
+    if (des->config.autobaud_errors == 0 || bad_frames < des->config.autobaud_errors
+            || cb->measure_baud_rate == NULL || cb->set_baud_rate == NULL) {
+        return false;
+    }
+    // Measured again only after as many bad frames, should this measurement fail; those the
+    // framing side counted meanwhile are kept
+    atomic_fetch_sub_explicit(&des->baud.bad_frames, bad_frames, memory_order_relaxed);
+    uint32_t rate = deserializer_standard_baud(cb->measure_baud_rate(cb->ctx));
+    if (rate == 0 || rate == des->baud.rate || !cb->set_baud_rate(cb->ctx, rate)) {
+        return false;
+    }
+    des->baud.rate = rate;
+    des->baud.confirmed = rate;
+    des->stats.baud_detections++;
+    return true;
+}
+
+/**
+ * @fn uint32_t deserializer_standard_baud(uint32_t measured)
+ * @brief Standard baud rate a measured one stands for
+ *
+ * @param measured Baud rate measured on the line
+ *
+ * @return The standard rate within 1/DESERIALIZER_BAUD_TOLERANCE of measured, or 0 if none is
+ */
+uint32_t deserializer_standard_baud(uint32_t measured) {
+    static uint32_t const rates[] = { 1200, 2400, 4800, 9600, 19200, 38400, 57600, 74880,
+        115200, 230400, 250000, 460800, 500000, 921600, 1000000, 1500000, 2000000, 2500000,
+        3000000, 5000000 };
+
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        uint32_t diff = measured > rates[i] ? measured - rates[i] : rates[i] - measured;
+        if (diff <= rates[i] / DESERIALIZER_BAUD_TOLERANCE) {
+            return rates[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @fn const char *deserializer_stage_name(deserializer_stage_t stage)
+ * @brief Short name of a stage, for reports of the stage histograms
+ *
+ * @param stage Stage
+ *
+ * @return Static lowercase name, "?" for a value out of range
+ */
+char const* deserializer_stage_name(deserializer_stage_t stage) {
+    static char const* const names[DESERIALIZER_STAGE_COUNT] = {
+        [DESERIALIZER_STAGE_WAIT] = "wait",
+        [DESERIALIZER_STAGE_READ] = "read",
+        [DESERIALIZER_STAGE_DECODE] = "decode",
+        [DESERIALIZER_STAGE_RENDER] = "render",
+        [DESERIALIZER_STAGE_OUTPUT] = "output",
+        [DESERIALIZER_STAGE_LOG] = "log",
+    };
+    return (unsigned)stage < DESERIALIZER_STAGE_COUNT ? names[stage] : "?";
+}
+
+/**
+ * @fn void emit_payload(deserializer_t *des, const uint8_t *payload, size_t len)
+ * @brief Decode one encoded Payload and emit its JSON rendering
+ *
+ * The specialized Payload decoder is tried first; messages with unknown fields
+ * go through the fallback decoder if one is configured.
+ *
+ * @param des Pipeline state
+ * @param payload Encoded Payload
+ * @param len Length of the encoded Payload
+ *
+ * @return void
+ */
+void emit_payload(deserializer_t* des, uint8_t const* payload, size_t len) {
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+    payload_view_t view;
+    uint32_t start = stage_start(des);
+
+    payload_decode_status_t status = payload_view_decode(payload, len, &view);
+    if (status == PAYLOAD_DECODE_UNKNOWN_FIELD && cb->unpack_fallback != NULL
+            && cb->unpack_fallback(cb->ctx, payload, len, &view)) {
+        status = PAYLOAD_DECODE_OK;
+    }
+    stage_end(des, DESERIALIZER_STAGE_DECODE, start);
+
+    if (status != PAYLOAD_DECODE_OK) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+        if (cb->on_payload_done != NULL) {
+            cb->on_payload_done(cb->ctx);
+        }
+        return;
+    }
+    emit_view(des, &view, len);
+}
+
+/**
+ * @fn void emit_view(deserializer_t *des, const payload_view_t *view, size_t len)
+ * @brief Render a decoded message to JSON, or write its binary record, and pass it to the
+ *        output callback
+ *
+ * @param des Pipeline state
+ * @param view Decoded message
+ * @param len Number of frame bytes the message was decoded from
+ *
+ * @return void
+ */
+void emit_view(deserializer_t* des, payload_view_t const* view, size_t len) {
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+    uint32_t start = stage_start(des);
+
+    atomic_store_explicit(&des->baud.bad_frames, 0, memory_order_relaxed);
+    size_t json_len = des->config.output == DESERIALIZER_OUTPUT_BINARY
+            ? binary_record_write((uint8_t*)des->config.json_buf, des->config.json_size,
+                      view->timestamp, view->data, view->data_len)
+            : json_write_payload(des->config.json_buf, des->config.json_size, view->timestamp,
+                      view->data, view->data_len);
+    start = stage_end(des, DESERIALIZER_STAGE_RENDER, start);
+    if (json_len == 0) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_JSON);
+    } else {
+        des->stats.payloads++;
+        cb->on_payload(cb->ctx, len, des->config.json_buf, json_len);
+        stage_end(des, DESERIALIZER_STAGE_OUTPUT, start);
+    }
+
+    if (cb->on_payload_done != NULL) {
+        cb->on_payload_done(cb->ctx);
+    }
+}
+
+/**
+ * @fn void handle_sequenced(deserializer_t *des, const uint8_t *body, size_t len)
+ * @brief Accept a sequenced frame if it is the next one in order and acknowledge it
+ *
+ * Go-back-N receiver: only the expected sequence number is decoded, so no frame
+ * has to be buffered. A frame from further ahead means earlier ones were lost;
+ * it is dropped and the first one of the gap is NACKed once, since the sender
+ * resends everything from there. Frames from behind were already accepted and
+ * are only acknowledged again, in case the previous ACK was lost.
+ *
+ * @param des Pipeline state
+ * @param body Sequence number byte followed by the wrapped frame
+ * @param len Length of body
+ *
+ * @return void
+ */
+void handle_sequenced(deserializer_t* des, uint8_t const* body, size_t len) {
+    if (len < 2) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+        return;
+    }
+    if (check_sequence(des, body[0])) {
+        handle_message(des, body + 1, len - 1);
+        accept_sequenced(des);
+    }
+}
+
+/**
+ * @fn bool check_sequence(deserializer_t *des, uint8_t seq)
+ * @brief Tell whether a sequenced frame is the next one, answering for it otherwise
+ *
+ * @param des Pipeline state
+ * @param seq Sequence number of the frame
+ *
+ * @return true if the frame is to be decoded and then accepted with accept_sequenced(),
+ *         false if it was dropped (and NACKed or acknowledged again as needed)
+ */
+bool check_sequence(deserializer_t* des, uint8_t seq) {
+    deserializer_window_t* window = &des->window;
+
+    uint8_t ahead = (uint8_t)(seq - window->expected_seq);
+    if (ahead == 0) {
+        return true;
+    }
+    if (ahead <= DESERIALIZER_MAX_WINDOW) {
+        des->stats.out_of_order++;
+        if (!window->nack_sent) {
+            window->nack_sent = true;
+            send_control(des, FRAME_TYPE_NACK, window->expected_seq);
+        }
+    } else {
+        des->stats.duplicates++;
+        send_control(des, FRAME_TYPE_ACK, window->expected_seq);
+    }
+    return false;
+}
+
+/**
+ * @fn void accept_sequenced(deserializer_t *des)
+ * @brief Move past the in-order frame just decoded and acknowledge it
+ *
+ * @param des Pipeline state
+ *
+ * @return void
+ */
+void accept_sequenced(deserializer_t* des) {
+    deserializer_window_t* window = &des->window;
+
+    window->expected_seq++;
+    window->nack_sent = false;
+    send_control(des, FRAME_TYPE_ACK, window->expected_seq);
+}
+
+/**
+ * @fn void handle_message(deserializer_t *des, const uint8_t *frame, size_t len)
+ * @brief Decode a message frame, possibly compressed, and emit its JSON renderings
+ *
+ * @param des Pipeline state
+ * @param frame Frame type byte followed by the encoded message, at least 1 byte
+ * @param len Length of the frame
+ *
+ * @return void
+ */
+void handle_message(deserializer_t* des, uint8_t const* frame, size_t len) {
+    switch (frame[0]) {
+    case FRAME_TYPE_PAYLOAD:
+        emit_payload(des, frame + 1, len - 1);
+        break;
+    case FRAME_TYPE_BATCH: {
+        pb_reader_t reader;
+        uint8_t const* payload;
+        size_t payload_len;
+        payload_batch_status_t status;
+
+        des->stats.batches++;
+        pb_reader_init(&reader, frame + 1, len - 1);
+        while ((status = payload_batch_next(&reader, &payload, &payload_len))
+                == PAYLOAD_BATCH_ENTRY) {
+            emit_payload(des, payload, payload_len);
+        }
+        if (status == PAYLOAD_BATCH_MALFORMED) {
+            deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+        }
+        break;
+    }
+    case FRAME_TYPE_DELTA_BATCH: {
+        delta_batch_reader_t reader;
+        payload_view_t view;
+        size_t wire_len;
+
+        des->stats.batches++;
+        if (!delta_batch_init(&reader, frame + 1, len - 1)) {
+            deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+            break;
+        }
+        uint32_t start = stage_start(des);
+        while (delta_batch_next(&reader, &view, &wire_len) == PAYLOAD_BATCH_ENTRY) {
+            stage_end(des, DESERIALIZER_STAGE_DECODE, start);
+            emit_view(des, &view, wire_len);
+            start = stage_start(des);
+        }
+        break;
+    }
+    case FRAME_TYPE_CHUNK:
+        handle_chunk(des, frame + 1, len - 1);
+        break;
+    case FRAME_TYPE_COMPRESSED:
+        handle_compressed(des, frame + 1, len - 1, NULL);
+        break;
+    case FRAME_TYPE_DICT_COMPRESSED:
+        handle_dict_compressed(des, frame + 1, len - 1);
+        break;
+    default:
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+        break;
+    }
+}
+
+/**
+ * @fn void handle_chunk(deserializer_t *des, const uint8_t *chunk, size_t len)
+ * @brief Add a Chunk to its transfer and emit the Payload once the transfer is complete
+ *
+ * Transfers that timed out are dropped first, so their slots can be reused.
+ * Every transfer dropped, by the pool or here, is reported as a transfer error.
+ *
+ * @param des Pipeline state
+ * @param chunk Encoded Chunk
+ * @param len Length of the encoded Chunk
+ *
+ * @return void
+ */
+void handle_chunk(deserializer_t* des, uint8_t const* chunk, size_t len) {
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+    chunk_pool_t* pool = &des->chunks;
+    chunk_pool_stats_t const* stats = &pool->stats;
+    chunk_view_t view;
+    chunk_slot_t* slot;
+
+    if (pool->count == 0 || !chunk_view_decode(chunk, len, &view)) {
+        // Not configured for chunked transfers, like any other unsupported frame
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+        return;
+    }
+    des->stats.chunks++;
+
+    uint32_t now = cb->now_ms != NULL ? cb->now_ms(cb->ctx) : 0;
+    uint32_t dropped = stats->dropped + stats->expired + stats->evicted;
+    if (cb->now_ms != NULL) {
+        chunk_pool_expire(pool, now);
+    }
+    // The FrameType byte is part of the frame the chunk arrived in
+    chunk_pool_status_t status = chunk_pool_add(pool, &view, 1 + len, now, &slot);
+    for (dropped = stats->dropped + stats->expired + stats->evicted - dropped; dropped > 0;
+            dropped--) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_TRANSFER);
+    }
+
+    if (status == CHUNK_POOL_COMPLETE) {
+        des->stats.transfers++;
+        emit_transfer(des, slot);
+        chunk_pool_release(pool, slot);
+    }
+}
+
+/**
+ * @fn void emit_transfer(deserializer_t *des, const chunk_slot_t *slot)
+ * @brief Render a reassembled chunked transfer and pass it to the output callbacks
+ *
+ * @param des Pipeline state
+ * @param slot Completed transfer
+ *
+ * @return void
+ */
+void emit_transfer(deserializer_t* des, chunk_slot_t const* slot) {
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+    payload_view_t const view = {
+        .timestamp = slot->timestamp,
+        .data = (char const*)slot->data,
+        .data_len = slot->len,
+    };
+
+    if (cb->on_payload_chunk != NULL) {
+        payload_stream_render(&des->stream.payload, &view, slot->frame_bytes);
+    } else {
+        emit_view(des, &view, slot->frame_bytes);
+    }
+}
+
+/**
+ * @fn void handle_compressed(deserializer_t *des, const uint8_t *body, size_t len,
+ *                            const lzss_dict_t *dict)
+ * @brief Decompress a compressed frame and handle the frame it carries
+ *
+ * The original frame must be a message frame; a compressed frame inside another
+ * would need a second buffer and gains nothing, so it is dropped.
+ *
+ * @param des Pipeline state
+ * @param body LZSS stream of the original frame
+ * @param len Length of body
+ * @param dict Dictionary the stream was compressed against, or NULL for none
+ *
+ * @return void
+ */
+void handle_compressed(deserializer_t* des, uint8_t const* body, size_t len,
+        lzss_dict_t const* dict) {
+    uint8_t* frame = des->config.decompress_buf;
+    size_t frame_len;
+
+    if (frame == NULL
+            || !lzss_decompress_dict(dict, body, len, frame, des->config.decompress_size,
+                    &frame_len)
+            || frame_len == 0 || frame[0] == FRAME_TYPE_COMPRESSED
+            || frame[0] == FRAME_TYPE_DICT_COMPRESSED) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+        return;
+    }
+    des->stats.compressed++;
+    handle_message(des, frame, frame_len);
+}
+
+/**
+ * @fn void handle_dict_compressed(deserializer_t *des, const uint8_t *body, size_t len)
+ * @brief Check the dictionary version of a dictionary-compressed frame and decompress it
+ *
+ * @param des Pipeline state
+ * @param body Dictionary version byte, then the LZSS stream of the original frame
+ * @param len Length of body
+ *
+ * @return void
+ */
+void handle_dict_compressed(deserializer_t* des, uint8_t const* body, size_t len) {
+    lzss_dict_t const* dict = des->config.dict;
+
+    if (len == 0) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+        return;
+    }
+    if (dict == NULL || body[0] != dict->version) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_DICTIONARY);
+        return;
+    }
+    handle_compressed(des, body + 1, len - 1, dict);
+}
+
+/**
+ * @fn void handle_baud_switch(deserializer_t *des, const uint8_t *body, size_t len)
+ * @brief Switch to the baud rate a BaudSwitch asks for, or confirm the current one
+ *
+ * The echo goes out at the old rate, before the switch, and tells the sender
+ * which rate to use: the requested one, or the current one when it is refused.
+ * Rates are refused before the echo, so the sender is only told to switch to a
+ * rate set_baud_rate should accept; if it still fails, the link stays at the
+ * current rate off probation, and the sender falls back once its probes at the
+ * new rate go unanswered.
+ * A request for the rate on probation confirms it; while on probation, the
+ * rate restored on timeout stays the last confirmed one.
+ *
+ * @param des Pipeline state
+ * @param body Encoded BaudSwitch
+ * @param len Length of body
+ *
+ * @return void
+ */
+void handle_baud_switch(deserializer_t* des, uint8_t const* body, size_t len) {
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+    uint64_t rate = 0;
+    pb_reader_t reader;
+
+    pb_reader_init(&reader, body, len);
+    while (!pb_reader_done(&reader)) {
+        uint32_t field;
+        uint32_t wire_type;
+        bool valid = pb_read_tag(&reader, &field, &wire_type);
+        if (valid && field == BAUD_SWITCH_FIELD_BAUD_RATE && wire_type == PB_WIRE_VARINT) {
+            valid = pb_read_varint(&reader, &rate);
+        } else if (valid) {
+            valid = pb_skip_field(&reader, wire_type);
+        }
+        if (!valid) {
+            deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+            return;
+        }
+    }
+
+    atomic_store_explicit(&des->baud.bad_frames, 0, memory_order_relaxed);
+    if (rate == des->baud.rate) {
+        if (atomic_load_explicit(&des->baud.probation, memory_order_relaxed)) {
+            atomic_store_explicit(&des->baud.probation, false, memory_order_relaxed);
+            des->baud.confirmed = des->baud.rate;
+            des->stats.baud_switches++;
+        }
+        send_baud_switch(des, des->baud.rate);
+        return;
+    }
+    if (rate == 0 || rate > des->config.max_baud_rate || cb->set_baud_rate == NULL
+            || cb->now_ms == NULL
+            || (cb->can_set_baud_rate != NULL && !cb->can_set_baud_rate(cb->ctx, (uint32_t)rate))) {
+        send_baud_switch(des, des->baud.rate);
+        return;
+    }
+    send_baud_switch(des, (uint32_t)rate);
+    if (cb->set_baud_rate(cb->ctx, (uint32_t)rate)) {
+        des->baud.rate = (uint32_t)rate;
+        atomic_store_explicit(&des->baud.probation, true, memory_order_relaxed);
+        des->baud.switched_ms = cb->now_ms(cb->ctx);
+    }
+}
+
+/**
+ * @fn void handle_baud_probe(deserializer_t *des, const uint8_t *probe, size_t len)
+ * @brief Answer a probe with the number of its bytes that differ from the pattern
+ *
+ * Missing or extra bytes count as errors too; the count saturates at 255.
+ *
+ * @param des Pipeline state
+ * @param probe Probe pattern as received
+ * @param len Length of probe
+ *
+ * @return void
+ */
+void handle_baud_probe(deserializer_t* des, uint8_t const* probe, size_t len) {
+    size_t errors = len > DESERIALIZER_BAUD_PROBE_LEN ? len - DESERIALIZER_BAUD_PROBE_LEN
+                                                      : DESERIALIZER_BAUD_PROBE_LEN - len;
+
+    for (size_t i = 0; i < len && i < DESERIALIZER_BAUD_PROBE_LEN; i++) {
+        errors += probe[i] != DESERIALIZER_BAUD_PROBE_BYTE(i);
+    }
+    send_control(des, FRAME_TYPE_BAUD_PROBE, errors > UINT8_MAX ? UINT8_MAX : (uint8_t)errors);
+}
+
+/**
+ * @fn void send_baud_switch(deserializer_t *des, uint32_t baud_rate)
+ * @brief Send a BaudSwitch back to the sender
+ *
+ * @param des Pipeline state
+ * @param baud_rate Rate the pipeline is about to use
+ *
+ * @return void
+ */
+void send_baud_switch(deserializer_t* des, uint32_t baud_rate) {
+    uint8_t body[1 + REPLY_FIELD_MAX_LEN + FRAME_CRC_LEN];  // Type byte, one uint32 field, checksum
+    pb_writer_t writer;
+
+    body[0] = FRAME_TYPE_BAUD;
+    pb_writer_init(&writer, body + 1, REPLY_FIELD_MAX_LEN);
+    pb_write_tag(&writer, BAUD_SWITCH_FIELD_BAUD_RATE, PB_WIRE_VARINT);
+    pb_write_varint(&writer, baud_rate);
+    send_reply_frame(des, body, 1 + writer.len);
+}
+
+/**
+ * @fn void send_stats(deserializer_t *des)
+ * @brief Answer a STATS frame with a Stats message
+ *
+ * The caller's counters come from on_stats_query, the histograms from
+ * stage_hists, which may still be updated by another task while they are
+ * summarized: the figures are a snapshot within a sample or so. Fields that
+ * are 0 are left out, as protobuf does.
+ *
+ * @param des Pipeline state
+ *
+ * @return void
+ */
+void send_stats(deserializer_t* des) {
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+    deserializer_stats_t const* stats = &des->stats;
+    deserializer_device_stats_t device = { 0 };
+    uint8_t body[REPLY_MAX_LEN + FRAME_CRC_LEN];
+    pb_writer_t writer;
+
+    if (cb->on_stats_query != NULL) {
+        cb->on_stats_query(cb->ctx, &device);
+    }
+    body[0] = FRAME_TYPE_STATS;
+    pb_writer_init(&writer, body + 1, REPLY_MAX_LEN - 1);
+    write_counter(&writer, STATS_FIELD_UPTIME_MS, device.uptime_ms);
+    write_counter(&writer, STATS_FIELD_FRAMES, stats->frames);
+    write_counter(&writer, STATS_FIELD_PAYLOADS, stats->payloads);
+    write_counter(&writer, STATS_FIELD_BYTES, stats->bytes);
+    write_counter(&writer, STATS_FIELD_UNPACK_ERRORS,
+            atomic_load_explicit(&stats->unpack_errors, memory_order_relaxed));
+    write_counter(&writer, STATS_FIELD_FRAMING_ERRORS,
+            atomic_load_explicit(&stats->framing_errors, memory_order_relaxed));
+    write_counter(&writer, STATS_FIELD_CRC_ERRORS,
+            atomic_load_explicit(&stats->crc_errors, memory_order_relaxed));
+    write_counter(&writer, STATS_FIELD_OVERFLOWS, device.overflows);
+    write_counter(&writer, STATS_FIELD_QUEUE_DROPPED, device.queue_dropped);
+    write_counter(&writer, STATS_FIELD_LOG_DROPPED, device.log_dropped);
+    write_counter(&writer, STATS_FIELD_RX_HIGH_WATER, device.rx_high_water);
+    write_counter(&writer, STATS_FIELD_FRAME_QUEUE_HIGH_WATER, device.frame_queue_high_water);
+    write_counter(&writer, STATS_FIELD_OUTPUT_QUEUE_HIGH_WATER, device.output_queue_high_water);
+    write_counter(&writer, STATS_FIELD_MIN_FREE_HEAP, device.min_free_heap);
+    if (des->config.stage_hists != NULL) {
+        // Every stage, even without samples, so that the position of an entry is its stage
+        for (int stage = 0; stage < DESERIALIZER_STAGE_COUNT; stage++) {
+            write_stage_stats(&writer, &des->config.stage_hists[stage]);
+        }
+    }
+    send_reply_frame(des, body, 1 + writer.len);
+}
+
+/**
+ * @fn void write_stage_stats(pb_writer_t *writer, const latency_hist_t *hist)
+ * @brief Append the summary of a stage histogram to a Stats message as a StageStats
+ *
+ * @param writer Writer of the Stats message
+ * @param hist Histogram of the stage
+ *
+ * @return void
+ */
+void write_stage_stats(pb_writer_t* writer, latency_hist_t const* hist) {
+    uint8_t buf[STAGE_STATS_MAX_LEN];
+    pb_writer_t stage;
+
+    pb_writer_init(&stage, buf, sizeof(buf));
+    write_counter(&stage, STAGE_STATS_FIELD_SAMPLES, hist->samples);
+    write_counter(&stage, STAGE_STATS_FIELD_MEAN_US, latency_hist_mean(hist));
+    write_counter(&stage, STAGE_STATS_FIELD_P50_US, latency_hist_percentile(hist, 50));
+    write_counter(&stage, STAGE_STATS_FIELD_P90_US, latency_hist_percentile(hist, 90));
+    write_counter(&stage, STAGE_STATS_FIELD_P99_US, latency_hist_percentile(hist, 99));
+    write_counter(&stage, STAGE_STATS_FIELD_MAX_US, hist->max_us);
+    pb_write_len(writer, STATS_FIELD_STAGES, buf, stage.len);
+}
+
+/**
+ * @fn void write_counter(pb_writer_t *writer, uint32_t field, uint32_t value)
+ * @brief Append a uint32 field, unless it is 0
+ *
+ * @param writer Writer to append to
+ * @param field Field number
+ * @param value Field value
+ *
+ * @return void
+ */
+void write_counter(pb_writer_t* writer, uint32_t field, uint32_t value) {
+    if (value != 0) {
+        pb_write_tag(writer, field, PB_WIRE_VARINT);
+        pb_write_varint(writer, value);
+    }
+}
+
+/**
+ * @fn void send_control(deserializer_t *des, frame_type_t type, uint8_t value)
+ * @brief Send an ACK, NACK or probe answer back to the sender
+ *
+ * @param des Pipeline state
+ * @param type FRAME_TYPE_ACK, FRAME_TYPE_NACK or FRAME_TYPE_BAUD_PROBE
+ * @param value Sequence number or error count carried by the reply
+ *
+ * @return void
+ */
+void send_control(deserializer_t* des, frame_type_t type, uint8_t value) {
+    uint8_t reply[2 + FRAME_CRC_LEN] = { (uint8_t)type, value };
+    send_reply_frame(des, reply, 2);
+}
+
+/**
+ * @fn void send_reply_frame(deserializer_t *des, uint8_t *body, size_t len)
+ * @brief Frame a reply with the configured framing and pass it to send_reply
+ *
+ * @param des Pipeline state
+ * @param body Frame type byte followed by the reply, at most REPLY_MAX_LEN bytes, with room
+ *             for FRAME_CRC_LEN more bytes after them for the checksum
+ * @param len Length of body, without checksum
+ *
+ * @return void
+ */
+void send_reply_frame(deserializer_t* des, uint8_t* body, size_t len) {
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+    // Also fits a varint length prefix, which is shorter than the COBS overhead
+    uint8_t out[COBS_ENCODED_MAX_LEN(REPLY_MAX_LEN + FRAME_CRC_LEN)];
+    pb_writer_t writer;
+    size_t out_len;
+
+    if (cb->send_reply == NULL || len > REPLY_MAX_LEN) {
+        return;
+    }
+    if (des->config.frame_crc) {
+        len = frame_crc_append(body, len);
+    }
+    if (des->config.framing == DESERIALIZER_FRAMING_COBS) {
+        out_len = cobs_encode(body, len, out, sizeof(out));
+    } else {
+        pb_writer_init(&writer, out, sizeof(out));
+        pb_write_varint(&writer, len);
+        memcpy(out + writer.len, body, len);
+        out_len = writer.len + len;
+    }
+    cb->send_reply(cb->ctx, out, out_len);
+}
+
+/**
+ * @fn void on_frame(void *ctx, const uint8_t *frame, size_t len)
+ * @brief Frame decoder callback forwarding complete frames to the pipeline, or to the
+ *        on_frame callback when one is set
+ */
+void on_frame(void* ctx, uint8_t const* frame, size_t len) {
+    deserializer_t* des = ctx;
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+
+    if (cb->on_frame != NULL) {
+        cb->on_frame(cb->ctx, frame, len);
+    } else {
+        deserializer_handle_frame(des, frame, len);
+    }
+}
+
+/**
+ * @fn void on_stream(void *ctx, const uint8_t *chunk, size_t len, frame_chunk_t kind)
+ * @brief Frame decoder callback for the pieces of a frame longer than the frame buffer
+ *
+ * Follows the frame header byte by byte as it arrives, then feeds the Payload
+ * to the streaming decoder. Only single Payloads, possibly sequenced, can be
+ * streamed: the rest of any other frame is ignored and it is reported as
+ * oversized once complete. A sequenced frame out of order is answered as soon
+ * as its sequence number is known; an in-order one is only acknowledged once
+ * complete, so a frame cut short is resent.
+ *
+ * With frame_crc, the last FRAME_CRC_LEN bytes received are held back, since
+ * they are the checksum if the frame ends there; a frame failing it is dropped
+ * once complete, with its rendering unfinished.
+ */
+void on_stream(void* ctx, uint8_t const* chunk, size_t len, frame_chunk_t kind) {
+    deserializer_t* des = ctx;
+    deserializer_stream_t* stream = &des->stream;
+
+    if (kind == FRAME_CHUNK_ABORTED) {
+        // The framing layer reports the dropped frame itself
+        abort_stream(des);
+        return;
+    }
+    if (stream->state == DESERIALIZER_STREAM_IDLE) {
+        stream->state = DESERIALIZER_STREAM_TYPE;
+        stream->sequenced = false;
+        stream->accepted = false;
+        stream->unsupported = false;
+        stream->len = 0;
+        stream->crc = 0;
+        stream->tail_len = 0;
+    }
+
+    if (des->config.frame_crc) {
+        stream_checked(des, chunk, len);
+    } else {
+        stream_bytes(des, chunk, len);
+    }
+
+    if (kind == FRAME_CHUNK_LAST) {
+        if (des->config.frame_crc && !stream_crc_valid(stream)) {
+            abort_stream(des);
+            deserializer_drop_frame(des, DESERIALIZER_ERROR_CRC);
+            return;
+        }
+        finish_stream(des);
+    }
+}
+
+/**
+ * @fn void stream_checked(deserializer_t *des, const uint8_t *chunk, size_t len)
+ * @brief Pass on the bytes of a streamed frame with a checksum, but for the last FRAME_CRC_LEN
+ */
+void stream_checked(deserializer_t* des, uint8_t const* chunk, size_t len) {
+    deserializer_stream_t* stream = &des->stream;
+    size_t total = stream->tail_len + len;
+    size_t release = total > FRAME_CRC_LEN ? total - FRAME_CRC_LEN : 0;
+    size_t from_tail = release < stream->tail_len ? release : stream->tail_len;
+    size_t from_chunk = release - from_tail;
+
+    stream->crc = crc32_update(stream->crc, stream->tail, from_tail);
+    stream_bytes(des, stream->tail, from_tail);
+    stream->crc = crc32_update(stream->crc, chunk, from_chunk);
+    stream_bytes(des, chunk, from_chunk);
+
+    memmove(stream->tail, stream->tail + from_tail, stream->tail_len - from_tail);
+    stream->tail_len -= (uint8_t)from_tail;
+    memcpy(stream->tail + stream->tail_len, chunk + from_chunk, len - from_chunk);
+    stream->tail_len += (uint8_t)(len - from_chunk);
+}
+
+/**
+ * @fn bool stream_crc_valid(const deserializer_stream_t *stream)
+ * @brief Check the bytes held back at the end of a streamed frame against its checksum
+ */
+bool stream_crc_valid(deserializer_stream_t const* stream) {
+    if (stream->tail_len != FRAME_CRC_LEN) {
+        return false;
+    }
+    for (size_t i = 0; i < FRAME_CRC_LEN; i++) {
+        if (stream->tail[i] != (uint8_t)(stream->crc >> (8 * i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @fn void stream_bytes(deserializer_t *des, const uint8_t *chunk, size_t len)
+ * @brief Follow the next bytes of a streamed frame
+ */
+void stream_bytes(deserializer_t* des, uint8_t const* chunk, size_t len) {
+    deserializer_stream_t* stream = &des->stream;
+    size_t pos = 0;
+
+    stream->len += len;
+    while (pos < len) {
+        switch (stream->state) {
+        case DESERIALIZER_STREAM_TYPE: {
+            uint8_t type = chunk[pos++];
+            if (type == FRAME_TYPE_SEQUENCED && !stream->sequenced) {
+                stream->sequenced = true;
+                stream->state = DESERIALIZER_STREAM_SEQ;
+            } else if (type == FRAME_TYPE_PAYLOAD) {
+                payload_stream_begin(&stream->payload);
+                stream->state = DESERIALIZER_STREAM_PAYLOAD;
+            } else {
+                stream->unsupported = true;
+                stream->state = DESERIALIZER_STREAM_SKIP;
+            }
+            break;
+        }
+        case DESERIALIZER_STREAM_SEQ:
+            stream->accepted = check_sequence(des, chunk[pos++]);
+            stream->state = stream->accepted ? DESERIALIZER_STREAM_TYPE : DESERIALIZER_STREAM_SKIP;
+            break;
+        case DESERIALIZER_STREAM_PAYLOAD:
+            payload_stream_feed(&stream->payload, chunk + pos, len - pos);
+            pos = len;
+            break;
+        default:
+            pos = len;
+            break;
+        }
+    }
+}
+
+/**
+ * @fn void finish_stream(deserializer_t *des)
+ * @brief Complete the rendering of a streamed frame and account for it
+ */
+void finish_stream(deserializer_t* des) {
+    deserializer_stream_t* stream = &des->stream;
+    deserializer_stream_state_t state = stream->state;
+
+    stream->state = DESERIALIZER_STREAM_IDLE;
+    des->stats.frames++;
+    des->stats.streamed++;
+    des->stats.bytes += stream->len;
+
+    if (stream->unsupported) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_OVERSIZED);
+    } else if (stream->sequenced && !stream->accepted) {
+        return;  // Already answered
+    } else if (state != DESERIALIZER_STREAM_PAYLOAD || !payload_stream_finish(&stream->payload)) {
+        deserializer_drop_frame(des, DESERIALIZER_ERROR_UNPACK);
+    }
+    if (stream->accepted) {
+        accept_sequenced(des);
+    }
+}
+
+/**
+ * @fn void abort_stream(deserializer_t *des)
+ * @brief Drop a streamed frame cut short, completing the binary record it may have started
+ */
+void abort_stream(deserializer_t* des) {
+    if (des->stream.state == DESERIALIZER_STREAM_PAYLOAD) {
+        payload_stream_abort(&des->stream.payload);
+    }
+    des->stream.state = DESERIALIZER_STREAM_IDLE;
+}
+
+/**
+ * @fn void on_json_chunk(void *ctx, const char *json, size_t len, bool last)
+ * @brief Streaming decoder callback passing the pieces of a rendering to on_payload_chunk
+ */
+void on_json_chunk(void* ctx, char const* json, size_t len, bool last) {
+    deserializer_t* des = ctx;
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+
+    if (last) {
+        des->stats.payloads++;
+        atomic_store_explicit(&des->baud.bad_frames, 0, memory_order_relaxed);
+    }
+    cb->on_payload_chunk(cb->ctx, last ? des->stream.payload.len : 0, json, len);
+}
+
+/**
+ * @fn uint32_t stage_start(const deserializer_t *des)
+ * @brief Time the start of a stage, when stages are timed
+ *
+ * @return Current time in microseconds, 0 when stages are not timed
+ */
+uint32_t stage_start(deserializer_t const* des) {
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+    return des->config.stage_hists != NULL ? cb->now_us(cb->ctx) : 0;
+}
+
+/**
+ * @fn uint32_t stage_end(deserializer_t *des, deserializer_stage_t stage, uint32_t start)
+ * @brief Count the duration of a stage in its histogram, when stages are timed
+ *
+ * @param des Pipeline state
+ * @param stage Stage that ends
+ * @param start Time it started, from stage_start()
+ *
+ * @return Current time in microseconds, the start of the next stage
+ */
+uint32_t stage_end(deserializer_t* des, deserializer_stage_t stage, uint32_t start) {
+    deserializer_callbacks_t const* cb = &des->config.callbacks;
+    if (des->config.stage_hists == NULL) {
+        return 0;
+    }
+    uint32_t now = cb->now_us(cb->ctx);
+    latency_hist_add(&des->config.stage_hists[stage], now - start);
+    return now;
+}
@@ -0,0 +1,333 @@
+/**
+ * @file frame_decoder.c
+ * @brief Incremental decoder for varint length-prefixed frames
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "frame_decoder.h"
+
+#include <string.h>
+
+#include "crc32.h"
+
+static bool emit_frame(frame_decoder_t* dec, uint8_t const* frame, size_t len,
+        frame_handler_t on_frame, void* ctx);
+static void start_hunt(frame_decoder_t* dec, size_t kept);
+static void hunt(frame_decoder_t* dec, frame_handler_t on_frame, void* ctx);
+
+/**
+ * @fn void frame_decoder_init(frame_decoder_t *dec, uint8_t *buf, size_t capacity)
+ * @brief Initialize a frame decoder over a caller-owned buffer
+ *
+ * @param dec Decoder to initialize
+ * @param buf Buffer used to reassemble frames split across chunks, of capacity bytes, or
+ *            FRAME_DECODER_CRC_BUF_SIZE(capacity) with checksums
+ * @param capacity Largest frame reassembled, checksum included; longer frames are discarded
+ *
+ * @return void
+ */
+void frame_decoder_init(frame_decoder_t* dec, uint8_t* buf, size_t capacity) {
+    memset(dec, 0, sizeof(*dec));
+    dec->buf = buf;
+    dec->capacity = capacity;
+    dec->state = FRAME_STATE_PREFIX;
+}
+
+/**
+ * @fn void frame_decoder_set_stream(frame_decoder_t *dec, size_t limit,
+ *                                   frame_stream_handler_t on_stream)
+ * @brief Stream frames longer than the buffer capacity instead of discarding them
+ *
+ * @param dec Decoder to configure
+ * @param limit Longest frame to stream; longer frames are still discarded
+ * @param on_stream Callback receiving the pieces of streamed frames, with the feed context
+ *
+ * @return void
+ */
+void frame_decoder_set_stream(frame_decoder_t* dec, size_t limit,
+        frame_stream_handler_t on_stream) {
+    dec->stream_limit = limit;
+    dec->on_stream = on_stream;
+}
+
+/**
+ * @fn void frame_decoder_set_crc(frame_decoder_t *dec, bool crc)
+ * @brief Expect every frame to end with a checksum, and hunt for the next frame on errors
+ *
+ * The buffer given to frame_decoder_init() must then hold
+ * FRAME_DECODER_CRC_BUF_SIZE(capacity) bytes.
+ *
+ * @param dec Decoder to configure
+ * @param crc Whether frames end with a checksum (see crc32.h)
+ *
+ * @return void
+ */
+void frame_decoder_set_crc(frame_decoder_t* dec, bool crc) { dec->crc = crc; }
+
+/**
+ * @fn void frame_decoder_reset(frame_decoder_t *dec)
+ * @brief Drop any partially received frame and wait for a new length prefix
+ *
+ * Used after the byte stream lost data (e.g. a UART FIFO overflow), since the
+ * bytes that follow can no longer be trusted to be aligned with a frame.
+ * Statistics counters are preserved.
+ *
+ * @param dec Decoder to reset
+ *
+ * @return void
+ */
+void frame_decoder_reset(frame_decoder_t* dec) {
+    dec->received = 0;
+    dec->expected = 0;
+    dec->prefix = 0;
+    dec->prefix_bytes = 0;
+    dec->state = FRAME_STATE_PREFIX;
+}
+
+/**
+ * @fn void frame_decoder_feed(frame_decoder_t *dec, const uint8_t *data, size_t len,
+ *                             frame_handler_t on_frame, void *ctx)
+ * @brief Consume a chunk of the byte stream and emit all frames it completes
+ *
+ * Chunks may contain any number of frames, partial frames or a mix of both. When
+ * a whole frame is contained in the chunk it is handed to the callback straight
+ * from the input, without copying; only frames split across chunks are
+ * reassembled in the decoder buffer. Frames larger than the buffer capacity are
+ * either streamed, straight from the input as well, or discarded. A streamed
+ * frame cut short by frame_decoder_reset() is never completed: the owner of the
+ * stream handler has to drop it on its own reset.
+ *
+ * With checksums, a frame is only emitted if its checksum matches, and is
+ * passed on without the checksum. A frame failing its check, an invalid prefix or an oversized
+ * length starts a hunt for the next valid frame through the bytes that follow.
+ *
+ * @param dec Decoder state
+ * @param data Incoming bytes
+ * @param len Number of incoming bytes
+ * @param on_frame Callback invoked once per complete frame
+ * @param ctx User context forwarded to the callback
+ *
+ * @return void
+ */
+void frame_decoder_feed(frame_decoder_t* dec, uint8_t const* data, size_t len,
+        frame_handler_t on_frame, void* ctx) {
+    size_t pos = 0;
+
+    while (pos < len) {
+        switch (dec->state) {
+        case FRAME_STATE_PREFIX: {
+            uint8_t byte = data[pos++];
+            dec->prefix |= (uint32_t)(byte & 0x7F) << (7 * dec->prefix_bytes);
+            dec->prefix_bytes++;
+            if (byte & 0x80) {
+                if (dec->prefix_bytes == FRAME_PREFIX_MAX_BYTES) {
+                    // Not a length we could ever have sent, wait for the next prefix
+                    dec->bad_prefixes++;
+                    if (dec->crc) {
+                        start_hunt(dec, 0);
+                    } else {
+                        frame_decoder_reset(dec);
+                    }
+                }
+                break;
+            }
+
+            dec->expected = dec->prefix;
+            dec->received = 0;
+            dec->prefix = 0;
+            dec->prefix_bytes = 0;
+            if (dec->expected > dec->capacity) {
+                if (dec->on_stream != NULL && dec->expected <= dec->stream_limit) {
+                    dec->state = FRAME_STATE_STREAM;
+                } else if (dec->crc) {
+                    // Most likely a corrupted prefix rather than a frame worth skipping
+                    dec->oversized++;
+                    start_hunt(dec, 0);
+                } else {
+                    dec->oversized++;
+                    dec->state = FRAME_STATE_SKIP;
+                }
+            } else if (len - pos >= dec->expected) {
+                // Fast path: the whole frame is in this chunk, no copy needed
+                if (emit_frame(dec, data + pos, dec->expected, on_frame, ctx)) {
+                    pos += dec->expected;
+                } else {
+                    // Hunt from the start of the body, read again from the input
+                    dec->crc_errors++;
+                    start_hunt(dec, 0);
+                }
+            } else {
+                dec->state = FRAME_STATE_BODY;
+            }
+            break;
+        }
+        case FRAME_STATE_BODY: {
+            size_t chunk = dec->expected - dec->received;
+            if (chunk > len - pos) {
+                chunk = len - pos;
+            }
+            // data may be the end of buf when hunt() resumes
+            memmove(dec->buf + dec->received, data + pos, chunk);
+            dec->received += chunk;
+            pos += chunk;
+            if (dec->received == dec->expected) {
+                dec->state = FRAME_STATE_PREFIX;
+                if (!emit_frame(dec, dec->buf, dec->expected, on_frame, ctx)) {
+                    dec->crc_errors++;
+                    start_hunt(dec, dec->expected);
+                    hunt(dec, on_frame, ctx);
+                }
+            }
+            break;
+        }
+        case FRAME_STATE_SKIP: {
+            size_t chunk = dec->expected - dec->received;
+            if (chunk > len - pos) {
+                chunk = len - pos;
+            }
+            dec->received += chunk;
+            pos += chunk;
+            if (dec->received == dec->expected) {
+                dec->state = FRAME_STATE_PREFIX;
+            }
+            break;
+        }
+        case FRAME_STATE_STREAM: {
+            size_t chunk = dec->expected - dec->received;
+            if (chunk > len - pos) {
+                chunk = len - pos;
+            }
+            dec->received += chunk;
+            if (dec->received == dec->expected) {
+                dec->streamed++;
+                dec->state = FRAME_STATE_PREFIX;
+                dec->on_stream(ctx, data + pos, chunk, FRAME_CHUNK_LAST);
+            } else {
+                dec->on_stream(ctx, data + pos, chunk, FRAME_CHUNK_MORE);
+            }
+            pos += chunk;
+            break;
+        }
+        case FRAME_STATE_HUNT: {
+            size_t chunk = FRAME_DECODER_CRC_BUF_SIZE(dec->capacity) - dec->received;
+            if (chunk > len - pos) {
+                chunk = len - pos;
+            }
+            memcpy(dec->buf + dec->received, data + pos, chunk);
+            dec->received += chunk;
+            pos += chunk;
+            hunt(dec, on_frame, ctx);
+            break;
+        }
+        }
+    }
+}
+
+/**
+ * @fn bool emit_frame(frame_decoder_t *dec, const uint8_t *frame, size_t len,
+ *                     frame_handler_t on_frame, void *ctx)
+ * @brief Check the checksum of a complete frame, if any, and hand the frame to the callback
+ *
+ * @return true if the frame was emitted, false if it failed its checksum
+ */
+bool emit_frame(frame_decoder_t* dec, uint8_t const* frame, size_t len, frame_handler_t on_frame,
+        void* ctx) {
+    if (dec->crc) {
+        if (!frame_crc_check(frame, len)) {
+            return false;
+        }
+        len -= FRAME_CRC_LEN;
+    }
+    dec->frames++;
+    on_frame(ctx, frame, len);
+    return true;
+}
+
+/**
+ * @fn void start_hunt(frame_decoder_t *dec, size_t kept)
+ * @brief Start looking for the next frame boundary
+ *
+ * @param dec Decoder state
+ * @param kept Bytes at the start of buf to search first, the rest comes from the input
+ */
+void start_hunt(frame_decoder_t* dec, size_t kept) {
+    dec->state = FRAME_STATE_HUNT;
+    dec->received = kept;
+    dec->prefix = 0;
+    dec->prefix_bytes = 0;
+}
+
+/**
+ * @fn void hunt(frame_decoder_t *dec, frame_handler_t on_frame, void *ctx)
+ * @brief Search the bytes kept in buf for the next frame with a valid checksum
+ *
+ * Each position is tried in turn as the start of a length prefix; the first
+ * one followed by a body whose checksum matches is taken as a frame boundary.
+ * Frames that follow it are checked the same way while they are complete in
+ * buf. Once the next one is not, decoding resumes normally from its start,
+ * which may be streamed. Until then, bytes are only dropped once no frame
+ * could start at them, so a candidate waiting for the rest of its body never
+ * needs more than buf.
+ *
+ * @param dec Decoder state, hunting
+ * @param on_frame Callback invoked once per frame found
+ * @param ctx User context forwarded to the callback
+ */
+void hunt(frame_decoder_t* dec, frame_handler_t on_frame, void* ctx) {
+    size_t start = 0;
+    bool synced = false;
+
+    while (start < dec->received) {
+        uint8_t const* candidate = dec->buf + start;
+        size_t avail = dec->received - start;
+        uint32_t length = 0;
+        size_t prefix_len = 0;
+        bool complete = false;
+        while (!complete && prefix_len < avail && prefix_len < FRAME_PREFIX_MAX_BYTES) {
+            uint8_t byte = candidate[prefix_len];
+            length |= (uint32_t)(byte & 0x7F) << (7 * prefix_len);
+            prefix_len++;
+            complete = (byte & 0x80) == 0;
+        }
+
+        if (!complete && prefix_len < FRAME_PREFIX_MAX_BYTES) {
+            break;  // Prefix cut short
+        }
+        // An empty body would pass, its CRC-32 is 0, but real frames hold at least a FrameType
+        bool fits = complete && length <= dec->capacity && length > FRAME_CRC_LEN;
+        if (!fits) {
+            bool streamed = complete && dec->on_stream != NULL && length <= dec->stream_limit;
+            if (synced && streamed) {
+                break;  // Let the normal path stream it
+            }
+            synced = false;
+            start++;
+            continue;
+        }
+        if (length > avail - prefix_len) {
+            break;  // Body cut short
+        }
+        if (emit_frame(dec, candidate + prefix_len, length, on_frame, ctx)) {
+            synced = true;
+            start += prefix_len + length;
+        } else {
+            synced = false;
+            start++;
+        }
+    }
+
+    size_t left = dec->received - start;
+    if (synced) {
+        // Less than a frame is left, feeding it again emits nothing and cannot hunt
+        dec->resyncs++;
+        dec->received = 0;
+        dec->state = FRAME_STATE_PREFIX;
+        frame_decoder_feed(dec, dec->buf + start, left, on_frame, ctx);
+    } else {
+        memmove(dec->buf, dec->buf + start, left);
+        dec->received = left;
+    }
+}
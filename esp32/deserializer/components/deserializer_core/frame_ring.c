@@ -0,0 +1,197 @@
+/**
+ * @file frame_ring.c
+ * @brief Lock-free single-producer single-consumer ring of variable-length frames
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "frame_ring.h"
+
+#include <string.h>
+
+#define FRAME_RING_SKIP UINT32_MAX  // Header value marking a skipped tail of the buffer
+
+static uint32_t read_header(uint8_t const* record);
+static void write_header(uint8_t* record, uint32_t value);
+
+/**
+ * @fn void frame_ring_init(frame_ring_t *ring, void *buf, size_t size)
+ * @brief Initialize an empty ring over a caller-owned buffer
+ *
+ * A frame is only guaranteed to fit in an empty ring when its record takes at
+ * most half of the buffer, so size it for at least twice the largest frame.
+ *
+ * @param ring Ring to initialize
+ * @param buf Backing buffer, 4-byte aligned
+ * @param size Size of the backing buffer in bytes, rounded down to a multiple of 4
+ *
+ * @return void
+ */
+void frame_ring_init(frame_ring_t* ring, void* buf, size_t size) {
+    memset(ring, 0, sizeof(*ring));
+    ring->buf = (uint8_t*)buf;
+    ring->size = size & ~(size_t)3;
+    atomic_init(&ring->written, 0);
+    atomic_init(&ring->read, 0);
+    atomic_init(&ring->released, 0);
+}
+
+/**
+ * @fn uint8_t *frame_ring_reserve(frame_ring_t *ring, size_t max_len)
+ * @brief Reserve contiguous room for a frame of up to max_len bytes
+ *
+ * The frame is not visible to the consumer until frame_ring_commit(); a
+ * reservation that is not committed is simply abandoned by the next one.
+ *
+ * @param ring Ring to write to (producer side)
+ * @param max_len Largest length the frame may be committed with
+ *
+ * @return Where to write the frame, or NULL when the ring has no room for it
+ */
+uint8_t* frame_ring_reserve(frame_ring_t* ring, size_t max_len) {
+    size_t record = FRAME_RING_RECORD_SIZE(max_len);
+    size_t tail = ring->size - ring->write_pos;
+    size_t skip = record <= tail ? 0 : tail;
+    uint32_t used = (uint32_t)atomic_load_explicit(&ring->written, memory_order_relaxed)
+            - (uint32_t)atomic_load_explicit(&ring->read, memory_order_acquire);
+
+    if (record > ring->size || used + skip + record > ring->size) {
+        ring->stats.full++;
+        return NULL;
+    }
+    ring->reserved_skip = skip;
+    ring->reserved_pos = skip != 0 ? 0 : ring->write_pos;
+    return ring->buf + ring->reserved_pos + FRAME_RING_HEADER_SIZE;
+}
+
+/**
+ * @fn void frame_ring_commit(frame_ring_t *ring, size_t len)
+ * @brief Publish the reserved frame to the consumer
+ *
+ * @param ring Ring to write to (producer side)
+ * @param len Final length of the frame, at most the max_len it was reserved with
+ *
+ * @return void
+ */
+void frame_ring_commit(frame_ring_t* ring, size_t len) {
+    size_t record = FRAME_RING_RECORD_SIZE(len);
+    frame_ring_stats_t* stats = &ring->stats;
+
+    if (ring->reserved_skip != 0) {
+        write_header(ring->buf + ring->write_pos, FRAME_RING_SKIP);
+    }
+    write_header(ring->buf + ring->reserved_pos, (uint32_t)len);
+    ring->write_pos = ring->reserved_pos + record;
+    if (ring->write_pos == ring->size) {
+        ring->write_pos = 0;
+    }
+
+    uint32_t written = (uint32_t)atomic_load_explicit(&ring->written, memory_order_relaxed)
+            + (uint32_t)(ring->reserved_skip + record);
+    atomic_store_explicit(&ring->written, written, memory_order_release);
+
+    // The consumer may have released more since, so these are upper bounds
+    size_t used = written - (uint32_t)atomic_load_explicit(&ring->read, memory_order_acquire);
+    uint32_t queued = ++stats->frames
+            - (uint32_t)atomic_load_explicit(&ring->released, memory_order_relaxed);
+    if (used > stats->high_water) {
+        stats->high_water = used;
+    }
+    if (queued > stats->high_water_frames) {
+        stats->high_water_frames = queued;
+    }
+    if (len > stats->largest_frame) {
+        stats->largest_frame = len;
+    }
+}
+
+/**
+ * @fn bool frame_ring_push(frame_ring_t *ring, const uint8_t *frame, size_t len)
+ * @brief Copy a complete frame into the ring
+ *
+ * @param ring Ring to write to (producer side)
+ * @param frame Frame to copy
+ * @param len Length of the frame
+ *
+ * @return true if the frame was queued, false when the ring has no room for it
+ */
+bool frame_ring_push(frame_ring_t* ring, uint8_t const* frame, size_t len) {
+    uint8_t* slot = frame_ring_reserve(ring, len);
+    if (slot == NULL) {
+        return false;
+    }
+    memcpy(slot, frame, len);
+    frame_ring_commit(ring, len);
+    return true;
+}
+
+/**
+ * @fn bool frame_ring_peek(frame_ring_t *ring, const uint8_t **frame, size_t *len)
+ * @brief Get the oldest frame without removing it
+ *
+ * @param ring Ring to read from (consumer side)
+ * @param frame Set to the start of the frame, valid until frame_ring_release()
+ * @param len Set to the length of the frame
+ *
+ * @return true if a frame is available, false when the ring is empty
+ */
+bool frame_ring_peek(frame_ring_t* ring, uint8_t const** frame, size_t* len) {
+    uint32_t read = (uint32_t)atomic_load_explicit(&ring->read, memory_order_relaxed);
+    uint32_t available =
+            (uint32_t)atomic_load_explicit(&ring->written, memory_order_acquire) - read;
+
+    while (available > 0) {
+        uint32_t header = read_header(ring->buf + ring->read_pos);
+        if (header != FRAME_RING_SKIP) {
+            *frame = ring->buf + ring->read_pos + FRAME_RING_HEADER_SIZE;
+            *len = header;
+            return true;
+        }
+        // The next frame did not fit before the end of the buffer
+        size_t skip = ring->size - ring->read_pos;
+        ring->read_pos = 0;
+        read += (uint32_t)skip;
+        available -= (uint32_t)skip;
+        atomic_store_explicit(&ring->read, read, memory_order_release);
+    }
+    return false;
+}
+
+/**
+ * @fn void frame_ring_release(frame_ring_t *ring)
+ * @brief Remove the frame returned by the last successful frame_ring_peek()
+ *
+ * @param ring Ring to read from (consumer side)
+ *
+ * @return void
+ */
+void frame_ring_release(frame_ring_t* ring) {
+    size_t record = FRAME_RING_RECORD_SIZE(read_header(ring->buf + ring->read_pos));
+
+    ring->read_pos += record;
+    if (ring->read_pos == ring->size) {
+        ring->read_pos = 0;
+    }
+    atomic_fetch_add_explicit(&ring->released, 1, memory_order_relaxed);
+    atomic_store_explicit(&ring->read,
+            (uint32_t)atomic_load_explicit(&ring->read, memory_order_relaxed) + (uint32_t)record,
+            memory_order_release);
+}
+
+/**
+ * @fn uint32_t read_header(const uint8_t *record)
+ * @brief Read the length header at the start of a record
+ */
+uint32_t read_header(uint8_t const* record) {
+    uint32_t value;
+    memcpy(&value, record, sizeof(value));
+    return value;
+}
+
+/**
+ * @fn void write_header(uint8_t *record, uint32_t value)
+ * @brief Write the length header at the start of a record
+ */
+void write_header(uint8_t* record, uint32_t value) { memcpy(record, &value, sizeof(value)); }
@@ -0,0 +1,37 @@
+/**
+ * @file arena.h
+ * @brief Bump-pointer arena allocator usable as a ProtobufCAllocator
+ *
+ * Allocations are carved sequentially out of a fixed buffer and are never freed
+ * individually; the whole arena is released at once with arena_reset(). This
+ * makes every allocation a pointer increment and keeps the system heap out of
+ * the per-message path.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint8_t* base;      //!< Start of the backing buffer
+    size_t capacity;    //!< Size of the backing buffer in bytes
+    size_t used;        //!< Bytes handed out since the last reset
+    size_t high_water;  //!< Largest value of used ever reached
+    uint32_t failures;  //!< Allocations refused because the arena was full
+} arena_t;
+
+void arena_init(arena_t* arena, void* buf, size_t capacity);
+void* arena_alloc(arena_t* arena, size_t size);
+void arena_reset(arena_t* arena);
+
+// ProtobufCAllocator-compatible callbacks, allocator_data must point to an arena_t
+void* arena_pb_alloc(void* allocator_data, size_t size);
+void arena_pb_free(void* allocator_data, void* pointer);
+
+#endif  // ARENA_H
@@ -0,0 +1,43 @@
+/**
+ * @file binary_record.h
+ * @brief Length-prefixed binary records, the alternative to the JSON rendering
+ *
+ * A record carries one decoded message re-encoded as a Payload, so a consumer
+ * that only parses it again downstream is spared the JSON rendering and its
+ * escaping on both ends:
+ *
+ *     0x00 | varint N | 0x08 varint timestamp | 0x12 varint data_len | data
+ *
+ * The N bytes after the length are an ordinary Payload message, with both
+ * fields always present, decodable by any protobuf library (message_pb2.Payload
+ * in pc/). The leading 0x00 marker never occurs in the text log lines a record
+ * may share the console with, so a reader tells them apart by their first byte.
+ *
+ * Every message is re-encoded the same way, whether it arrived in its own
+ * frame, inside a Batch or DeltaBatch, or in a chunked transfer, and whatever
+ * unknown fields it carried.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef BINARY_RECORD_H
+#define BINARY_RECORD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BINARY_RECORD_MARKER 0x00  //!< First byte of every record
+
+//! Longest record header: marker, length, both field keys, timestamp and data length
+#define BINARY_RECORD_HEADER_MAX_LEN 18
+
+//! Size of the record of a Payload whose data is data_len bytes long, at most
+#define BINARY_RECORD_MAX_LEN(data_len) ((data_len) + BINARY_RECORD_HEADER_MAX_LEN)
+
+size_t binary_record_header(uint8_t* buf, uint32_t timestamp, size_t data_len);
+size_t binary_record_write(uint8_t* buf, size_t size, uint32_t timestamp, char const* data,
+        size_t data_len);
+
+#endif  // BINARY_RECORD_H
@@ -0,0 +1,83 @@
+/**
+ * @file chunk_pool.h
+ * @brief Fixed pool of reassembly buffers for chunked transfers
+ *
+ * A Payload too large for one frame can be sent as a chunked transfer: its
+ * data is split into Chunk frames sharing a transfer id and numbered from 0.
+ * Each transfer is reassembled in a slot of a caller-owned buffer divided into
+ * equal slots, so memory use is fixed at init whatever the sender does.
+ *
+ * Chunks are expected in order, as a sequenced link delivers them: a repeated
+ * chunk is ignored and a missing one drops the transfer. A transfer that stops
+ * receiving chunks for longer than the timeout is dropped and frees its slot;
+ * when a new transfer finds every slot taken, the least recently active one is
+ * dropped (evicted) to make room.
+ *
+ * Transfer ids must not be reused while a transfer with the same id may still
+ * hold a slot: chunk 0 of the new transfer would be taken for a repeat of the
+ * old one's and ignored, and its other chunks dropped as orphans, until the old
+ * transfer times out. Senders number their transfers from a random start, so
+ * a restarted sender does not collide with the transfers it left unfinished.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef CHUNK_POOL_H
+#define CHUNK_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "payload_decoder.h"
+
+#define CHUNK_POOL_MAX_SLOTS 8  //!< Largest number of concurrent transfers
+
+typedef enum {
+    CHUNK_POOL_MORE,       //!< Chunk stored, the transfer is not complete yet
+    CHUNK_POOL_COMPLETE,   //!< Chunk stored and the transfer is complete
+    CHUNK_POOL_DUPLICATE,  //!< Chunk already stored, ignored
+    CHUNK_POOL_ORPHAN,     //!< Chunk of a transfer whose first chunk was not stored, ignored
+    CHUNK_POOL_DROPPED,    //!< Transfer dropped: chunk missing, too large or inconsistent
+} chunk_pool_status_t;
+
+typedef struct {
+    bool active;           //!< A transfer is being reassembled in this slot
+    uint32_t transfer_id;  //!< Transfer being reassembled
+    uint32_t next_index;   //!< Index of the next chunk expected
+    uint32_t timestamp;    //!< Payload timestamp, from the first chunk
+    size_t size;           //!< Data length announced by the first chunk
+    size_t len;            //!< Data bytes stored so far
+    size_t frame_bytes;    //!< Frame bytes the chunks stored so far arrived in
+    uint32_t updated_ms;   //!< Time the last chunk was stored
+    uint8_t* data;         //!< Reassembly buffer, slot_size bytes
+} chunk_slot_t;
+
+typedef struct {
+    uint32_t chunks;      //!< Chunks stored
+    uint32_t completed;   //!< Transfers completed
+    uint32_t duplicates;  //!< Chunks received again and ignored
+    uint32_t orphans;     //!< Chunks of unknown transfers ignored
+    uint32_t dropped;     //!< Transfers dropped for a missing, too large or inconsistent chunk
+    uint32_t expired;     //!< Transfers dropped after timeout_ms without a chunk
+    uint32_t evicted;     //!< Transfers dropped to make room for a new one
+} chunk_pool_stats_t;
+
+typedef struct {
+    chunk_slot_t slots[CHUNK_POOL_MAX_SLOTS];  //!< Transfers, the first count used
+    size_t count;                              //!< Slots, 0 when transfers are refused
+    size_t slot_size;                          //!< Largest transfer in bytes of data
+    uint32_t timeout_ms;                       //!< Longest time between two chunks
+    chunk_pool_stats_t stats;                  //!< Counters since init
+} chunk_pool_t;
+
+void chunk_pool_init(chunk_pool_t* pool, uint8_t* buf, size_t slot_size, size_t slots,
+        uint32_t timeout_ms);
+void chunk_pool_expire(chunk_pool_t* pool, uint32_t now_ms);
+chunk_pool_status_t chunk_pool_add(chunk_pool_t* pool, chunk_view_t const* chunk,
+        size_t frame_len, uint32_t now_ms, chunk_slot_t** slot);
+void chunk_pool_release(chunk_pool_t* pool, chunk_slot_t* slot);
+
+#endif  // CHUNK_POOL_H
@@ -0,0 +1,67 @@
+/**
+ * @file cobs.h
+ * @brief Consistent Overhead Byte Stuffing (COBS) frame encoding and decoding
+ *
+ * COBS removes every 0x00 byte from a message at a cost of at most one byte per
+ * 254, so 0x00 can be used as an unambiguous frame delimiter on the UART link.
+ * Frames can be decoded in place once their delimiter has been located, or with
+ * the streaming decoder when the byte stream arrives in arbitrary chunks. The
+ * streaming decoder can also pass frames too large for its buffer on piece by
+ * piece, decoding each block as it arrives. The encoder is used for the (short)
+ * frames the firmware sends back to the PC.
+ *
+ * Every delimiter resynchronizes the streaming decoder, so a bit error costs
+ * the frame it hit, or the two frames around a delimiter it hit. With checksums
+ * (see crc32.h), those frames are also dropped instead of being decoded into
+ * bogus content; streamed frames are passed on with their checksum, for the
+ * stream handler to check.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef COBS_H
+#define COBS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "frame_decoder.h"
+
+#define COBS_DELIMITER 0x00  //!< Byte that terminates every COBS frame
+
+//! Largest encoding of a len-byte message, delimiter included
+#define COBS_ENCODED_MAX_LEN(len) ((len) + (len) / 254 + 2)
+
+typedef struct {
+    uint8_t* buf;                      //!< Accumulation buffer for the encoded frame
+    size_t capacity;                   //!< Size of buf, also the largest frame emitted whole
+    size_t len;                        //!< Encoded bytes accumulated for the current frame
+    bool overflow;                     //!< Current frame is too long and is being discarded
+    bool streaming;                    //!< Current frame is too long and is being streamed
+    bool zero_pending;                 //!< Streaming: a zero is due before the next block
+    uint8_t block_left;                //!< Streaming: encoded bytes left in the current block
+    size_t decoded;                    //!< Streaming: decoded bytes passed on so far
+    size_t stream_limit;               //!< Largest decoded frame streamed
+    frame_stream_handler_t on_stream;  //!< Receives frames longer than capacity (optional)
+    bool crc;                          //!< Frames end with a checksum, checked and removed
+    uint32_t frames;                   //!< Total frames emitted
+    uint32_t streamed;                 //!< Total frames streamed
+    uint32_t oversized;                //!< Frames discarded for exceeding capacity or stream_limit
+    uint32_t invalid;                  //!< Frames discarded because they are not valid COBS
+    uint32_t crc_errors;               //!< Frames discarded for failing their checksum
+} cobs_decoder_t;
+
+size_t cobs_encode(uint8_t const* data, size_t len, uint8_t* out, size_t out_size);
+bool cobs_decode_in_place(uint8_t* buf, size_t len, size_t* decoded_len);
+
+void cobs_decoder_init(cobs_decoder_t* dec, uint8_t* buf, size_t capacity);
+void cobs_decoder_set_stream(cobs_decoder_t* dec, size_t limit, frame_stream_handler_t on_stream);
+void cobs_decoder_set_crc(cobs_decoder_t* dec, bool crc);
+void cobs_decoder_reset(cobs_decoder_t* dec);
+void cobs_decoder_feed(cobs_decoder_t* dec, uint8_t const* data, size_t len,
+        frame_handler_t on_frame, void* ctx);
+
+#endif  // COBS_H
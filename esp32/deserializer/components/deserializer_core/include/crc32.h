@@ -0,0 +1,33 @@
+/**
+ * @file crc32.h
+ * @brief CRC-32 check of frames sent with a checksum
+ *
+ * With frame checksums enabled, every frame body (FrameType byte and message)
+ * is followed by the CRC-32 of the body, least significant byte first: the
+ * IEEE 802.3 CRC, as computed by zlib.crc32() in pc/serializer.py. A frame hit
+ * by a bit error then fails its check instead of being decoded into bogus
+ * content. The checksum goes inside the framing, so COBS encodes it like the
+ * rest of the frame and a length prefix counts it.
+ *
+ * On the ESP32 the CRC is computed by the ROM routine, so it costs no flash;
+ * other targets use a 16-entry table, one lookup per nibble.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_CRC_LEN 4  //!< Bytes of the checksum that ends a frame
+
+uint32_t crc32_update(uint32_t crc, uint8_t const* data, size_t len);
+bool frame_crc_check(uint8_t const* frame, size_t len);
+size_t frame_crc_append(uint8_t* frame, size_t len);
+
+#endif  // CRC32_H
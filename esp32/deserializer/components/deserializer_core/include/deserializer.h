@@ -0,0 +1,322 @@
+/**
+ * @file deserializer.h
+ * @brief Portable message pipeline: framing, Payload decoding and JSON rendering
+ *
+ * Turns the raw byte stream received from the UART into one JSON rendering per
+ * message, whether it arrived in its own frame or inside a Batch or DeltaBatch.
+ * The pipeline has no dependency on ESP-IDF or protobuf-c: the firmware feeds it
+ * from the UART driver and logs its output, while the host build drives the
+ * exact same code from benchmarks and tests.
+ *
+ * Senders that need delivery guarantees wrap their frames in sequenced frames
+ * and keep a window of them in flight. The pipeline accepts them strictly in
+ * order (go-back-N) and answers through the send_reply callback: an ACK with
+ * the next expected sequence number for every frame accepted or duplicated, and
+ * a single NACK when a gap shows that frames were lost.
+ *
+ * For credit-based flow control the caller reports how many bytes it has read
+ * out of its receive buffer with deserializer_send_credit(); the sender never
+ * has more than the buffer size in flight beyond that, so it cannot overflow.
+ *
+ * Framing and decoding can run in different tasks: with the on_frame callback,
+ * deserializer_feed() only delimits frames and deserializer_handle_frame() is
+ * called on them elsewhere. The framing state belongs to the first side and the
+ * sequence window to the second. Both sides drop frames, so the error counters
+ * deserializer_drop_frame() shares between them are atomic; the other stats
+ * fields are only updated while decoding, which is why frames are not streamed
+ * (decoded within deserializer_feed()) in that setup.
+ *
+ * Frames longer than the frame buffer are discarded, unless on_payload_chunk is
+ * set and they are within max_message_size: single Payloads, sequenced or not,
+ * are then decoded by deserializer_feed() as their bytes arrive and rendered in
+ * pieces, so the message size is not bounded by any buffer. Streamed frames do
+ * not go through on_frame.
+ *
+ * Payloads may also arrive as chunked transfers, a series of Chunk frames that
+ * fit in the frame buffer. They are reassembled in a fixed pool of chunk_slots
+ * buffers of chunk_slot_size bytes, then rendered in pieces through
+ * on_payload_chunk when it is set, or whole into json_buf otherwise. Transfers
+ * left unfinished are dropped once chunk_timeout_ms passes without any of their
+ * chunks, checked whenever a Chunk frame arrives.
+ *
+ * Any message frame (Payload, Batch, DeltaBatch or Chunk) may also arrive
+ * compressed, sequenced or not: it is decompressed into decompress_buf, which
+ * bounds the size of the original frame, and then handled like the original.
+ * Dictionary-compressed frames name the version of the dictionary they were
+ * compressed against; those not matching dict (or arriving without one) are
+ * dropped, so a sender with another dictionary is reported instead of decoded
+ * into garbage.
+ *
+ * The sender may raise the baud rate at runtime. A BaudSwitch frame naming a
+ * rate up to max_baud_rate that can_set_baud_rate accepts is echoed at the
+ * current rate, then the link is switched through set_baud_rate; other rates
+ * are refused by echoing the current one. Probe frames sent at the new rate
+ * are answered with the number of bytes differing from the expected pattern,
+ * and a second BaudSwitch for the same rate confirms it. A rate not confirmed
+ * within baud_timeout_ms is undone by deserializer_check_baud(), so a switch to
+ * a rate the wiring cannot carry never strands the link. The baud rate state
+ * belongs to the side calling deserializer_handle_frame(), which must also call
+ * deserializer_check_baud(), except for two atomic fields: probation, which the
+ * framing side may read, and the count of bad frames, which both sides add to.
+ *
+ * The receiver may also follow a sender configured for another rate: after
+ * autobaud_errors frames in a row that failed to frame or unpack, which is
+ * what bytes sampled at the wrong rate turn into, deserializer_check_baud()
+ * has measure_baud_rate measure the incoming signal and switches the link to
+ * the nearest standard rate, if that is another one.
+ *
+ * With frame_crc, every frame ends with the CRC-32 of its body (see crc32.h),
+ * replies included. Frames failing it are dropped by the framing layer, which
+ * finds the next frame boundary again right after (see frame_decoder.h), so a
+ * bit error costs one frame. Streamed frames are only checked once complete:
+ * their rendering is then reported incomplete through on_error, and sequenced
+ * ones are not acknowledged. Callers that delimit frames themselves check the
+ * checksum with frame_crc_check() before calling deserializer_handle_frame(),
+ * which takes frames without it.
+ *
+ * With DESERIALIZER_OUTPUT_BINARY, every message is passed on as a
+ * length-prefixed binary record (see binary_record.h) instead of its JSON
+ * rendering, through the same callbacks and json_buf: the record is not
+ * NUL-terminated, and streamed and chunked messages come in pieces as usual.
+ * A streamed record cut short is padded to the length it announced before
+ * on_error reports it, so the reader of the records stays in step.
+ *
+ * With stage_hists, the time every message spends in each stage of the
+ * pipeline is counted in a histogram per stage (see latency_hist.h), read from
+ * the now_us clock: decoding, rendering and the on_payload callback here, and
+ * the stages before and after the pipeline by the caller into the same array.
+ * Streamed and chunked messages, rendered in pieces, are not timed. Without
+ * stage_hists the stages cost a pointer test each.
+ *
+ * A STATS frame is answered through send_reply with a Stats message: the
+ * counters of the pipeline, those the caller keeps around it (receive buffer
+ * overflows, queue high-water marks, free heap...), filled in by
+ * on_stats_query, and a summary of every stage histogram. The reply is a few
+ * hundred bytes at most, so the link can be monitored without a console.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef DESERIALIZER_H
+#define DESERIALIZER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chunk_pool.h"
+#include "cobs.h"
+#include "crc32.h"
+#include "frame_decoder.h"
+#include "latency_hist.h"
+#include "lzss.h"
+#include "lzss_dict.h"
+#include "payload_decoder.h"
+#include "payload_stream.h"
+
+//! Largest sender window: sequence numbers up to this far ahead of the expected one are
+//! gaps, anything else in the 8-bit sequence space is a duplicate
+#define DESERIALIZER_MAX_WINDOW 127
+
+#define DESERIALIZER_BAUD_PROBE_LEN 32  //!< Length of the pattern carried by a probe frame
+
+//! Byte i of the probe pattern, with all bit transitions and most byte values
+#define DESERIALIZER_BAUD_PROBE_BYTE(i) ((uint8_t)(0x55u + (i) * 0x4Bu))
+
+//! Largest difference, as a fraction of the rate, between a measured baud rate and the
+//! standard rate it is taken for
+#define DESERIALIZER_BAUD_TOLERANCE 32
+
+typedef enum {
+    DESERIALIZER_FRAMING_LENGTH_PREFIX,  //!< Varint length prefix before every message
+    DESERIALIZER_FRAMING_COBS,           //!< COBS-encoded messages terminated by 0x00
+} deserializer_framing_t;
+
+typedef enum {
+    DESERIALIZER_OUTPUT_JSON,    //!< JSON rendering of every message
+    DESERIALIZER_OUTPUT_BINARY,  //!< Binary record of every message, see binary_record.h
+} deserializer_output_t;
+
+typedef enum {
+    DESERIALIZER_STAGE_WAIT,    //!< Waiting for received data (timed by the caller)
+    DESERIALIZER_STAGE_READ,    //!< Reading received data out of the driver (timed by the caller)
+    DESERIALIZER_STAGE_DECODE,  //!< Decoding a Payload, alone or from a Batch or DeltaBatch
+    DESERIALIZER_STAGE_RENDER,  //!< Rendering a message to JSON or to its binary record
+    DESERIALIZER_STAGE_OUTPUT,  //!< on_payload callback: logging, or queuing for an output task
+    DESERIALIZER_STAGE_LOG,     //!< Logging what an output task dequeued (timed by the caller)
+    DESERIALIZER_STAGE_COUNT,   //!< Number of stages
+} deserializer_stage_t;
+
+typedef enum {
+    DESERIALIZER_ERROR_UNPACK,      //!< Frame is not a valid Payload, Batch or DeltaBatch
+    DESERIALIZER_ERROR_JSON,        //!< Rendering or binary record did not fit the output buffer
+    DESERIALIZER_ERROR_OVERSIZED,   //!< Frame longer than the frame buffer was discarded
+    DESERIALIZER_ERROR_FRAMING,     //!< Invalid length prefix or COBS encoding
+    DESERIALIZER_ERROR_TRANSFER,    //!< Chunked transfer dropped before it was complete
+    DESERIALIZER_ERROR_DICTIONARY,  //!< Frame compressed against an unknown dictionary version
+    DESERIALIZER_ERROR_CRC,         //!< Frame failed its checksum
+} deserializer_error_t;
+
+typedef struct {
+    uint32_t uptime_ms;                //!< Time since boot
+    uint32_t overflows;                //!< Receive buffer or FIFO overflows
+    uint32_t queue_dropped;            //!< Frames dropped for lack of room in a frame queue
+    uint32_t log_dropped;              //!< Messages decoded but dropped from the log
+    uint32_t rx_high_water;            //!< Most bytes seen waiting in the receive buffer
+    uint32_t frame_queue_high_water;   //!< Most bytes held by the frame queue, if any
+    uint32_t output_queue_high_water;  //!< Most bytes held by the output queue, if any
+    uint32_t min_free_heap;            //!< Lowest free heap since boot in bytes, if known
+} deserializer_device_stats_t;
+
+typedef struct {
+    //! Called once per decoded message with its NUL-terminated JSON rendering (or its binary
+    //! record); payload_len is the number of frame bytes the message was decoded from
+    void (*on_payload)(void* ctx, size_t payload_len, char const* json, size_t json_len);
+    //! Called for every frame that could not be turned into JSON (optional)
+    void (*on_error)(void* ctx, deserializer_error_t error);
+    //! Generic decoder for Payloads with fields unknown to the specialized one (optional)
+    bool (*unpack_fallback)(void* ctx, uint8_t const* frame, size_t len, payload_view_t* view);
+    //! Called once the output for a Payload has been emitted, e.g. to reset an arena (optional)
+    void (*on_payload_done)(void* ctx);
+    //! Writes a framed reply (ACK, NACK, Credit, Stats...) back to the sender (optional,
+    //! sequenced frames are not acknowledged without it)
+    void (*send_reply)(void* ctx, uint8_t const* data, size_t len);
+    //! Receives the complete frames found by deserializer_feed() instead of decoding them, e.g.
+    //! to decode them in another task with deserializer_handle_frame() (optional)
+    void (*on_frame)(void* ctx, uint8_t const* frame, size_t len);
+    //! Called with consecutive pieces of the JSON rendering of a streamed Payload, json is not
+    //! NUL-terminated; payload_len is 0 except on the last piece (optional, enables streaming).
+    //! When on_error is called before the last piece, the rendering is incomplete
+    void (*on_payload_chunk)(void* ctx, size_t payload_len, char const* json, size_t json_len);
+    //! Returns the current time in milliseconds, for the chunked transfer timeout (optional,
+    //! transfers never time out without it) and the baud rate confirmation timeout
+    uint32_t (*now_ms)(void* ctx);
+    //! Switches the link to baud_rate once the replies already passed to send_reply are sent;
+    //! returns false if the rate is not supported (optional, baud rate switches are refused
+    //! without it or now_ms)
+    bool (*set_baud_rate)(void* ctx, uint32_t baud_rate);
+    //! Returns whether set_baud_rate can switch the link to baud_rate, asked before the rate is
+    //! echoed to the sender (optional, every rate up to max_baud_rate is taken as supported)
+    bool (*can_set_baud_rate)(void* ctx, uint32_t baud_rate);
+    //! Returns the baud rate of the signal received lately, e.g. from its shortest pulse, or
+    //! 0 if it could not be measured (optional, the sender's rate is not detected without it)
+    uint32_t (*measure_baud_rate)(void* ctx);
+    //! Returns the current time in microseconds, wrapping at 2^32, to time the stages into
+    //! stage_hists (optional, stages are not timed without it)
+    uint32_t (*now_us)(void* ctx);
+    //! Called for a STATS frame, to fill in the counters kept outside the pipeline before the
+    //! Stats reply is sent (optional, they are sent as 0 without it)
+    void (*on_stats_query)(void* ctx, deserializer_device_stats_t* device);
+    void* ctx;  //!< User context passed to every callback
+} deserializer_callbacks_t;
+
+typedef struct {
+    deserializer_framing_t framing;      //!< Framing used on the byte stream
+    //! Reassembly buffer for frames decoded whole, of frame_size bytes, or
+    //! FRAME_DECODER_CRC_BUF_SIZE(frame_size) with frame_crc
+    uint8_t* frame_buf;
+    size_t frame_size;                   //!< Largest frame decoded whole, checksum included
+    size_t max_message_size;             //!< Longest frame streamed, if above frame_size
+    deserializer_output_t output;        //!< Format messages are passed on in
+    char* json_buf;                      //!< Output buffer for the JSON rendering or record
+    size_t json_size;                    //!< Size of json_buf
+    uint8_t* chunk_buf;                  //!< chunk_slots * chunk_slot_size bytes, or NULL
+    size_t chunk_slot_size;              //!< Largest chunked transfer in bytes of data
+    size_t chunk_slots;                  //!< Concurrent chunked transfers
+    uint32_t chunk_timeout_ms;           //!< Longest time between two chunks of a transfer
+    uint8_t* decompress_buf;             //!< Compressed frames are decompressed here, or NULL
+    size_t decompress_size;              //!< Size of decompress_buf
+    lzss_dict_t const* dict;             //!< Dictionary of dictionary-compressed frames, or NULL
+    uint32_t baud_rate;                  //!< Baud rate of the link at init
+    uint32_t max_baud_rate;              //!< Highest rate a BaudSwitch may select, 0: none
+    uint32_t baud_timeout_ms;            //!< Time a new baud rate has to be confirmed in
+    uint32_t autobaud_errors;            //!< Bad frames in a row that trigger auto-baud, 0: never
+    bool frame_crc;                      //!< Frames and replies end with a CRC-32 of their body
+    latency_hist_t* stage_hists;         //!< DESERIALIZER_STAGE_COUNT histograms, or NULL
+    deserializer_callbacks_t callbacks;  //!< Output callbacks
+} deserializer_config_t;
+
+typedef struct {
+    uint32_t frames;                       //!< Complete frames received
+    uint32_t batches;                      //!< Frames carrying a Batch or DeltaBatch
+    uint32_t payloads;                     //!< Payloads rendered to JSON
+    uint32_t bytes;                        //!< Frame bytes received (excluding framing overhead)
+    atomic_uint_least32_t unpack_errors;   //!< Invalid frames or Payloads (either side)
+    uint32_t json_errors;                  //!< Payloads whose rendering did not fit json_buf
+    atomic_uint_least32_t oversized;       //!< Frames over frame_size or max_message_size
+    atomic_uint_least32_t framing_errors;  //!< Invalid length prefixes or COBS frames
+    uint32_t duplicates;                   //!< Sequenced frames received again, ACKed and ignored
+    uint32_t out_of_order;                 //!< Sequenced frames after a gap, dropped until resent
+    uint32_t streamed;                     //!< Frames over frame_size decoded as they arrived
+    uint32_t chunks;                       //!< Chunk frames received
+    uint32_t transfers;                    //!< Chunked transfers completed
+    uint32_t transfer_errors;              //!< Chunked transfers dropped
+    uint32_t compressed;                   //!< Compressed frames decompressed, dictionary or not
+    uint32_t dict_mismatches;              //!< Frames compressed against another dictionary version
+    uint32_t baud_switches;                //!< Baud rate switches confirmed by the sender
+    uint32_t baud_reverts;                 //!< Baud rate switches undone for lack of a confirmation
+    uint32_t baud_detections;              //!< Switches to the baud rate measured on the line
+    atomic_uint_least32_t crc_errors;      //!< Frames dropped for failing their checksum
+} deserializer_stats_t;
+
+typedef struct {
+    uint8_t expected_seq;  //!< Sequence number of the next in-order frame
+    bool nack_sent;        //!< A NACK for expected_seq was sent, wait for the resend
+} deserializer_window_t;
+
+typedef struct {
+    uint32_t rate;                     //!< Current baud rate
+    uint32_t confirmed;                //!< Last confirmed rate, restored if not confirmed in time
+    atomic_bool probation;             //!< rate is waiting for the sender's confirmation
+    uint32_t switched_ms;              //!< Time of the switch to rate
+    atomic_uint_least32_t bad_frames;  //!< Frames in a row that failed to frame or unpack
+} deserializer_baud_t;
+
+typedef enum {
+    DESERIALIZER_STREAM_IDLE,     //!< No frame being streamed
+    DESERIALIZER_STREAM_TYPE,     //!< Expecting the FrameType byte
+    DESERIALIZER_STREAM_SEQ,      //!< Expecting the sequence number of a sequenced frame
+    DESERIALIZER_STREAM_PAYLOAD,  //!< Decoding the Payload
+    DESERIALIZER_STREAM_SKIP,     //!< Ignoring the rest of the frame
+} deserializer_stream_state_t;
+
+typedef struct {
+    deserializer_stream_state_t state;  //!< Position in the streamed frame
+    bool sequenced;                     //!< The frame is a sequenced frame
+    bool accepted;                      //!< Sequenced frame in order, acknowledged once complete
+    bool unsupported;                   //!< Not a Payload, which is all that can be streamed
+    size_t len;                         //!< Frame bytes received so far
+    uint32_t crc;                       //!< CRC-32 of the frame bytes so far, with frame_crc
+    uint8_t tail[FRAME_CRC_LEN];        //!< Last bytes received, held back as the checksum
+    uint8_t tail_len;                   //!< Bytes in tail
+    payload_stream_t payload;           //!< Payload decoder and JSON renderer
+} deserializer_stream_t;
+
+typedef struct {
+    deserializer_config_t config;
+    union {
+        frame_decoder_t length_prefix;
+        cobs_decoder_t cobs;
+    } decoder;
+    deserializer_window_t window;
+    deserializer_baud_t baud;
+    deserializer_stream_t stream;
+    chunk_pool_t chunks;
+    deserializer_stats_t stats;
+} deserializer_t;
+
+void deserializer_init(deserializer_t* des, deserializer_config_t const* config);
+void deserializer_reset(deserializer_t* des);
+void deserializer_feed(deserializer_t* des, uint8_t const* data, size_t len);
+bool deserializer_frame_pending(deserializer_t const* des);
+void deserializer_handle_frame(deserializer_t* des, uint8_t const* frame, size_t len);
+void deserializer_drop_frame(deserializer_t* des, deserializer_error_t error);
+void deserializer_send_credit(deserializer_t* des, uint32_t consumed, uint32_t window);
+bool deserializer_check_baud(deserializer_t* des);
+uint32_t deserializer_standard_baud(uint32_t measured);
+char const* deserializer_stage_name(deserializer_stage_t stage);
+
+#endif  // DESERIALIZER_H
@@ -0,0 +1,101 @@
+/**
+ * @file frame_decoder.h
+ * @brief Incremental decoder for varint length-prefixed frames
+ *
+ * Every protobuf message on the UART link is preceded by its length encoded as a
+ * base-128 varint (the same encoding protobuf uses for its own length-delimited
+ * fields). The decoder accepts the byte stream in arbitrarily sized chunks, keeps
+ * partial frames across calls and emits every complete frame exactly once.
+ * Frames too large for the buffer can be streamed instead: their body is handed
+ * to a second callback piece by piece, as it arrives, and never buffered.
+ *
+ * A corrupted length prefix throws the decoder off the frame boundaries, and
+ * without a way to tell it keeps misreading the stream. With checksums (see
+ * crc32.h) a frame that fails its check, or whose prefix is invalid or
+ * oversized, makes the decoder hunt for the next boundary instead: it scans
+ * the following bytes, kept in the buffer, for a length prefix followed by a
+ * body with a valid checksum, and resumes from there. The buffer then needs
+ * room for a prefix on top of the largest frame, FRAME_DECODER_CRC_BUF_SIZE(). A bit error then costs
+ * the frame it hit, not the frames after it. Streamed frames are passed on with
+ * their checksum, for the stream handler to check.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef FRAME_DECODER_H
+#define FRAME_DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest varint accepted as a length prefix (enough for any uint32 length)
+#define FRAME_PREFIX_MAX_BYTES 5
+
+// Buffer size of a decoder with checksums: the hunt keeps a prefix along with a whole frame
+#define FRAME_DECODER_CRC_BUF_SIZE(capacity) ((capacity) + FRAME_PREFIX_MAX_BYTES)
+
+/**
+ * @brief Callback invoked for every complete frame
+ *
+ * @param ctx User context given to frame_decoder_feed()
+ * @param frame Pointer to the frame body (valid only during the call)
+ * @param len Length of the frame body in bytes
+ */
+typedef void (*frame_handler_t)(void* ctx, uint8_t const* frame, size_t len);
+
+typedef enum {
+    FRAME_CHUNK_MORE,     //!< More of the frame follows
+    FRAME_CHUNK_LAST,     //!< Last piece, the frame is complete
+    FRAME_CHUNK_ABORTED,  //!< The frame turned out invalid, drop what was received (no data)
+} frame_chunk_t;
+
+/**
+ * @brief Callback invoked for every piece of a streamed frame, in order
+ *
+ * @param ctx User context given to the feed function
+ * @param chunk Next bytes of the frame body (valid only during the call)
+ * @param len Number of bytes in chunk, may be 0 for the last or an aborted piece
+ * @param kind Whether more of the frame follows
+ */
+typedef void (*frame_stream_handler_t)(void* ctx, uint8_t const* chunk, size_t len,
+        frame_chunk_t kind);
+
+typedef enum {
+    FRAME_STATE_PREFIX,  //!< Reading the varint length prefix
+    FRAME_STATE_BODY,    //!< Accumulating the frame body
+    FRAME_STATE_SKIP,    //!< Discarding the body of an oversized frame
+    FRAME_STATE_STREAM,  //!< Passing the body of a large frame to the stream handler
+    FRAME_STATE_HUNT,    //!< Looking for the next frame boundary after a checksum failure
+} frame_state_t;
+
+typedef struct {
+    uint8_t* buf;                      //!< Accumulation buffer for frames split across chunks
+    size_t capacity;                   //!< Size of buf, also the largest frame emitted whole
+    size_t received;                   //!< Body bytes received for the current frame
+    size_t expected;                   //!< Declared body length of the current frame
+    uint32_t prefix;                   //!< Partially decoded length prefix
+    uint8_t prefix_bytes;              //!< Number of prefix bytes consumed so far
+    frame_state_t state;               //!< Current decoder state
+    size_t stream_limit;               //!< Largest frame streamed, longer ones are discarded
+    frame_stream_handler_t on_stream;  //!< Receives frames longer than capacity (optional)
+    bool crc;                          //!< Frames end with a checksum, checked and removed
+    uint32_t frames;                   //!< Total frames emitted
+    uint32_t streamed;                 //!< Total frames streamed
+    uint32_t oversized;                //!< Frames discarded for exceeding capacity or stream_limit
+    uint32_t bad_prefixes;             //!< Length prefixes longer than FRAME_PREFIX_MAX_BYTES
+    uint32_t crc_errors;               //!< Frames failing their checksum
+    uint32_t resyncs;                  //!< Hunts that found a frame boundary again
+} frame_decoder_t;
+
+void frame_decoder_init(frame_decoder_t* dec, uint8_t* buf, size_t capacity);
+void frame_decoder_set_stream(frame_decoder_t* dec, size_t limit,
+        frame_stream_handler_t on_stream);
+void frame_decoder_set_crc(frame_decoder_t* dec, bool crc);
+void frame_decoder_reset(frame_decoder_t* dec);
+void frame_decoder_feed(frame_decoder_t* dec, uint8_t const* data, size_t len,
+        frame_handler_t on_frame, void* ctx);
+
+#endif  // FRAME_DECODER_H
@@ -0,0 +1,75 @@
+/**
+ * @file frame_protocol.h
+ * @brief Frame types and control message field numbers of the UART protocol
+ *
+ * Every frame starts with a FrameType byte (message.proto) saying what follows:
+ * a message for the payload decoder (see payload_decoder.h), one wrapped in a
+ * sequenced or compressed frame, a Chunk of a chunked transfer, or a control
+ * message: sequence numbers, Credits, baud rate switches and probes, and the
+ * Stats query and reply. The control messages are few and small, so they are
+ * read and written with pb_wire.h directly, using the field numbers below.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef FRAME_PROTOCOL_H
+#define FRAME_PROTOCOL_H
+
+// Field numbers of the Credit message in message.proto
+#define CREDIT_FIELD_CONSUMED 1
+#define CREDIT_FIELD_WINDOW 2
+
+// Field numbers of the Chunk message in message.proto
+#define CHUNK_FIELD_TRANSFER_ID 1
+#define CHUNK_FIELD_INDEX 2
+#define CHUNK_FIELD_SIZE 3
+#define CHUNK_FIELD_TIMESTAMP 4
+#define CHUNK_FIELD_DATA 5
+
+// Field number of the BaudSwitch message in message.proto
+#define BAUD_SWITCH_FIELD_BAUD_RATE 1
+
+// Field numbers of the Stats and StageStats messages in message.proto
+#define STATS_FIELD_UPTIME_MS 1
+#define STATS_FIELD_FRAMES 2
+#define STATS_FIELD_PAYLOADS 3
+#define STATS_FIELD_BYTES 4
+#define STATS_FIELD_UNPACK_ERRORS 5
+#define STATS_FIELD_FRAMING_ERRORS 6
+#define STATS_FIELD_CRC_ERRORS 7
+#define STATS_FIELD_OVERFLOWS 8
+#define STATS_FIELD_QUEUE_DROPPED 9
+#define STATS_FIELD_LOG_DROPPED 10
+#define STATS_FIELD_RX_HIGH_WATER 11
+#define STATS_FIELD_FRAME_QUEUE_HIGH_WATER 12
+#define STATS_FIELD_OUTPUT_QUEUE_HIGH_WATER 13
+#define STATS_FIELD_MIN_FREE_HEAP 14
+#define STATS_FIELD_STAGES 15
+#define STAGE_STATS_FIELD_SAMPLES 1
+#define STAGE_STATS_FIELD_MEAN_US 2
+#define STAGE_STATS_FIELD_P50_US 3
+#define STAGE_STATS_FIELD_P90_US 4
+#define STAGE_STATS_FIELD_P99_US 5
+#define STAGE_STATS_FIELD_MAX_US 6
+
+// Values of the FrameType enum from message.proto, the first byte of every frame
+typedef enum {
+    FRAME_TYPE_PAYLOAD = 0,           //!< A single Payload
+    FRAME_TYPE_BATCH = 1,             //!< A Batch of Payloads
+    FRAME_TYPE_DELTA_BATCH = 2,       //!< A DeltaBatch
+    FRAME_TYPE_SEQUENCED = 3,         //!< Sequence number byte, then one of the frames above
+    FRAME_TYPE_SYNC = 4,              //!< Sequence number byte the next sequenced frame will carry
+    FRAME_TYPE_ACK = 5,               //!< Reply: sequence number of the next expected frame
+    FRAME_TYPE_NACK = 6,              //!< Reply: sequence number to resend from
+    FRAME_TYPE_CREDIT = 7,            //!< Reply: a Credit
+    FRAME_TYPE_CHUNK = 8,             //!< A Chunk of a Payload too large for one frame
+    FRAME_TYPE_COMPRESSED = 9,        //!< LZSS-compressed FrameType byte and message, see lzss.h
+    FRAME_TYPE_DICT_COMPRESSED = 10,  //!< Dictionary version byte, then as above, see lzss_dict.h
+    FRAME_TYPE_BAUD = 11,             //!< A BaudSwitch, echoed back with the rate in use
+    FRAME_TYPE_BAUD_PROBE = 12,       //!< Probe pattern, answered with its error count byte
+    FRAME_TYPE_STATS = 13,            //!< Request for the counters, answered with a Stats
+} frame_type_t;
+
+#endif  // FRAME_PROTOCOL_H
@@ -0,0 +1,67 @@
+/**
+ * @file frame_ring.h
+ * @brief Lock-free single-producer single-consumer ring of variable-length frames
+ *
+ * Hands complete frames over from the task receiving them to the task decoding
+ * them without locks or copies: the producer reserves room for a frame, writes
+ * it in place (e.g. reads it from the UART and decodes its COBS encoding there)
+ * and commits its final length; the consumer gets the oldest frame as one
+ * contiguous span and releases it once decoded.
+ *
+ * Every frame is stored contiguously behind a 4-byte length header; a frame
+ * that does not fit before the end of the buffer is placed at its start and the
+ * tail is skipped. Each side owns its own position and publishes a byte counter
+ * with release semantics, so exactly one producer and one consumer may run
+ * concurrently, on different cores, without further synchronization.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_RING_HEADER_SIZE 4  //!< Length header stored before every frame
+
+//! Bytes a frame of len bytes takes in the ring, header and alignment padding included
+#define FRAME_RING_RECORD_SIZE(len) (FRAME_RING_HEADER_SIZE + (((len) + 3) & ~(size_t)3))
+
+typedef struct {
+    uint32_t frames;             //!< Frames committed
+    uint32_t full;               //!< Reservations refused for lack of room
+    size_t high_water;           //!< Most bytes ever in use, headers and skipped tails included
+    uint32_t high_water_frames;  //!< Most frames ever queued at once
+    size_t largest_frame;        //!< Longest frame committed
+} frame_ring_stats_t;
+
+typedef struct {
+    uint8_t* buf;                    //!< Backing buffer, 4-byte aligned
+    size_t size;                     //!< Size of buf, a multiple of 4
+    atomic_uint_least32_t written;   //!< Bytes committed since init (producer, wraps around)
+    atomic_uint_least32_t read;      //!< Bytes released or skipped since init (consumer)
+    atomic_uint_least32_t released;  //!< Frames released since init (consumer)
+    size_t write_pos;                //!< Offset of the next record (producer only)
+    size_t reserved_pos;             //!< Offset of the reserved record (producer only)
+    size_t reserved_skip;            //!< Tail skipped by the reservation (producer only)
+    size_t read_pos;                 //!< Offset of the oldest record (consumer only)
+    frame_ring_stats_t stats;        //!< Updated by the producer only
+} frame_ring_t;
+
+void frame_ring_init(frame_ring_t* ring, void* buf, size_t size);
+
+// Producer side
+uint8_t* frame_ring_reserve(frame_ring_t* ring, size_t max_len);
+void frame_ring_commit(frame_ring_t* ring, size_t len);
+bool frame_ring_push(frame_ring_t* ring, uint8_t const* frame, size_t len);
+
+// Consumer side
+bool frame_ring_peek(frame_ring_t* ring, uint8_t const** frame, size_t* len);
+void frame_ring_release(frame_ring_t* ring);
+
+#endif  // FRAME_RING_H
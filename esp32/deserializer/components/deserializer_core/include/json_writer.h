@@ -0,0 +1,44 @@
+/**
+ * @file json_writer.h
+ * @brief Allocation-free streaming JSON writer
+ *
+ * Writes JSON text directly into a caller-supplied buffer, with the same
+ * compact layout and string escaping as cJSON_PrintUnformatted(), so the output
+ * is byte-identical to the previous cJSON based rendering.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Worst case rendered size of a Payload whose data is data_len bytes long
+// (every byte escaped as \uXXXX plus the fixed keys, punctuation and timestamp)
+#define JSON_PAYLOAD_MAX_LEN(data_len) (6 * (data_len) + 40)
+
+#define JSON_ESCAPE_MAX_LEN 6  //!< Longest escape of a single byte (\u00xx)
+
+typedef struct {
+    char* buf;      //!< Output buffer
+    size_t size;    //!< Size of buf, including room for the terminating NUL
+    size_t len;     //!< Characters written so far
+    bool overflow;  //!< Set when some output did not fit in buf
+} json_writer_t;
+
+void json_writer_init(json_writer_t* writer, char* buf, size_t size);
+void json_write_raw(json_writer_t* writer, char const* text, size_t len);
+void json_write_uint(json_writer_t* writer, uint32_t value);
+void json_write_string(json_writer_t* writer, char const* str, size_t len);
+void json_write_escaped(json_writer_t* writer, char const* str, size_t len);
+bool json_writer_finish(json_writer_t* writer);
+
+size_t json_write_payload(char* buf, size_t size, uint32_t timestamp, char const* data,
+        size_t data_len);
+
+#endif  // JSON_WRITER_H
@@ -0,0 +1,44 @@
+/**
+ * @file latency_hist.h
+ * @brief Fixed-bucket histograms of durations, on a log scale
+ *
+ * A duration of d microseconds is counted in bucket 0 if d is 0, and in bucket
+ * i, holding [2^(i-1), 2^i) us, otherwise; the last bucket also takes anything
+ * longer. Adding a sample is a count-leading-zeros and an increment, with no
+ * division and no allocation, so it can stay in the hot path. The price is
+ * resolution: a percentile is only known to within a factor of 2, which is
+ * enough to tell where the time goes.
+ *
+ * Each histogram must have a single writer. A reader in another task, e.g. one
+ * reporting the histograms, may see a sample counted in one field but not yet
+ * in another; the figures are approximate while samples keep coming.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//! Number of buckets: the last one starts at 2^(LATENCY_HIST_BUCKETS - 2) us, about 4 s
+#define LATENCY_HIST_BUCKETS 24
+
+typedef struct {
+    uint32_t counts[LATENCY_HIST_BUCKETS];  //!< Samples per bucket
+    uint32_t samples;                       //!< Samples in all the buckets
+    uint32_t max_us;                        //!< Longest sample
+    uint64_t total_us;                      //!< Sum of the samples, for their mean
+} latency_hist_t;
+
+void latency_hist_reset(latency_hist_t* hist);
+void latency_hist_add(latency_hist_t* hist, uint32_t us);
+size_t latency_hist_bucket(uint32_t us);
+uint32_t latency_hist_bucket_max(size_t bucket);
+uint32_t latency_hist_percentile(latency_hist_t const* hist, uint32_t percent);
+uint32_t latency_hist_mean(latency_hist_t const* hist);
+
+#endif  // LATENCY_HIST_H
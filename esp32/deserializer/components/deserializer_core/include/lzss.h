@@ -0,0 +1,54 @@
+/**
+ * @file lzss.h
+ * @brief Decompressor for the LZSS encoding of compressed frames
+ *
+ * Compressed frames carry an ordinary frame body (FrameType byte and message)
+ * encoded as a sequence of groups: a flag byte, then up to 8 items, one per
+ * flag bit starting from the least significant. A clear bit is a literal byte;
+ * a set bit is a 2-byte back-reference, big-endian, with the distance minus 1
+ * in its top LZSS_DISTANCE_BITS bits and the length minus LZSS_MIN_MATCH in the
+ * others, copying bytes already decoded (possibly overlapping the output).
+ *
+ * Back-references point into the output itself, so decompression needs no
+ * window or state beyond the output buffer, in the spirit of heatshrink with a
+ * window as large as the buffer. The matching compressor is lzss_compress() in
+ * pc/serializer.py.
+ *
+ * A stream may also be compressed against a dictionary known to both ends, a
+ * fixed block of typical data placed just before the output: back-references
+ * that reach past the start of the output continue into the end of the
+ * dictionary, so even a short message finds matches. The dictionary carries a
+ * version that dictionary-compressed frames repeat, see lzss_dict.h.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef LZSS_H
+#define LZSS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LZSS_DISTANCE_BITS 11  //!< Bits of a back-reference holding the distance
+#define LZSS_LENGTH_BITS 5     //!< Bits of a back-reference holding the length
+#define LZSS_MIN_MATCH 3       //!< Shortest back-reference, shorter matches are literals
+
+//! Farthest and longest back-references
+#define LZSS_MAX_DISTANCE (1u << LZSS_DISTANCE_BITS)
+#define LZSS_MAX_MATCH (LZSS_MIN_MATCH + (1u << LZSS_LENGTH_BITS) - 1)
+
+typedef struct {
+    uint8_t version;      //!< Identifies the contents, changed whenever they change
+    uint8_t const* data;  //!< Dictionary bytes, only the last LZSS_MAX_DISTANCE are reachable
+    size_t len;           //!< Length of data
+} lzss_dict_t;
+
+bool lzss_decompress(uint8_t const* src, size_t src_len, uint8_t* dst, size_t dst_size,
+        size_t* dst_len);
+bool lzss_decompress_dict(lzss_dict_t const* dict, uint8_t const* src, size_t src_len,
+        uint8_t* dst, size_t dst_size, size_t* dst_len);
+
+#endif  // LZSS_H
@@ -0,0 +1,27 @@
+/**
+ * @file lzss_dict.h
+ * @brief Dictionary shared with the sender for dictionary-compressed frames
+ *
+ * Short messages hardly compress on their own, as LZSS only finds repeats of
+ * bytes already sent in the same frame. Compressed against this dictionary of
+ * words typical of telemetry strings, they can refer to it from their first
+ * byte instead. The sender keeps an identical copy (DICTIONARY in
+ * pc/serializer.py); any change to the contents must bump LZSS_DICT_VERSION on
+ * both sides, so that frames compressed against another version are refused
+ * rather than decoded into garbage.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef LZSS_DICT_H
+#define LZSS_DICT_H
+
+#include "lzss.h"
+
+#define LZSS_DICT_VERSION 1  //!< Version of lzss_telemetry_dict
+
+extern lzss_dict_t const lzss_telemetry_dict;
+
+#endif  // LZSS_DICT_H
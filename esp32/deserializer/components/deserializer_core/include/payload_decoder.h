@@ -0,0 +1,79 @@
+/**
+ * @file payload_decoder.h
+ * @brief Allocation-free decoder specialized for the Payload message
+ *
+ * Decodes the two Payload fields (1: uint32 timestamp, 2: string data) directly
+ * into a caller-owned view. The data string is not copied: the view points into
+ * the encoded buffer, which must outlive it. Messages carrying any other field
+ * are reported as such so the caller can fall back to payload__unpack().
+ * A Batch (repeated Payload) is walked entry by entry in the same zero-copy way,
+ * and so is a DeltaBatch, whose absolute timestamps are rebuilt from the deltas.
+ * A Chunk of a chunked transfer is decoded into a view in the same way (see
+ * frame_protocol.h for the frame types and the other protocol messages).
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef PAYLOAD_DECODER_H
+#define PAYLOAD_DECODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pb_wire.h"
+
+// Field numbers of the Payload, Batch and DeltaBatch messages in message.proto
+#define PAYLOAD_FIELD_TIMESTAMP 1
+#define PAYLOAD_FIELD_DATA 2
+#define BATCH_FIELD_PAYLOADS 1
+#define DELTA_BATCH_FIELD_BASE_TIMESTAMP 1
+#define DELTA_BATCH_FIELD_TIMESTAMP_DELTAS 2
+#define DELTA_BATCH_FIELD_DATA 3
+
+typedef struct {
+    uint32_t timestamp;  //!< Unix timestamp in seconds
+    char const* data;    //!< Message content, NOT NUL-terminated
+    size_t data_len;     //!< Length of data in bytes
+} payload_view_t;
+
+typedef struct {
+    uint32_t transfer_id;  //!< Transfer the chunk belongs to
+    uint32_t index;        //!< Position of the chunk in the transfer
+    uint32_t size;         //!< Total data length (first chunk only)
+    uint32_t timestamp;    //!< Payload timestamp (first chunk only)
+    uint8_t const* data;   //!< Piece of the Payload data
+    size_t data_len;       //!< Length of data in bytes
+} chunk_view_t;
+
+typedef enum {
+    PAYLOAD_DECODE_OK,             //!< View filled in
+    PAYLOAD_DECODE_UNKNOWN_FIELD,  //!< Well-formed so far but has fields this decoder ignores
+    PAYLOAD_DECODE_MALFORMED,      //!< Not a valid encoding of Payload
+} payload_decode_status_t;
+
+typedef enum {
+    PAYLOAD_BATCH_ENTRY,      //!< Next encoded Payload returned
+    PAYLOAD_BATCH_END,        //!< No Payload left
+    PAYLOAD_BATCH_MALFORMED,  //!< Not a valid encoding of Batch
+} payload_batch_status_t;
+
+typedef struct {
+    uint32_t timestamp;   //!< Timestamp of the last message returned
+    pb_reader_t deltas;   //!< Fields of the DeltaBatch, searched for timestamp_deltas
+    pb_reader_t packed;   //!< Remaining deltas of the current packed timestamp_deltas field
+    pb_reader_t data;     //!< Fields of the DeltaBatch, searched for data
+    size_t remaining;     //!< Messages not returned yet
+} delta_batch_reader_t;
+
+payload_decode_status_t payload_view_decode(uint8_t const* buf, size_t len, payload_view_t* view);
+payload_batch_status_t payload_batch_next(pb_reader_t* reader, uint8_t const** payload,
+        size_t* len);
+bool delta_batch_init(delta_batch_reader_t* reader, uint8_t const* buf, size_t len);
+payload_batch_status_t delta_batch_next(delta_batch_reader_t* reader, payload_view_t* view,
+        size_t* wire_len);
+bool chunk_view_decode(uint8_t const* buf, size_t len, chunk_view_t* view);
+
+#endif  // PAYLOAD_DECODER_H
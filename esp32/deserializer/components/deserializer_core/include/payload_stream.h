@@ -0,0 +1,88 @@
+/**
+ * @file payload_stream.h
+ * @brief Incremental decoder rendering a Payload to JSON as its bytes arrive
+ *
+ * Counterpart of payload_view_decode() and json_write_payload() for messages
+ * too large to be buffered whole: the encoded Payload is fed in pieces of any
+ * size and its JSON rendering, byte-identical to json_write_payload(), comes
+ * out in pieces through a small fixed buffer. Memory use does not depend on
+ * the message size.
+ *
+ * The rendering starts with the timestamp, so it must come before data on the
+ * wire, as every protobuf encoder writes fields in field number order. A
+ * timestamp after data, or a second data field, cannot be honored once data
+ * has been rendered and makes the message invalid. Unknown fields are skipped.
+ *
+ * A message already decoded but too large to be rendered in one piece goes
+ * through the same output with payload_stream_render().
+ *
+ * With payload_stream_set_binary(), the pieces make up the binary record of the
+ * Payload instead (see binary_record.h). Its header needs the data length,
+ * known once the data field starts, so the same field order applies.
+ * Unlike a rendering, a record cut short is completed with padding by
+ * payload_stream_abort(), since its reader relies on its announced length.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef PAYLOAD_STREAM_H
+#define PAYLOAD_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "json_writer.h"
+#include "payload_decoder.h"
+
+#define PAYLOAD_STREAM_CHUNK 128  //!< Size of the JSON output buffer, NUL included
+
+/**
+ * @brief Callback invoked for every piece of the JSON rendering, in order
+ *
+ * @param ctx User context given to payload_stream_init()
+ * @param json Next characters of the rendering (or bytes of the binary record), NOT
+ *             NUL-terminated
+ * @param len Number of characters in json
+ * @param last Whether this piece completes the rendering
+ */
+typedef void (*json_chunk_handler_t)(void* ctx, char const* json, size_t len, bool last);
+
+typedef enum {
+    PAYLOAD_STREAM_TAG,        //!< Reading a field tag
+    PAYLOAD_STREAM_VARINT,     //!< Reading a varint field value
+    PAYLOAD_STREAM_LEN,        //!< Reading the length of a length-delimited field
+    PAYLOAD_STREAM_DATA,       //!< Rendering the data string
+    PAYLOAD_STREAM_SKIP,       //!< Skipping the value of an unknown field
+    PAYLOAD_STREAM_MALFORMED,  //!< Invalid encoding, the rest of the message is ignored
+} payload_stream_state_t;
+
+typedef struct {
+    json_chunk_handler_t on_json;    //!< Output callback
+    void* ctx;                       //!< User context passed to on_json
+    payload_stream_state_t state;    //!< Current decoder state
+    uint64_t varint;                 //!< Partially decoded varint
+    uint8_t varint_bytes;            //!< Number of varint bytes consumed so far
+    uint32_t field;                  //!< Field number of the current value
+    uint64_t remaining;              //!< Bytes left in the current data or skipped value
+    uint32_t timestamp;              //!< Timestamp decoded so far
+    bool started;                    //!< The rendering up to the data string was written
+    bool binary;                     //!< Binary records are passed on instead of JSON
+    size_t max_data;                 //!< Longest data field accepted in binary mode
+    size_t len;                      //!< Encoded bytes fed so far
+    json_writer_t out;               //!< Rendering not passed to on_json yet, in buf
+    char buf[PAYLOAD_STREAM_CHUNK];  //!< Output buffer
+} payload_stream_t;
+
+void payload_stream_init(payload_stream_t* stream, json_chunk_handler_t on_json, void* ctx);
+void payload_stream_set_binary(payload_stream_t* stream, bool binary, size_t max_data);
+void payload_stream_begin(payload_stream_t* stream);
+void payload_stream_feed(payload_stream_t* stream, uint8_t const* data, size_t len);
+bool payload_stream_finish(payload_stream_t* stream);
+void payload_stream_abort(payload_stream_t* stream);
+void payload_stream_render(payload_stream_t* stream, payload_view_t const* view,
+        size_t payload_len);
+
+#endif  // PAYLOAD_STREAM_H
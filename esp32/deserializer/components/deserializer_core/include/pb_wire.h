@@ -0,0 +1,72 @@
+/**
+ * @file pb_wire.h
+ * @brief Minimal protobuf wire format reader and writer
+ *
+ * Reads varints, tags and length-delimited fields straight from an encoded
+ * buffer, without descriptors or allocations. Used by the hand-specialized
+ * message decoders on the hot path. The matching writer encodes messages into
+ * a caller-supplied buffer.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#ifndef PB_WIRE_H
+#define PB_WIRE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Protobuf wire types
+#define PB_WIRE_VARINT 0
+#define PB_WIRE_FIXED64 1
+#define PB_WIRE_LEN 2
+#define PB_WIRE_FIXED32 5
+
+#define PB_VARINT_MAX_BYTES 10
+
+typedef struct {
+    uint8_t const* pos;  //!< Next byte to read
+    uint8_t const* end;  //!< One past the last byte of the buffer
+} pb_reader_t;
+
+typedef struct {
+    uint8_t* buf;   //!< Output buffer
+    size_t size;    //!< Size of buf
+    size_t len;     //!< Bytes written so far
+    bool overflow;  //!< Set when some output did not fit in buf
+} pb_writer_t;
+
+void pb_reader_init(pb_reader_t* reader, uint8_t const* buf, size_t len);
+bool pb_read_varint(pb_reader_t* reader, uint64_t* value);
+bool pb_read_tag(pb_reader_t* reader, uint32_t* field, uint32_t* wire_type);
+bool pb_read_len(pb_reader_t* reader, uint8_t const** data, size_t* len);
+bool pb_skip_field(pb_reader_t* reader, uint32_t wire_type);
+
+void pb_writer_init(pb_writer_t* writer, uint8_t* buf, size_t size);
+void pb_write_varint(pb_writer_t* writer, uint64_t value);
+void pb_write_tag(pb_writer_t* writer, uint32_t field, uint32_t wire_type);
+void pb_write_len(pb_writer_t* writer, uint32_t field, void const* data, size_t len);
+
+/**
+ * @brief Check whether all bytes of the reader have been consumed
+ */
+static inline bool pb_reader_done(pb_reader_t const* reader) { return reader->pos >= reader->end; }
+
+/**
+ * @brief Decode a sint32 value from its zigzag encoding
+ */
+static inline int32_t pb_zigzag_decode32(uint32_t value) {
+    return (int32_t)((value >> 1) ^ (0U - (value & 1U)));
+}
+
+/**
+ * @brief Zigzag-encode a sint32 value, so small negative values stay short varints
+ */
+static inline uint32_t pb_zigzag_encode32(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+#endif  // PB_WIRE_H
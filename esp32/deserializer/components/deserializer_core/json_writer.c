@@ -0,0 +1,194 @@
+/**
+ * @file json_writer.c
+ * @brief Allocation-free streaming JSON writer
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "json_writer.h"
+
+#include <string.h>
+
+/**
+ * @fn void json_writer_init(json_writer_t *writer, char *buf, size_t size)
+ * @brief Start writing JSON into a buffer
+ *
+ * @param writer Writer to initialize
+ * @param buf Output buffer
+ * @param size Size of buf; one byte is always kept for the terminating NUL
+ *
+ * @return void
+ */
+void json_writer_init(json_writer_t* writer, char* buf, size_t size) {
+    writer->buf = buf;
+    writer->size = size;
+    writer->len = 0;
+    writer->overflow = size == 0;
+}
+
+/**
+ * @fn void json_write_raw(json_writer_t *writer, const char *text, size_t len)
+ * @brief Append text verbatim
+ *
+ * @param writer Writer to append to
+ * @param text Text to append
+ * @param len Length of text
+ *
+ * @return void
+ */
+void json_write_raw(json_writer_t* writer, char const* text, size_t len) {
+    if (writer->overflow || len >= writer->size - writer->len) {
+        writer->overflow = true;
+        return;
+    }
+    memcpy(writer->buf + writer->len, text, len);
+    writer->len += len;
+}
+
+/**
+ * @fn void json_write_uint(json_writer_t *writer, uint32_t value)
+ * @brief Append an unsigned integer as a JSON number
+ *
+ * @param writer Writer to append to
+ * @param value Number to append
+ *
+ * @return void
+ */
+void json_write_uint(json_writer_t* writer, uint32_t value) {
+    char digits[10];
+    size_t n = sizeof(digits);
+
+    do {
+        digits[--n] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    json_write_raw(writer, digits + n, sizeof(digits) - n);
+}
+
+/**
+ * @fn void json_write_string(json_writer_t *writer, const char *str, size_t len)
+ * @brief Append a quoted and escaped JSON string
+ *
+ * Escapes exactly like cJSON: quote, backslash and the \\b \\f \\n \\r \\t control
+ * characters get their short escapes, the remaining control characters are
+ * written as \\u00xx and every other byte (including UTF-8 sequences) is copied
+ * as is. Unlike cJSON the string is not NUL-terminated, so embedded NULs are
+ * escaped instead of ending the string.
+ *
+ * @param writer Writer to append to
+ * @param str String to append
+ * @param len Length of str in bytes
+ *
+ * @return void
+ */
+void json_write_string(json_writer_t* writer, char const* str, size_t len) {
+    json_write_raw(writer, "\"", 1);
+    json_write_escaped(writer, str, len);
+    json_write_raw(writer, "\"", 1);
+}
+
+/**
+ * @fn void json_write_escaped(json_writer_t *writer, const char *str, size_t len)
+ * @brief Append the escaped contents of a JSON string, without the quotes
+ *
+ * Same escaping as json_write_string(), for strings written in several pieces:
+ * each byte is escaped on its own, so the pieces may split UTF-8 sequences.
+ * A piece of n bytes never takes more than n * JSON_ESCAPE_MAX_LEN characters.
+ *
+ * @param writer Writer to append to
+ * @param str Next piece of the string
+ * @param len Length of str in bytes
+ *
+ * @return void
+ */
+void json_write_escaped(json_writer_t* writer, char const* str, size_t len) {
+    static char const hex[] = "0123456789abcdef";
+    size_t run = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)str[i];
+        if (c > 31 && c != '"' && c != '\\') {
+            continue;
+        }
+
+        // Flush the run of plain characters preceding the escaped one
+        json_write_raw(writer, str + run, i - run);
+        run = i + 1;
+
+        char escape[6] = { '\\', 0 };
+        size_t escape_len = 2;
+        switch (c) {
+        case '"':
+        case '\\':
+            escape[1] = (char)c;
+            break;
+        case '\b':
+            escape[1] = 'b';
+            break;
+        case '\f':
+            escape[1] = 'f';
+            break;
+        case '\n':
+            escape[1] = 'n';
+            break;
+        case '\r':
+            escape[1] = 'r';
+            break;
+        case '\t':
+            escape[1] = 't';
+            break;
+        default:
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[3] = '0';
+            escape[4] = hex[c >> 4];
+            escape[5] = hex[c & 0x0F];
+            escape_len = 6;
+            break;
+        }
+        json_write_raw(writer, escape, escape_len);
+    }
+    json_write_raw(writer, str + run, len - run);
+}
+
+/**
+ * @fn bool json_writer_finish(json_writer_t *writer)
+ * @brief NUL-terminate the output
+ *
+ * @param writer Writer to finish
+ *
+ * @return true if the whole output fit in the buffer, false otherwise
+ */
+bool json_writer_finish(json_writer_t* writer) {
+    if (writer->size > 0) {
+        writer->buf[writer->overflow ? 0 : writer->len] = '\0';
+    }
+    return !writer->overflow;
+}
+
+/**
+ * @fn size_t json_write_payload(char *buf, size_t size, uint32_t timestamp,
+ *                               const char *data, size_t data_len)
+ * @brief Render a Payload as compact JSON: {"timestamp":N,"data":"..."}
+ *
+ * @param buf Output buffer, at least JSON_PAYLOAD_MAX_LEN(data_len) bytes to never overflow
+ * @param size Size of buf
+ * @param timestamp Payload timestamp
+ * @param data Payload data, not necessarily NUL-terminated
+ * @param data_len Length of data in bytes
+ *
+ * @return Length of the NUL-terminated JSON text, or 0 if it did not fit in buf
+ */
+size_t json_write_payload(char* buf, size_t size, uint32_t timestamp, char const* data,
+        size_t data_len) {
+    json_writer_t writer;
+    json_writer_init(&writer, buf, size);
+    json_write_raw(&writer, "{\"timestamp\":", 13);
+    json_write_uint(&writer, timestamp);
+    json_write_raw(&writer, ",\"data\":", 8);
+    json_write_string(&writer, data, data_len);
+    json_write_raw(&writer, "}", 1);
+    return json_writer_finish(&writer) ? writer.len : 0;
+}
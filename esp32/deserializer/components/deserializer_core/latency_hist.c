@@ -0,0 +1,103 @@
+/**
+ * @file latency_hist.c
+ * @brief Fixed-bucket histograms of durations, on a log scale
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "latency_hist.h"
+
+#include <string.h>
+
+/**
+ * @fn void latency_hist_reset(latency_hist_t *hist)
+ * @brief Empty a histogram
+ *
+ * @param hist Histogram to empty
+ *
+ * @return void
+ */
+void latency_hist_reset(latency_hist_t* hist) { memset(hist, 0, sizeof(*hist)); }
+
+/**
+ * @fn void latency_hist_add(latency_hist_t *hist, uint32_t us)
+ * @brief Count one duration
+ *
+ * @param hist Histogram
+ * @param us Duration in microseconds
+ *
+ * @return void
+ */
+void latency_hist_add(latency_hist_t* hist, uint32_t us) {
+    hist->counts[latency_hist_bucket(us)]++;
+    hist->samples++;
+    hist->total_us += us;
+    if (us > hist->max_us) {
+        hist->max_us = us;
+    }
+}
+
+/**
+ * @fn size_t latency_hist_bucket(uint32_t us)
+ * @brief Bucket a duration is counted in
+ *
+ * @param us Duration in microseconds
+ *
+ * @return 0 for 0 us, the bit length of us otherwise, at most LATENCY_HIST_BUCKETS - 1
+ */
+size_t latency_hist_bucket(uint32_t us) {
+    size_t bucket = us == 0 ? 0 : 32 - (size_t)__builtin_clz(us);
+    return bucket < LATENCY_HIST_BUCKETS ? bucket : LATENCY_HIST_BUCKETS - 1;
+}
+
+/**
+ * @fn uint32_t latency_hist_bucket_max(size_t bucket)
+ * @brief Longest duration a bucket counts
+ *
+ * @param bucket Bucket index, below LATENCY_HIST_BUCKETS
+ *
+ * @return Upper bound of the bucket in microseconds, UINT32_MAX for the last one
+ */
+uint32_t latency_hist_bucket_max(size_t bucket) {
+    return bucket == LATENCY_HIST_BUCKETS - 1 ? UINT32_MAX : (1u << bucket) - 1;
+}
+
+/**
+ * @fn uint32_t latency_hist_percentile(const latency_hist_t *hist, uint32_t percent)
+ * @brief Bound on a percentile of the durations counted
+ *
+ * The buckets only tell which one the percentile falls in, so the result is
+ * the upper bound of that bucket, or the longest sample if that is lower.
+ *
+ * @param hist Histogram
+ * @param percent Percentile, from 0 to 100
+ *
+ * @return Duration in microseconds that percent of the samples do not exceed, 0 without samples
+ */
+uint32_t latency_hist_percentile(latency_hist_t const* hist, uint32_t percent) {
+    uint64_t rank = ((uint64_t)hist->samples * percent + 99) / 100;
+    uint64_t seen = 0;
+
+    for (size_t bucket = 0; bucket < LATENCY_HIST_BUCKETS; bucket++) {
+        seen += hist->counts[bucket];
+        if (seen >= rank && seen > 0) {
+            uint32_t bound = latency_hist_bucket_max(bucket);
+            return bound < hist->max_us ? bound : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+/**
+ * @fn uint32_t latency_hist_mean(const latency_hist_t *hist)
+ * @brief Mean of the durations counted
+ *
+ * @param hist Histogram
+ *
+ * @return Mean duration in microseconds, rounded down, 0 without samples
+ */
+uint32_t latency_hist_mean(latency_hist_t const* hist) {
+    return hist->samples == 0 ? 0 : (uint32_t)(hist->total_us / hist->samples);
+}
@@ -0,0 +1,88 @@
+/**
+ * @file lzss.c
+ * @brief Decompressor for the LZSS encoding of compressed frames
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "lzss.h"
+
+/**
+ * @fn bool lzss_decompress(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_size,
+ *                          size_t *dst_len)
+ * @brief Decompress an LZSS stream into a caller-owned buffer
+ *
+ * The stream ends with its input: flag bits left over in the last group are
+ * ignored, but a back-reference cut short is not.
+ *
+ * @param src Compressed stream
+ * @param src_len Length of the compressed stream
+ * @param dst Output buffer
+ * @param dst_size Size of dst, the largest output accepted
+ * @param dst_len Output for the length of the decompressed data
+ *
+ * @return true on success, false if the stream is invalid or does not fit in dst
+ */
+bool lzss_decompress(uint8_t const* src, size_t src_len, uint8_t* dst, size_t dst_size,
+        size_t* dst_len) {
+    return lzss_decompress_dict(NULL, src, src_len, dst, dst_size, dst_len);
+}
+
+/**
+ * @fn bool lzss_decompress_dict(const lzss_dict_t *dict, const uint8_t *src, size_t src_len,
+ *                               uint8_t *dst, size_t dst_size, size_t *dst_len)
+ * @brief Decompress an LZSS stream compressed against a dictionary
+ *
+ * Same as lzss_decompress(), except that back-references may reach up to
+ * dict->len bytes before the start of the output, into the dictionary.
+ *
+ * @param dict Dictionary the stream was compressed against, or NULL for none
+ * @param src Compressed stream
+ * @param src_len Length of the compressed stream
+ * @param dst Output buffer
+ * @param dst_size Size of dst, the largest output accepted
+ * @param dst_len Output for the length of the decompressed data
+ *
+ * @return true on success, false if the stream is invalid or does not fit in dst
+ */
+bool lzss_decompress_dict(lzss_dict_t const* dict, uint8_t const* src, size_t src_len,
+        uint8_t* dst, size_t dst_size, size_t* dst_len) {
+    uint8_t const* dict_data = dict != NULL ? dict->data : NULL;
+    size_t dict_len = dict != NULL ? dict->len : 0;
+    size_t read = 0;
+    size_t write = 0;
+
+    while (read < src_len) {
+        uint8_t flags = src[read++];
+        for (int bit = 0; bit < 8 && read < src_len; bit++, flags >>= 1) {
+            if ((flags & 1) == 0) {
+                if (write == dst_size) {
+                    return false;
+                }
+                dst[write++] = src[read++];
+                continue;
+            }
+            if (src_len - read < 2) {
+                return false;
+            }
+            uint16_t token = (uint16_t)(src[read] << 8 | src[read + 1]);
+            read += 2;
+            size_t distance = (token >> LZSS_LENGTH_BITS) + 1u;
+            size_t length = (token & ((1u << LZSS_LENGTH_BITS) - 1)) + LZSS_MIN_MATCH;
+            if (distance > write + dict_len || length > dst_size - write) {
+                return false;
+            }
+            // Byte by byte: a reference closer than its length repeats the bytes it copies,
+            // and one starting in the dictionary may run on into the output
+            for (size_t i = 0; i < length; i++, write++) {
+                dst[write] = distance > write ? dict_data[dict_len - (distance - write)]
+                                              : dst[write - distance];
+            }
+        }
+    }
+
+    *dst_len = write;
+    return true;
+}
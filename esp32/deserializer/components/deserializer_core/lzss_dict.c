@@ -0,0 +1,23 @@
+/**
+ * @file lzss_dict.c
+ * @brief Dictionary shared with the sender for dictionary-compressed frames
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "lzss_dict.h"
+
+// Must stay byte-identical to DICTIONARY in pc/serializer.py. The most frequent
+// words come last, so they stay within reach of back-references the longest.
+static char const dictionary[] =
+        "Hello world! device firmware version uptime signal rssi dBm current mA power mW "
+        "value min max avg count error warning update node gateway level % battery voltage mV "
+        "pressure hPa humidity %RH temperature C alarm cleared status ok nominal sensor reading ";
+
+lzss_dict_t const lzss_telemetry_dict = {
+    .version = LZSS_DICT_VERSION,
+    .data = (uint8_t const*)dictionary,
+    .len = sizeof(dictionary) - 1,  // Without the NUL terminator
+};
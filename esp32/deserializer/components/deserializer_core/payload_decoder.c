@@ -0,0 +1,320 @@
+/**
+ * @file payload_decoder.c
+ * @brief Allocation-free decoder specialized for the Payload message
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "payload_decoder.h"
+
+#include "frame_protocol.h"
+
+static size_t read_next_delta(delta_batch_reader_t* reader, uint64_t* delta);
+
+/**
+ * @fn payload_decode_status_t payload_view_decode(const uint8_t *buf, size_t len,
+ *                                                 payload_view_t *view)
+ * @brief Decode an encoded Payload into a non-owning view
+ *
+ * Follows the same rules as the generated payload__unpack(): missing fields keep
+ * their proto3 defaults, the last occurrence of a repeated field wins and a
+ * known field with the wrong wire type makes the message invalid.
+ *
+ * @param buf Encoded Payload
+ * @param len Length of the encoded Payload
+ * @param view Output view; data points into buf
+ *
+ * @return PAYLOAD_DECODE_OK on success,
+ *         PAYLOAD_DECODE_UNKNOWN_FIELD if the message contains fields other than
+ *         timestamp and data (view content is then undefined),
+ *         PAYLOAD_DECODE_MALFORMED if the encoding is invalid
+ */
+payload_decode_status_t payload_view_decode(uint8_t const* buf, size_t len, payload_view_t* view) {
+    pb_reader_t reader;
+    pb_reader_init(&reader, buf, len);
+    view->timestamp = 0;
+    view->data = "";
+    view->data_len = 0;
+
+    while (!pb_reader_done(&reader)) {
+        uint32_t field;
+        uint32_t wire_type;
+        if (!pb_read_tag(&reader, &field, &wire_type)) {
+            return PAYLOAD_DECODE_MALFORMED;
+        }
+
+        if (field == PAYLOAD_FIELD_TIMESTAMP) {
+            uint64_t value;
+            if (wire_type != PB_WIRE_VARINT || !pb_read_varint(&reader, &value)) {
+                return PAYLOAD_DECODE_MALFORMED;
+            }
+            view->timestamp = (uint32_t)value;
+        } else if (field == PAYLOAD_FIELD_DATA) {
+            uint8_t const* data;
+            if (wire_type != PB_WIRE_LEN || !pb_read_len(&reader, &data, &view->data_len)) {
+                return PAYLOAD_DECODE_MALFORMED;
+            }
+            view->data = (char const*)data;
+        } else {
+            return PAYLOAD_DECODE_UNKNOWN_FIELD;
+        }
+    }
+
+    return PAYLOAD_DECODE_OK;
+}
+
+/**
+ * @fn payload_batch_status_t payload_batch_next(pb_reader_t *reader, const uint8_t **payload,
+ *                                               size_t *len)
+ * @brief Return the next encoded Payload of a Batch
+ *
+ * The reader must have been initialized on the encoded Batch. Each call
+ * advances it past one entry, so a whole batch is decoded in a single pass
+ * without unpacking it into an intermediate structure. Fields other than
+ * payloads are skipped.
+ *
+ * @param reader Reader over the encoded Batch
+ * @param payload Output pointer to the encoded Payload, inside the Batch buffer
+ * @param len Output length of the encoded Payload
+ *
+ * @return PAYLOAD_BATCH_ENTRY when an entry was returned, PAYLOAD_BATCH_END once
+ *         all entries have been returned, PAYLOAD_BATCH_MALFORMED if the
+ *         encoding is invalid
+ */
+payload_batch_status_t payload_batch_next(pb_reader_t* reader, uint8_t const** payload,
+        size_t* len) {
+    while (!pb_reader_done(reader)) {
+        uint32_t field;
+        uint32_t wire_type;
+        if (!pb_read_tag(reader, &field, &wire_type)) {
+            return PAYLOAD_BATCH_MALFORMED;
+        }
+
+        if (field == BATCH_FIELD_PAYLOADS) {
+            if (wire_type != PB_WIRE_LEN || !pb_read_len(reader, payload, len)) {
+                return PAYLOAD_BATCH_MALFORMED;
+            }
+            return PAYLOAD_BATCH_ENTRY;
+        }
+        if (!pb_skip_field(reader, wire_type)) {
+            return PAYLOAD_BATCH_MALFORMED;
+        }
+    }
+
+    return PAYLOAD_BATCH_END;
+}
+
+/**
+ * @fn bool delta_batch_init(delta_batch_reader_t *reader, const uint8_t *buf, size_t len)
+ * @brief Validate an encoded DeltaBatch and prepare to iterate over its messages
+ *
+ * Checks the whole message first, so a malformed batch is rejected before any
+ * of its messages is emitted: every field must be well formed and there must
+ * be exactly one delta per data entry. Deltas may be packed (the proto3
+ * default) or not, and unknown fields are skipped.
+ *
+ * @param reader Reader to initialize
+ * @param buf Encoded DeltaBatch, must outlive the reader
+ * @param len Length of the encoded DeltaBatch
+ *
+ * @return true if the batch is valid, false otherwise
+ */
+bool delta_batch_init(delta_batch_reader_t* reader, uint8_t const* buf, size_t len) {
+    pb_reader_t scan;
+    size_t deltas = 0;
+    size_t data = 0;
+
+    reader->timestamp = 0;
+    pb_reader_init(&scan, buf, len);
+    while (!pb_reader_done(&scan)) {
+        uint32_t field;
+        uint32_t wire_type;
+        uint64_t value;
+        uint8_t const* bytes;
+        size_t bytes_len;
+        if (!pb_read_tag(&scan, &field, &wire_type)) {
+            return false;
+        }
+
+        if (field == DELTA_BATCH_FIELD_BASE_TIMESTAMP) {
+            if (wire_type != PB_WIRE_VARINT || !pb_read_varint(&scan, &value)) {
+                return false;
+            }
+            reader->timestamp = (uint32_t)value;
+        } else if (field == DELTA_BATCH_FIELD_TIMESTAMP_DELTAS && wire_type == PB_WIRE_VARINT) {
+            if (!pb_read_varint(&scan, &value)) {
+                return false;
+            }
+            deltas++;
+        } else if (field == DELTA_BATCH_FIELD_TIMESTAMP_DELTAS && wire_type == PB_WIRE_LEN) {
+            pb_reader_t packed;
+            if (!pb_read_len(&scan, &bytes, &bytes_len)) {
+                return false;
+            }
+            pb_reader_init(&packed, bytes, bytes_len);
+            while (!pb_reader_done(&packed)) {
+                if (!pb_read_varint(&packed, &value)) {
+                    return false;
+                }
+                deltas++;
+            }
+        } else if (field == DELTA_BATCH_FIELD_DATA) {
+            if (wire_type != PB_WIRE_LEN || !pb_read_len(&scan, &bytes, &bytes_len)) {
+                return false;
+            }
+            data++;
+        } else if (field == DELTA_BATCH_FIELD_TIMESTAMP_DELTAS
+                || !pb_skip_field(&scan, wire_type)) {
+            return false;
+        }
+    }
+
+    if (deltas != data) {
+        return false;
+    }
+    pb_reader_init(&reader->deltas, buf, len);
+    pb_reader_init(&reader->packed, buf, 0);
+    pb_reader_init(&reader->data, buf, len);
+    reader->remaining = data;
+    return true;
+}
+
+/**
+ * @fn payload_batch_status_t delta_batch_next(delta_batch_reader_t *reader,
+ *                                             payload_view_t *view, size_t *wire_len)
+ * @brief Return the next message of a DeltaBatch validated by delta_batch_init()
+ *
+ * Deltas and data are stored in separate fields, so two cursors walk the
+ * encoded batch side by side; each call advances both by one message and adds
+ * the delta to the previous timestamp (modulo 2^32, as uint32 arithmetic).
+ *
+ * @param reader Reader initialized by delta_batch_init()
+ * @param view Output view; data points into the DeltaBatch buffer
+ * @param wire_len Output number of batch bytes used by this message (delta and data entry)
+ *
+ * @return PAYLOAD_BATCH_ENTRY when a message was returned, PAYLOAD_BATCH_END once
+ *         all messages have been returned
+ */
+payload_batch_status_t delta_batch_next(delta_batch_reader_t* reader, payload_view_t* view,
+        size_t* wire_len) {
+    uint32_t field;
+    uint32_t wire_type;
+    uint64_t delta;
+    uint8_t const* data;
+
+    if (reader->remaining == 0) {
+        return PAYLOAD_BATCH_END;
+    }
+    reader->remaining--;
+
+    // The batch was validated, so both cursors are known to find their next entry
+    *wire_len = read_next_delta(reader, &delta);
+    for (;;) {
+        uint8_t const* start = reader->data.pos;
+        pb_read_tag(&reader->data, &field, &wire_type);
+        if (field == DELTA_BATCH_FIELD_DATA) {
+            pb_read_len(&reader->data, &data, &view->data_len);
+            *wire_len += (size_t)(reader->data.pos - start);
+            break;
+        }
+        pb_skip_field(&reader->data, wire_type);
+    }
+
+    reader->timestamp += (uint32_t)pb_zigzag_decode32((uint32_t)delta);
+    view->timestamp = reader->timestamp;
+    view->data = (char const*)data;
+    return PAYLOAD_BATCH_ENTRY;
+}
+
+/**
+ * @fn bool chunk_view_decode(const uint8_t *buf, size_t len, chunk_view_t *view)
+ * @brief Decode an encoded Chunk into a non-owning view
+ *
+ * Missing fields keep their proto3 defaults and unknown fields are skipped.
+ *
+ * @param buf Encoded Chunk
+ * @param len Length of the encoded Chunk
+ * @param view Output view; data points into buf
+ *
+ * @return true on success, false if the encoding is invalid
+ */
+bool chunk_view_decode(uint8_t const* buf, size_t len, chunk_view_t* view) {
+    pb_reader_t reader;
+    pb_reader_init(&reader, buf, len);
+    *view = (chunk_view_t) { .data = buf };
+
+    while (!pb_reader_done(&reader)) {
+        uint32_t field;
+        uint32_t wire_type;
+        uint64_t value;
+        if (!pb_read_tag(&reader, &field, &wire_type)) {
+            return false;
+        }
+
+        switch (field) {
+        case CHUNK_FIELD_TRANSFER_ID:
+        case CHUNK_FIELD_INDEX:
+        case CHUNK_FIELD_SIZE:
+        case CHUNK_FIELD_TIMESTAMP:
+            if (wire_type != PB_WIRE_VARINT || !pb_read_varint(&reader, &value)) {
+                return false;
+            }
+            if (field == CHUNK_FIELD_TRANSFER_ID) {
+                view->transfer_id = (uint32_t)value;
+            } else if (field == CHUNK_FIELD_INDEX) {
+                view->index = (uint32_t)value;
+            } else if (field == CHUNK_FIELD_SIZE) {
+                view->size = (uint32_t)value;
+            } else {
+                view->timestamp = (uint32_t)value;
+            }
+            break;
+        case CHUNK_FIELD_DATA:
+            if (wire_type != PB_WIRE_LEN || !pb_read_len(&reader, &view->data, &view->data_len)) {
+                return false;
+            }
+            break;
+        default:
+            if (!pb_skip_field(&reader, wire_type)) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @fn size_t read_next_delta(delta_batch_reader_t *reader, uint64_t *delta)
+ * @brief Read the next timestamp delta, packed or not, of a validated DeltaBatch
+ *
+ * @return Number of bytes of the encoded delta
+ */
+size_t read_next_delta(delta_batch_reader_t* reader, uint64_t* delta) {
+    uint32_t field;
+    uint32_t wire_type;
+    uint8_t const* start;
+
+    while (pb_reader_done(&reader->packed)) {
+        pb_read_tag(&reader->deltas, &field, &wire_type);
+        if (field != DELTA_BATCH_FIELD_TIMESTAMP_DELTAS) {
+            pb_skip_field(&reader->deltas, wire_type);
+        } else if (wire_type == PB_WIRE_VARINT) {
+            start = reader->deltas.pos;
+            pb_read_varint(&reader->deltas, delta);
+            return (size_t)(reader->deltas.pos - start);
+        } else {
+            uint8_t const* packed;
+            size_t len;
+            pb_read_len(&reader->deltas, &packed, &len);
+            pb_reader_init(&reader->packed, packed, len);
+        }
+    }
+
+    start = reader->packed.pos;
+    pb_read_varint(&reader->packed, delta);
+    return (size_t)(reader->packed.pos - start);
+}
@@ -0,0 +1,366 @@
+/**
+ * @file payload_stream.c
+ * @brief Incremental decoder rendering a Payload to JSON as its bytes arrive
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "payload_stream.h"
+
+#include "binary_record.h"
+
+#define JSON_HEADER_MAX_LEN 32  // {"timestamp":4294967295,"data":"
+
+static bool read_varint_byte(payload_stream_t* stream, uint8_t byte);
+static void start_field(payload_stream_t* stream);
+static void start_rendering(payload_stream_t* stream, size_t data_len);
+static void render_data(payload_stream_t* stream, uint8_t const* data, size_t len);
+static void reserve(payload_stream_t* stream, size_t len);
+static void flush(payload_stream_t* stream, bool last);
+
+/**
+ * @fn void payload_stream_init(payload_stream_t *stream, json_chunk_handler_t on_json, void *ctx)
+ * @brief Initialize a streaming decoder
+ *
+ * @param stream Decoder to initialize
+ * @param on_json Callback receiving the pieces of every rendering
+ * @param ctx User context forwarded to the callback
+ *
+ * @return void
+ */
+void payload_stream_init(payload_stream_t* stream, json_chunk_handler_t on_json, void* ctx) {
+    stream->on_json = on_json;
+    stream->ctx = ctx;
+    stream->binary = false;
+    payload_stream_begin(stream);
+}
+
+/**
+ * @fn void payload_stream_set_binary(payload_stream_t *stream, bool binary, size_t max_data)
+ * @brief Choose between JSON renderings and binary records for the following Payloads
+ *
+ * A record announces its length up front, so a data field longer than max_data
+ * makes the message invalid before its record is started: a record aborted
+ * later is padded to that length (see payload_stream_abort()).
+ *
+ * @param stream Decoder state
+ * @param binary true to pass on the binary record of every Payload, see binary_record.h
+ * @param max_data Longest data field accepted in binary mode
+ *
+ * @return void
+ */
+void payload_stream_set_binary(payload_stream_t* stream, bool binary, size_t max_data) {
+    stream->binary = binary;
+    stream->max_data = max_data;
+}
+
+/**
+ * @fn void payload_stream_begin(payload_stream_t *stream)
+ * @brief Start decoding a new Payload, dropping any unfinished one
+ *
+ * @param stream Decoder state
+ *
+ * @return void
+ */
+void payload_stream_begin(payload_stream_t* stream) {
+    stream->state = PAYLOAD_STREAM_TAG;
+    stream->varint = 0;
+    stream->varint_bytes = 0;
+    stream->remaining = 0;
+    stream->timestamp = 0;
+    stream->started = false;
+    stream->len = 0;
+    json_writer_init(&stream->out, stream->buf, sizeof(stream->buf));
+}
+
+/**
+ * @fn void payload_stream_feed(payload_stream_t *stream, const uint8_t *data, size_t len)
+ * @brief Consume the next bytes of the encoded Payload
+ *
+ * The data string is escaped and rendered straight from the input; the output
+ * buffer is passed to the callback whenever it cannot take the next piece.
+ * Once the message turned out to be invalid the rest of it is ignored.
+ *
+ * @param stream Decoder state
+ * @param data Next bytes of the encoded Payload
+ * @param len Number of bytes
+ *
+ * @return void
+ */
+void payload_stream_feed(payload_stream_t* stream, uint8_t const* data, size_t len) {
+    size_t pos = 0;
+
+    stream->len += len;
+    while (pos < len) {
+        switch (stream->state) {
+        case PAYLOAD_STREAM_TAG:
+            if (read_varint_byte(stream, data[pos++])) {
+                start_field(stream);
+            }
+            break;
+        case PAYLOAD_STREAM_VARINT:
+            if (read_varint_byte(stream, data[pos++])) {
+                if (stream->field == PAYLOAD_FIELD_TIMESTAMP) {
+                    stream->timestamp = (uint32_t)stream->varint;
+                }
+                stream->state = PAYLOAD_STREAM_TAG;
+            }
+            break;
+        case PAYLOAD_STREAM_LEN:
+            if (!read_varint_byte(stream, data[pos++])) {
+                break;
+            }
+            stream->remaining = stream->varint;
+            if (stream->field == PAYLOAD_FIELD_DATA && stream->binary
+                    && stream->remaining > stream->max_data) {
+                stream->state = PAYLOAD_STREAM_MALFORMED;
+            } else if (stream->field == PAYLOAD_FIELD_DATA) {
+                start_rendering(stream, (size_t)stream->remaining);
+                stream->state = PAYLOAD_STREAM_DATA;
+            } else {
+                stream->state = PAYLOAD_STREAM_SKIP;
+            }
+            break;
+        case PAYLOAD_STREAM_DATA: {
+            size_t chunk = len - pos;
+            if (chunk > stream->remaining) {
+                chunk = (size_t)stream->remaining;
+            }
+            render_data(stream, data + pos, chunk);
+            pos += chunk;
+            stream->remaining -= chunk;
+            break;
+        }
+        case PAYLOAD_STREAM_SKIP: {
+            size_t chunk = len - pos;
+            if (chunk > stream->remaining) {
+                chunk = (size_t)stream->remaining;
+            }
+            pos += chunk;
+            stream->remaining -= chunk;
+            break;
+        }
+        case PAYLOAD_STREAM_MALFORMED:
+            return;
+        }
+
+        if ((stream->state == PAYLOAD_STREAM_DATA || stream->state == PAYLOAD_STREAM_SKIP)
+                && stream->remaining == 0) {
+            stream->state = PAYLOAD_STREAM_TAG;
+        }
+    }
+}
+
+/**
+ * @fn bool payload_stream_finish(payload_stream_t *stream)
+ * @brief Complete the rendering once the whole Payload was fed
+ *
+ * @param stream Decoder state
+ *
+ * @return true if the Payload was valid and the last piece of its rendering was passed to
+ *         the callback, false if it was invalid or truncated (the pieces already passed
+ *         on are then to be discarded)
+ */
+bool payload_stream_finish(payload_stream_t* stream) {
+    if (stream->state != PAYLOAD_STREAM_TAG || stream->varint_bytes != 0) {
+        payload_stream_abort(stream);
+        return false;
+    }
+    start_rendering(stream, 0);
+    if (!stream->binary) {
+        reserve(stream, 2);
+        json_write_raw(&stream->out, "\"}", 2);
+    }
+    flush(stream, true);
+    return true;
+}
+
+/**
+ * @fn void payload_stream_abort(payload_stream_t *stream)
+ * @brief Drop the Payload being decoded, e.g. when its frame was cut short
+ *
+ * A JSON rendering is left unfinished. A binary record already started is
+ * completed with zero bytes up to the length it announced instead, so that a
+ * reader of the records stays in step with the ones that follow; like an
+ * unfinished rendering, it is to be discarded. The rest of the message is
+ * ignored.
+ *
+ * @param stream Decoder state
+ *
+ * @return void
+ */
+void payload_stream_abort(payload_stream_t* stream) {
+    static uint8_t const zeros[16] = { 0 };
+
+    if (stream->binary && stream->started) {
+        if (stream->state == PAYLOAD_STREAM_DATA) {
+            for (; stream->remaining > sizeof(zeros); stream->remaining -= sizeof(zeros)) {
+                render_data(stream, zeros, sizeof(zeros));
+            }
+            render_data(stream, zeros, (size_t)stream->remaining);
+        }
+        flush(stream, false);
+        stream->started = false;
+    }
+    stream->state = PAYLOAD_STREAM_MALFORMED;
+}
+
+/**
+ * @fn void payload_stream_render(payload_stream_t *stream, const payload_view_t *view,
+ *                                size_t payload_len)
+ * @brief Render an already decoded message in pieces, as if its Payload had been fed
+ *
+ * For messages held in a buffer too large to be rendered in one piece, e.g. a
+ * reassembled chunked transfer. Drops any unfinished Payload.
+ *
+ * @param stream Decoder state
+ * @param view Decoded message
+ * @param payload_len Length reported for the message, in place of the bytes fed
+ *
+ * @return void
+ */
+void payload_stream_render(payload_stream_t* stream, payload_view_t const* view,
+        size_t payload_len) {
+    payload_stream_begin(stream);
+    stream->timestamp = view->timestamp;
+    stream->len = payload_len;
+    start_rendering(stream, view->data_len);
+    render_data(stream, (uint8_t const*)view->data, view->data_len);
+    payload_stream_finish(stream);
+}
+
+/**
+ * @fn bool read_varint_byte(payload_stream_t *stream, uint8_t byte)
+ * @brief Accumulate one byte of a varint
+ *
+ * @return true once the varint is complete (in stream->varint, reset on the next call),
+ *         false while more bytes are needed or when it is too long (state set to malformed)
+ */
+bool read_varint_byte(payload_stream_t* stream, uint8_t byte) {
+    if (stream->varint_bytes == 0) {
+        stream->varint = 0;
+    }
+    stream->varint |= (uint64_t)(byte & 0x7F) << (7 * stream->varint_bytes);
+    stream->varint_bytes++;
+    if (!(byte & 0x80)) {
+        stream->varint_bytes = 0;
+        return true;
+    }
+    if (stream->varint_bytes == PB_VARINT_MAX_BYTES) {
+        stream->state = PAYLOAD_STREAM_MALFORMED;
+    }
+    return false;
+}
+
+/**
+ * @fn void start_field(payload_stream_t *stream)
+ * @brief Check the tag just read and prepare for the value that follows
+ *
+ * Applies the rules of payload_view_decode(), plus the field order constraint of
+ * streaming: nothing may change the rendering once data has been written.
+ */
+void start_field(payload_stream_t* stream) {
+    uint64_t key = stream->varint;
+    uint32_t wire_type = (uint32_t)(key & 0x07);
+
+    stream->field = (key >> 3) <= UINT32_MAX ? (uint32_t)(key >> 3) : 0;
+    if (stream->field == PAYLOAD_FIELD_TIMESTAMP) {
+        stream->state = wire_type == PB_WIRE_VARINT && !stream->started ? PAYLOAD_STREAM_VARINT
+                                                                         : PAYLOAD_STREAM_MALFORMED;
+    } else if (stream->field == PAYLOAD_FIELD_DATA) {
+        stream->state = wire_type == PB_WIRE_LEN && !stream->started ? PAYLOAD_STREAM_LEN
+                                                                     : PAYLOAD_STREAM_MALFORMED;
+    } else if (stream->field == 0) {
+        stream->state = PAYLOAD_STREAM_MALFORMED;
+    } else {
+        switch (wire_type) {
+        case PB_WIRE_VARINT:
+            stream->state = PAYLOAD_STREAM_VARINT;
+            break;
+        case PB_WIRE_LEN:
+            stream->state = PAYLOAD_STREAM_LEN;
+            break;
+        case PB_WIRE_FIXED64:
+            stream->remaining = 8;
+            stream->state = PAYLOAD_STREAM_SKIP;
+            break;
+        case PB_WIRE_FIXED32:
+            stream->remaining = 4;
+            stream->state = PAYLOAD_STREAM_SKIP;
+            break;
+        default:
+            stream->state = PAYLOAD_STREAM_MALFORMED;
+            break;
+        }
+    }
+}
+
+/**
+ * @fn void start_rendering(payload_stream_t *stream, size_t data_len)
+ * @brief Write the rendering up to the opening quote of the data string, or the record up
+ *        to the data bytes, once
+ */
+void start_rendering(payload_stream_t* stream, size_t data_len) {
+    if (stream->started) {
+        return;
+    }
+    stream->started = true;
+    if (stream->binary) {
+        uint8_t header[BINARY_RECORD_HEADER_MAX_LEN];
+        size_t header_len = binary_record_header(header, stream->timestamp, data_len);
+        reserve(stream, header_len);
+        json_write_raw(&stream->out, (char const*)header, header_len);
+        return;
+    }
+    reserve(stream, JSON_HEADER_MAX_LEN);
+    json_write_raw(&stream->out, "{\"timestamp\":", 13);
+    json_write_uint(&stream->out, stream->timestamp);
+    json_write_raw(&stream->out, ",\"data\":\"", 9);
+}
+
+/**
+ * @fn void render_data(payload_stream_t *stream, const uint8_t *data, size_t len)
+ * @brief Escape and render part of the data string, or copy it into the record, flushing
+ *        the output buffer as it fills
+ */
+void render_data(payload_stream_t* stream, uint8_t const* data, size_t len) {
+    size_t expansion = stream->binary ? 1 : JSON_ESCAPE_MAX_LEN;
+
+    while (len > 0) {
+        // Take as many bytes as fit in the output buffer even if all need escaping
+        size_t room = (stream->out.size - 1 - stream->out.len) / expansion;
+        if (room == 0) {
+            flush(stream, false);
+            continue;
+        }
+        size_t chunk = len < room ? len : room;
+        if (stream->binary) {
+            json_write_raw(&stream->out, (char const*)data, chunk);
+        } else {
+            json_write_escaped(&stream->out, (char const*)data, chunk);
+        }
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+/**
+ * @fn void reserve(payload_stream_t *stream, size_t len)
+ * @brief Flush the output buffer unless len more characters fit in it
+ */
+void reserve(payload_stream_t* stream, size_t len) {
+    if (len > stream->out.size - 1 - stream->out.len) {
+        flush(stream, false);
+    }
+}
+
+/**
+ * @fn void flush(payload_stream_t *stream, bool last)
+ * @brief Pass the output buffer to the callback and empty it
+ */
+void flush(payload_stream_t* stream, bool last) {
+    stream->on_json(stream->ctx, stream->buf, stream->out.len, last);
+    json_writer_init(&stream->out, stream->buf, sizeof(stream->buf));
+}
@@ -0,0 +1,201 @@
+/**
+ * @file pb_wire.c
+ * @brief Minimal protobuf wire format reader and writer
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "pb_wire.h"
+
+#include <string.h>
+
+/**
+ * @fn void pb_reader_init(pb_reader_t *reader, const uint8_t *buf, size_t len)
+ * @brief Start reading an encoded message
+ *
+ * @param reader Reader to initialize
+ * @param buf Encoded message
+ * @param len Length of the encoded message
+ *
+ * @return void
+ */
+void pb_reader_init(pb_reader_t* reader, uint8_t const* buf, size_t len) {
+    reader->pos = buf;
+    reader->end = buf + len;
+}
+
+/**
+ * @fn bool pb_read_varint(pb_reader_t *reader, uint64_t *value)
+ * @brief Read a base-128 varint of up to PB_VARINT_MAX_BYTES bytes
+ *
+ * @param reader Reader positioned on the varint
+ * @param value Output for the decoded value
+ *
+ * @return true on success, false if the varint is truncated or too long
+ */
+bool pb_read_varint(pb_reader_t* reader, uint64_t* value) {
+    uint64_t result = 0;
+
+    for (unsigned i = 0; i < PB_VARINT_MAX_BYTES && reader->pos < reader->end; i++) {
+        uint8_t byte = *reader->pos++;
+        result |= (uint64_t)(byte & 0x7F) << (7 * i);
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @fn bool pb_read_tag(pb_reader_t *reader, uint32_t *field, uint32_t *wire_type)
+ * @brief Read a field key and split it into field number and wire type
+ *
+ * @param reader Reader positioned on the key
+ * @param field Output for the field number
+ * @param wire_type Output for the wire type
+ *
+ * @return true on success, false if the key is malformed or the field number is 0
+ */
+bool pb_read_tag(pb_reader_t* reader, uint32_t* field, uint32_t* wire_type) {
+    uint64_t key;
+    if (!pb_read_varint(reader, &key) || (key >> 3) == 0 || (key >> 3) > UINT32_MAX) {
+        return false;
+    }
+    *field = (uint32_t)(key >> 3);
+    *wire_type = (uint32_t)(key & 0x07);
+    return true;
+}
+
+/**
+ * @fn bool pb_read_len(pb_reader_t *reader, const uint8_t **data, size_t *len)
+ * @brief Read the value of a length-delimited field without copying it
+ *
+ * @param reader Reader positioned on the length prefix
+ * @param data Output for a pointer to the value inside the encoded buffer
+ * @param len Output for the length of the value
+ *
+ * @return true on success, false if the value extends past the buffer
+ */
+bool pb_read_len(pb_reader_t* reader, uint8_t const** data, size_t* len) {
+    uint64_t size;
+    if (!pb_read_varint(reader, &size) || size > (uint64_t)(reader->end - reader->pos)) {
+        return false;
+    }
+    *data = reader->pos;
+    *len = (size_t)size;
+    reader->pos += size;
+    return true;
+}
+
+/**
+ * @fn bool pb_skip_field(pb_reader_t *reader, uint32_t wire_type)
+ * @brief Skip the value of a field of the given wire type
+ *
+ * @param reader Reader positioned on the value
+ * @param wire_type Wire type read from the field key
+ *
+ * @return true on success, false for truncated values or unsupported wire types (groups)
+ */
+bool pb_skip_field(pb_reader_t* reader, uint32_t wire_type) {
+    uint64_t value;
+    uint8_t const* data;
+    size_t len;
+
+    switch (wire_type) {
+    case PB_WIRE_VARINT:
+        return pb_read_varint(reader, &value);
+    case PB_WIRE_LEN:
+        return pb_read_len(reader, &data, &len);
+    case PB_WIRE_FIXED64:
+        len = 8;
+        break;
+    case PB_WIRE_FIXED32:
+        len = 4;
+        break;
+    default:
+        return false;
+    }
+
+    if (len > (size_t)(reader->end - reader->pos)) {
+        return false;
+    }
+    reader->pos += len;
+    return true;
+}
+
+/**
+ * @fn void pb_writer_init(pb_writer_t *writer, uint8_t *buf, size_t size)
+ * @brief Start encoding a message into a buffer
+ *
+ * @param writer Writer to initialize
+ * @param buf Output buffer
+ * @param size Size of buf
+ *
+ * @return void
+ */
+void pb_writer_init(pb_writer_t* writer, uint8_t* buf, size_t size) {
+    writer->buf = buf;
+    writer->size = size;
+    writer->len = 0;
+    writer->overflow = false;
+}
+
+/**
+ * @fn void pb_write_varint(pb_writer_t *writer, uint64_t value)
+ * @brief Append a base-128 varint
+ *
+ * @param writer Writer to append to
+ * @param value Value to encode
+ *
+ * @return void
+ */
+void pb_write_varint(pb_writer_t* writer, uint64_t value) {
+    do {
+        if (writer->len == writer->size) {
+            writer->overflow = true;
+            return;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        writer->buf[writer->len++] = value != 0 ? (byte | 0x80) : byte;
+    } while (value != 0);
+}
+
+/**
+ * @fn void pb_write_tag(pb_writer_t *writer, uint32_t field, uint32_t wire_type)
+ * @brief Append a field key
+ *
+ * @param writer Writer to append to
+ * @param field Field number
+ * @param wire_type Wire type of the value that follows
+ *
+ * @return void
+ */
+void pb_write_tag(pb_writer_t* writer, uint32_t field, uint32_t wire_type) {
+    pb_write_varint(writer, ((uint64_t)field << 3) | wire_type);
+}
+
+/**
+ * @fn void pb_write_len(pb_writer_t *writer, uint32_t field, const void *data, size_t len)
+ * @brief Append a complete length-delimited field (key, length and value)
+ *
+ * @param writer Writer to append to
+ * @param field Field number
+ * @param data Field value
+ * @param len Length of the value
+ *
+ * @return void
+ */
+void pb_write_len(pb_writer_t* writer, uint32_t field, void const* data, size_t len) {
+    pb_write_tag(writer, field, PB_WIRE_LEN);
+    pb_write_varint(writer, len);
+    if (writer->overflow || len > writer->size - writer->len) {
+        writer->overflow = true;
+        return;
+    }
+    memcpy(writer->buf + writer->len, data, len);
+    writer->len += len;
+}
@@ -0,0 +1,427 @@
+/**
+ * @file deserializer_bench.c
+ * @brief Host benchmark of the deserializer core hot paths
+ *
+ * Encodes a set of realistic Payload mixes once, then measures throughput
+ * (messages/sec) and cost per message (ns/message) of each stage of the
+ * pipeline on the workstation:
+ * - pipeline: framing + decoding + JSON rendering, fed in UART FIFO sized chunks
+ * - pipeline batch: same, with up to BATCH_SIZE messages per Batch frame
+ * - pipeline delta: same, with DeltaBatch frames (delta-encoded timestamps)
+ * - pipeline binary: same as pipeline, writing binary records instead of JSON
+ * - pipeline timed: same as pipeline, timing every stage into histograms, to
+ *   show the cost of the instrumentation
+ * Pipeline stages also report the wire bytes per message of their stream.
+ * - view decode: specialized payload_view_decode() alone
+ * - protobuf-c unpack: generic payload__unpack() + free, when protobuf-c is installed
+ * - json render: json_write_payload() alone
+ * - binary record: binary_record_write() alone
+ * - frame ring: frame_ring push, peek and release of every message, in one thread
+ * - frame ring 2 thr: the same with a producer and a consumer thread, as between the
+ *   firmware RX and decode tasks; also reports the ring high-water marks
+ *
+ * Usage: deserializer_bench [messages per mix]
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "binary_record.h"
+#include "deserializer.h"
+#include "frame_protocol.h"
+#include "frame_ring.h"
+#include "json_writer.h"
+#include "payload_decoder.h"
+#include "pb_wire.h"
+#ifdef HAVE_PROTOBUF_C
+#include "message.pb-c.h"
+#endif
+
+#define DEFAULT_MESSAGES 20000
+#define FRAME_SIZE 4096
+#define FIFO_CHUNK 120  // Bytes delivered per UART_DATA event at the default FIFO threshold
+#define MIN_RUN_NS 200000000ULL  // Repeat each measurement for at least 0.2 s
+#define BATCH_SIZE 8  // Messages per frame in the batched stream
+#define BATCH_FRAME_SIZE 256  // Batches are cut to fit the firmware frame buffer
+#define RING_SIZE 2048  // Default CONFIG_DESERIALIZER_PIPELINE_FRAME_BUFFER
+
+typedef struct {
+    char const* name;
+    size_t min_len;
+    size_t max_len;
+    char const* alphabet;
+} payload_mix_t;
+
+typedef struct {
+    uint8_t* stream;       // All messages, one length-prefixed frame each, back-to-back
+    size_t stream_len;
+    uint8_t* batched;      // The same messages grouped into length-prefixed Batch frames
+    size_t batched_len;
+    uint8_t* delta;        // The same messages grouped into length-prefixed DeltaBatch frames
+    size_t delta_len;
+    uint8_t const** msgs;  // Start of each encoded message inside stream
+    size_t* msg_lens;
+    payload_view_t* views;  // Decoded messages, used to render JSON on its own
+    size_t count;
+} encoded_set_t;
+
+static payload_mix_t const mixes[] = {
+    { "short", 4, 16, "abcdefghijklmnopqrstuvwxyz0123456789 " },
+    { "telemetry", 40, 90, "temp=23.5;hum=41;volt=3.30;id=node-07;status=ok " },
+    { "long", 180, 240, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789" },
+    { "escaped", 20, 60, "ab\"c\\d\n\te\x01/f" },
+};
+
+static char json_buffer[JSON_PAYLOAD_MAX_LEN(FRAME_SIZE)];
+static uint8_t frame_buffer[FRAME_SIZE];
+static volatile size_t sink;  // Keeps results observable so nothing is optimized away
+static _Alignas(4) uint8_t ring_buffer[RING_SIZE];
+static frame_ring_t ring;
+static latency_hist_t stage_hists[DESERIALIZER_STAGE_COUNT];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static size_t encode_payload(uint8_t* out, size_t size, uint32_t timestamp, char const* data,
+        size_t len) {
+    pb_writer_t writer;
+    pb_writer_init(&writer, out, size);
+    if (timestamp != 0) {
+        pb_write_tag(&writer, PAYLOAD_FIELD_TIMESTAMP, PB_WIRE_VARINT);
+        pb_write_varint(&writer, timestamp);
+    }
+    if (len != 0) {
+        pb_write_len(&writer, PAYLOAD_FIELD_DATA, data, len);
+    }
+    return writer.overflow ? 0 : writer.len;
+}
+
+static size_t append_frame(uint8_t* out, size_t size, frame_type_t type, uint8_t const* msg,
+        size_t len) {
+    pb_writer_t writer;
+    pb_writer_init(&writer, out, size);
+    pb_write_varint(&writer, len + 1);
+    if (writer.overflow || size - writer.len < len + 1) {
+        fprintf(stderr, "Stream buffer too small\n");
+        exit(1);
+    }
+    out[writer.len] = type;
+    memcpy(out + writer.len + 1, msg, len);
+    return writer.len + 1 + len;
+}
+
+static void build_batches(encoded_set_t* set, size_t capacity) {
+    uint8_t batch[BATCH_FRAME_SIZE];
+    pb_writer_t writer;
+
+    set->batched_len = 0;
+    pb_writer_init(&writer, batch, sizeof(batch) - 1);
+    size_t entries = 0;
+    for (size_t i = 0; i <= set->count; i++) {
+        if (i < set->count) {
+            pb_writer_t next = writer;
+            pb_write_len(&next, BATCH_FIELD_PAYLOADS, set->msgs[i], set->msg_lens[i]);
+            if (!next.overflow && entries < BATCH_SIZE) {
+                writer = next;
+                entries++;
+                continue;
+            }
+        }
+        if (entries > 0) {
+            set->batched_len += append_frame(set->batched + set->batched_len,
+                    capacity - set->batched_len, FRAME_TYPE_BATCH, batch, writer.len);
+        }
+        if (i < set->count) {
+            pb_writer_init(&writer, batch, sizeof(batch) - 1);
+            pb_write_len(&writer, BATCH_FIELD_PAYLOADS, set->msgs[i], set->msg_lens[i]);
+            entries = 1;
+        }
+    }
+}
+
+static size_t encode_delta_batch(encoded_set_t const* set, size_t first, size_t count,
+        uint8_t* out, size_t size) {
+    uint8_t packed[BATCH_SIZE * PB_VARINT_MAX_BYTES];
+    pb_writer_t deltas;
+    pb_writer_t writer;
+
+    pb_writer_init(&deltas, packed, sizeof(packed));
+    uint32_t previous = set->views[first].timestamp;
+    for (size_t i = first; i < first + count; i++) {
+        pb_write_varint(&deltas, pb_zigzag_encode32((int32_t)(set->views[i].timestamp - previous)));
+        previous = set->views[i].timestamp;
+    }
+
+    pb_writer_init(&writer, out, size);
+    pb_write_tag(&writer, DELTA_BATCH_FIELD_BASE_TIMESTAMP, PB_WIRE_VARINT);
+    pb_write_varint(&writer, set->views[first].timestamp);
+    pb_write_len(&writer, DELTA_BATCH_FIELD_TIMESTAMP_DELTAS, packed, deltas.len);
+    for (size_t i = first; i < first + count; i++) {
+        pb_write_len(&writer, DELTA_BATCH_FIELD_DATA, set->views[i].data, set->views[i].data_len);
+    }
+    return writer.overflow ? 0 : writer.len;
+}
+
+static void build_delta_batches(encoded_set_t* set, size_t capacity) {
+    uint8_t batch[BATCH_FRAME_SIZE];
+
+    set->delta_len = 0;
+    for (size_t first = 0; first < set->count;) {
+        size_t count = set->count - first < BATCH_SIZE ? set->count - first : BATCH_SIZE;
+        size_t len;
+        while ((len = encode_delta_batch(set, first, count, batch, sizeof(batch) - 1)) == 0) {
+            count--;
+        }
+        set->delta_len += append_frame(set->delta + set->delta_len, capacity - set->delta_len,
+                FRAME_TYPE_DELTA_BATCH, batch, len);
+        first += count;
+    }
+}
+
+static void build_set(encoded_set_t* set, payload_mix_t const* mix, size_t count) {
+    size_t alphabet_len = strlen(mix->alphabet);
+    size_t capacity = count * (mix->max_len + 16);
+    char data[FRAME_SIZE];
+
+    set->stream = malloc(capacity);
+    set->batched = malloc(capacity);
+    set->delta = malloc(capacity);
+    set->msgs = malloc(count * sizeof(*set->msgs));
+    set->msg_lens = malloc(count * sizeof(*set->msg_lens));
+    set->views = malloc(count * sizeof(*set->views));
+    if (set->stream == NULL || set->batched == NULL || set->delta == NULL || set->msgs == NULL
+            || set->msg_lens == NULL || set->views == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(1);
+    }
+    set->stream_len = 0;
+    set->count = count;
+
+    srand(42);
+    for (size_t i = 0; i < count; i++) {
+        size_t len = mix->min_len + (size_t)rand() % (mix->max_len - mix->min_len + 1);
+        for (size_t j = 0; j < len; j++) {
+            data[j] = mix->alphabet[(size_t)rand() % alphabet_len];
+        }
+
+        uint8_t encoded[FRAME_SIZE];
+        size_t encoded_len = encode_payload(encoded, sizeof(encoded), 1758894299 + (uint32_t)i,
+                data, len);
+        size_t frame_len = append_frame(set->stream + set->stream_len, capacity - set->stream_len,
+                FRAME_TYPE_PAYLOAD, encoded, encoded_len);
+        set->stream_len += frame_len;
+        set->msgs[i] = set->stream + set->stream_len - encoded_len;
+        set->msg_lens[i] = encoded_len;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        payload_view_decode(set->msgs[i], set->msg_lens[i], &set->views[i]);
+    }
+    build_batches(set, capacity);
+    build_delta_batches(set, capacity);
+}
+
+static void free_set(encoded_set_t* set) {
+    free(set->stream);
+    free(set->batched);
+    free(set->delta);
+    free(set->msgs);
+    free(set->msg_lens);
+    free(set->views);
+}
+
+static void count_payload(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+    sink += json_len;
+}
+
+static uint32_t now_us(void* ctx) { return (uint32_t)(now_ns() / 1000); }
+
+static void run_stream(encoded_set_t const* set, uint8_t const* stream, size_t stream_len,
+        deserializer_output_t output, latency_hist_t* hists) {
+    deserializer_t des;
+    deserializer_config_t config = {
+        .framing = DESERIALIZER_FRAMING_LENGTH_PREFIX,
+        .output = output,
+        .frame_buf = frame_buffer,
+        .frame_size = sizeof(frame_buffer),
+        .json_buf = json_buffer,
+        .json_size = sizeof(json_buffer),
+        .stage_hists = hists,
+        .callbacks = { .on_payload = count_payload, .now_us = now_us },
+    };
+    deserializer_init(&des, &config);
+    for (size_t pos = 0; pos < stream_len; pos += FIFO_CHUNK) {
+        size_t chunk = stream_len - pos < FIFO_CHUNK ? stream_len - pos : FIFO_CHUNK;
+        deserializer_feed(&des, stream + pos, chunk);
+    }
+    if (des.stats.payloads != set->count) {
+        fprintf(stderr, "Pipeline decoded %u of %zu messages\n", des.stats.payloads, set->count);
+        exit(1);
+    }
+}
+
+static void run_pipeline(encoded_set_t const* set) {
+    run_stream(set, set->stream, set->stream_len, DESERIALIZER_OUTPUT_JSON, NULL);
+}
+
+static void run_pipeline_batch(encoded_set_t const* set) {
+    run_stream(set, set->batched, set->batched_len, DESERIALIZER_OUTPUT_JSON, NULL);
+}
+
+static void run_pipeline_delta(encoded_set_t const* set) {
+    run_stream(set, set->delta, set->delta_len, DESERIALIZER_OUTPUT_JSON, NULL);
+}
+
+static void run_pipeline_binary(encoded_set_t const* set) {
+    run_stream(set, set->stream, set->stream_len, DESERIALIZER_OUTPUT_BINARY, NULL);
+}
+
+static void run_pipeline_timed(encoded_set_t const* set) {
+    run_stream(set, set->stream, set->stream_len, DESERIALIZER_OUTPUT_JSON, stage_hists);
+}
+
+static void run_view_decode(encoded_set_t const* set) {
+    payload_view_t view;
+    for (size_t i = 0; i < set->count; i++) {
+        payload_view_decode(set->msgs[i], set->msg_lens[i], &view);
+        sink += view.data_len;
+    }
+}
+
+#ifdef HAVE_PROTOBUF_C
+static void run_protobuf_c_unpack(encoded_set_t const* set) {
+    for (size_t i = 0; i < set->count; i++) {
+        Payload* payload = payload__unpack(NULL, set->msg_lens[i], set->msgs[i]);
+        sink += payload->timestamp;
+        payload__free_unpacked(payload, NULL);
+    }
+}
+#endif
+
+static void run_json_render(encoded_set_t const* set) {
+    for (size_t i = 0; i < set->count; i++) {
+        payload_view_t const* view = &set->views[i];
+        sink += json_write_payload(json_buffer, sizeof(json_buffer), view->timestamp, view->data,
+                view->data_len);
+    }
+}
+
+static void run_binary_record(encoded_set_t const* set) {
+    for (size_t i = 0; i < set->count; i++) {
+        payload_view_t const* view = &set->views[i];
+        sink += binary_record_write((uint8_t*)json_buffer, sizeof(json_buffer), view->timestamp,
+                view->data, view->data_len);
+    }
+}
+
+static void pop_frame(encoded_set_t const* set, size_t i) {
+    uint8_t const* frame;
+    size_t len;
+    while (!frame_ring_peek(&ring, &frame, &len)) {
+        sched_yield();
+    }
+    if (len != set->msg_lens[i] || frame[0] != set->msgs[i][0]) {
+        fprintf(stderr, "Frame ring returned message %zu out of order\n", i);
+        exit(1);
+    }
+    sink += len;
+    frame_ring_release(&ring);
+}
+
+static void run_frame_ring(encoded_set_t const* set) {
+    frame_ring_init(&ring, ring_buffer, sizeof(ring_buffer));
+    for (size_t i = 0; i < set->count; i++) {
+        frame_ring_push(&ring, set->msgs[i], set->msg_lens[i]);
+        pop_frame(set, i);
+    }
+}
+
+static void* produce_frames(void* arg) {
+    encoded_set_t const* set = arg;
+    for (size_t i = 0; i < set->count; i++) {
+        while (!frame_ring_push(&ring, set->msgs[i], set->msg_lens[i])) {
+            sched_yield();  // Full: the firmware RX task drops the frame instead
+        }
+    }
+    return NULL;
+}
+
+static void run_frame_ring_threads(encoded_set_t const* set) {
+    pthread_t producer;
+    frame_ring_init(&ring, ring_buffer, sizeof(ring_buffer));
+    if (pthread_create(&producer, NULL, produce_frames, (void*)set) != 0) {
+        fprintf(stderr, "Failed to start the producer thread\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < set->count; i++) {
+        pop_frame(set, i);
+    }
+    pthread_join(producer, NULL);
+}
+
+static void measure(char const* mix, char const* stage, encoded_set_t const* set,
+        void (*run)(encoded_set_t const*), size_t stream_len) {
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    size_t messages = 0;
+
+    do {
+        run(set);
+        messages += set->count;
+        elapsed = now_ns() - start;
+    } while (elapsed < MIN_RUN_NS);
+
+    double ns_per_msg = (double)elapsed / (double)messages;
+    printf("%-10s %-18s %14.0f %10.1f", mix, stage, 1e9 / ns_per_msg, ns_per_msg);
+    if (stream_len != 0) {
+        printf(" %11.1f", (double)stream_len / (double)set->count);
+    }
+    putchar('\n');
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_MESSAGES;
+    if (count == 0) {
+        fprintf(stderr, "Usage: %s [messages per mix]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%-10s %-18s %14s %10s %11s\n", "mix", "stage", "msgs/s", "ns/msg", "wire B/msg");
+    for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+        encoded_set_t set;
+        build_set(&set, &mixes[m], count);
+        measure(mixes[m].name, "pipeline", &set, run_pipeline, set.stream_len);
+        measure(mixes[m].name, "pipeline batch", &set, run_pipeline_batch, set.batched_len);
+        measure(mixes[m].name, "pipeline delta", &set, run_pipeline_delta, set.delta_len);
+        measure(mixes[m].name, "pipeline binary", &set, run_pipeline_binary, set.stream_len);
+        measure(mixes[m].name, "pipeline timed", &set, run_pipeline_timed, set.stream_len);
+        measure(mixes[m].name, "view decode", &set, run_view_decode, 0);
+#ifdef HAVE_PROTOBUF_C
+        measure(mixes[m].name, "protobuf-c unpack", &set, run_protobuf_c_unpack, 0);
+#endif
+        measure(mixes[m].name, "json render", &set, run_json_render, 0);
+        measure(mixes[m].name, "binary record", &set, run_binary_record, 0);
+        measure(mixes[m].name, "frame ring", &set, run_frame_ring, 0);
+        measure(mixes[m].name, "frame ring 2 thr", &set, run_frame_ring_threads, 0);
+        printf("%-10s %-18s high water %zu of %d bytes, %u frames, %u pushes refused\n", "",
+                "", ring.stats.high_water, RING_SIZE, ring.stats.high_water_frames,
+                ring.stats.full);
+        free_set(&set);
+    }
+#ifndef HAVE_PROTOBUF_C
+    printf("(protobuf-c not found, generic payload__unpack not measured)\n");
+#endif
+
+    return sink == 0;
+}
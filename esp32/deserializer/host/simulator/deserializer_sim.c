@@ -0,0 +1,1086 @@
+/**
+ * @file deserializer_sim.c
+ * @brief Pseudo-terminal simulator of the ESP32 deserializer
+ *
+ * Runs the host build of the deserializer pipeline behind a pseudo-terminal
+ * pair. The slave side behaves like the board's serial port: serializer.py (or
+ * any other sender) can open it with pyserial, and every decoded message is
+ * printed in the same format the firmware logs it. Acknowledgements of
+ * sequenced frames are written back to the sender through the pty, like the
+ * firmware sends them on its UART TX line.
+ *
+ * The pty itself has no notion of baud rate, so when --baud is given the
+ * simulator paces its reads to the time the bytes would take on a real 8N1 UART
+ * link. Writers then block once the pty buffer is full, as they would on a
+ * saturated serial port.
+ *
+ * Like the UART driver, a reader thread moves the received bytes into an RX
+ * buffer (--rx-buffer bytes, 256 on the firmware) whatever the decoding side is
+ * doing; when it is full the buffer overflows and the decoding side flushes it,
+ * as uart_task does on UART_BUFFER_FULL. --log-baud makes every log line take as
+ * long as on the firmware console, the usual reason decoding falls behind, and
+ * --credits advertises the free buffer space to the sender, like the firmware
+ * with credit-based flow control enabled. With --rtscts the reader stops
+ * reading the pty while the buffer has no room for another FIFO chunk, as RTS
+ * does, so the sender blocks in write() instead of losing data. --drop-every
+ * forces an overflow every N reads, to exercise the retransmissions of
+ * acknowledged senders, and --corrupt-every flips a bit in every Nth byte
+ * received, for --crc to catch: frames and replies then end with a CRC-32, as
+ * with CONFIG_DESERIALIZER_FRAME_CRC.
+ *
+ * --async-log logs from a thread of its own, as CONFIG_DESERIALIZER_ASYNC_LOG
+ * makes the firmware do: the decoding side copies every rendering into a ring
+ * of that many bytes without waiting, and the renderings that find it full are
+ * counted and reported in a "Dropped N log record(s)" line instead.
+ *
+ * --binary writes the binary record of every message (see binary_record.h)
+ * instead of logging its JSON rendering, as CONFIG_DESERIALIZER_OUTPUT_BINARY
+ * makes the firmware do. With --timestamps a record is preceded by the time
+ * like a log line, but not followed by a newline: its length delimits it.
+ *
+ * --stages times every stage into histograms, as CONFIG_DESERIALIZER_STAGE_STATS
+ * makes the firmware do: the wait for received bytes, their copy out of the RX
+ * buffer, decoding, rendering, output and, with --async-log, the log write. The
+ * percentiles are printed to stderr on exit, leaving stdout to the log.
+ *
+ * STATS frames are answered with a Stats reply like on the firmware, holding the
+ * RX buffer overflows and high-water mark, the --async-log ring high-water mark
+ * and, with --stages, the stage histograms; the simulator has no frame queue
+ * and no heap figure to report.
+ *
+ * Messages longer than the frame buffer and up to --max-message bytes are
+ * streamed like on the firmware: their JSON rendering is logged piece by piece
+ * as it is decoded. Chunked transfers of up to --max-message bytes of data are
+ * reassembled in the same pool of buffers as on the firmware, and compressed
+ * frames are decompressed into a buffer of the firmware's default size, with
+ * the same built-in dictionary.
+ *
+ * BaudSwitch frames change the pacing rate like they change the firmware's UART
+ * rate, and a rate not confirmed in time is undone the same way. The pty
+ * carries any rate, so --max-baud corrupts the bytes received faster than the
+ * given rate, like wiring that cannot carry them, for the sender's probes to
+ * detect.
+ *
+ * The rate the sender set on the pty slave stands for the rate of its signal:
+ * while it differs from the pacing rate, the bytes received are garbled, as
+ * they would be sampled at the wrong rate, long low stretches of the line
+ * reading as zero bytes. After --autobaud bad frames in a
+ * row the simulator measures it, as the firmware does with its UART auto-baud
+ * counters, and switches to it.
+ *
+ * Usage: deserializer_sim [--baud RATE] [--framing length|cobs] [--frame-size BYTES]
+ *                         [--max-message BYTES] [--link PATH] [--timestamps]
+ *                         [--drop-every N] [--rx-buffer BYTES] [--log-baud RATE]
+ *                         [--credits] [--rtscts] [--max-baud RATE]
+ *                         [--autobaud N] [--crc] [--corrupt-every N] [--async-log BYTES]
+ *                         [--binary] [--stages]
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "deserializer.h"
+#include "frame_ring.h"
+#include "json_writer.h"
+
+#define READ_SIZE 256
+#define RX_FIFO_THRESHOLD 120  // Driver default: a paced UART delivers data in such chunks
+#define BITS_PER_BYTE 10  // 8N1: start bit, 8 data bits, stop bit
+#define RX_BUFFER_DEFAULT 65536  // Large enough never to overflow unless decoding stalls
+#define POLL_INTERVAL_MS 100     // Also the interval between idle Credit frames, as the firmware
+#define MAX_MESSAGE_DEFAULT 4096  // Default CONFIG_DESERIALIZER_MAX_MESSAGE_SIZE
+#define CHUNK_SLOTS 2            // Default CONFIG_DESERIALIZER_CHUNK_SLOTS
+#define CHUNK_TIMEOUT_MS 1000    // Default CONFIG_DESERIALIZER_CHUNK_TIMEOUT_MS
+#define DECOMPRESS_SIZE 1024     // Default CONFIG_DESERIALIZER_COMPRESSION_BUFFER
+#define MAX_BAUD_RATE 921600     // Default CONFIG_DESERIALIZER_MAX_BAUD_RATE
+#define BAUD_TIMEOUT_MS 1000     // Default CONFIG_DESERIALIZER_BAUD_TIMEOUT_MS
+#define CORRUPT_EVERY 8          // Bytes received above --max-baud, one of which is corrupted
+#define GARBLE_ZERO_EVERY 4      // Bytes received at the wrong rate, one of which reads as 0
+#define AUTOBAUD_ERRORS 3        // Default CONFIG_DESERIALIZER_AUTOBAUD_ERRORS
+
+typedef struct {
+    long baud_rate;
+    deserializer_framing_t framing;
+    size_t frame_size;
+    size_t max_message;
+    char const* link;
+    int timestamps;
+    unsigned long drop_every;
+    size_t rx_buffer;
+    long log_baud;
+    int credits;
+    int rtscts;
+    long max_baud;
+    unsigned long autobaud;
+    int crc;
+    unsigned long corrupt_every;
+    size_t async_log;
+    int binary;
+    int stages;
+} sim_options_t;
+
+// Emulated UART driver RX ring buffer, filled by the reader thread
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_cond_t space;  // Signaled when data is taken out, for --rtscts
+    uint8_t* buf;
+    size_t size;    // Capacity of buf
+    size_t head;    // Offset of the oldest buffered byte
+    size_t len;     // Buffered bytes
+    size_t lost;    // Bytes discarded since the last flush
+    size_t high_water;  // Most bytes ever buffered
+    bool overflow;  // The buffer overflowed and must be flushed
+    bool closed;    // The reader thread stopped
+} rx_buffer_t;
+
+// --async-log records, as the output ring buffer items of the firmware
+typedef enum {
+    LOG_PAYLOAD,  // value: Payload length, followed by the NUL-terminated JSON rendering
+    LOG_CHUNK,    // value: Payload length on the last piece, 0 before, followed by the piece
+    LOG_ERROR,    // value: deserializer_error_t
+    LOG_DROPPED,  // value: records dropped because the ring was full
+} log_kind_t;
+
+typedef struct {
+    uint32_t kind;
+    uint32_t value;
+} log_record_t;  // Header of every record
+
+// Ring of records from the decoding side (producer) to the log thread (consumer)
+typedef struct {
+    frame_ring_t ring;
+    pthread_mutex_t lock;  // Only for the log thread to wait for records
+    pthread_cond_t ready;
+    bool closed;              // No more records will be queued
+    uint32_t pending_drops;   // Records dropped since the last LOG_DROPPED (producer only)
+    uint32_t dropped;         // Records dropped in total (producer only)
+    bool chunk_dropped;       // A piece of the current rendering was dropped, so is the rest
+} log_queue_t;
+
+static char const* TAG = "Deserializer";
+static volatile sig_atomic_t running = 1;
+static uint64_t start_ns;
+static int print_timestamps;
+static int pty_master = -1;
+static int pty_slave = -1;
+static uint64_t log_byte_ns;  // Console time per logged byte, 0 when not emulated
+static rx_buffer_t rx;
+static atomic_long line_baud;  // Current pacing rate, changed by BaudSwitch frames
+static bool json_line_open;   // A streamed rendering or record is being logged
+static size_t json_line_len;  // Characters of the streamed rendering logged so far
+static bool binary_output;    // --binary, records are written instead of renderings
+static log_queue_t log_queue;  // With --async-log
+static latency_hist_t stage_hists[DESERIALIZER_STAGE_COUNT];  // With --stages
+static bool time_stages;
+static uint32_t overflows;  // RX buffer overflows flushed by the decoding side
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until_ns(uint64_t deadline) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(deadline / 1000000000ULL),
+        .tv_nsec = (long)(deadline % 1000000000ULL),
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && running) { }
+}
+
+static uint32_t now_us(void* ctx) { return (uint32_t)(now_ns() / 1000ULL); }
+
+/**
+ * @brief With --stages, count the time since start in the histogram of a stage
+ */
+static void end_stage(deserializer_stage_t stage, uint32_t start) {
+    if (time_stages) {
+        latency_hist_add(&stage_hists[stage], now_us(NULL) - start);
+    }
+}
+
+/**
+ * @brief Print the percentiles of every stage timed so far to stderr, as the firmware logs them
+ */
+static void print_stage_stats(void) {
+    for (int stage = 0; stage < DESERIALIZER_STAGE_COUNT; stage++) {
+        latency_hist_t const* hist = &stage_hists[stage];
+        if (hist->samples == 0) {
+            continue;
+        }
+        fprintf(stderr,
+                "Stage %-6s %" PRIu32 " samples, mean %" PRIu32 " us, p50 <= %" PRIu32
+                " us, p90 <= %" PRIu32 " us, p99 <= %" PRIu32 " us, max %" PRIu32 " us\n",
+                deserializer_stage_name(stage), hist->samples, latency_hist_mean(hist),
+                latency_hist_percentile(hist, 50), latency_hist_percentile(hist, 90),
+                latency_hist_percentile(hist, 99), hist->max_us);
+    }
+}
+
+/**
+ * @brief Fill in the counters of a Stats reply kept outside the pipeline, as the firmware does
+ */
+static void fill_device_stats(void* ctx, deserializer_device_stats_t* device) {
+    device->uptime_ms = (uint32_t)((now_ns() - start_ns) / 1000000ULL);
+    device->overflows = overflows;
+    device->log_dropped = log_queue.dropped;
+    device->output_queue_high_water = (uint32_t)log_queue.ring.stats.high_water;
+    pthread_mutex_lock(&rx.lock);
+    device->rx_high_water = (uint32_t)rx.high_water;
+    pthread_mutex_unlock(&rx.lock);
+}
+
+/**
+ * @brief Print the start of a line in the ESP-IDF log format used by the firmware
+ *
+ * With --timestamps every line is prefixed with the CLOCK_MONOTONIC time in
+ * nanoseconds, so a driver on the same machine can compute exact latencies.
+ *
+ * @return Number of characters the firmware would send on the console
+ */
+static int log_prefix(char level) {
+    uint64_t now = now_ns();
+
+    if (print_timestamps) {
+        printf("%llu ", (unsigned long long)now);
+    }
+    return printf("%c (%llu) %s: ", level, (unsigned long long)((now - start_ns) / 1000000ULL),
+            TAG);
+}
+
+/**
+ * @brief With --log-baud, take as long as sending len characters on the console
+ */
+static void pace_console(size_t len) {
+    if (log_byte_ns > 0) {
+        fflush(stdout);
+        sleep_until_ns(now_ns() + (uint64_t)len * log_byte_ns);
+    }
+}
+
+/**
+ * @brief Print one line in the ESP-IDF log format used by the firmware
+ */
+static void log_line(char level, char const* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void log_line(char level, char const* fmt, ...) {
+    va_list args;
+    flockfile(stdout);  // Whole lines, with --async-log two threads log
+    int len = log_prefix(level);
+
+    va_start(args, fmt);
+    len += vprintf(fmt, args);
+    va_end(args);
+    putchar('\n');
+    pace_console((size_t)len + 1);
+    funlockfile(stdout);
+}
+
+static void show_payload_as_json(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+    log_line('I', "Received payload of length %zu bytes", payload_len);
+    log_line('I', "JSON payload created: %s", json);
+    log_line('I', "JSON payload length: %zu bytes", json_len);
+    fflush(stdout);
+}
+
+/**
+ * @brief Log the pieces of a streamed rendering on one line, as the firmware does
+ */
+static void show_payload_chunk(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+    size_t len = json_len;
+
+    flockfile(stdout);
+    if (!json_line_open) {
+        json_line_open = true;
+        json_line_len = 0;
+        len += (size_t)log_prefix('I') + (size_t)printf("JSON payload created: ");
+    }
+    fwrite(json, 1, json_len, stdout);
+    json_line_len += json_len;
+    if (payload_len != 0) {
+        json_line_open = false;
+        putchar('\n');
+        len++;
+    }
+    pace_console(len);
+    if (payload_len != 0) {
+        log_line('I', "Received payload of length %zu bytes", payload_len);
+        log_line('I', "JSON payload length: %zu bytes", json_line_len);
+        fflush(stdout);
+    }
+    funlockfile(stdout);
+}
+
+/**
+ * @brief Write a binary record, or the next piece of a streamed one, in place of a rendering
+ */
+static void show_record(void* ctx, size_t payload_len, char const* record, size_t len) {
+    flockfile(stdout);
+    if (!json_line_open && print_timestamps) {
+        printf("%llu ", (unsigned long long)now_ns());
+    }
+    json_line_open = payload_len == 0;
+    fwrite(record, 1, len, stdout);
+    pace_console(len);
+    if (payload_len != 0) {
+        fflush(stdout);
+    }
+    funlockfile(stdout);
+}
+
+/**
+ * @brief End the line of a streamed rendering cut short
+ *
+ * A record cut short was already padded to its length, so it needs no newline.
+ */
+static void close_json_line(void) {
+    if (json_line_open) {
+        json_line_open = false;
+        if (!binary_output) {
+            putchar('\n');
+        }
+    }
+}
+
+static void log_deserializer_error(void* ctx, deserializer_error_t error) {
+    sim_options_t const* opts = ctx;
+    close_json_line();
+    switch (error) {
+    case DESERIALIZER_ERROR_UNPACK:
+        log_line('E', "Failed to unpack payload");
+        break;
+    case DESERIALIZER_ERROR_JSON:
+        log_line('E', "Failed to print JSON");
+        break;
+    case DESERIALIZER_ERROR_OVERSIZED:
+        log_line('E', "Discarded 1 frame(s) larger than %zu bytes",
+                opts->max_message > opts->frame_size ? opts->max_message : opts->frame_size);
+        break;
+    case DESERIALIZER_ERROR_FRAMING:
+        log_line('E', "Invalid frame");
+        break;
+    case DESERIALIZER_ERROR_TRANSFER:
+        log_line('E', "Dropped incomplete chunked transfer");
+        break;
+    case DESERIALIZER_ERROR_DICTIONARY:
+        log_line('E', "Compressed with an unknown dictionary (expected version %d)",
+                LZSS_DICT_VERSION);
+        break;
+    case DESERIALIZER_ERROR_CRC:
+        log_line('E', "Frame failed its checksum");
+        break;
+    }
+    fflush(stdout);
+}
+
+/**
+ * @brief Append a record to the --async-log ring and wake the log thread
+ *
+ * @return false if the ring has no room for it
+ */
+static bool push_record(log_kind_t kind, uint32_t value, void const* data, size_t len) {
+    log_record_t const header = { .kind = kind, .value = value };
+    uint8_t* record = frame_ring_reserve(&log_queue.ring, sizeof(header) + len);
+
+    if (record == NULL) {
+        return false;
+    }
+    memcpy(record, &header, sizeof(header));
+    if (len > 0) {
+        memcpy(record + sizeof(header), data, len);
+    }
+    frame_ring_commit(&log_queue.ring, sizeof(header) + len);
+    pthread_mutex_lock(&log_queue.lock);
+    pthread_cond_signal(&log_queue.ready);
+    pthread_mutex_unlock(&log_queue.lock);
+    return true;
+}
+
+/**
+ * @brief Report the records dropped since the last report, if any, when there is room
+ *
+ * @return false if a report is still pending
+ */
+static bool report_dropped_records(void) {
+    if (log_queue.pending_drops != 0
+            && !push_record(LOG_DROPPED, log_queue.pending_drops, NULL, 0)) {
+        return false;
+    }
+    log_queue.pending_drops = 0;
+    return true;
+}
+
+/**
+ * @brief Queue a record for the log thread, or count it as dropped when the ring is full
+ *
+ * Records dropped before are reported first, so the log shows the gap where it
+ * happened; when even that report finds no room, this record is dropped too.
+ */
+static bool queue_record(log_kind_t kind, uint32_t value, void const* data, size_t len) {
+    if (report_dropped_records() && push_record(kind, value, data, len)) {
+        return true;
+    }
+    log_queue.pending_drops++;
+    log_queue.dropped++;
+    return false;
+}
+
+static void queue_payload(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+    queue_record(LOG_PAYLOAD, (uint32_t)payload_len, json, json_len + 1);
+}
+
+/**
+ * @brief Queue a piece of a streamed rendering, dropping the rest of it once a piece is
+ */
+static void queue_payload_chunk(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+    bool queued = !log_queue.chunk_dropped
+            && queue_record(LOG_CHUNK, (uint32_t)payload_len, json, json_len);
+    log_queue.chunk_dropped = !queued && payload_len == 0;
+}
+
+static void queue_error(void* ctx, deserializer_error_t error) {
+    log_queue.chunk_dropped = false;  // The error ends the rendering it interrupts
+    queue_record(LOG_ERROR, error, NULL, 0);
+}
+
+/**
+ * @brief Log thread of --async-log, the output task of the firmware
+ */
+static void* log_thread(void* arg) {
+    for (;;) {
+        uint8_t const* record;
+        size_t len;
+        bool queued;
+
+        pthread_mutex_lock(&log_queue.lock);
+        while (!(queued = frame_ring_peek(&log_queue.ring, &record, &len)) && !log_queue.closed) {
+            pthread_cond_wait(&log_queue.ready, &log_queue.lock);
+        }
+        pthread_mutex_unlock(&log_queue.lock);
+        if (!queued) {
+            return NULL;
+        }
+
+        log_record_t header;
+        memcpy(&header, record, sizeof(header));
+        char const* data = (char const*)record + sizeof(header);
+        size_t data_len = len - sizeof(header);
+        uint32_t start = now_us(NULL);
+        switch ((log_kind_t)header.kind) {
+        case LOG_PAYLOAD:
+            show_payload_as_json(arg, header.value, data, data_len - 1);
+            end_stage(DESERIALIZER_STAGE_LOG, start);
+            break;
+        case LOG_CHUNK:
+            if (binary_output) {
+                show_record(arg, header.value, data, data_len);
+            } else {
+                show_payload_chunk(arg, header.value, data, data_len);
+            }
+            end_stage(DESERIALIZER_STAGE_LOG, start);
+            break;
+        case LOG_ERROR:
+            log_deserializer_error(arg, (deserializer_error_t)header.value);
+            break;
+        case LOG_DROPPED:
+            close_json_line();
+            log_line('W', "Dropped %" PRIu32 " log record(s), the console fell behind",
+                    header.value);
+            fflush(stdout);
+            break;
+        }
+        frame_ring_release(&log_queue.ring);
+    }
+}
+
+static uint32_t now_ms(void* ctx) { return (uint32_t)(now_ns() / 1000000ULL); }
+
+/**
+ * @brief Baud rate the sender set on the pty slave, 0 if it is not a standard one
+ */
+static long sender_baud(void) {
+    static struct {
+        speed_t speed;
+        long rate;
+    } const speeds[] = { { B1200, 1200 }, { B2400, 2400 }, { B4800, 4800 }, { B9600, 9600 },
+        { B19200, 19200 }, { B38400, 38400 }, { B57600, 57600 }, { B115200, 115200 },
+        { B230400, 230400 }, { B460800, 460800 }, { B500000, 500000 }, { B921600, 921600 },
+        { B1000000, 1000000 }, { B1500000, 1500000 }, { B2000000, 2000000 },
+        { B2500000, 2500000 }, { B3000000, 3000000 } };
+    struct termios tio;
+
+    if (tcgetattr(pty_slave, &tio) != 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+        if (speeds[i].speed == cfgetospeed(&tio)) {
+            return speeds[i].rate;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Measure the sender's baud rate, as the firmware does on its RX line
+ */
+static uint32_t measure_baud_rate(void* ctx) {
+    long rate = sender_baud();
+    log_line('W', "Frames keep failing, measured %ld baud on RX", rate);
+    fflush(stdout);
+    return (uint32_t)rate;
+}
+
+/**
+ * @brief Pace reception to the rate a BaudSwitch frame selected or the sender uses, as the
+ *        firmware switches its UART
+ *
+ * Replies are written synchronously, so the echo has already left at the old rate.
+ */
+static bool set_baud_rate(void* ctx, uint32_t baud_rate) {
+    atomic_store(&line_baud, (long)baud_rate);
+    log_line('I', "Baud rate set to %" PRIu32, baud_rate);
+    fflush(stdout);
+    return true;
+}
+
+/**
+ * @brief Write an ACK, NACK or Credit back to the sender, who reads it from the pty slave
+ */
+static void write_reply(void* ctx, uint8_t const* data, size_t len) {
+    while (len > 0) {
+        ssize_t written = write(pty_master, data, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("write");
+            return;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+}
+
+static void stop(int signum) { running = 0; }
+
+static void usage(char const* prog) {
+    fprintf(stderr,
+            "Usage: %s [--baud RATE] [--framing length|cobs] [--frame-size BYTES]\n"
+            "          [--max-message BYTES] [--link PATH] [--timestamps] [--drop-every N]\n"
+            "          [--rx-buffer BYTES] [--log-baud RATE] [--credits] [--rtscts]\n"
+            "          [--max-baud RATE] [--autobaud N] [--crc] [--corrupt-every N]\n"
+            "          [--async-log BYTES] [--binary] [--stages]\n"
+            "  --baud RATE        pace reception to RATE baud (8N1), 0 = unpaced (default)\n"
+            "  --framing MODE     length (default) or cobs, must match the sender\n"
+            "  --frame-size BYTES frame buffer, largest frame decoded whole (default 256)\n"
+            "  --max-message BYTES largest accepted message, streamed when longer than the\n"
+            "                     frame buffer, and largest chunked transfer (default 4096)\n"
+            "  --link PATH        create a symlink to the pty slave at PATH\n"
+            "  --timestamps       prefix every log line with CLOCK_MONOTONIC nanoseconds\n"
+            "  --drop-every N     discard every Nth read, like a UART buffer overflow\n"
+            "  --rx-buffer BYTES  emulated driver RX buffer (default 65536, 256 on the firmware)\n"
+            "  --log-baud RATE    emulate a console at RATE baud, 0 = instant (default)\n"
+            "  --credits          advertise free RX buffer space (credit-based flow control)\n"
+            "  --rtscts           hold the sender back while the RX buffer is full\n"
+            "  --max-baud RATE    corrupt data received faster than RATE baud, 0 = never\n"
+            "  --autobaud N       follow the sender's rate after N bad frames (default 3)\n"
+            "  --crc              frames and replies end with a CRC-32, must match the sender\n"
+            "  --corrupt-every N  flip a bit in every Nth byte received, 0 = never (default)\n"
+            "  --async-log BYTES  log from a thread fed through a ring of BYTES, dropping\n"
+            "                     what does not fit, 0 = log while decoding (default)\n"
+            "  --binary           write binary records instead of JSON renderings\n"
+            "  --stages           time every stage, percentiles in Stats replies and on exit\n",
+            prog);
+}
+
+static int parse_options(int argc, char** argv, sim_options_t* opts) {
+    static struct option const long_opts[] = {
+        { "baud", required_argument, NULL, 'b' },
+        { "framing", required_argument, NULL, 'f' },
+        { "frame-size", required_argument, NULL, 's' },
+        { "max-message", required_argument, NULL, 'm' },
+        { "link", required_argument, NULL, 'l' },
+        { "timestamps", no_argument, NULL, 't' },
+        { "drop-every", required_argument, NULL, 'd' },
+        { "rx-buffer", required_argument, NULL, 'r' },
+        { "log-baud", required_argument, NULL, 'g' },
+        { "credits", no_argument, NULL, 'c' },
+        { "rtscts", no_argument, NULL, 'R' },
+        { "max-baud", required_argument, NULL, 'M' },
+        { "autobaud", required_argument, NULL, 'a' },
+        { "crc", no_argument, NULL, 'C' },
+        { "corrupt-every", required_argument, NULL, 'x' },
+        { "async-log", required_argument, NULL, 'L' },
+        { "binary", no_argument, NULL, 'B' },
+        { "stages", no_argument, NULL, 'S' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int opt;
+
+    *opts = (sim_options_t) {
+        .framing = DESERIALIZER_FRAMING_LENGTH_PREFIX,
+        .frame_size = 256,
+        .max_message = MAX_MESSAGE_DEFAULT,
+        .rx_buffer = RX_BUFFER_DEFAULT,
+        .autobaud = AUTOBAUD_ERRORS,
+    };
+    while ((opt = getopt_long(argc, argv, "b:f:s:m:l:td:r:g:cRM:a:Cx:L:BSh", long_opts, NULL))
+            != -1) {
+        switch (opt) {
+        case 'b':
+            opts->baud_rate = strtol(optarg, NULL, 10);
+            break;
+        case 'f':
+            if (strcmp(optarg, "cobs") == 0) {
+                opts->framing = DESERIALIZER_FRAMING_COBS;
+            } else if (strcmp(optarg, "length") == 0) {
+                opts->framing = DESERIALIZER_FRAMING_LENGTH_PREFIX;
+            } else {
+                return -1;
+            }
+            break;
+        case 's':
+            opts->frame_size = strtoul(optarg, NULL, 10);
+            break;
+        case 'm':
+            opts->max_message = strtoul(optarg, NULL, 10);
+            break;
+        case 'l':
+            opts->link = optarg;
+            break;
+        case 't':
+            opts->timestamps = 1;
+            break;
+        case 'd':
+            opts->drop_every = strtoul(optarg, NULL, 10);
+            break;
+        case 'r':
+            opts->rx_buffer = strtoul(optarg, NULL, 10);
+            break;
+        case 'g':
+            opts->log_baud = strtol(optarg, NULL, 10);
+            break;
+        case 'c':
+            opts->credits = 1;
+            break;
+        case 'R':
+            opts->rtscts = 1;
+            break;
+        case 'M':
+            opts->max_baud = strtol(optarg, NULL, 10);
+            break;
+        case 'a':
+            opts->autobaud = strtoul(optarg, NULL, 10);
+            break;
+        case 'C':
+            opts->crc = 1;
+            break;
+        case 'x':
+            opts->corrupt_every = strtoul(optarg, NULL, 10);
+            break;
+        case 'L':
+            opts->async_log = strtoul(optarg, NULL, 10) & ~(size_t)3;  // frame_ring size
+            break;
+        case 'B':
+            opts->binary = 1;
+            break;
+        case 'S':
+            opts->stages = 1;
+            break;
+        default:
+            return -1;
+        }
+    }
+    return opts->baud_rate < 0 || opts->log_baud < 0 || opts->max_baud < 0 || opts->frame_size == 0
+                    || opts->rx_buffer < READ_SIZE
+            ? -1
+            : 0;
+}
+
+/**
+ * @brief Emulated UART receiver: paced reads from the pty into the RX buffer
+ *
+ * Runs independently of decoding, as the UART interrupt and driver do, so
+ * bytes keep arriving while the decoding side is busy logging. Bytes that do
+ * not fit in the buffer are lost and flag an overflow, unless --rtscts keeps
+ * them waiting in the pty until there is room. Above --max-baud, one byte in
+ * CORRUPT_EVERY has a bit flipped, and bytes sent at another rate than the
+ * pacing rate are all garbled, one in GARBLE_ZERO_EVERY reading as zero.
+ * --corrupt-every flips a bit in one byte in N whatever the rate.
+ */
+static void* rx_thread(void* arg) {
+    sim_options_t const* opts = arg;
+    uint8_t data[READ_SIZE];
+    unsigned long reads = 0;
+    unsigned long corrupt = 0;
+    unsigned long received = 0;
+    struct pollfd pfd = { .fd = pty_master, .events = POLLIN };
+
+    // Time at which the byte currently on the emulated wire has been fully received
+    uint64_t wire_ns = now_ns();
+    while (running) {
+        long baud = atomic_load(&line_baud);
+        size_t read_size = baud > 0 ? RX_FIFO_THRESHOLD : sizeof(data);
+        if (opts->rtscts) {
+            // RTS deasserted: leave the bytes in the pty until a full FIFO chunk fits
+            pthread_mutex_lock(&rx.lock);
+            while (running && rx.size - rx.len < read_size) {
+                pthread_cond_wait(&rx.space, &rx.lock);
+            }
+            pthread_mutex_unlock(&rx.lock);
+        }
+        // Poll with a timeout, a signal may be delivered to the other thread
+        int ready = poll(&pfd, 1, POLL_INTERVAL_MS);
+        if (ready <= 0) {
+            if (ready < 0 && errno != EINTR) {
+                perror("poll");
+                break;
+            }
+            continue;
+        }
+        ssize_t len = read(pty_master, data, read_size);
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("read");
+            break;
+        }
+
+        baud = atomic_load(&line_baud);  // The rate may have changed while polling
+        if (baud > 0) {
+            uint64_t now = now_ns();
+            if (wire_ns < now) {
+                wire_ns = now;
+            }
+            wire_ns += (uint64_t)len * BITS_PER_BYTE * 1000000000ULL / (uint64_t)baud;
+            sleep_until_ns(wire_ns);
+        }
+        long sender = sender_baud();
+        if (baud > 0 && sender > 0 && sender != baud) {
+            for (ssize_t i = 0; i < len; i++) {
+                data[i] = ++corrupt % GARBLE_ZERO_EVERY == 0 ? 0 : (uint8_t)(~data[i] ^ 0x5a);
+            }
+        } else if (opts->max_baud > 0 && baud > opts->max_baud) {
+            for (ssize_t i = 0; i < len; i++) {
+                if (++corrupt % CORRUPT_EVERY == 0) {
+                    data[i] ^= 0x10;
+                }
+            }
+        }
+
+        for (ssize_t i = 0; opts->corrupt_every > 0 && i < len; i++) {
+            if (++received % opts->corrupt_every == 0) {
+                data[i] ^= 0x10;
+            }
+        }
+
+        bool drop = opts->drop_every > 0 && ++reads % opts->drop_every == 0;
+        pthread_mutex_lock(&rx.lock);
+        if (drop || (size_t)len > rx.size - rx.len) {
+            rx.overflow = true;
+            rx.lost += (size_t)len;
+        } else {
+            size_t tail = (rx.head + rx.len) % rx.size;
+            size_t first = rx.size - tail < (size_t)len ? rx.size - tail : (size_t)len;
+            memcpy(rx.buf + tail, data, first);
+            memcpy(rx.buf, data + first, (size_t)len - first);
+            rx.len += (size_t)len;
+            if (rx.len > rx.high_water) {
+                rx.high_water = rx.len;
+            }
+        }
+        pthread_cond_signal(&rx.ready);
+        pthread_mutex_unlock(&rx.lock);
+    }
+
+    pthread_mutex_lock(&rx.lock);
+    rx.closed = true;
+    pthread_cond_signal(&rx.ready);
+    pthread_mutex_unlock(&rx.lock);
+    return NULL;
+}
+
+/**
+ * @brief Open a raw pty pair and return the master side
+ *
+ * The slave is kept open by the simulator too, so reads on the master keep
+ * blocking (instead of failing with EIO) while no sender has the port open.
+ */
+static int open_pty(int* slave_fd, char* slave_name, size_t name_size) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0
+            || ptsname_r(master, slave_name, name_size) != 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+
+    *slave_fd = open(slave_name, O_RDWR | O_NOCTTY);
+    if (*slave_fd < 0) {
+        perror(slave_name);
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(*slave_fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(*slave_fd, TCSANOW, &tio);
+    }
+    return master;
+}
+
+int main(int argc, char** argv) {
+    sim_options_t opts;
+    if (parse_options(argc, argv, &opts) != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int slave;
+    char slave_name[128];
+    int master = open_pty(&slave, slave_name, sizeof(slave_name));
+    if (master < 0) {
+        return 1;
+    }
+    pty_master = master;
+    pty_slave = slave;
+    if (opts.link != NULL) {
+        unlink(opts.link);
+        if (symlink(slave_name, opts.link) != 0) {
+            perror(opts.link);
+            return 1;
+        }
+    }
+
+    // No SA_RESTART: a signal must interrupt blocking waits so the loops can exit
+    struct sigaction action = { .sa_handler = stop };
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    uint8_t* frame_buf = malloc(FRAME_DECODER_CRC_BUF_SIZE(opts.frame_size));
+    size_t json_size = JSON_PAYLOAD_MAX_LEN(opts.frame_size);
+    char* json_buf = malloc(json_size);
+    uint8_t* chunk_buf = malloc(CHUNK_SLOTS * opts.max_message);
+    uint8_t* decompress_buf = malloc(DECOMPRESS_SIZE);
+    rx = (rx_buffer_t) { .buf = malloc(opts.rx_buffer), .size = opts.rx_buffer };
+    void* log_buf = opts.async_log > 0 ? aligned_alloc(4, opts.async_log) : NULL;
+    if (frame_buf == NULL || json_buf == NULL || chunk_buf == NULL || decompress_buf == NULL
+            || rx.buf == NULL || (opts.async_log > 0 && log_buf == NULL)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    deserializer_t des;
+    deserializer_config_t config = {
+        .framing = opts.framing,
+        .output = opts.binary ? DESERIALIZER_OUTPUT_BINARY : DESERIALIZER_OUTPUT_JSON,
+        .frame_buf = frame_buf,
+        .frame_size = opts.frame_size,
+        .max_message_size = opts.max_message,
+        .json_buf = json_buf,
+        .json_size = json_size,
+        .chunk_buf = chunk_buf,
+        .chunk_slot_size = opts.max_message,
+        .chunk_slots = CHUNK_SLOTS,
+        .chunk_timeout_ms = CHUNK_TIMEOUT_MS,
+        .decompress_buf = decompress_buf,
+        .decompress_size = DECOMPRESS_SIZE,
+        .dict = &lzss_telemetry_dict,
+        .baud_rate = (uint32_t)opts.baud_rate,
+        .max_baud_rate = MAX_BAUD_RATE,
+        .baud_timeout_ms = BAUD_TIMEOUT_MS,
+        .autobaud_errors = (uint32_t)opts.autobaud,
+        .frame_crc = opts.crc,
+        .stage_hists = opts.stages ? stage_hists : NULL,
+        .callbacks = {
+            .on_payload = show_payload_as_json,
+            .on_error = log_deserializer_error,
+            .send_reply = write_reply,
+            .on_payload_chunk = show_payload_chunk,
+            .now_ms = now_ms,
+            .set_baud_rate = set_baud_rate,
+            .measure_baud_rate = measure_baud_rate,
+            .now_us = now_us,
+            .on_stats_query = fill_device_stats,
+            .ctx = &opts,
+        },
+    };
+    if (opts.binary) {
+        // A whole record is written like the last piece of a streamed one
+        config.callbacks.on_payload = show_record;
+        config.callbacks.on_payload_chunk = show_record;
+    }
+    if (opts.async_log > 0) {
+        config.callbacks.on_payload = opts.binary ? queue_payload_chunk : queue_payload;
+        config.callbacks.on_error = queue_error;
+        config.callbacks.on_payload_chunk = queue_payload_chunk;
+    }
+    deserializer_init(&des, &config);
+
+    start_ns = now_ns();
+    print_timestamps = opts.timestamps;
+    binary_output = opts.binary;
+    time_stages = opts.stages;
+    printf("Simulator listening on %s\n", opts.link != NULL ? opts.link : slave_name);
+    log_line('I', "Uart initialized on port 2 with TX pin 42, RX pin 41 at baud rate %ld",
+            opts.baud_rate);
+    fflush(stdout);
+
+    atomic_init(&line_baud, opts.baud_rate);
+    log_byte_ns = opts.log_baud > 0 ? BITS_PER_BYTE * 1000000000ULL / (uint64_t)opts.log_baud : 0;
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&rx.ready, &cond_attr);
+    pthread_cond_init(&rx.space, NULL);
+    pthread_mutex_init(&rx.lock, NULL);
+    pthread_t reader;
+    if (pthread_create(&reader, NULL, rx_thread, &opts) != 0) {
+        fprintf(stderr, "Failed to start the reader thread\n");
+        return 1;
+    }
+    pthread_t logger;
+    if (opts.async_log > 0) {
+        frame_ring_init(&log_queue.ring, log_buf, opts.async_log);
+        pthread_mutex_init(&log_queue.lock, NULL);
+        pthread_cond_init(&log_queue.ready, NULL);
+        if (pthread_create(&logger, NULL, log_thread, &opts) != 0) {
+            fprintf(stderr, "Failed to start the log thread\n");
+            return 1;
+        }
+    }
+
+    // Consumer side, like uart_task: decode what the driver buffered and report consumption
+    uint8_t data[READ_SIZE];
+    uint32_t consumed = 0;    // Bytes taken out of the RX buffer, read or flushed
+    uint32_t advertised = 0;  // consumed as of the last Credit frame
+    uint64_t credit_ns = 0;   // Time of the last Credit frame
+    for (;;) {
+        size_t len = 0;
+        bool overflow = false;
+        struct timespec deadline;
+        uint32_t wait_start = now_us(NULL);
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += POLL_INTERVAL_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        pthread_mutex_lock(&rx.lock);
+        while (rx.len == 0 && !rx.overflow && !rx.closed
+                && pthread_cond_timedwait(&rx.ready, &rx.lock, &deadline) == 0) {
+        }
+        uint32_t read_start = now_us(NULL);
+        if (rx.len > 0 || rx.overflow) {
+            end_stage(DESERIALIZER_STAGE_WAIT, wait_start);
+        }
+        if (rx.overflow) {
+            // Flushing also discards what was buffered before the overflow
+            consumed += (uint32_t)(rx.len + rx.lost);
+            rx.head = rx.len = rx.lost = 0;
+            rx.overflow = false;
+            overflow = true;
+        } else if (rx.len > 0) {
+            len = rx.len < sizeof(data) ? rx.len : sizeof(data);
+            size_t first = rx.size - rx.head < len ? rx.size - rx.head : len;
+            memcpy(data, rx.buf + rx.head, first);
+            memcpy(data + first, rx.buf, len - first);
+            rx.head = (rx.head + len) % rx.size;
+            rx.len -= len;
+            consumed += (uint32_t)len;
+            pthread_cond_signal(&rx.space);
+            end_stage(DESERIALIZER_STAGE_READ, read_start);
+        }
+        bool closed = rx.closed && rx.len == 0 && !overflow;
+        pthread_mutex_unlock(&rx.lock);
+
+        if (overflow) {
+            // What the firmware does when the driver reports UART_BUFFER_FULL
+            overflows++;
+            log_line('W', "UART buffer full");
+            fflush(stdout);
+            deserializer_reset(&des);
+        } else if (len > 0) {
+            deserializer_feed(&des, data, len);
+        } else if (closed) {
+            break;
+        }
+        if (opts.async_log > 0) {
+            report_dropped_records();  // Without waiting for the next record
+        }
+
+        uint64_t now = now_ns();
+        if (opts.credits
+                && (consumed - advertised >= opts.rx_buffer / 4
+                        || now - credit_ns >= POLL_INTERVAL_MS * 1000000ULL)) {
+            deserializer_send_credit(&des, consumed, (uint32_t)opts.rx_buffer);
+            advertised = consumed;
+            credit_ns = now;
+        }
+        if (deserializer_check_baud(&des)) {
+            // Like uart_task after a change: what arrived at the previous rate is garbage
+            pthread_mutex_lock(&rx.lock);
+            consumed += (uint32_t)(rx.len + rx.lost);
+            rx.head = rx.len = rx.lost = 0;
+            rx.overflow = false;
+            pthread_cond_signal(&rx.space);
+            pthread_mutex_unlock(&rx.lock);
+            deserializer_reset(&des);
+        }
+    }
+    pthread_join(reader, NULL);
+    if (opts.async_log > 0) {
+        pthread_mutex_lock(&log_queue.lock);
+        log_queue.closed = true;
+        pthread_cond_signal(&log_queue.ready);
+        pthread_mutex_unlock(&log_queue.lock);
+        pthread_join(logger, NULL);
+    }
+
+    if (opts.link != NULL) {
+        unlink(opts.link);
+    }
+    fprintf(stderr,
+            "frames=%u batches=%u payloads=%u bytes=%u unpack_errors=%u oversized=%u "
+            "framing_errors=%u duplicates=%u out_of_order=%u streamed=%u chunks=%u "
+            "transfers=%u transfer_errors=%u compressed=%u dict_mismatches=%u baud_switches=%u "
+            "baud_reverts=%u baud_detections=%u crc_errors=%u overflows=%u log_dropped=%u\n",
+            des.stats.frames, des.stats.batches, des.stats.payloads, des.stats.bytes,
+            des.stats.unpack_errors, des.stats.oversized, des.stats.framing_errors,
+            des.stats.duplicates, des.stats.out_of_order, des.stats.streamed, des.stats.chunks,
+            des.stats.transfers, des.stats.transfer_errors, des.stats.compressed,
+            des.stats.dict_mismatches, des.stats.baud_switches, des.stats.baud_reverts,
+            des.stats.baud_detections, des.stats.crc_errors, overflows, log_queue.dropped);
+    print_stage_stats();
+    close(slave);
+    close(master);
+    free(frame_buf);
+    free(json_buf);
+    free(chunk_buf);
+    free(decompress_buf);
+    free(rx.buf);
+    free(log_buf);
+    return 0;
+}
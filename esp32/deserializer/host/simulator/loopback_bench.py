@@ -0,0 +1,638 @@
+"""
+@file loopback_bench.py
+@brief End-to-end latency and throughput benchmark against the pty simulator
+@details Starts deserializer_sim for each baud rate, connects to its pseudo-terminal
+         with pc/serializer.py exactly as it would connect to the board, and sends
+         numbered Payload messages at several offered loads (a fraction of what the
+         link can carry) and then as fast as the port accepts them.
+         The simulator prefixes every log line with its CLOCK_MONOTONIC time, the same
+         clock as time.monotonic_ns(), so latency is measured from just before the
+         frame is written until the JSON line for that message is printed.
+         For each run the script reports latency percentiles, lost messages and the
+         delivered rate; the flood run gives the max sustained rate at that baud rate.
+         With --batch, messages go through serializer.PayloadBatcher instead of one
+         frame each. With --window, frames go through serializer.ReliableLink and are
+         acknowledged by the simulator, so no message may be lost even when flooding
+         or when --drop-every makes the simulator discard data.
+         --rx-buffer and --log-baud give the simulator the firmware's 256-byte UART
+         receive buffer and a console as slow as the real one, so flooding overflows
+         the buffer; with --credits the sender only writes what fits in it, and with
+         --rtscts the simulator holds the sender back like RTS/CTS flow control would.
+         With --chunked, messages too large for one frame are sent as chunked
+         transfers that the simulator reassembles (see serializer.send_chunks()).
+         --compress sends the frames that shrink LZSS-compressed, and lets batches grow
+         to what fits in a frame once compressed; --text fills messages with words
+         rather than a repeated character, for compression ratios closer to real text.
+         --dictionary compresses against the dictionary shared with the firmware
+         instead, which also shrinks short messages sent one per frame.
+         With --negotiate, every run starts at the given baud rate and moves to the
+         fastest one serializer.negotiate_baud() finds; --max-baud makes the simulator
+         corrupt data sent faster than that, so the faster rates must fail their probes.
+         --sim-baud starts the simulator at another rate than the sender, which must
+         then detect the sender's rate from the frames it fails to decode.
+         --corrupt-every makes the simulator flip a bit in every Nth byte it receives;
+         with a "-crc" framing the frames hit fail their CRC and are dropped, and with
+         --window they are sent again, so no message may be lost either.
+         --async-log has the simulator log from a thread fed through a ring of that many
+         bytes; messages decoded but dropped from a full ring count as unlogged rather
+         than lost, and the slow console (--log-baud) no longer overflows the receive
+         buffer.
+         --binary has the simulator write binary records instead of JSON renderings;
+         latency is then measured until the record is written.
+         --stages has the simulator time each stage of the pipeline and print the
+         latency histograms of each run when it exits.
+         --stats asks the simulator for its counters once the runs are over, with a
+         STATS frame as serializer.py --stats sends, and prints its Stats reply; it
+         must come back, and count at least the messages delivered.
+
+@author Juan Ignacio Giorgetti
+@date 2025
+@version 1.0
+
+@usage
+    cmake -S .. -B ../build && cmake --build ../build
+    python loopback_bench.py [--sim PATH] [--bauds 9600 115200 ...] [--loads 0.25 0.5 ...]
+                             [--size BYTES] [--duration SECONDS]
+                             [--framing {length,cobs,length-crc,cobs-crc}] [--batch N]
+                             [--linger MS] [--batch-encoding {delta,plain}]
+                             [--window N] [--drop-every N] [--rx-buffer BYTES]
+                             [--log-baud RATE] [--credits] [--rtscts] [--chunked]
+                             [--compress] [--dictionary] [--text] [--negotiate]
+                             [--max-baud RATE] [--sim-baud RATE] [--corrupt-every N]
+                             [--async-log BYTES] [--binary] [--stages] [--stats]
+                             [--check]
+
+@note Linux only (pseudo-terminals and a shared CLOCK_MONOTONIC)
+"""
+
+import argparse
+import contextlib
+import json
+import os
+import random
+import subprocess
+import sys
+import textwrap
+import threading
+import time
+
+sys.path.insert(
+    0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "..", "..", "pc")
+)
+
+import message_pb2  # noqa: E402
+import serializer  # noqa: E402
+from google.protobuf.message import DecodeError  # noqa: E402
+
+DEFAULT_SIM = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)), "..", "build", "deserializer_sim"
+)
+BITS_PER_BYTE = 10  #!< 8N1: start bit, 8 data bits, stop bit
+JSON_MARKER = "JSON payload created: "
+OVERFLOW_MARKER = "UART buffer full"
+UNLOGGED_MARKER = " log record(s)"  #!< Ends "Dropped N" in place of records not logged
+BAUD_MARKER = "Baud rate set to "
+RECORD_MARKER = b"\x00"  #!< First byte of a binary record, see binary_record.h
+SEQ_DIGITS = 8  #!< Every message starts with its zero-padded sequence number
+DRAIN_TIMEOUT = 2.0  #!< Seconds without any new message before giving up on the rest
+TEXT_WORDS = (
+    "sensor", "temperature", "humidity", "pressure", "reading", "status", "ok", "battery",
+    "voltage", "nominal", "alarm", "cleared", "node", "gateway", "update", "level",
+)  #!< Vocabulary of --text messages
+
+
+def message_data(seq: int, size: int, text: bool = False) -> str:
+    """
+    @fn message_data
+    @brief Data field of message number seq, padded to size characters
+    @param text Pad with words picked at random (seeded with seq) instead of "x"
+    """
+    data = f"{seq:0{SEQ_DIGITS}d}"
+    if not text:
+        return data.ljust(size, "x")
+    rng = random.Random(seq)
+    while len(data) < size:
+        data += " " + rng.choice(TEXT_WORDS)
+    return data[:size]
+
+
+def build_payload(seq: int, size: int, text: bool = False) -> bytes:
+    """
+    @fn build_payload
+    @brief Serialize the Payload for message number seq
+    @param seq Sequence number, encoded at the start of the data field
+    @param size Length of the data field in characters (at least SEQ_DIGITS)
+    @param text Data made of words, see message_data()
+    @return Serialized Payload
+    """
+    payload = message_pb2.Payload()
+    payload.timestamp = int(time.time())
+    payload.data = message_data(seq, size, text)
+    return payload.SerializeToString()
+
+
+def build_frame(
+    seq: int,
+    size: int,
+    framing: str,
+    max_frame: int = 0,
+    text: bool = False,
+    compress: bool = False,
+    dictionary: bool = False,
+) -> bytes:
+    """
+    @fn build_frame
+    @brief Build the framed Payload for message number seq
+    @param framing Framing mode, one of serializer.FRAMINGS
+    @param max_frame Send a Payload frame longer than this as Chunk frames (0: never)
+    @param text Data made of words, see message_data()
+    @param compress Compress the frames that shrink, except Payloads the ESP32 streams
+    @param dictionary Compress against serializer.DICTIONARY
+    @return Frame, or back-to-back Chunk frames, ready to be written to the port
+    """
+    payload = build_payload(seq, size, text)
+    if max_frame == 0 or 1 + len(payload) <= max_frame:
+        frame_type = message_pb2.FRAME_TYPE_PAYLOAD
+        if compress and 1 + len(payload) <= serializer.max_frame_body(framing):
+            frame_type, payload = serializer.compress_frame(payload, frame_type, dictionary)
+        return serializer.frame_message(payload, framing, frame_type)
+    frames = []
+    for chunk in serializer.encode_chunks(message_data(seq, size, text).encode(), 0, max_frame):
+        frame_type = message_pb2.FRAME_TYPE_CHUNK
+        if compress:
+            frame_type, chunk = serializer.compress_frame(chunk, frame_type, dictionary)
+        frames.append(serializer.frame_message(chunk, framing, frame_type))
+    return b"".join(frames)
+
+
+def read_record(stream) -> bytes | None:
+    """
+    @fn read_record
+    @brief Read one binary record: marker byte, varint length, then the Payload message
+    @param stream Buffered binary stream positioned on the marker
+    @return Encoded Payload, or None if the stream ended first
+    """
+    if stream.read(1) != RECORD_MARKER:
+        return None
+    length = shift = 0
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            return None
+        length |= (byte[0] & 0x7F) << shift
+        shift += 7
+        if byte[0] < 0x80:
+            break
+    record = stream.read(length)
+    return record if len(record) == length else None
+
+
+class Simulator:
+    """
+    @brief Running deserializer_sim process and the messages it has decoded
+    """
+
+    def __init__(self, path: str, baud: int, framing: str, options: list[str] = ()):
+        method, crc = serializer.split_framing(framing)
+        if crc:
+            options = [*options, "--crc"]
+        self.proc = subprocess.Popen(
+            [path, "--baud", str(baud), "--framing", method, "--timestamps", *options],
+            stdout=subprocess.PIPE,
+        )
+        first = self.proc.stdout.readline().decode().split()
+        if not first or first[0] != "Simulator":
+            raise RuntimeError("deserializer_sim did not start")
+        self.port = first[-1]
+        self.baud = baud  # Pacing rate, followed through the "Baud rate set to" lines
+        self.received = {}  # Sequence number -> receive time in ns
+        self.errors = 0
+        self.overflows = 0
+        self.unlogged = 0
+        self.lock = threading.Lock()
+        self.reader = threading.Thread(target=self._read, daemon=True)
+        self.reader.start()
+
+    def _read(self) -> None:
+        stdout = self.proc.stdout
+        while True:
+            stamp = bytearray()
+            while (byte := stdout.read(1)) not in (b" ", b""):
+                stamp += byte
+            if not byte:
+                return
+            if stdout.peek(1)[:1] == RECORD_MARKER and stamp.isdigit():
+                record = read_record(stdout)
+                if record is None:
+                    return
+                self._record(int(stamp), record)
+                continue
+            line = stdout.readline().decode(errors="replace")
+            if stamp.isdigit():
+                self._line(int(stamp), line)
+
+    def _record(self, stamp: int, record: bytes) -> None:
+        try:
+            seq = int(message_pb2.Payload.FromString(record).data[:SEQ_DIGITS])
+        except (DecodeError, ValueError):
+            return  # Cut short and padded, or corrupted: the error line follows
+        with self.lock:
+            self.received[seq] = stamp
+
+    def _line(self, stamp: int, rest: str) -> None:
+        if rest.startswith("E "):
+            with self.lock:
+                self.errors += 1
+            return
+        if rest.startswith("W ") and rest.rstrip().endswith(OVERFLOW_MARKER):
+            with self.lock:
+                self.overflows += 1
+            return
+        if rest.startswith("W ") and UNLOGGED_MARKER in rest:
+            with self.lock:
+                self.unlogged += int(rest.split(UNLOGGED_MARKER)[0].rsplit(" ", 1)[1])
+            return
+        if BAUD_MARKER in rest:
+            self.baud = int(rest.rsplit(" ", 1)[1])
+            return
+        marker = rest.find(JSON_MARKER)
+        if marker < 0:
+            return
+        data = json.loads(rest[marker + len(JSON_MARKER) :])["data"]
+        with self.lock:
+            self.received[int(data[:SEQ_DIGITS])] = stamp
+
+    def reset(self) -> None:
+        with self.lock:
+            self.received = {}
+            self.errors = 0
+            self.overflows = 0
+            self.unlogged = 0
+
+    def wait_for(self, count: int, timeout: float) -> None:
+        # Backpressure can leave a long backlog: only give up once it stops draining
+        deadline = time.monotonic() + timeout
+        last = -1
+        while time.monotonic() < deadline:
+            with self.lock:
+                received = len(self.received) + self.unlogged
+            if received >= count:
+                return
+            if received != last:
+                last = received
+                deadline = time.monotonic() + timeout
+            time.sleep(0.01)
+
+    def stop(self) -> None:
+        self.proc.terminate()
+        try:
+            self.proc.wait(timeout=2)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
+            self.proc.wait()
+
+
+class ByteCounter:
+    """
+    @brief Stand-in for the serial port that only counts the frames written to it
+    """
+
+    def __init__(self):
+        self.frames = 0
+        self.bytes = 0
+
+    def write(self, data: bytes) -> None:
+        self.frames += 1
+        self.bytes += len(data)
+
+
+def wire_bytes_per_message(args: argparse.Namespace, sample: int = 64) -> float:
+    """
+    @fn wire_bytes_per_message
+    @brief Average bytes a message takes on the wire, to size the runs to the link capacity
+    @details With --batch, the first sample messages are packed by a PayloadBatcher writing
+             to a ByteCounter, so batching and compression are accounted for as sent.
+    @param sample Number of messages batched for the estimate
+    """
+    max_frame = 0
+    if args.chunked:
+        max_frame = serializer.max_frame_body(args.framing) - (
+            serializer.SEQUENCED_HEADER_SIZE if args.window > 0 else 0
+        )
+    header = serializer.SEQUENCED_HEADER_SIZE if args.window > 0 else 0
+    if args.batch > 1:
+        counter = ByteCounter()
+        batcher = serializer.PayloadBatcher(
+            counter, args.framing, args.batch, 60, args.batch_encoding, None, args.chunked,
+            args.compress, args.dictionary,
+        )
+        with open(os.devnull, "w") as devnull, contextlib.redirect_stdout(devnull):
+            for seq in range(sample):
+                batcher.add(message_data(seq, args.size, args.text), 0)
+            batcher.flush()
+        return (counter.bytes + counter.frames * header) / sample
+
+    frame_len = len(
+        build_frame(
+            0, args.size, args.framing, max_frame, args.text, args.compress, args.dictionary
+        )
+    )
+    # Every frame of a chunked transfer is sequenced on its own
+    frames_per_message = 1
+    if args.chunked and 1 + len(build_payload(0, args.size, args.text)) > max_frame:
+        data = message_data(0, args.size, args.text).encode()
+        frames_per_message = len(serializer.encode_chunks(data, 0, max_frame))
+    return frame_len + frames_per_message * header
+
+
+def percentile(sorted_values: list, fraction: float) -> float:
+    """
+    @fn percentile
+    @brief Nearest-rank percentile of an already sorted list
+    """
+    index = min(len(sorted_values) - 1, int(fraction * len(sorted_values)))
+    return sorted_values[index]
+
+
+def run_load(
+    sim: Simulator, ser, link, rate: float | None, count: int, args: argparse.Namespace
+) -> dict:
+    """
+    @fn run_load
+    @brief Send count messages at rate msgs/s (None: as fast as possible) and collect results
+    @param link serializer.ReliableLink to send through, or None to write frames directly
+    @return Dictionary with sent/received counts, errors, UART buffer overflows, messages
+            decoded but not logged, latencies in ms and delivered rate
+    """
+    payloads = [build_payload(seq, args.size, args.text) for seq in range(count)]
+    max_frame = serializer.max_frame_body(args.framing) if args.chunked else 0
+    frames = [
+        build_frame(
+            seq, args.size, args.framing, max_frame, args.text, args.compress, args.dictionary
+        )
+        for seq in range(count)
+    ]
+    data = [message_data(seq, args.size, args.text) for seq in range(count)]
+    batcher = None
+    if args.batch > 1:
+        batcher = serializer.PayloadBatcher(
+            ser, args.framing, args.batch, args.linger / 1000, args.batch_encoding, link,
+            args.chunked, args.compress, args.dictionary,
+        )
+    sent = [0] * count
+    sim.reset()
+
+    start = time.monotonic_ns()
+    with open(os.devnull, "w") as devnull, contextlib.redirect_stdout(devnull):
+        for seq in range(count):
+            if rate is not None:
+                due = start + int(seq * 1e9 / rate)
+                while time.monotonic_ns() < due:
+                    time.sleep(max(0.0, (due - time.monotonic_ns()) / 1e9 - 0.0005))
+            sent[seq] = time.monotonic_ns()
+            if batcher is not None:
+                batcher.add(data[seq], int(time.time()))
+            elif link is not None and (args.chunked or args.compress):
+                serializer.send_message(
+                    ser, data[seq], int(time.time()), args.framing, link, args.chunked,
+                    args.compress, args.dictionary,
+                )
+            elif link is not None:
+                link.send(payloads[seq])
+            else:
+                ser.write(frames[seq])
+        if batcher is not None:
+            batcher.flush()
+    sim.wait_for(count, DRAIN_TIMEOUT)
+
+    with sim.lock:
+        received = dict(sim.received)
+        errors = sim.errors
+        overflows = sim.overflows
+        unlogged = sim.unlogged
+    latencies = sorted((received[seq] - sent[seq]) / 1e6 for seq in received)
+    result = {"sent": count, "received": len(received), "errors": errors, "overflows": overflows}
+    result["unlogged"] = unlogged
+    if latencies:
+        span = (max(received.values()) - start) / 1e9
+        result.update(
+            p50=percentile(latencies, 0.50),
+            p90=percentile(latencies, 0.90),
+            p99=percentile(latencies, 0.99),
+            max=latencies[-1],
+            rate=len(received) / span if span > 0 else 0.0,
+        )
+    return result
+
+
+def print_row(baud: int, label: str, offered: float | None, result: dict) -> None:
+    offered_text = f"{offered:.0f}" if offered is not None else "max"
+    lost = result["sent"] - result["received"] - result["unlogged"]
+    line = f"{baud:>8} {label:>6} {offered_text:>9} {result['sent']:>6} {lost:>5}"
+    line += f" {result['overflows']:>5}"
+    if "p50" in result:
+        line += (
+            f" {result['p50']:>8.2f} {result['p90']:>8.2f} {result['p99']:>8.2f}"
+            f" {result['max']:>8.2f} {result['rate']:>10.1f}"
+        )
+    if result["unlogged"]:
+        line += f" ({result['unlogged']} not logged)"
+    print(line, flush=True)
+
+
+def main() -> int:
+    """
+    @fn main
+    @brief Benchmark entry point
+    @return Process exit code: 1 when --check is given and a sub-capacity run (any run
+            with --window, --credits or --rtscts) lost messages or reported decoding
+            errors, a run with flow control overflowed the receive buffer, or
+            --negotiate did not end on the fastest rate the simulated link carries, or the
+            simulator did not detect the sender's rate with --sim-baud. With
+            --corrupt-every, decoding errors are expected and only runs with --window
+            must not lose messages. Messages decoded but not logged with --async-log are
+            not lost, and --async-log must keep the receive buffer from overflowing
+    """
+    parser = argparse.ArgumentParser(description="End-to-end benchmark on the pty simulator")
+    parser.add_argument("--sim", default=DEFAULT_SIM, help="Path to deserializer_sim")
+    parser.add_argument("--bauds", type=int, nargs="+", default=[9600, 115200, 921600])
+    parser.add_argument(
+        "--loads", type=float, nargs="+", default=[0.25, 0.5, 0.9],
+        help="Offered loads, as fractions of the link capacity",
+    )
+    parser.add_argument("--size", type=int, default=32, help="Data field length in characters")
+    parser.add_argument("--duration", type=float, default=2.0, help="Seconds per run")
+    parser.add_argument("--framing", choices=serializer.FRAMINGS, default="length")
+    parser.add_argument("--batch", type=int, default=1, help="Maximum messages per frame")
+    parser.add_argument("--linger", type=float, default=20, help="Batch linger time in ms")
+    parser.add_argument("--batch-encoding", choices=serializer.BATCH_ENCODINGS, default="delta")
+    parser.add_argument("--window", type=int, default=0, help="Frames in flight, 0: no ACKs")
+    parser.add_argument("--ack-timeout", type=float, default=200, help="ACK timeout in ms")
+    parser.add_argument(
+        "--drop-every", type=int, default=0, help="Make the simulator discard every Nth read"
+    )
+    parser.add_argument(
+        "--rx-buffer", type=int, default=0, help="Simulator UART receive buffer (0: default)"
+    )
+    parser.add_argument(
+        "--log-baud", type=int, default=0, help="Simulator console baud rate (0: instant)"
+    )
+    parser.add_argument("--credits", action="store_true", help="Credit-based flow control")
+    parser.add_argument("--rtscts", action="store_true", help="Emulated RTS/CTS flow control")
+    parser.add_argument(
+        "--chunked", action="store_true", help="Send large messages as chunked transfers"
+    )
+    parser.add_argument("--compress", action="store_true", help="LZSS-compress the frames")
+    parser.add_argument(
+        "--dictionary", action="store_true", help="Compress against the shared dictionary"
+    )
+    parser.add_argument("--text", action="store_true", help="Messages made of words")
+    parser.add_argument(
+        "--negotiate", action="store_true", help="Negotiate a faster baud rate after connecting"
+    )
+    parser.add_argument(
+        "--max-baud", type=int, default=0, help="Fastest rate the simulated link carries (0: any)"
+    )
+    parser.add_argument(
+        "--sim-baud", type=int, default=0, help="Start the simulator at this rate (0: the sender's)"
+    )
+    parser.add_argument(
+        "--corrupt-every", type=int, default=0,
+        help="Make the simulator flip a bit in every Nth byte received (0: never)",
+    )
+    parser.add_argument(
+        "--async-log", type=int, default=0,
+        help="Simulator log ring in bytes, dropping what does not fit (0: log while decoding)",
+    )
+    parser.add_argument(
+        "--binary", action="store_true", help="Simulator writes binary records instead of JSON"
+    )
+    parser.add_argument(
+        "--stages", action="store_true", help="Simulator prints per-stage latency histograms"
+    )
+    parser.add_argument(
+        "--stats", action="store_true", help="Query the simulator counters after the runs"
+    )
+    parser.add_argument("--check", action="store_true", help="Fail on lost messages below capacity")
+    args = parser.parse_args()
+    args.size = max(args.size, SEQ_DIGITS)
+    args.compress = args.compress or args.dictionary
+
+    frame_len = wire_bytes_per_message(args)
+    print(f"Wire bytes per message: {frame_len:.1f} ({args.framing} framing)")
+    print(
+        f"{'baud':>8} {'load':>6} {'offered/s':>9} {'sent':>6} {'lost':>5} {'ovf':>5}"
+        f" {'p50 ms':>8} {'p90 ms':>8} {'p99 ms':>8} {'max ms':>8} {'deliv/s':>10}"
+    )
+
+    # Flow control keeps the receive buffer from overflowing unless the simulator drops data,
+    # and so does decoding that never waits for the console
+    overflow_free = (args.credits or args.rtscts or args.async_log > 0) and args.drop_every == 0
+    # Corrupted frames are reported as errors, and only sent again with a window
+    corrupted = args.corrupt_every > 0
+    failed = False
+    for baud in args.bauds:
+        options = ["--drop-every", str(args.drop_every), "--log-baud", str(args.log_baud)]
+        if corrupted:
+            options += ["--corrupt-every", str(args.corrupt_every)]
+        if args.async_log > 0:
+            options += ["--async-log", str(args.async_log)]
+        if args.binary:
+            options.append("--binary")
+        if args.stages:
+            options.append("--stages")
+        if args.rx_buffer > 0:
+            options += ["--rx-buffer", str(args.rx_buffer)]
+        if args.credits:
+            options.append("--credits")
+        if args.rtscts:
+            options.append("--rtscts")
+        if args.max_baud > 0:
+            options += ["--max-baud", str(args.max_baud)]
+        sim = Simulator(args.sim, args.sim_baud or baud, args.framing, options)
+        ser = serializer.setup_uart(sim.port, baud, args.rtscts)
+        if ser is None:
+            sim.stop()
+            return 1
+        link = None
+        delivered_total = 0
+        try:
+            if args.sim_baud:
+                # Garbled until the simulator follows the sender: keep sending until it does
+                deadline = time.monotonic() + DRAIN_TIMEOUT
+                frame = build_frame(0, args.size, args.framing)
+                while sim.baud != baud and time.monotonic() < deadline:
+                    ser.write(frame)
+                    time.sleep(0.05)
+                time.sleep(0.2)  # Let the frames sent before the switch drain
+                print(f"{args.sim_baud:>8} simulator now at {sim.baud} baud", flush=True)
+                failed = failed or sim.baud != baud
+            if args.negotiate:
+                start = baud
+                baud = serializer.negotiate_baud(ser, args.framing)
+                print(f"{start:>8} negotiated {baud} baud", flush=True)
+                expected = [r for r in serializer.BAUD_RATES if r <= (args.max_baud or r)]
+                failed = failed or baud != max(expected[0], start)
+            capacity = baud / BITS_PER_BYTE / frame_len  # Messages per second the link can carry
+            if args.window > 0 or args.credits:
+                link = serializer.ReliableLink(
+                    ser, args.framing, args.window, args.ack_timeout / 1000, args.credits
+                )
+                if not link.open():
+                    print("deserializer_sim did not answer the SYNC frame or send credits")
+                    return 1
+            for load in args.loads:
+                rate = capacity * load
+                count = max(10, int(rate * args.duration))
+                result = run_load(sim, ser, link, rate, count, args)
+                print_row(baud, f"{load:.2f}", rate, result)
+                delivered = result["received"] + result["unlogged"]
+                delivered_total += delivered
+                lost = delivered != count and (link is not None or not corrupted)
+                if load < 1 and (lost or (result["errors"] != 0 and not corrupted)):
+                    failed = True
+                failed = failed or (overflow_free and result["overflows"] != 0)
+            count = max(10, int(capacity * args.duration))
+            result = run_load(sim, ser, link, None, count, args)
+            print_row(baud, "flood", None, result)
+            delivered = result["received"] + result["unlogged"]
+            delivered_total += delivered
+            if (link is not None or overflow_free) and delivered != count:
+                failed = True
+            failed = failed or (overflow_free and result["overflows"] != 0)
+            print(f"{'':>8} link capacity {capacity:.1f} msgs/s", flush=True)
+            if link is not None:
+                stats = link.stats
+                print(
+                    f"{'':>8} sent {stats['sent']} frames, resent {stats['resent']}"
+                    f" ({stats['nacks']} NACKs, {stats['timeouts']} timeouts),"
+                    f" {stats['stalls']} waited for credits",
+                    flush=True,
+                )
+            if args.stats:
+                if link is not None:
+                    link.close(0)  # Its receive thread would take the reply
+                    link = None
+                reader = serializer.FrameReader(args.framing)
+                stats = serializer.query_stats(ser, reader, args.framing)
+                if stats is None:
+                    print(f"{'':>8} no answer to the STATS frame", flush=True)
+                    failed = True
+                else:
+                    print(textwrap.indent(serializer.format_stats(stats), " " * 9), flush=True)
+                    failed = failed or stats.payloads < delivered_total
+                    failed = failed or (args.stages and len(stats.stages) == 0)
+        except ConnectionError as e:
+            print(f"{baud:>8} {e}", flush=True)
+            failed = True
+        finally:
+            if link is not None:
+                link.close(0)
+            ser.close()
+            sim.stop()
+
+    return 1 if args.check and failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,1505 @@
+/**
+ * @file test_deserializer_core.c
+ * @brief Host unit tests for the portable deserializer core
+ *
+ * Covers the framing layers, the specialized Payload decoder and the JSON
+ * writer, and checks that the full pipeline produces the same output the
+ * firmware logs, whatever way the byte stream is chunked or messages batched,
+ * and that sequenced frames are acknowledged as the sender expects. Also covers
+ * the frame ring used to hand frames over between tasks, and the streaming of
+ * messages larger than the frame buffer or their reassembly from chunks, the
+ * decompression of compressed frames, the checksums that let the framing
+ * recover from a bit error at the cost of one frame, the binary records that
+ * may replace the JSON rendering, the histograms timing every stage, and the
+ * Stats reply that reports them along with the counters.
+ *
+ * @author Juan Ignacio Giorgetti
+ * @date 2025
+ * @version 1.0
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "binary_record.h"
+#include "chunk_pool.h"
+#include "cobs.h"
+#include "crc32.h"
+#include "deserializer.h"
+#include "frame_decoder.h"
+#include "frame_protocol.h"
+#include "frame_ring.h"
+#include "json_writer.h"
+#include "latency_hist.h"
+#include "lzss.h"
+#include "payload_decoder.h"
+#include "payload_stream.h"
+#include "pb_wire.h"
+
+static int failures;
+
+#define CHECK(cond)                                                       \
+    do {                                                                  \
+        if (!(cond)) {                                                    \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                   \
+        }                                                                 \
+    } while (0)
+
+// "Hello, world!" at 1727185234, as serialized by serializer.py (21 bytes)
+static uint8_t const hello_payload[] = { 0x08, 0xd2, 0x82, 0xcb, 0xb7, 0x06, 0x12, 0x0d, 'H', 'e',
+    'l', 'l', 'o', ',', ' ', 'w', 'o', 'r', 'l', 'd', '!' };
+static char const hello_json[] = "{\"timestamp\":1727185234,\"data\":\"Hello, world!\"}";
+
+typedef struct {
+    size_t count;
+    size_t lens[8];
+    char json[8][128];
+    size_t errors;
+    uint8_t replies[256];
+    size_t replies_len;
+    char streamed[4096];  // Pieces of streamed renderings, concatenated
+    size_t streamed_len;
+    size_t streamed_payloads;
+    size_t streamed_payload_len;
+    uint32_t now_ms;     // Clock of chunked transfers and baud rate switches
+    uint32_t baud_rate;  // Last rate set_baud_rate switched to
+    uint32_t baud_max;   // Rates above it fail in set_baud_rate, 0 = none
+    uint32_t measured;   // Rate returned by measure_baud_rate
+    uint32_t now_us;     // Clock of the stage histograms, advanced by tick_us on every reading
+    uint32_t tick_us;
+    size_t stats_queries;
+} capture_t;
+
+static void capture_frame(void* ctx, uint8_t const* frame, size_t len) {
+    capture_t* cap = ctx;
+    if (cap->count < 8) {
+        cap->lens[cap->count] = len;
+    }
+    cap->count++;
+}
+
+static void capture_payload(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+    capture_t* cap = ctx;
+    if (cap->count < 8) {
+        cap->lens[cap->count] = payload_len;
+        snprintf(cap->json[cap->count], sizeof(cap->json[0]), "%s", json);
+    }
+    cap->count++;
+}
+
+static void capture_chunk(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+    capture_t* cap = ctx;
+    if (json_len <= sizeof(cap->streamed) - cap->streamed_len) {
+        memcpy(cap->streamed + cap->streamed_len, json, json_len);
+        cap->streamed_len += json_len;
+    }
+    if (payload_len != 0) {
+        cap->streamed_payloads++;
+        cap->streamed_payload_len = payload_len;
+    }
+}
+
+static void capture_json(void* ctx, char const* json, size_t len, bool last) {
+    capture_chunk(ctx, last ? 1 : 0, json, len);
+}
+
+static void capture_error(void* ctx, deserializer_error_t error) { ((capture_t*)ctx)->errors++; }
+
+static uint32_t capture_now(void* ctx) { return ((capture_t*)ctx)->now_ms; }
+
+static bool capture_can_baud(void* ctx, uint32_t baud_rate) {
+    capture_t const* cap = ctx;
+    return cap->baud_max == 0 || baud_rate <= cap->baud_max;
+}
+
+static bool capture_baud(void* ctx, uint32_t baud_rate) {
+    if (!capture_can_baud(ctx, baud_rate)) {
+        return false;
+    }
+    ((capture_t*)ctx)->baud_rate = baud_rate;
+    return true;
+}
+
+static uint32_t capture_measure(void* ctx) { return ((capture_t*)ctx)->measured; }
+
+static uint32_t capture_now_us(void* ctx) {
+    capture_t* cap = ctx;
+    cap->now_us += cap->tick_us;
+    return cap->now_us;
+}
+
+static void capture_stats_query(void* ctx, deserializer_device_stats_t* device) {
+    ((capture_t*)ctx)->stats_queries++;
+    device->overflows = 3;
+    device->min_free_heap = 200000;
+}
+
+// Encode a Payload whose data is len bytes of every value but zero, quotes and backslashes
+// included; returns the encoded length and the expected rendering in json
+static size_t encode_large_payload(uint8_t* buf, size_t size, size_t len, char* json,
+        size_t json_size) {
+    char data[1024];
+    pb_writer_t writer;
+
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (char)(1 + i % 255);
+    }
+    pb_writer_init(&writer, buf, size);
+    pb_write_tag(&writer, PAYLOAD_FIELD_TIMESTAMP, PB_WIRE_VARINT);
+    pb_write_varint(&writer, 1727185234);
+    pb_write_len(&writer, PAYLOAD_FIELD_DATA, data, len);
+    json_write_payload(json, json_size, 1727185234, data, len);
+    return writer.len;
+}
+
+static void capture_reply(void* ctx, uint8_t const* data, size_t len) {
+    capture_t* cap = ctx;
+    if (len <= sizeof(cap->replies) - cap->replies_len) {
+        memcpy(cap->replies + cap->replies_len, data, len);
+        cap->replies_len += len;
+    }
+}
+
+// Configuration shared by the pipeline tests: length-prefixed frames of up to frame_size bytes,
+// rendered as JSON into cap; each test sets the fields it exercises on top of it
+static deserializer_config_t test_config(capture_t* cap, uint8_t* frame_buf, size_t frame_size,
+        char* json_buf, size_t json_size) {
+    return (deserializer_config_t) {
+        .framing = DESERIALIZER_FRAMING_LENGTH_PREFIX,
+        .frame_buf = frame_buf,
+        .frame_size = frame_size,
+        .json_buf = json_buf,
+        .json_size = json_size,
+        .callbacks = { .on_payload = capture_payload, .on_error = capture_error, .ctx = cap },
+    };
+}
+
+static void test_frame_decoder(void) {
+    // Three frames (3 bytes, empty, 2 bytes), one oversized frame, then one more frame
+    static uint8_t const stream[] = { 3, 1, 2, 3, 0, 2, 9, 9, 10, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+        7 };
+    uint8_t buf[8];
+    frame_decoder_t dec;
+
+    for (size_t chunk = 1; chunk <= sizeof(stream); chunk++) {
+        capture_t cap = { 0 };
+        frame_decoder_init(&dec, buf, sizeof(buf));
+        for (size_t pos = 0; pos < sizeof(stream); pos += chunk) {
+            size_t len = sizeof(stream) - pos < chunk ? sizeof(stream) - pos : chunk;
+            frame_decoder_feed(&dec, stream + pos, len, capture_frame, &cap);
+        }
+        CHECK(cap.count == 4);
+        CHECK(cap.lens[0] == 3 && cap.lens[1] == 0 && cap.lens[2] == 2 && cap.lens[3] == 1);
+        CHECK(dec.oversized == 1);
+        CHECK(dec.state == FRAME_STATE_PREFIX);
+    }
+
+    // A length prefix longer than any uint32 is rejected
+    static uint8_t const bad[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 1, 7 };
+    capture_t cap = { 0 };
+    frame_decoder_init(&dec, buf, sizeof(buf));
+    frame_decoder_feed(&dec, bad, sizeof(bad), capture_frame, &cap);
+    CHECK(dec.bad_prefixes == 1);
+    CHECK(cap.count == 1 && cap.lens[0] == 1);
+}
+
+static void test_cobs(void) {
+    uint8_t encoded[] = { 0x03, 0x11, 0x22, 0x02, 0x33 };
+    size_t len;
+    CHECK(cobs_decode_in_place(encoded, sizeof(encoded), &len));
+    CHECK(len == 4 && memcmp(encoded, "\x11\x22\x00\x33", 4) == 0);
+
+    uint8_t zero[] = { 0x01, 0x01 };
+    CHECK(cobs_decode_in_place(zero, sizeof(zero), &len) && len == 1 && zero[0] == 0);
+
+    uint8_t truncated[] = { 0x05, 0x01 };
+    CHECK(!cobs_decode_in_place(truncated, sizeof(truncated), &len));
+
+    // Encoding round trip, including a 254-byte run ending exactly at the end of the message
+    uint8_t message[300];
+    uint8_t frame[COBS_ENCODED_MAX_LEN(sizeof(message))];
+    for (size_t i = 0; i < sizeof(message); i++) {
+        message[i] = i % 100 == 0 ? 0 : (uint8_t)i;
+    }
+    for (size_t msg_len = 0; msg_len <= sizeof(message); msg_len += msg_len < 8 ? 1 : 41) {
+        size_t frame_len = cobs_encode(message, msg_len, frame, sizeof(frame));
+        CHECK(frame_len > msg_len && frame[frame_len - 1] == COBS_DELIMITER);
+        CHECK(memchr(frame, COBS_DELIMITER, frame_len - 1) == NULL);
+        CHECK(cobs_decode_in_place(frame, frame_len - 1, &len) && len == msg_len);
+        CHECK(memcmp(frame, message, msg_len) == 0);
+    }
+    memset(message, 0x55, 254);
+    size_t frame_len = cobs_encode(message, 254, frame, sizeof(frame));
+    CHECK(frame_len == 256 && frame[0] == 0xFF);
+    CHECK(cobs_decode_in_place(frame, frame_len - 1, &len) && len == 254);
+    CHECK(cobs_encode(message, 254, frame, 255) == 0);
+
+    // Streaming: two frames split at every possible point, with an empty frame between
+    static uint8_t const stream[] = { 0x03, 0x11, 0x22, 0x02, 0x33, 0x00, 0x00, 0x02, 0x44, 0x00 };
+    for (size_t split = 0; split <= sizeof(stream); split++) {
+        uint8_t buf[16];
+        cobs_decoder_t dec;
+        capture_t cap = { 0 };
+        cobs_decoder_init(&dec, buf, sizeof(buf));
+        cobs_decoder_feed(&dec, stream, split, capture_frame, &cap);
+        cobs_decoder_feed(&dec, stream + split, sizeof(stream) - split, capture_frame, &cap);
+        CHECK(cap.count == 2 && cap.lens[0] == 4 && cap.lens[1] == 1);
+    }
+}
+
+static void check_pop(frame_ring_t* ring, char const* expected, size_t expected_len) {
+    uint8_t const* frame;
+    size_t len;
+    CHECK(frame_ring_peek(ring, &frame, &len));
+    CHECK(len == expected_len && memcmp(frame, expected, len) == 0);
+    frame_ring_release(ring);
+}
+
+static void test_frame_ring(void) {
+    static char const data[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEF";
+    _Alignas(4) uint8_t buf[64];
+    frame_ring_t ring;
+    uint8_t const* frame;
+    size_t len;
+
+    frame_ring_init(&ring, buf, sizeof(buf));
+    CHECK(!frame_ring_peek(&ring, &frame, &len));
+
+    // Frames come out in order, including an empty one
+    CHECK(frame_ring_push(&ring, (uint8_t const*)"abc", 3));
+    CHECK(frame_ring_push(&ring, (uint8_t const*)"", 0));
+    check_pop(&ring, "abc", 3);
+    check_pop(&ring, "", 0);
+    CHECK(!frame_ring_peek(&ring, &frame, &len));
+
+    // In place: reserve room for the largest frame, commit the length actually written
+    uint8_t* slot = frame_ring_reserve(&ring, 24);
+    CHECK(slot != NULL && ((uintptr_t)slot & 3) == 0);
+    memcpy(slot, data, 10);
+    frame_ring_commit(&ring, 10);
+    CHECK(frame_ring_push(&ring, (uint8_t const*)data, 20));
+    CHECK(frame_ring_push(&ring, (uint8_t const*)data, 8));  // Ends exactly at the buffer end
+
+    // Full: 52 bytes in use, a 16-byte frame takes 20 more
+    CHECK(!frame_ring_push(&ring, (uint8_t const*)data, 16));
+    check_pop(&ring, data, 10);
+    CHECK(frame_ring_push(&ring, (uint8_t const*)data + 1, 16));
+    check_pop(&ring, data, 20);
+    check_pop(&ring, data, 8);
+    check_pop(&ring, data + 1, 16);
+
+    // A frame that does not fit before the end of the buffer is stored at its start
+    CHECK(frame_ring_push(&ring, (uint8_t const*)data, 36));
+    check_pop(&ring, data, 36);
+    CHECK(frame_ring_push(&ring, (uint8_t const*)data + 2, 8));
+    check_pop(&ring, data + 2, 8);
+    CHECK(!frame_ring_peek(&ring, &frame, &len));
+
+    CHECK(frame_ring_reserve(&ring, sizeof(buf)) == NULL);
+    CHECK(ring.stats.frames == 8 && ring.stats.full == 2);
+    CHECK(ring.stats.high_water == 56 && ring.stats.high_water_frames == 3);
+    CHECK(ring.stats.largest_frame == 36);
+}
+
+static void test_payload_decoder(void) {
+    payload_view_t view;
+    CHECK(payload_view_decode(hello_payload, sizeof(hello_payload), &view) == PAYLOAD_DECODE_OK);
+    CHECK(view.timestamp == 1727185234);
+    CHECK(view.data_len == 13 && memcmp(view.data, "Hello, world!", 13) == 0);
+
+    // Empty message: proto3 defaults
+    CHECK(payload_view_decode(hello_payload, 0, &view) == PAYLOAD_DECODE_OK);
+    CHECK(view.timestamp == 0 && view.data_len == 0);
+
+    static uint8_t const unknown[] = { 0x18, 0x01 };
+    CHECK(payload_view_decode(unknown, sizeof(unknown), &view) == PAYLOAD_DECODE_UNKNOWN_FIELD);
+
+    static uint8_t const truncated[] = { 0x12, 0x05, 'a' };
+    CHECK(payload_view_decode(truncated, sizeof(truncated), &view) == PAYLOAD_DECODE_MALFORMED);
+
+    static uint8_t const wrong_wire_type[] = { 0x0a, 0x00 };
+    CHECK(payload_view_decode(wrong_wire_type, sizeof(wrong_wire_type), &view)
+            == PAYLOAD_DECODE_MALFORMED);
+}
+
+static void test_json_writer(void) {
+    char buf[256];
+    size_t len = json_write_payload(buf, sizeof(buf), 1727185234, "Hello, world!", 13);
+    CHECK(len == 47 && strcmp(buf, hello_json) == 0);
+
+    // Same escaping as cJSON_PrintUnformatted
+    static char const special[] = "q\"b\\s/\b\f\n\r\t\x01\x1f\x7f\xc3\xa9";
+    len = json_write_payload(buf, sizeof(buf), 0, special, sizeof(special) - 1);
+    CHECK(strcmp(buf, "{\"timestamp\":0,\"data\":\"q\\\"b\\\\s/\\b\\f\\n\\r\\t\\u0001\\u001f\x7f\xc3\xa9\"}")
+            == 0);
+    CHECK(len == strlen(buf));
+
+    // Output that does not fit is rejected instead of truncated
+    CHECK(json_write_payload(buf, 47, 1727185234, "Hello, world!", 13) == 0);
+    CHECK(json_write_payload(buf, 48, 1727185234, "Hello, world!", 13) == 47);
+}
+
+static void test_payload_stream(void) {
+    uint8_t payload[1100];
+    char expected[JSON_PAYLOAD_MAX_LEN(1000)];
+    size_t len = encode_large_payload(payload, sizeof(payload), 1000, expected, sizeof(expected));
+    payload_stream_t stream;
+
+    // Same rendering as json_write_payload() however the input is split
+    for (size_t chunk = 1; chunk <= len; chunk = chunk * 3 + 1) {
+        capture_t cap = { 0 };
+        payload_stream_init(&stream, capture_json, &cap);
+        for (size_t pos = 0; pos < len; pos += chunk) {
+            payload_stream_feed(&stream, payload + pos, len - pos < chunk ? len - pos : chunk);
+        }
+        CHECK(payload_stream_finish(&stream));
+        CHECK(cap.streamed_payloads == 1 && stream.len == len);
+        CHECK(cap.streamed_len == strlen(expected));
+        CHECK(memcmp(cap.streamed, expected, cap.streamed_len) == 0);
+    }
+
+    // Unknown fields are skipped, a missing data field renders as empty
+    static uint8_t const unknown[] = { 0x18, 0x01, 0x08, 0x2a, 0x25, 1, 2, 3, 4, 0x22, 1, 'x' };
+    capture_t cap = { 0 };
+    payload_stream_init(&stream, capture_json, &cap);
+    payload_stream_feed(&stream, unknown, sizeof(unknown));
+    CHECK(payload_stream_finish(&stream));
+    CHECK(cap.streamed_len == 26);
+    CHECK(memcmp(cap.streamed, "{\"timestamp\":42,\"data\":\"\"}", 26) == 0);
+
+    // Invalid: timestamp after data, truncated data, wrong wire type
+    static uint8_t const late_timestamp[] = { 0x12, 0x01, 'a', 0x08, 0x01 };
+    payload_stream_begin(&stream);
+    payload_stream_feed(&stream, late_timestamp, sizeof(late_timestamp));
+    CHECK(!payload_stream_finish(&stream));
+    static uint8_t const truncated[] = { 0x12, 0x05, 'a' };
+    payload_stream_begin(&stream);
+    payload_stream_feed(&stream, truncated, sizeof(truncated));
+    CHECK(!payload_stream_finish(&stream));
+    static uint8_t const wrong_wire_type[] = { 0x0a, 0x00 };
+    payload_stream_begin(&stream);
+    payload_stream_feed(&stream, wrong_wire_type, sizeof(wrong_wire_type));
+    CHECK(!payload_stream_finish(&stream));
+}
+
+static void test_pipeline(deserializer_framing_t framing) {
+    uint8_t stream[128];
+    size_t stream_len = 0;
+
+    // The same Payload frame three times, back to back
+    for (int i = 0; i < 3; i++) {
+        if (framing == DESERIALIZER_FRAMING_COBS) {
+            // The frame type byte is the only zero: two COBS blocks
+            stream[stream_len++] = 0x01;
+            stream[stream_len++] = sizeof(hello_payload) + 1;
+            memcpy(stream + stream_len, hello_payload, sizeof(hello_payload));
+            stream_len += sizeof(hello_payload);
+            stream[stream_len++] = COBS_DELIMITER;
+        } else {
+            stream[stream_len++] = sizeof(hello_payload) + 1;
+            stream[stream_len++] = FRAME_TYPE_PAYLOAD;
+            memcpy(stream + stream_len, hello_payload, sizeof(hello_payload));
+            stream_len += sizeof(hello_payload);
+        }
+    }
+
+    for (size_t chunk = 1; chunk <= stream_len; chunk++) {
+        uint8_t frame_buf[64];
+        char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+        capture_t cap = { 0 };
+        deserializer_t des;
+        deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+                sizeof(json_buf));
+        config.framing = framing;
+        deserializer_init(&des, &config);
+        for (size_t pos = 0; pos < stream_len; pos += chunk) {
+            deserializer_feed(&des, stream + pos, stream_len - pos < chunk ? stream_len - pos : chunk);
+        }
+        CHECK(cap.count == 3 && cap.errors == 0);
+        for (size_t i = 0; i < 3; i++) {
+            CHECK(cap.lens[i] == sizeof(hello_payload));
+            CHECK(strcmp(cap.json[i], hello_json) == 0);
+        }
+        CHECK(des.stats.frames == 3 && des.stats.payloads == 3);
+    }
+
+    // Framing only: the frames are handed over undecoded, to be decoded elsewhere
+    uint8_t frame_buf[64];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), NULL, 0);
+    config.framing = framing;
+    config.callbacks.on_payload = NULL;
+    config.callbacks.on_frame = capture_frame;
+    deserializer_init(&des, &config);
+    deserializer_feed(&des, stream, stream_len);
+    CHECK(cap.count == 3 && cap.errors == 0);
+    CHECK(cap.lens[0] == sizeof(hello_payload) + 1 && cap.lens[2] == sizeof(hello_payload) + 1);
+    CHECK(des.stats.frames == 0 && des.stats.payloads == 0);
+}
+
+// Append a frame to stream with the given framing, returning the new stream length
+static size_t append_frame(uint8_t* stream, size_t stream_len, deserializer_framing_t framing,
+        uint8_t const* frame, size_t len) {
+    if (framing == DESERIALIZER_FRAMING_COBS) {
+        return stream_len + cobs_encode(frame, len, stream + stream_len, COBS_ENCODED_MAX_LEN(len));
+    }
+    pb_writer_t writer;
+    pb_writer_init(&writer, stream + stream_len, FRAME_PREFIX_MAX_BYTES);
+    pb_write_varint(&writer, len);
+    memcpy(stream + stream_len + writer.len, frame, len);
+    return stream_len + writer.len + len;
+}
+
+static void test_streaming(deserializer_framing_t framing) {
+    uint8_t frame[1100] = { FRAME_TYPE_SEQUENCED, 0, FRAME_TYPE_PAYLOAD };
+    char expected[JSON_PAYLOAD_MAX_LEN(1000)];
+    size_t payload_len = encode_large_payload(frame + 3, sizeof(frame) - 3, 1000, expected,
+            sizeof(expected));
+    uint8_t small[1 + sizeof(hello_payload)] = { FRAME_TYPE_PAYLOAD };
+    memcpy(small + 1, hello_payload, sizeof(hello_payload));
+
+    // Small frame, large Payload, sequenced large Payload, small frame
+    uint8_t stream[2 * COBS_ENCODED_MAX_LEN(sizeof(frame)) + 2 * sizeof(small) + 8];
+    size_t stream_len = append_frame(stream, 0, framing, small, sizeof(small));
+    stream_len = append_frame(stream, stream_len, framing, frame + 2, 1 + payload_len);
+    stream_len = append_frame(stream, stream_len, framing, frame, 3 + payload_len);
+    stream_len = append_frame(stream, stream_len, framing, small, sizeof(small));
+
+    for (size_t chunk = 1; chunk <= stream_len; chunk = chunk * 5 + 2) {
+        uint8_t frame_buf[64];
+        char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+        capture_t cap = { 0 };
+        deserializer_t des;
+        deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+                sizeof(json_buf));
+        config.framing = framing;
+        config.max_message_size = 1100;
+        config.callbacks.send_reply = capture_reply;
+        config.callbacks.on_payload_chunk = capture_chunk;
+        deserializer_init(&des, &config);
+        for (size_t pos = 0; pos < stream_len; pos += chunk) {
+            deserializer_feed(&des, stream + pos, stream_len - pos < chunk ? stream_len - pos : chunk);
+        }
+        CHECK(cap.count == 2 && cap.errors == 0);
+        CHECK(strcmp(cap.json[0], hello_json) == 0 && strcmp(cap.json[1], hello_json) == 0);
+        CHECK(cap.streamed_payloads == 2 && cap.streamed_payload_len == payload_len);
+        CHECK(cap.streamed_len == 2 * strlen(expected));
+        CHECK(memcmp(cap.streamed, expected, strlen(expected)) == 0);
+        CHECK(memcmp(cap.streamed + strlen(expected), expected, strlen(expected)) == 0);
+        CHECK(des.stats.frames == 4 && des.stats.streamed == 2 && des.stats.payloads == 4);
+        // The sequenced frame is acknowledged once complete
+        CHECK(cap.replies_len == (framing == DESERIALIZER_FRAMING_COBS ? 4 : 3));
+        CHECK(cap.replies[cap.replies_len - (framing == DESERIALIZER_FRAMING_COBS ? 2 : 1)] == 1);
+        CHECK(!deserializer_frame_pending(&des));
+    }
+
+    // Over max_message_size, or not a single Payload: discarded as oversized
+    frame[3 + payload_len] = 0;
+    uint8_t batch[600] = { FRAME_TYPE_BATCH, 0x0a, 0xd4, 0x04 };
+    memset(batch + 4, 'b', sizeof(batch) - 4);
+    stream_len = append_frame(stream, 0, framing, frame + 2, 2 + payload_len);
+    stream_len = append_frame(stream, stream_len, framing, batch, sizeof(batch));
+    stream_len = append_frame(stream, stream_len, framing, small, sizeof(small));
+    uint8_t frame_buf[64];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    config.framing = framing;
+    config.max_message_size = 1 + payload_len;
+    config.callbacks.on_payload_chunk = capture_chunk;
+    deserializer_init(&des, &config);
+    deserializer_feed(&des, stream, stream_len);
+    CHECK(cap.count == 1 && cap.errors == 2 && cap.streamed_payloads == 0);
+    CHECK(des.stats.oversized == 2);
+
+    // A reset in the middle of a streamed frame drops it as a framing error
+    stream_len = append_frame(stream, 0, framing, frame + 2, 1 + payload_len);
+    cap = (capture_t) { 0 };
+    deserializer_init(&des, &config);
+    deserializer_feed(&des, stream, stream_len / 2);
+    CHECK(deserializer_frame_pending(&des));
+    deserializer_reset(&des);
+    CHECK(cap.errors == 1 && des.stats.framing_errors == 1 && !deserializer_frame_pending(&des));
+    deserializer_feed(&des, stream, stream_len);
+    CHECK(cap.streamed_payloads == 1 && cap.errors == 1);
+}
+
+// Pass a Chunk frame to the pipeline; size and timestamp are only encoded in chunk 0
+static void send_chunk(deserializer_t* des, uint32_t transfer_id, uint32_t index, size_t size,
+        char const* data, size_t len) {
+    uint8_t frame[256] = { FRAME_TYPE_CHUNK };
+    pb_writer_t writer;
+
+    pb_writer_init(&writer, frame + 1, sizeof(frame) - 1);
+    pb_write_tag(&writer, CHUNK_FIELD_TRANSFER_ID, PB_WIRE_VARINT);
+    pb_write_varint(&writer, transfer_id);
+    pb_write_tag(&writer, CHUNK_FIELD_INDEX, PB_WIRE_VARINT);
+    pb_write_varint(&writer, index);
+    if (index == 0) {
+        pb_write_tag(&writer, CHUNK_FIELD_SIZE, PB_WIRE_VARINT);
+        pb_write_varint(&writer, size);
+        pb_write_tag(&writer, CHUNK_FIELD_TIMESTAMP, PB_WIRE_VARINT);
+        pb_write_varint(&writer, 1727185234);
+    }
+    pb_write_len(&writer, CHUNK_FIELD_DATA, data, len);
+    deserializer_handle_frame(des, frame, 1 + writer.len);
+}
+
+static void test_crc(deserializer_framing_t framing) {
+    static uint8_t const check[] = "123456789";
+    CHECK(crc32_update(0, check, 9) == 0xCBF43926);
+    CHECK(crc32_update(crc32_update(0, check, 4), check + 4, 5) == 0xCBF43926);
+
+    uint8_t small[1 + sizeof(hello_payload) + FRAME_CRC_LEN] = { FRAME_TYPE_PAYLOAD };
+    memcpy(small + 1, hello_payload, sizeof(hello_payload));
+    size_t small_len = frame_crc_append(small, 1 + sizeof(hello_payload));
+    CHECK(frame_crc_check(small, small_len) && !frame_crc_check(small, small_len - 1));
+
+    // Five frames; any bit error in the second one costs that frame only, or the third one too
+    // when it hits the COBS delimiter between them
+    uint8_t stream[5 * COBS_ENCODED_MAX_LEN(sizeof(small))];
+    size_t stream_len = append_frame(stream, 0, framing, small, small_len);
+    size_t second = stream_len;
+    for (int i = 1; i < 5; i++) {
+        stream_len = append_frame(stream, stream_len, framing, small, small_len);
+    }
+    static uint8_t const flips[] = { 0x01, 0x10, 0x80 };
+    for (size_t pos = second; pos < 2 * second; pos++) {
+        for (size_t f = 0; f < sizeof(flips); f++) {
+            for (size_t chunk = 7; chunk <= stream_len; chunk += stream_len - 7) {
+                uint8_t frame_buf[FRAME_DECODER_CRC_BUF_SIZE(64)];
+                char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+                capture_t cap = { 0 };
+                deserializer_t des;
+                deserializer_config_t config = test_config(&cap, frame_buf, 64, json_buf,
+                        sizeof(json_buf));
+                config.framing = framing;
+                config.frame_crc = true;
+                deserializer_init(&des, &config);
+                bool delimiter = framing == DESERIALIZER_FRAMING_COBS && stream[pos] == 0;
+                size_t lost = delimiter ? 2 : 1;
+                stream[pos] ^= flips[f];
+                for (size_t at = 0; at < stream_len; at += chunk) {
+                    size_t len = stream_len - at < chunk ? stream_len - at : chunk;
+                    deserializer_feed(&des, stream + at, len);
+                }
+                stream[pos] ^= flips[f];
+                CHECK(cap.count == 5 - lost && cap.errors >= 1);
+                CHECK(strcmp(cap.json[4 - lost], hello_json) == 0);
+                CHECK(!deserializer_frame_pending(&des));
+            }
+        }
+    }
+
+    // A streamed frame is checked once complete, and the sequenced one is not acknowledged
+    uint8_t frame[1100] = { FRAME_TYPE_SEQUENCED, 0, FRAME_TYPE_PAYLOAD };
+    char expected[JSON_PAYLOAD_MAX_LEN(1000)];
+    size_t large_len = 3 + encode_large_payload(frame + 3, sizeof(frame) - 3, 1000, expected,
+            sizeof(expected));
+    large_len = frame_crc_append(frame, large_len);
+    uint8_t large[COBS_ENCODED_MAX_LEN(sizeof(frame)) + sizeof(small) + 8];
+    for (int corrupt = 0; corrupt < 2; corrupt++) {
+        frame[500] ^= corrupt;
+        size_t len = append_frame(large, 0, framing, frame, large_len);
+        len = append_frame(large, len, framing, small, small_len);
+        frame[500] ^= corrupt;
+
+        uint8_t frame_buf[FRAME_DECODER_CRC_BUF_SIZE(64)];
+        char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+        capture_t cap = { 0 };
+        deserializer_t des;
+        deserializer_config_t config = test_config(&cap, frame_buf, 64, json_buf,
+                sizeof(json_buf));
+        config.framing = framing;
+        config.max_message_size = 1100;
+        config.frame_crc = true;
+        config.callbacks.send_reply = capture_reply;
+        config.callbacks.on_payload_chunk = capture_chunk;
+        deserializer_init(&des, &config);
+        for (size_t at = 0; at < len; at += 100) {
+            deserializer_feed(&des, large + at, len - at < 100 ? len - at : 100);
+        }
+        CHECK(cap.count == 1 && strcmp(cap.json[0], hello_json) == 0);
+        CHECK(des.stats.crc_errors == (uint32_t)corrupt && cap.errors == (size_t)corrupt);
+        CHECK(cap.streamed_payloads == (size_t)!corrupt);
+        if (!corrupt) {
+            CHECK(cap.streamed_len == strlen(expected));
+            CHECK(memcmp(cap.streamed, expected, strlen(expected)) == 0);
+            // The ACK carries a checksum too
+            size_t header = framing == DESERIALIZER_FRAMING_COBS ? 0 : 1;
+            size_t ack_len = cap.replies_len - header;
+            if (framing == DESERIALIZER_FRAMING_COBS) {
+                CHECK(cobs_decode_in_place(cap.replies, cap.replies_len - 1, &ack_len));
+            }
+            CHECK(ack_len == 2 + FRAME_CRC_LEN && frame_crc_check(cap.replies + header, ack_len));
+            CHECK(cap.replies[header] == FRAME_TYPE_ACK && cap.replies[header + 1] == 1);
+        } else {
+            CHECK(cap.replies_len == 0);
+        }
+    }
+
+    if (framing == DESERIALIZER_FRAMING_COBS) {
+        return;  // COBS resynchronizes on delimiters, there is no hunt
+    }
+
+    // Ten frames of exactly frame_size bytes: the hunt must hold a prefix and a whole frame
+    // to find the second one after a bit error in the first
+    uint8_t full[64] = { FRAME_TYPE_PAYLOAD };
+    char full_json[JSON_PAYLOAD_MAX_LEN(64)];
+    size_t full_len = 1 + encode_large_payload(full + 1, sizeof(full) - 1, 51, full_json,
+            sizeof(full_json));
+    full_len = frame_crc_append(full, full_len);
+    CHECK(full_len == sizeof(full));
+    uint8_t full_stream[10 * (2 + sizeof(full))];
+    size_t full_stream_len = append_frame(full_stream, 0, framing, full, full_len);
+    size_t full_second = full_stream_len;
+    for (int i = 1; i < 10; i++) {
+        full_stream_len = append_frame(full_stream, full_stream_len, framing, full, full_len);
+    }
+    for (size_t pos = 0; pos < full_second; pos++) {
+        for (size_t chunk = 64; chunk <= full_stream_len; chunk += full_stream_len - 64) {
+            uint8_t frame_buf[FRAME_DECODER_CRC_BUF_SIZE(64)];
+            char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+            capture_t cap = { 0 };
+            deserializer_t des;
+            deserializer_config_t config = test_config(&cap, frame_buf, 64, json_buf,
+                    sizeof(json_buf));
+            config.framing = framing;
+            config.frame_crc = true;
+            deserializer_init(&des, &config);
+            full_stream[pos] ^= 0x10;
+            for (size_t at = 0; at < full_stream_len; at += chunk) {
+                size_t len = full_stream_len - at < chunk ? full_stream_len - at : chunk;
+                deserializer_feed(&des, full_stream + at, len);
+            }
+            full_stream[pos] ^= 0x10;
+            CHECK(cap.count == 9 && des.stats.unpack_errors == 0);
+            CHECK(cap.lens[0] == full_len - 1 - FRAME_CRC_LEN);
+        }
+    }
+
+    // While hunting, an empty body followed by its CRC-32 of 0 is not taken for a frame
+    uint8_t hunted[10 + sizeof(small) + 1] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0x04 };
+    size_t hunted_len = append_frame(hunted, 10, framing, small, small_len);
+    uint8_t frame_buf[FRAME_DECODER_CRC_BUF_SIZE(64)];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, 64, json_buf, sizeof(json_buf));
+    config.framing = framing;
+    config.frame_crc = true;
+    deserializer_init(&des, &config);
+    deserializer_feed(&des, hunted, hunted_len);
+    CHECK(cap.count == 1 && strcmp(cap.json[0], hello_json) == 0);
+    CHECK(des.stats.unpack_errors == 0 && des.decoder.length_prefix.resyncs == 1);
+}
+
+static void test_binary_output(void) {
+    // The record of a canonical Payload is the Payload itself behind the marker and length
+    uint8_t record[64];
+    size_t len = binary_record_write(record, sizeof(record), 1727185234, "Hello, world!", 13);
+    CHECK(len == 2 + sizeof(hello_payload));
+    CHECK(record[0] == BINARY_RECORD_MARKER && record[1] == sizeof(hello_payload));
+    CHECK(memcmp(record + 2, hello_payload, sizeof(hello_payload)) == 0);
+    CHECK(binary_record_write(record, len - 1, 1727185234, "Hello, world!", 13) == 0);
+
+    // Every Batch entry becomes a record, an empty one included
+    uint8_t frame[64];
+    pb_writer_t writer;
+    frame[0] = FRAME_TYPE_BATCH;
+    pb_writer_init(&writer, frame + 1, sizeof(frame) - 1);
+    pb_write_len(&writer, BATCH_FIELD_PAYLOADS, hello_payload, sizeof(hello_payload));
+    pb_write_len(&writer, BATCH_FIELD_PAYLOADS, hello_payload, 0);
+    CHECK(!writer.overflow);
+
+    uint8_t frame_buf[64];
+    char out_buf[BINARY_RECORD_MAX_LEN(64)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), out_buf,
+            sizeof(out_buf));
+    config.output = DESERIALIZER_OUTPUT_BINARY;
+    config.callbacks.on_payload = capture_chunk;
+    deserializer_init(&des, &config);
+    deserializer_handle_frame(&des, frame, writer.len + 1);
+    static uint8_t const empty_record[] = { BINARY_RECORD_MARKER, 4, 0x08, 0x00, 0x12, 0x00 };
+    CHECK(cap.errors == 0 && des.stats.payloads == 2);
+    CHECK(cap.streamed_len == len + sizeof(empty_record));
+    CHECK(memcmp(cap.streamed, record, len) == 0);
+    CHECK(memcmp(cap.streamed + len, empty_record, sizeof(empty_record)) == 0);
+
+    // Streamed in pieces, the record is the same as written whole
+    uint8_t payload[1100];
+    char json[JSON_PAYLOAD_MAX_LEN(1000)];
+    uint8_t expected[BINARY_RECORD_MAX_LEN(1000)];
+    len = encode_large_payload(payload, sizeof(payload), 1000, json, sizeof(json));
+    payload_view_t view;
+    CHECK(payload_view_decode(payload, len, &view) == PAYLOAD_DECODE_OK);
+    size_t record_len = binary_record_write(
+            expected, sizeof(expected), view.timestamp, view.data, view.data_len);
+    CHECK(record_len == 1 + 2 + len);
+    for (size_t chunk = 1; chunk <= len; chunk = chunk * 5 + 1) {
+        payload_stream_t stream;
+        cap = (capture_t) { 0 };
+        payload_stream_init(&stream, capture_json, &cap);
+        payload_stream_set_binary(&stream, true, sizeof(payload));
+        for (size_t pos = 0; pos < len; pos += chunk) {
+            payload_stream_feed(&stream, payload + pos, len - pos < chunk ? len - pos : chunk);
+        }
+        CHECK(payload_stream_finish(&stream));
+        CHECK(cap.streamed_payloads == 1 && cap.streamed_len == record_len);
+        CHECK(memcmp(cap.streamed, expected, record_len) == 0);
+    }
+
+    // A streamed record cut short is padded to its announced length before the error
+    uint8_t frame_buf_small[32];
+    uint8_t stream[sizeof(payload) + 8];
+    uint8_t typed[1 + sizeof(payload)] = { FRAME_TYPE_PAYLOAD };
+    memcpy(typed + 1, payload, len);
+    size_t stream_len = append_frame(stream, 0, DESERIALIZER_FRAMING_LENGTH_PREFIX, typed, 1 + len);
+    cap = (capture_t) { 0 };
+    config.frame_buf = frame_buf_small;
+    config.frame_size = sizeof(frame_buf_small);
+    config.max_message_size = sizeof(typed);
+    config.callbacks.on_payload_chunk = capture_chunk;
+    deserializer_init(&des, &config);
+    deserializer_feed(&des, stream, stream_len / 2);
+    deserializer_reset(&des);
+    CHECK(cap.errors == 1 && cap.streamed_payloads == 0 && cap.streamed_len == record_len);
+    size_t fed = stream_len / 2 - (stream_len - len);  // Payload bytes before the cut
+    CHECK(memcmp(cap.streamed, expected, record_len - len + fed) == 0);
+    CHECK(cap.streamed[record_len - 1] == 0);
+}
+
+static void test_chunked(void) {
+    char data[1000];
+    char expected[JSON_PAYLOAD_MAX_LEN(sizeof(data))];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (char)(1 + i % 255);
+    }
+    json_write_payload(expected, sizeof(expected), 1727185234, data, sizeof(data));
+
+    uint8_t frame_buf[64];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    uint8_t chunk_buf[2 * sizeof(data)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    config.framing = DESERIALIZER_FRAMING_COBS;
+    config.chunk_buf = chunk_buf;
+    config.chunk_slot_size = sizeof(data);
+    config.chunk_slots = 2;
+    config.chunk_timeout_ms = 1000;
+    config.callbacks.on_payload_chunk = capture_chunk;
+    config.callbacks.now_ms = capture_now;
+    deserializer_init(&des, &config);
+
+    // 5 chunks of 200 bytes, with another message and a repeated chunk in between
+    uint8_t small[1 + sizeof(hello_payload)] = { FRAME_TYPE_PAYLOAD };
+    memcpy(small + 1, hello_payload, sizeof(hello_payload));
+    for (uint32_t index = 0; index < 5; index++) {
+        send_chunk(&des, 7, index, sizeof(data), data + index * 200, 200);
+        if (index == 2) {
+            deserializer_handle_frame(&des, small, sizeof(small));
+            send_chunk(&des, 7, 1, 0, data + 200, 200);
+        }
+    }
+    CHECK(cap.count == 1 && strcmp(cap.json[0], hello_json) == 0 && cap.errors == 0);
+    CHECK(cap.streamed_payloads == 1 && cap.streamed_len == strlen(expected));
+    CHECK(memcmp(cap.streamed, expected, strlen(expected)) == 0);
+    // Reported length: the 5 Chunk frames stored, headers included
+    CHECK(cap.streamed_payload_len > sizeof(data) + 5 * 4);
+    CHECK(cap.streamed_payload_len < sizeof(data) + 5 * 16);
+    CHECK(des.stats.chunks == 6 && des.stats.transfers == 1 && des.stats.payloads == 2);
+    CHECK(des.chunks.stats.duplicates == 1);
+
+    // Missing chunk, announced size too large, or more data than announced: dropped
+    cap = (capture_t) { 0 };
+    send_chunk(&des, 8, 0, sizeof(data), data, 200);
+    send_chunk(&des, 8, 2, 0, data, 200);
+    send_chunk(&des, 9, 0, sizeof(data) + 1, data, 200);
+    send_chunk(&des, 10, 0, 100, data, 200);
+    CHECK(cap.errors == 3 && des.stats.transfer_errors == 3 && cap.streamed_payloads == 0);
+    // The rest of a dropped transfer is ignored
+    send_chunk(&des, 8, 3, 0, data, 200);
+    CHECK(cap.errors == 3 && des.chunks.stats.orphans == 1);
+
+    // A transfer idle for longer than the timeout is dropped when the next chunk arrives
+    cap = (capture_t) { 0 };
+    send_chunk(&des, 11, 0, sizeof(data), data, 200);
+    cap.now_ms = 1001;
+    send_chunk(&des, 12, 0, sizeof(data), data, 200);
+    CHECK(cap.errors == 1 && des.chunks.stats.expired == 1);
+
+    // A third transfer evicts the least recently active one, 12
+    cap.now_ms = 1500;
+    send_chunk(&des, 13, 0, sizeof(data), data, 200);
+    cap.now_ms = 1600;
+    send_chunk(&des, 13, 1, 0, data + 200, 200);
+    send_chunk(&des, 14, 0, sizeof(data), data, 200);
+    CHECK(cap.errors == 2 && des.chunks.stats.evicted == 1);
+    for (uint32_t index = 2; index < 5; index++) {
+        send_chunk(&des, 13, index, 0, data + index * 200, 200);
+    }
+    CHECK(cap.streamed_payloads == 1 && memcmp(cap.streamed, expected, strlen(expected)) == 0);
+
+    // Without piecewise output, a transfer is rendered into json_buf if it fits
+    config.callbacks.on_payload_chunk = NULL;
+    deserializer_init(&des, &config);
+    cap = (capture_t) { 0 };
+    send_chunk(&des, 1, 0, 13, "Hello, ", 7);
+    send_chunk(&des, 1, 1, 0, "world!", 6);
+    send_chunk(&des, 2, 0, sizeof(data), data, 200);
+    for (uint32_t index = 1; index < 5; index++) {
+        send_chunk(&des, 2, index, 0, data + index * 200, 200);
+    }
+    CHECK(cap.count == 1 && strcmp(cap.json[0], hello_json) == 0);
+    CHECK(cap.errors == 1 && des.stats.json_errors == 1);
+
+    // Chunked transfers disabled: every Chunk is an unsupported frame
+    config.chunk_buf = NULL;
+    deserializer_init(&des, &config);
+    send_chunk(&des, 1, 0, 13, "Hello, ", 7);
+    send_chunk(&des, 1, 1, 0, "world!", 6);
+    CHECK(cap.count == 1 && cap.errors == 3 && des.stats.unpack_errors == 2);
+}
+
+static void test_batch(void) {
+    uint8_t frame[128];
+    pb_writer_t writer;
+
+    // Batch of three Payloads plus an unknown field, which is skipped
+    frame[0] = FRAME_TYPE_BATCH;
+    pb_writer_init(&writer, frame + 1, sizeof(frame) - 1);
+    pb_write_len(&writer, BATCH_FIELD_PAYLOADS, hello_payload, sizeof(hello_payload));
+    pb_write_tag(&writer, 7, PB_WIRE_VARINT);
+    pb_write_varint(&writer, 300);
+    pb_write_len(&writer, BATCH_FIELD_PAYLOADS, hello_payload, 0);
+    pb_write_len(&writer, BATCH_FIELD_PAYLOADS, hello_payload, sizeof(hello_payload));
+    CHECK(!writer.overflow);
+
+    uint8_t frame_buf[128];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(128)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    deserializer_init(&des, &config);
+    deserializer_handle_frame(&des, frame, writer.len + 1);
+    CHECK(cap.count == 3 && cap.errors == 0);
+    CHECK(strcmp(cap.json[0], hello_json) == 0);
+    CHECK(strcmp(cap.json[1], "{\"timestamp\":0,\"data\":\"\"}") == 0);
+    CHECK(strcmp(cap.json[2], hello_json) == 0);
+    CHECK(des.stats.frames == 1 && des.stats.batches == 1 && des.stats.payloads == 3);
+
+    // Entries before a truncated one are still emitted
+    cap = (capture_t) { 0 };
+    deserializer_handle_frame(&des, frame, 1 + 2 + sizeof(hello_payload) + 4);
+    CHECK(cap.count == 1 && cap.errors == 1);
+
+    // Empty frames and unknown frame types are rejected
+    static uint8_t const unknown_type[] = { 0x7f, 0x08, 0x01 };
+    cap = (capture_t) { 0 };
+    deserializer_handle_frame(&des, frame, 0);
+    deserializer_handle_frame(&des, unknown_type, sizeof(unknown_type));
+    CHECK(cap.count == 0 && cap.errors == 2);
+}
+
+static void test_latency_hist(void) {
+    latency_hist_t hist;
+
+    CHECK(latency_hist_bucket(0) == 0 && latency_hist_bucket(1) == 1);
+    CHECK(latency_hist_bucket(2) == 2 && latency_hist_bucket(3) == 2);
+    CHECK(latency_hist_bucket(4) == 3);
+    CHECK(latency_hist_bucket(UINT32_MAX) == LATENCY_HIST_BUCKETS - 1);
+    CHECK(latency_hist_bucket_max(0) == 0 && latency_hist_bucket_max(3) == 7);
+    CHECK(latency_hist_bucket_max(LATENCY_HIST_BUCKETS - 1) == UINT32_MAX);
+
+    latency_hist_reset(&hist);
+    CHECK(latency_hist_percentile(&hist, 50) == 0 && latency_hist_mean(&hist) == 0);
+
+    // 90 samples of 3 us and 10 of 100 us: percentiles are bucket bounds, capped by the max
+    for (int i = 0; i < 100; i++) {
+        latency_hist_add(&hist, i < 90 ? 3 : 100);
+    }
+    CHECK(hist.samples == 100 && hist.max_us == 100);
+    CHECK(hist.counts[2] == 90 && hist.counts[7] == 10);
+    CHECK(latency_hist_percentile(&hist, 0) == 3 && latency_hist_percentile(&hist, 50) == 3);
+    CHECK(latency_hist_percentile(&hist, 90) == 3 && latency_hist_percentile(&hist, 91) == 100);
+    CHECK(latency_hist_percentile(&hist, 100) == 100);
+    CHECK(latency_hist_mean(&hist) == 12);
+
+    // Decoding, rendering and output of every Batch entry are timed, a STATS frame is passed on
+    uint8_t frame[64];
+    pb_writer_t writer;
+    frame[0] = FRAME_TYPE_BATCH;
+    pb_writer_init(&writer, frame + 1, sizeof(frame) - 1);
+    pb_write_len(&writer, BATCH_FIELD_PAYLOADS, hello_payload, sizeof(hello_payload));
+    pb_write_len(&writer, BATCH_FIELD_PAYLOADS, hello_payload, sizeof(hello_payload));
+
+    uint8_t frame_buf[64];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    latency_hist_t stages[DESERIALIZER_STAGE_COUNT] = { 0 };
+    capture_t cap = { .tick_us = 5 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    config.stage_hists = stages;
+    config.callbacks.now_us = capture_now_us;
+    config.callbacks.on_stats_query = capture_stats_query;
+    deserializer_init(&des, &config);
+    deserializer_handle_frame(&des, frame, writer.len + 1);
+    CHECK(cap.count == 2 && cap.errors == 0);
+    CHECK(stages[DESERIALIZER_STAGE_DECODE].samples == 2);
+    CHECK(stages[DESERIALIZER_STAGE_RENDER].samples == 2);
+    CHECK(stages[DESERIALIZER_STAGE_OUTPUT].samples == 2);
+    CHECK(stages[DESERIALIZER_STAGE_OUTPUT].max_us == 5);
+    CHECK(stages[DESERIALIZER_STAGE_WAIT].samples == 0);
+
+    static uint8_t const query[] = { FRAME_TYPE_STATS, 0 };
+    deserializer_handle_frame(&des, query, 1);
+    deserializer_handle_frame(&des, query, 2);
+    CHECK(cap.stats_queries == 1 && cap.errors == 1);
+    CHECK(strcmp(deserializer_stage_name(DESERIALIZER_STAGE_DECODE), "decode") == 0);
+
+    // Without a clock or a query handler, nothing is timed but queries are still valid
+    memset(stages, 0, sizeof(stages));
+    cap = (capture_t) { .tick_us = 5 };
+    config.callbacks.now_us = NULL;
+    config.callbacks.on_stats_query = NULL;
+    deserializer_init(&des, &config);
+    deserializer_handle_frame(&des, frame, writer.len + 1);
+    deserializer_handle_frame(&des, query, 1);
+    CHECK(cap.count == 2 && cap.errors == 0 && stages[DESERIALIZER_STAGE_DECODE].samples == 0);
+}
+
+static void test_lzss(void) {
+    // Three literals, then a back-reference 3 bytes back, overlapping its own output
+    static uint8_t const repeat[] = { 0x08, 'a', 'b', 'c', 0x00, 0x46 };
+    static uint8_t const too_far[] = { 0x01, 0x00, 0x00 };
+    uint8_t out[16];
+    size_t len;
+
+    CHECK(lzss_decompress(repeat, sizeof(repeat), out, sizeof(out), &len));
+    CHECK(len == 12 && memcmp(out, "abcabcabcabc", 12) == 0);
+    CHECK(lzss_decompress(repeat, 0, out, sizeof(out), &len) && len == 0);
+    CHECK(!lzss_decompress(repeat, sizeof(repeat), out, 11, &len));
+    CHECK(!lzss_decompress(repeat, sizeof(repeat) - 1, out, sizeof(out), &len));
+    CHECK(!lzss_decompress(too_far, sizeof(too_far), out, sizeof(out), &len));
+
+    // With a dictionary, back-references start before the output and may run on into it
+    static uint8_t const dict_data[] = { 'x', 'y', 'z' };
+    static lzss_dict_t const dict = { .version = 1, .data = dict_data, .len = sizeof(dict_data) };
+    static uint8_t const from_dict[] = { 0x01, 0x00, 0x42 };
+    static uint8_t const past_dict[] = { 0x01, 0x00, 0x60 };
+    CHECK(lzss_decompress_dict(&dict, from_dict, sizeof(from_dict), out, sizeof(out), &len));
+    CHECK(len == 5 && memcmp(out, "xyzxy", 5) == 0);
+    CHECK(!lzss_decompress_dict(&dict, past_dict, sizeof(past_dict), out, sizeof(out), &len));
+    CHECK(!lzss_decompress(from_dict, sizeof(from_dict), out, sizeof(out), &len));
+}
+
+static void test_compressed(void) {
+    // Batch frame of four hello_payload, 93 bytes, compressed by serializer.lzss_compress()
+    static uint8_t const batch[] = { FRAME_TYPE_COMPRESSED, 0x00, 0x01, 0x0a, 0x15, 0x08, 0xd2,
+        0x82, 0xcb, 0xb7, 0x00, 0x06, 0x12, 0x0d, 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x00, 0x2c, 0x20,
+        0x77, 0x6f, 0x72, 0x6c, 0x64, 0x21, 0x03, 0x02, 0xdf, 0x02, 0xdf, 0x21 };
+    // A compressed frame holding another compressed frame (literals 0x09 0x00)
+    static uint8_t const nested[] = { FRAME_TYPE_COMPRESSED, 0x00, FRAME_TYPE_COMPRESSED, 0x00 };
+    // The batch inside a sequenced frame
+    uint8_t sequenced[sizeof(batch) + 2] = { FRAME_TYPE_SEQUENCED, 0 };
+    memcpy(sequenced + 2, batch, sizeof(batch));
+
+    uint8_t frame_buf[64];
+    uint8_t decompress_buf[128];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    config.decompress_buf = decompress_buf;
+    config.decompress_size = sizeof(decompress_buf);
+    config.callbacks.send_reply = capture_reply;
+    deserializer_init(&des, &config);
+
+    // Decompressed frames are handled like the original, sequenced or not
+    deserializer_handle_frame(&des, batch, sizeof(batch));
+    deserializer_handle_frame(&des, sequenced, sizeof(sequenced));
+    CHECK(cap.count == 8 && cap.errors == 0);
+    CHECK(strcmp(cap.json[0], hello_json) == 0 && strcmp(cap.json[7], hello_json) == 0);
+    CHECK(cap.lens[0] == sizeof(hello_payload));
+    CHECK(des.stats.compressed == 2 && des.stats.batches == 2 && des.window.expected_seq == 1);
+
+    // Compressed frames inside compressed frames, and frames decompressing to more than the
+    // buffer, are dropped
+    cap = (capture_t) { 0 };
+    deserializer_handle_frame(&des, nested, sizeof(nested));
+    des.config.decompress_size = 92;
+    deserializer_handle_frame(&des, batch, sizeof(batch));
+    CHECK(cap.count == 0 && cap.errors == 2 && des.stats.compressed == 2);
+
+    // Without a decompression buffer compressed frames are unsupported
+    config.decompress_buf = NULL;
+    deserializer_init(&des, &config);
+    deserializer_handle_frame(&des, batch, sizeof(batch));
+    CHECK(cap.count == 0 && cap.errors == 3 && des.stats.unpack_errors == 1);
+}
+
+static void test_dict_compressed(void) {
+    // Payload "sensor reading ok", 26 bytes, compressed by serializer.compress_frame() against
+    // version 1 of the dictionary: "sensor reading " is a single back-reference into it
+    static uint8_t const payload[] = { FRAME_TYPE_DICT_COMPRESSED, LZSS_DICT_VERSION, 0x00, 0x00,
+        0x08, 0xd2, 0x82, 0xcb, 0xb7, 0x06, 0x12, 0x02, 0x11, 0x02, 0xec, 'o', 'k' };
+    uint8_t other_version[sizeof(payload)];
+    memcpy(other_version, payload, sizeof(payload));
+    other_version[1] = LZSS_DICT_VERSION + 1;
+
+    uint8_t frame_buf[64];
+    uint8_t decompress_buf[128];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    config.decompress_buf = decompress_buf;
+    config.decompress_size = sizeof(decompress_buf);
+    config.dict = &lzss_telemetry_dict;
+    deserializer_init(&des, &config);
+
+    deserializer_handle_frame(&des, payload, sizeof(payload));
+    CHECK(cap.count == 1 && cap.errors == 0 && des.stats.compressed == 1);
+    CHECK(strcmp(cap.json[0], "{\"timestamp\":1727185234,\"data\":\"sensor reading ok\"}") == 0);
+
+    // Another dictionary version, or no dictionary at all, is reported rather than decoded
+    deserializer_handle_frame(&des, other_version, sizeof(other_version));
+    CHECK(cap.count == 1 && cap.errors == 1 && des.stats.dict_mismatches == 1);
+    config.dict = NULL;
+    deserializer_init(&des, &config);
+    deserializer_handle_frame(&des, payload, sizeof(payload));
+    CHECK(cap.count == 1 && cap.errors == 2 && des.stats.dict_mismatches == 1);
+    CHECK(des.stats.unpack_errors == 0);
+}
+
+static void test_delta_batch(void) {
+    static int32_t const deltas[] = { 0, 0, 2, -1 };
+    static char const* const data[] = { "a", "b", "", "d" };
+    uint8_t frame[128];
+    uint8_t packed[8];
+    pb_writer_t writer;
+    pb_writer_t packed_writer;
+
+    CHECK(pb_zigzag_encode32(-1) == 1 && pb_zigzag_encode32(2) == 4);
+    CHECK(pb_zigzag_decode32(pb_zigzag_encode32(INT32_MIN)) == INT32_MIN);
+
+    // Deltas packed in one field, as the proto3 encoders write them
+    frame[0] = FRAME_TYPE_DELTA_BATCH;
+    pb_writer_init(&writer, frame + 1, sizeof(frame) - 1);
+    pb_write_tag(&writer, DELTA_BATCH_FIELD_BASE_TIMESTAMP, PB_WIRE_VARINT);
+    pb_write_varint(&writer, 1727185234);
+    pb_writer_init(&packed_writer, packed, sizeof(packed));
+    for (size_t i = 0; i < 4; i++) {
+        pb_write_varint(&packed_writer, pb_zigzag_encode32(deltas[i]));
+    }
+    pb_write_len(&writer, DELTA_BATCH_FIELD_TIMESTAMP_DELTAS, packed, packed_writer.len);
+    for (size_t i = 0; i < 4; i++) {
+        pb_write_len(&writer, DELTA_BATCH_FIELD_DATA, data[i], strlen(data[i]));
+    }
+    size_t packed_len = writer.len + 1;
+
+    uint8_t frame_buf[128];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(128)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    deserializer_init(&des, &config);
+    deserializer_handle_frame(&des, frame, packed_len);
+    CHECK(cap.count == 4 && cap.errors == 0);
+    CHECK(strcmp(cap.json[0], "{\"timestamp\":1727185234,\"data\":\"a\"}") == 0);
+    CHECK(strcmp(cap.json[1], "{\"timestamp\":1727185234,\"data\":\"b\"}") == 0);
+    CHECK(strcmp(cap.json[2], "{\"timestamp\":1727185236,\"data\":\"\"}") == 0);
+    CHECK(strcmp(cap.json[3], "{\"timestamp\":1727185235,\"data\":\"d\"}") == 0);
+    CHECK(cap.lens[0] == 1 + 3 && cap.lens[2] == 1 + 2);
+
+    // Unpacked deltas interleaved with the data entries and an unknown field
+    pb_writer_init(&writer, frame + 1, sizeof(frame) - 1);
+    pb_write_tag(&writer, DELTA_BATCH_FIELD_BASE_TIMESTAMP, PB_WIRE_VARINT);
+    pb_write_varint(&writer, 10);
+    for (size_t i = 0; i < 4; i++) {
+        pb_write_len(&writer, DELTA_BATCH_FIELD_DATA, data[i], strlen(data[i]));
+        pb_write_tag(&writer, 9, PB_WIRE_VARINT);
+        pb_write_varint(&writer, 1);
+        pb_write_tag(&writer, DELTA_BATCH_FIELD_TIMESTAMP_DELTAS, PB_WIRE_VARINT);
+        pb_write_varint(&writer, pb_zigzag_encode32(deltas[i]));
+    }
+    cap = (capture_t) { 0 };
+    deserializer_handle_frame(&des, frame, writer.len + 1);
+    CHECK(cap.count == 4 && cap.errors == 0);
+    CHECK(strcmp(cap.json[3], "{\"timestamp\":11,\"data\":\"d\"}") == 0);
+
+    // A missing delta or a truncated field rejects the whole frame before any output
+    cap = (capture_t) { 0 };
+    deserializer_handle_frame(&des, frame, writer.len + 1 - 2);
+    deserializer_handle_frame(&des, frame, writer.len + 1 - 1);
+    CHECK(cap.count == 0 && cap.errors == 2);
+    CHECK(des.stats.batches == 4 && des.stats.payloads == 8);
+}
+
+static void test_baud_switch(void) {
+    // BaudSwitch frames for 115200, 9600 and 230400 baud
+    static uint8_t const to_115200[] = { FRAME_TYPE_BAUD, 0x08, 0x80, 0x84, 0x07 };
+    static uint8_t const to_9600[] = { FRAME_TYPE_BAUD, 0x08, 0x80, 0x4b };
+    static uint8_t const to_230400[] = { FRAME_TYPE_BAUD, 0x08, 0x80, 0x88, 0x0e };
+    uint8_t probe[1 + DESERIALIZER_BAUD_PROBE_LEN] = { FRAME_TYPE_BAUD_PROBE };
+    for (size_t i = 0; i < DESERIALIZER_BAUD_PROBE_LEN; i++) {
+        probe[1 + i] = DESERIALIZER_BAUD_PROBE_BYTE(i);
+    }
+
+    uint8_t frame_buf[64];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    config.baud_rate = 9600;
+    config.max_baud_rate = 115200;
+    config.baud_timeout_ms = 1000;
+    config.callbacks.send_reply = capture_reply;
+    config.callbacks.now_ms = capture_now;
+    config.callbacks.set_baud_rate = capture_baud;
+    deserializer_init(&des, &config);
+
+    // Above max_baud_rate: refused, the echo names the current rate
+    deserializer_handle_frame(&des, to_230400, sizeof(to_230400));
+    CHECK(cap.replies_len == 5 && memcmp(cap.replies, "\x04\x0b\x08\x80\x4b", 5) == 0);
+    CHECK(cap.baud_rate == 0 && des.baud.rate == 9600);
+
+    // Echoed, then switched, on probation until confirmed
+    cap.replies_len = 0;
+    deserializer_handle_frame(&des, to_115200, sizeof(to_115200));
+    CHECK(cap.replies_len == 6 && memcmp(cap.replies, "\x05\x0b\x08\x80\x84\x07", 6) == 0);
+    CHECK(cap.baud_rate == 115200 && des.baud.probation);
+
+    // Probes are answered with their error count, a missing byte counting as one
+    cap.replies_len = 0;
+    deserializer_handle_frame(&des, probe, sizeof(probe));
+    probe[5] ^= 0x10;
+    deserializer_handle_frame(&des, probe, sizeof(probe) - 1);
+    CHECK(cap.replies_len == 6 && memcmp(cap.replies, "\x02\x0c\x00\x02\x0c\x02", 6) == 0);
+
+    // Confirmed by a second request for the same rate, which is then kept
+    deserializer_handle_frame(&des, to_115200, sizeof(to_115200));
+    CHECK(!des.baud.probation && des.stats.baud_switches == 1);
+    cap.now_ms = 5000;
+    CHECK(!deserializer_check_baud(&des));
+    CHECK(des.baud.rate == 115200 && des.stats.baud_reverts == 0);
+
+    // A switch left unconfirmed is undone after baud_timeout_ms
+    deserializer_handle_frame(&des, to_9600, sizeof(to_9600));
+    CHECK(cap.baud_rate == 9600 && des.baud.probation);
+    cap.now_ms += 999;
+    CHECK(!deserializer_check_baud(&des));
+    CHECK(cap.baud_rate == 9600);
+    cap.now_ms += 1;
+    CHECK(deserializer_check_baud(&des));
+    CHECK(cap.baud_rate == 115200 && des.baud.rate == 115200 && !des.baud.probation);
+    CHECK(des.stats.baud_reverts == 1 && des.stats.baud_switches == 1 && cap.errors == 0);
+
+    // Without set_baud_rate every switch is refused
+    config.callbacks.set_baud_rate = NULL;
+    deserializer_init(&des, &config);
+    cap.replies_len = 0;
+    deserializer_handle_frame(&des, to_115200, sizeof(to_115200));
+    CHECK(cap.replies_len == 5 && memcmp(cap.replies, "\x04\x0b\x08\x80\x4b", 5) == 0);
+    CHECK(des.baud.rate == 9600 && !des.baud.probation);
+
+    // A switch failing after the echo leaves the rate as it was, off probation
+    config.callbacks.set_baud_rate = capture_baud;
+    deserializer_init(&des, &config);
+    cap = (capture_t) { .baud_max = 57600 };
+    deserializer_handle_frame(&des, to_115200, sizeof(to_115200));
+    CHECK(cap.replies_len == 6 && memcmp(cap.replies, "\x05\x0b\x08\x80\x84\x07", 6) == 0);
+    CHECK(cap.baud_rate == 0 && des.baud.rate == 9600 && !des.baud.probation);
+    cap.now_ms = 5000;
+    CHECK(!deserializer_check_baud(&des) && des.stats.baud_reverts == 0);
+
+    // Unless can_set_baud_rate refuses the rate before it is echoed
+    config.callbacks.can_set_baud_rate = capture_can_baud;
+    deserializer_init(&des, &config);
+    cap.replies_len = 0;
+    deserializer_handle_frame(&des, to_115200, sizeof(to_115200));
+    CHECK(cap.replies_len == 5 && memcmp(cap.replies, "\x04\x0b\x08\x80\x4b", 5) == 0);
+    CHECK(cap.baud_rate == 0 && des.baud.rate == 9600 && !des.baud.probation);
+}
+
+static void test_autobaud(void) {
+    uint8_t payload[1 + sizeof(hello_payload)] = { FRAME_TYPE_PAYLOAD };
+    memcpy(payload + 1, hello_payload, sizeof(hello_payload));
+    static uint8_t const garbage[] = { FRAME_TYPE_PAYLOAD, 0xff };
+
+    // Measured rates are taken for the standard rate within 1/32 of them
+    CHECK(deserializer_standard_baud(117000) == 115200);
+    CHECK(deserializer_standard_baud(930232) == 921600);
+    CHECK(deserializer_standard_baud(125000) == 0 && deserializer_standard_baud(0) == 0);
+
+    uint8_t frame_buf[64];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    capture_t cap = { .measured = 114000 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    config.baud_rate = 9600;
+    config.autobaud_errors = 3;
+    config.callbacks.set_baud_rate = capture_baud;
+    config.callbacks.measure_baud_rate = capture_measure;
+    deserializer_init(&des, &config);
+
+    // A decoded Payload ends the run of bad frames
+    deserializer_handle_frame(&des, garbage, sizeof(garbage));
+    deserializer_handle_frame(&des, garbage, sizeof(garbage));
+    CHECK(!deserializer_check_baud(&des));
+    deserializer_handle_frame(&des, payload, sizeof(payload));
+    deserializer_handle_frame(&des, garbage, sizeof(garbage));
+    deserializer_handle_frame(&des, garbage, sizeof(garbage));
+    CHECK(!deserializer_check_baud(&des) && cap.baud_rate == 0);
+
+    // The third bad frame in a row: switched to the measured rate, which is kept
+    deserializer_handle_frame(&des, garbage, sizeof(garbage));
+    CHECK(deserializer_check_baud(&des));
+    CHECK(cap.baud_rate == 115200 && des.baud.rate == 115200 && !des.baud.probation);
+    CHECK(des.stats.baud_detections == 1 && cap.errors == 5);
+
+    // Measuring the current rate, or nothing, changes nothing
+    for (int i = 0; i < 3; i++) {
+        deserializer_handle_frame(&des, garbage, sizeof(garbage));
+    }
+    CHECK(!deserializer_check_baud(&des));
+    cap.measured = 0;
+    for (int i = 0; i < 3; i++) {
+        deserializer_handle_frame(&des, garbage, sizeof(garbage));
+    }
+    CHECK(!deserializer_check_baud(&des));
+    CHECK(des.baud.rate == 115200 && des.stats.baud_detections == 1);
+}
+
+// Feed a sequenced frame carrying hello_payload
+static void send_sequenced(deserializer_t* des, uint8_t seq) {
+    uint8_t frame[3 + sizeof(hello_payload)] = { FRAME_TYPE_SEQUENCED, seq, FRAME_TYPE_PAYLOAD };
+    memcpy(frame + 3, hello_payload, sizeof(hello_payload));
+    deserializer_handle_frame(des, frame, sizeof(frame));
+}
+
+static void test_sequenced(void) {
+    uint8_t frame_buf[64];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    config.callbacks.send_reply = capture_reply;
+    deserializer_init(&des, &config);
+
+    // SYNC close to the end of the sequence space, so numbering wraps around below
+    static uint8_t const sync[] = { FRAME_TYPE_SYNC, 250 };
+    deserializer_handle_frame(&des, sync, sizeof(sync));
+    CHECK(cap.replies_len == 3 && memcmp(cap.replies, "\x02\x05\xfa", 3) == 0);
+
+    // In order: decoded and acknowledged
+    cap.replies_len = 0;
+    send_sequenced(&des, 250);
+    CHECK(cap.count == 1 && strcmp(cap.json[0], hello_json) == 0);
+    CHECK(cap.lens[0] == sizeof(hello_payload));
+    CHECK(cap.replies_len == 3 && memcmp(cap.replies, "\x02\x05\xfb", 3) == 0);
+
+    // 251 lost: 252 and 253 are dropped, with a single NACK for 251
+    cap.replies_len = 0;
+    send_sequenced(&des, 252);
+    send_sequenced(&des, 253);
+    CHECK(cap.count == 1);
+    CHECK(cap.replies_len == 3 && memcmp(cap.replies, "\x02\x06\xfb", 3) == 0);
+    CHECK(des.stats.out_of_order == 2);
+
+    // A duplicate of 250 is acknowledged again but not decoded
+    cap.replies_len = 0;
+    send_sequenced(&des, 250);
+    CHECK(cap.count == 1 && des.stats.duplicates == 1);
+    CHECK(cap.replies_len == 3 && memcmp(cap.replies, "\x02\x05\xfb", 3) == 0);
+
+    // The sender goes back to 251 and resends everything, across the wraparound
+    cap.replies_len = 0;
+    for (unsigned seq = 251; seq <= 256 + 1; seq++) {
+        send_sequenced(&des, (uint8_t)seq);
+    }
+    CHECK(cap.count == 8 && cap.errors == 0);
+    CHECK(cap.replies_len == 7 * 3 && memcmp(cap.replies + 6 * 3, "\x02\x05\x02", 3) == 0);
+    CHECK(des.stats.payloads == 8);
+
+    // Malformed control frames are rejected without a reply
+    static uint8_t const short_sequenced[] = { FRAME_TYPE_SEQUENCED, 2 };
+    static uint8_t const long_sync[] = { FRAME_TYPE_SYNC, 0, 0 };
+    cap.replies_len = 0;
+    deserializer_handle_frame(&des, short_sequenced, sizeof(short_sequenced));
+    deserializer_handle_frame(&des, long_sync, sizeof(long_sync));
+    CHECK(cap.errors == 2 && cap.replies_len == 0);
+
+    // With COBS framing, replies are COBS frames too
+    config.framing = DESERIALIZER_FRAMING_COBS;
+    deserializer_init(&des, &config);
+    static uint8_t const sync_zero[] = { FRAME_TYPE_SYNC, 0 };
+    cap.replies_len = 0;
+    deserializer_handle_frame(&des, sync_zero, sizeof(sync_zero));
+    CHECK(cap.replies_len == 4 && memcmp(cap.replies, "\x02\x05\x01\x00", 4) == 0);
+}
+
+static void test_credit(void) {
+    uint8_t frame_buf[64];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    capture_t cap = { 0 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    config.callbacks.send_reply = capture_reply;
+
+    // Credit { consumed: 300, window: 256 }, as serializer.py parses it
+    deserializer_init(&des, &config);
+    deserializer_send_credit(&des, 300, 256);
+    CHECK(cap.replies_len == 8);
+    CHECK(memcmp(cap.replies, "\x07\x07\x08\xac\x02\x10\x80\x02", 8) == 0);
+
+    // Largest values, COBS framing
+    config.framing = DESERIALIZER_FRAMING_COBS;
+    deserializer_init(&des, &config);
+    cap.replies_len = 0;
+    deserializer_send_credit(&des, UINT32_MAX, UINT32_MAX);
+    size_t len;
+    CHECK(cap.replies_len > 0 && cap.replies[cap.replies_len - 1] == COBS_DELIMITER);
+    CHECK(cobs_decode_in_place(cap.replies, cap.replies_len - 1, &len) && len == 13);
+    CHECK(cap.replies[0] == FRAME_TYPE_CREDIT && cap.replies[6] == 0x0f);
+}
+
+static void test_stats_reply(void) {
+    uint8_t frame_buf[64];
+    char json_buf[JSON_PAYLOAD_MAX_LEN(64)];
+    latency_hist_t stages[DESERIALIZER_STAGE_COUNT] = { 0 };
+    capture_t cap = { .tick_us = 5 };
+    deserializer_t des;
+    deserializer_config_t config = test_config(&cap, frame_buf, sizeof(frame_buf), json_buf,
+            sizeof(json_buf));
+    config.stage_hists = stages;
+    config.callbacks.send_reply = capture_reply;
+    config.callbacks.now_us = capture_now_us;
+    config.callbacks.on_stats_query = capture_stats_query;
+    deserializer_init(&des, &config);
+
+    // A Payload, then a query: the reply holds the pipeline and caller counters, zeros left out
+    uint8_t frame[1 + sizeof(hello_payload)] = { FRAME_TYPE_PAYLOAD };
+    memcpy(frame + 1, hello_payload, sizeof(hello_payload));
+    deserializer_handle_frame(&des, frame, sizeof(frame));
+    static uint8_t const query[] = { FRAME_TYPE_STATS };
+    deserializer_handle_frame(&des, query, sizeof(query));
+    CHECK(cap.count == 1 && cap.stats_queries == 1);
+
+    pb_reader_t reader;
+    uint64_t len;
+    pb_reader_init(&reader, cap.replies, cap.replies_len);
+    CHECK(pb_read_varint(&reader, &len) && (uint64_t)(reader.end - reader.pos) == len);
+    CHECK(reader.pos[0] == FRAME_TYPE_STATS);
+    pb_reader_init(&reader, reader.pos + 1, len - 1);
+
+    uint64_t counters[STATS_FIELD_STAGES] = { 0 };
+    latency_hist_t const* expected = stages;
+    size_t stage_count = 0;
+    uint32_t field;
+    uint32_t wire_type;
+    while (!pb_reader_done(&reader)) {
+        CHECK(pb_read_tag(&reader, &field, &wire_type));
+        if (field != STATS_FIELD_STAGES) {
+            CHECK(field < STATS_FIELD_STAGES && pb_read_varint(&reader, &counters[field]));
+            continue;
+        }
+        // Every stage in order, each with its sample count and max
+        uint8_t const* stage;
+        size_t stage_len;
+        uint64_t samples = 0;
+        uint64_t max_us = 0;
+        pb_reader_t stage_reader;
+        CHECK(pb_read_len(&reader, &stage, &stage_len));
+        pb_reader_init(&stage_reader, stage, stage_len);
+        while (!pb_reader_done(&stage_reader)) {
+            uint64_t value;
+            CHECK(pb_read_tag(&stage_reader, &field, &wire_type));
+            CHECK(pb_read_varint(&stage_reader, &value));
+            samples = field == STAGE_STATS_FIELD_SAMPLES ? value : samples;
+            max_us = field == STAGE_STATS_FIELD_MAX_US ? value : max_us;
+        }
+        CHECK(samples == expected->samples && max_us == expected->max_us);
+        expected++;
+        stage_count++;
+    }
+    CHECK(stage_count == DESERIALIZER_STAGE_COUNT);
+    CHECK(stages[DESERIALIZER_STAGE_DECODE].samples == 1);
+    CHECK(counters[STATS_FIELD_FRAMES] == 2 && counters[STATS_FIELD_PAYLOADS] == 1);
+    CHECK(counters[STATS_FIELD_BYTES] == sizeof(frame) + sizeof(query));
+    CHECK(counters[STATS_FIELD_OVERFLOWS] == 3 && counters[STATS_FIELD_MIN_FREE_HEAP] == 200000);
+    CHECK(counters[STATS_FIELD_UNPACK_ERRORS] == 0 && counters[STATS_FIELD_UPTIME_MS] == 0);
+
+    // Longer than 127 bytes with large counters, so the length prefix takes two bytes
+    des.stats.frames = des.stats.payloads = des.stats.bytes = UINT32_MAX;
+    des.stats.unpack_errors = des.stats.framing_errors = des.stats.crc_errors = UINT32_MAX;
+    for (int i = 0; i < DESERIALIZER_STAGE_COUNT; i++) {
+        latency_hist_add(&stages[i], UINT32_MAX);
+    }
+    cap.replies_len = 0;
+    deserializer_handle_frame(&des, query, sizeof(query));
+    pb_reader_init(&reader, cap.replies, cap.replies_len);
+    CHECK(pb_read_varint(&reader, &len) && len > 127 && reader.pos == cap.replies + 2);
+    CHECK(len == cap.replies_len - 2 && cap.replies[2] == FRAME_TYPE_STATS);
+
+    // Without stage histograms there are no StageStats
+    config.stage_hists = NULL;
+    cap = (capture_t) { 0 };
+    deserializer_init(&des, &config);
+    deserializer_handle_frame(&des, query, sizeof(query));
+    CHECK(cap.replies_len == 12);
+    CHECK(memcmp(cap.replies, "\x0b\x0d\x10\x01\x20\x01\x40\x03\x70\xc0\x9a\x0c", 12) == 0);
+}
+
+int main(void) {
+    test_frame_decoder();
+    test_cobs();
+    test_frame_ring();
+    test_payload_decoder();
+    test_json_writer();
+    test_pipeline(DESERIALIZER_FRAMING_LENGTH_PREFIX);
+    test_pipeline(DESERIALIZER_FRAMING_COBS);
+    test_payload_stream();
+    test_streaming(DESERIALIZER_FRAMING_LENGTH_PREFIX);
+    test_streaming(DESERIALIZER_FRAMING_COBS);
+    test_crc(DESERIALIZER_FRAMING_LENGTH_PREFIX);
+    test_crc(DESERIALIZER_FRAMING_COBS);
+    test_binary_output();
+    test_chunked();
+    test_batch();
+    test_delta_batch();
+    test_latency_hist();
+    test_lzss();
+    test_compressed();
+    test_dict_compressed();
+    test_baud_switch();
+    test_autobaud();
+    test_sequenced();
+    test_credit();
+    test_stats_reply();
+
+    if (failures != 0) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All deserializer core tests passed\n");
+    return 0;
+}
@@ -6,42 +6,337 @@
  * and converts it to JSON format for further processing. It implements a UART
  * communication interface with protobuf-c library integration.
  *
+ * Framing, decoding and JSON rendering live in the portable deserializer_core
+ * component; this file only connects it to the UART driver and the log output.
+ * The TX line carries the acknowledgements of sequenced frames back to the PC,
+ * the credits of credit-based flow control when it is enabled, and the answer
+ * to a STATS frame: a Stats message with the pipeline counters, the UART
+ * overflows, the high-water marks of the receive buffer and of the queues
+ * between tasks, and the lowest free heap, so that the link can be monitored
+ * from the PC without a console.
+ *
+ * With CONFIG_DESERIALIZER_PIPELINE the work is split between three tasks:
+ * uart_task only delimits frames and queues them in a lock-free frame ring,
+ * decode_task decodes and renders them and queues the JSON in a ring buffer,
+ * and output_task logs it. Reception is never held up by the log output.
+ *
+ * With CONFIG_DESERIALIZER_ASYNC_LOG decoding is not held up by it either: the
+ * renderings are copied into the output ring buffer without waiting, for
+ * output_task to log (an output task is started for uart_task too), and those
+ * that find it full are counted and reported instead of logged.
+ *
+ * Otherwise messages longer than the frame buffer, up to
+ * CONFIG_DESERIALIZER_MAX_MESSAGE_SIZE bytes, are decoded as their bytes are
+ * read and their JSON rendering is logged piece by piece.
+ *
+ * In both modes, with CONFIG_DESERIALIZER_CHUNKED_TRANSFER, large Payloads may
+ * also arrive as chunked transfers, reassembled in a static pool of buffers and
+ * logged piece by piece as well. With CONFIG_DESERIALIZER_COMPRESSION, frames
+ * may arrive LZSS-compressed, possibly against the built-in dictionary
+ * (lzss_dict.h), and are decompressed into a static buffer.
+ *
+ * With CONFIG_DESERIALIZER_BAUD_NEGOTIATION the PC may move the link to a faster
+ * baud rate once connected: the new rate is probed and must be confirmed within
+ * CONFIG_DESERIALIZER_BAUD_TIMEOUT_MS, or the UART falls back to the last
+ * confirmed rate (see deserializer.h). With CONFIG_DESERIALIZER_AUTOBAUD, a
+ * run of frames that fail to decode has the rate of the RX signal measured by
+ * the UART auto-baud counters, and the UART follows a sender using another one.
+ *
+ * With CONFIG_DESERIALIZER_FRAME_CRC every frame ends with a CRC-32, checked
+ * with the ROM routine: frames hit by bit errors are dropped, and decoding
+ * resumes at the next intact frame (see frame_decoder.h).
+ *
+ * With CONFIG_DESERIALIZER_OUTPUT_BINARY messages are not rendered to JSON:
+ * their binary record (binary_record.h) is written to the console instead, for
+ * tools that would only parse the JSON again. Records are never cut short or
+ * interleaved with log lines, so the reader stays in step with them.
+ *
+ * With CONFIG_DESERIALIZER_STAGE_STATS the time spent in every stage, from the
+ * UART event wait to the log write, is counted in a histogram per stage
+ * (latency_hist.h), logged every CONFIG_DESERIALIZER_STAGE_STATS_INTERVAL
+ * seconds and summarized in the Stats replies. Without it the timing code is
+ * compiled out.
+ *
  * @author Juan Ignacio Giorgetti
  * @date 2025
  * @version 1.0
  */
 
+#include <inttypes.h>
+#include <stdalign.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
 
-#include "cJSON.h"
+#include "arena.h"
+#include "binary_record.h"
+#include "cobs.h"
+#include "deserializer.h"
 #include "driver/uart.h"
 #include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
+#include "frame_ring.h"
+#include "json_writer.h"
 #include "message.pb-c.h"
 #include "sdkconfig.h"
+#if CONFIG_DESERIALIZER_AUTOBAUD
+#include "esp_private/esp_clk.h"
+#include "hal/uart_ll.h"
+#endif
+#if CONFIG_DESERIALIZER_BAUD_NEGOTIATION
+#include "soc/soc_caps.h"
+#endif
 
 // UART configuration parameters from Kconfig
 #define UART_NUM CONFIG_DESERIALIZER_UART_NUMBER
 #define UART_TX CONFIG_DESERIALIZER_UART_TX_PIN
 #define UART_RX CONFIG_DESERIALIZER_UART_RX_PIN
 #define UART_BAUD_RATE CONFIG_DESERIALIZER_UART_BAUD_RATE
+#if CONFIG_DESERIALIZER_UART_HW_FLOW_CONTROL
+#define UART_RTS CONFIG_DESERIALIZER_UART_RTS_PIN
+#define UART_CTS CONFIG_DESERIALIZER_UART_CTS_PIN
+#define UART_FLOW_CTRL UART_HW_FLOWCTRL_CTS_RTS
+#define UART_RX_FLOW_CTRL_THRESH CONFIG_DESERIALIZER_UART_RX_FLOW_CTRL_THRESH
+#else
+#define UART_RTS UART_PIN_NO_CHANGE
+#define UART_CTS UART_PIN_NO_CHANGE
+#define UART_FLOW_CTRL UART_HW_FLOWCTRL_DISABLE
+#define UART_RX_FLOW_CTRL_THRESH 0
+#endif
 
 // Buffer and task configuration
 #define BUFF_SIZE 256
+#define FRAME_SIZE BUFF_SIZE  // Largest accepted protobuf message
+#define ARENA_SIZE (FRAME_SIZE + 128)  // Unpacked message: strings plus struct overhead
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY && CONFIG_DESERIALIZER_COMPRESSION
+#define JSON_SIZE BINARY_RECORD_MAX_LEN(DECOMPRESS_SIZE)  // Record of the largest original frame
+#elif CONFIG_DESERIALIZER_OUTPUT_BINARY
+#define JSON_SIZE BINARY_RECORD_MAX_LEN(FRAME_SIZE)  // Record of the largest message
+#else
+#define JSON_SIZE JSON_PAYLOAD_MAX_LEN(FRAME_SIZE)  // Rendered message, worst-case escaping
+#endif
+#if CONFIG_DESERIALIZER_PIPELINE
+#define MAX_MESSAGE_SIZE FRAME_SIZE  // decode_task only handles whole frames
+#else
+#define MAX_MESSAGE_SIZE CONFIG_DESERIALIZER_MAX_MESSAGE_SIZE  // Longer frames are streamed
+#endif
+#if CONFIG_DESERIALIZER_CHUNKED_TRANSFER
+#define CHUNK_SLOTS CONFIG_DESERIALIZER_CHUNK_SLOTS
+#define CHUNK_SLOT_SIZE CONFIG_DESERIALIZER_CHUNK_SLOT_SIZE
+#endif
+#if CONFIG_DESERIALIZER_COMPRESSION
+#define DECOMPRESS_SIZE CONFIG_DESERIALIZER_COMPRESSION_BUFFER
+#endif
 #define QUEUE_SIZE 5
 #define TASK_MEM 1024 * 4
+#if CONFIG_DESERIALIZER_PIPELINE
+#define RX_TASK_PRIORITY 10
+#define DECODE_TASK_PRIORITY 5
+#define OUTPUT_TASK_PRIORITY 2
+#if CONFIG_DESERIALIZER_PIPELINE_PIN_CORES
+#define RX_TASK_CORE 0
+#define DECODE_TASK_CORE 1
+#define OUTPUT_TASK_CORE 1
+#else
+#define RX_TASK_CORE tskNO_AFFINITY
+#define DECODE_TASK_CORE tskNO_AFFINITY
+#define OUTPUT_TASK_CORE tskNO_AFFINITY
+#endif
+#elif CONFIG_DESERIALIZER_ASYNC_LOG
+#define OUTPUT_TASK_PRIORITY 2  // Below uart_task
+#define OUTPUT_TASK_CORE tskNO_AFFINITY
+#endif
+#if CONFIG_DESERIALIZER_PIPELINE || CONFIG_DESERIALIZER_ASYNC_LOG
+#define OUTPUT_TASK 1  // Renderings are logged by output_task
+#endif
+#if CONFIG_DESERIALIZER_PIPELINE
+#define OUTPUT_BUFFER CONFIG_DESERIALIZER_PIPELINE_OUTPUT_BUFFER
+#elif CONFIG_DESERIALIZER_ASYNC_LOG
+#define OUTPUT_BUFFER CONFIG_DESERIALIZER_ASYNC_LOG_BUFFER
+#endif
+#if CONFIG_DESERIALIZER_ASYNC_LOG
+#define OUTPUT_WAIT 0  // A full output ring buffer drops renderings
+#else
+#define OUTPUT_WAIT portMAX_DELAY  // A full output ring buffer holds decoding back
+#endif
+#if CONFIG_DESERIALIZER_CREDIT_FLOW_CONTROL
+#define EVENT_WAIT pdMS_TO_TICKS(CONFIG_DESERIALIZER_CREDIT_INTERVAL_MS)  // Idle Credit interval
+#else
+#define EVENT_WAIT portMAX_DELAY
+#endif
+#if CONFIG_DESERIALIZER_BAUD_NEGOTIATION || CONFIG_DESERIALIZER_AUTOBAUD
+#define BAUD_CONTROL 1  // The deserializer may change the baud rate
+#define BAUD_CHECK_WAIT pdMS_TO_TICKS(50)  // Wake-up period while the baud rate may change
+#define BAUD_TX_WAIT pdMS_TO_TICKS(100)  // Longest wait for replies to leave at the old rate
+#endif
+#if CONFIG_DESERIALIZER_AUTOBAUD
+#define AUTOBAUD_MIN_EDGES 64  // RX signal edges a baud rate measurement needs
+#endif
+#if CONFIG_DESERIALIZER_CHUNKED_TRANSFER || CONFIG_DESERIALIZER_BAUD_NEGOTIATION
+#define HAS_CLOCK 1  // The deserializer needs now_ms
+#endif
+#if CONFIG_DESERIALIZER_STAGE_STATS
+// Time a stage: STAGE_START declares the variable holding its start, STAGE_END counts it
+#define STAGE_START(start) uint32_t start = uptime_us(NULL)
+#define STAGE_END(stage, start) latency_hist_add(&stage_hists[stage], uptime_us(NULL) - (start))
+#else
+#define STAGE_START(start)
+#define STAGE_END(stage, start)
+#endif
+#if CONFIG_DESERIALIZER_STAGE_STATS && CONFIG_DESERIALIZER_STAGE_STATS_INTERVAL > 0
+#define STAGE_REPORTS 1  // The stage histograms are also logged periodically
+#define STAGE_REPORT_INTERVAL_US (CONFIG_DESERIALIZER_STAGE_STATS_INTERVAL * 1000000LL)
+#define STAGE_REPORT_WAIT pdMS_TO_TICKS(CONFIG_DESERIALIZER_STAGE_STATS_INTERVAL * 1000)
+#endif
 
 // Global variables
 char const* TAG = "Deserializer";
 static QueueHandle_t uart_queue;
+static alignas(max_align_t) uint8_t arena_buffer[ARENA_SIZE];
+static arena_t arena;
+static ProtobufCAllocator arena_allocator = {
+    .alloc = arena_pb_alloc,
+    .free = arena_pb_free,
+    .allocator_data = &arena,
+};
+// Reassembly buffer for frames split across reads, with room for the CRC hunt
+static uint8_t frame_buffer[FRAME_DECODER_CRC_BUF_SIZE(FRAME_SIZE)];
+static char json_buffer[JSON_SIZE];
+static deserializer_t deserializer;
+static uint32_t rx_consumed;  // Bytes read or flushed from the UART receive buffer
+// Written by uart_task, read for the Stats replies
+static volatile uint32_t rx_overflows;   // UART FIFO or receive buffer overflows
+static volatile uint32_t rx_high_water;  // Most bytes seen in the UART receive buffer
+static bool json_line_open;   // A rendering logged piece by piece is being logged
+#if !CONFIG_DESERIALIZER_OUTPUT_BINARY
+static size_t json_line_len;  // Characters of that rendering logged so far
+#endif
+#if CONFIG_DESERIALIZER_CHUNKED_TRANSFER
+static uint8_t chunk_buffer[CHUNK_SLOTS * CHUNK_SLOT_SIZE];  // Chunked transfer reassembly
+#endif
+#if CONFIG_DESERIALIZER_COMPRESSION
+static uint8_t decompress_buffer[DECOMPRESS_SIZE];  // Original frame of a compressed frame
+#endif
+#if CONFIG_DESERIALIZER_STAGE_STATS
+// Written by the task running each stage, read by the one logging the reports
+static latency_hist_t stage_hists[DESERIALIZER_STAGE_COUNT];
+#endif
+
+#if OUTPUT_TASK
+typedef enum {
+    OUTPUT_PAYLOAD,      // value: Payload length, followed by the NUL-terminated JSON rendering
+    OUTPUT_CHUNK,        // value: Payload length on the last piece, 0 before, followed by the piece
+    OUTPUT_ERROR,        // value: deserializer_error_t
+    OUTPUT_DROPPED,      // value: frames dropped because the frame ring buffer was full
+    OUTPUT_LOG_DROPPED,  // value: items dropped because the output ring buffer was full
+    OUTPUT_STAGE_STATS,  // value: unused, log the stage histograms (periodic report)
+} output_kind_t;
+
+typedef struct {
+    output_kind_t kind;
+    uint32_t value;
+} output_header_t;  // Header of every output ring buffer item
+
+static RingbufHandle_t output_ring;             // Decoding side to output_task: renderings, errors
+static atomic_uint_least32_t records_dropped;  // Items not queued since the last report of them
+static atomic_uint_least32_t records_reported;  // Items reported dropped so far
+static atomic_uint_least32_t output_high_water;  // Most bytes seen in use in the output ring
+static bool chunk_dropped;  // A piece of the current rendering was dropped, so is the rest
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY
+static bool record_open;  // Pieces of a binary record were queued, not its last one yet
+#if CONFIG_DESERIALIZER_PIPELINE
+static SemaphoreHandle_t record_lock;  // Held by decode_task while it queues a record in pieces
+#endif
+#endif
+#endif
+
+#if CONFIG_DESERIALIZER_PIPELINE
+static alignas(4) uint8_t frame_ring_buffer[CONFIG_DESERIALIZER_PIPELINE_FRAME_BUFFER];
+static frame_ring_t frame_ring;          // uart_task to decode_task: frames to decode
+static TaskHandle_t decode_task_handle;  // Notified by uart_task for every queued frame
+// Each counter has a single writer task, the other task only reads it
+static volatile uint32_t frame_bytes_in;   // Frame bytes queued by uart_task
+static volatile uint32_t frame_bytes_out;  // Frame bytes released by decode_task
+static volatile uint32_t frames_dropped;   // Frames uart_task found no room for
+#if BAUD_CONTROL
+static atomic_bool baud_changed;  // Set by decode_task, uart_task then flushes its input
+#endif
+#endif
 
 // Function prototypes
 static void uart_init(void);
 static void uart_task(void* arg);
-static void show_payload_as_json(Payload const* payload);
+#if CONFIG_DESERIALIZER_FRAMING_COBS
+static void read_cobs_frame(uint8_t* data);
+#endif
+#if CONFIG_DESERIALIZER_FRAMING_COBS && !CONFIG_DESERIALIZER_PIPELINE
+static void read_cobs_stream(uint8_t* data);
+#endif
+#if !CONFIG_DESERIALIZER_FRAMING_COBS || !CONFIG_DESERIALIZER_PIPELINE
+static void read_stream_data(uint8_t* data, size_t size);
+#endif
+static void reset_framing(void);
+static void discard_input(void);
+static void track_rx_high_water(void);
+#if CONFIG_DESERIALIZER_UART_HW_FLOW_CONTROL
+static void relieve_backpressure(uint8_t* data);
+#endif
+#if CONFIG_DESERIALIZER_CREDIT_FLOW_CONTROL
+static void advertise_credit(void);
+#endif
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY
+static void show_record(void* ctx, size_t payload_len, char const* record, size_t len);
+#else
+static void show_payload_as_json(void* ctx, size_t payload_len, char const* json, size_t json_len);
+static void show_payload_chunk(void* ctx, size_t payload_len, char const* json, size_t json_len);
+#endif
+static void log_deserializer_error(void* ctx, deserializer_error_t error);
+static void close_json_line(void);
+#if HAS_CLOCK
+static uint32_t uptime_ms(void* ctx);
+#endif
+#if BAUD_CONTROL
+static bool set_baud_rate(void* ctx, uint32_t baud_rate);
+#endif
+#if CONFIG_DESERIALIZER_BAUD_NEGOTIATION
+static bool can_set_baud_rate(void* ctx, uint32_t baud_rate);
+#endif
+#if CONFIG_DESERIALIZER_AUTOBAUD
+static uint32_t measure_baud_rate(void* ctx);
+#endif
+#if CONFIG_DESERIALIZER_STAGE_STATS
+static uint32_t uptime_us(void* ctx);
+#endif
+#if STAGE_REPORTS
+static void report_stage_stats_due(void);
+static void report_stage_stats(void);
+static void log_stage_stats(void);
+#endif
+static void fill_device_stats(void* ctx, deserializer_device_stats_t* device);
+static bool unpack_payload(void* ctx, uint8_t const* frame, size_t len, payload_view_t* view);
+static void release_payload(void* ctx);
+static void write_reply(void* ctx, uint8_t const* data, size_t len);
+#if CONFIG_DESERIALIZER_PIPELINE
+static void decode_task(void* arg);
+static void queue_frame(void* ctx, uint8_t const* frame, size_t len);
+#endif
+#if OUTPUT_TASK
+static void output_task(void* arg);
+static void queue_payload(void* ctx, size_t payload_len, char const* json, size_t json_len);
+static void queue_payload_chunk(void* ctx, size_t payload_len, char const* json, size_t json_len);
+static void queue_error(void* ctx, deserializer_error_t error);
+static output_header_t* acquire_output(output_kind_t kind, uint32_t value, size_t len,
+        TickType_t wait);
+static bool report_log_dropped(TickType_t wait);
+static bool queue_output(output_kind_t kind, uint32_t value, TickType_t wait);
+static void track_output_high_water(void);
+#endif
 
 /**
  * @fn void app_main(void)
@@ -64,8 +359,10 @@ void app_main(void) { uart_init(); }
  * - Data bits: 8
  * - Parity: None
  * - Stop bits: 1
- * - Flow control: None
+ * - Flow control: RTS/CTS when enabled in Kconfig, deasserting RTS at the configured
+ *   RX FIFO threshold, otherwise none
  * - Source clock: APB clock
+ * - Pattern detection on the COBS delimiter, when COBS framing is selected
  *
  * If any configuration step fails, an error is logged and the function returns early.
  * A stabilization delay is included to ensure proper hardware initialization.
@@ -82,7 +379,8 @@ void uart_init(void) {
         .data_bits = UART_DATA_8_BITS,
         .parity = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .flow_ctrl = UART_FLOW_CTRL,
+        .rx_flow_ctrl_thresh = UART_RX_FLOW_CTRL_THRESH,
         .source_clk = UART_SCLK_APB,
     };
 
@@ -91,7 +389,7 @@ void uart_init(void) {
         return;
     }
 
-    if (uart_set_pin(UART_NUM, UART_TX, UART_RX, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE)) {
+    if (uart_set_pin(UART_NUM, UART_TX, UART_RX, UART_RTS, UART_CTS)) {
         ESP_LOGE(TAG, "Failed to set UART pins");
         return;
     }
@@ -101,13 +399,55 @@ void uart_init(void) {
         return;
     }
 
+#if CONFIG_DESERIALIZER_FRAMING_COBS
+    // Raise an event per frame delimiter instead of per received FIFO chunk
+    if (uart_enable_pattern_det_baud_intr(UART_NUM, COBS_DELIMITER, 1, 9, 0, 0)
+            || uart_pattern_queue_reset(UART_NUM, QUEUE_SIZE)) {
+        ESP_LOGE(TAG, "Failed to enable UART pattern detection");
+        return;
+    }
+#endif
+
+#if CONFIG_DESERIALIZER_AUTOBAUD
+    // Pulse width counters of measure_baud_rate(), running alongside reception
+    uart_ll_set_autobaud_en(UART_LL_GET_HW(UART_NUM), true);
+#endif
+
     // Small delay to allow system to stabilize
     vTaskDelay(pdMS_TO_TICKS(100));
 
     ESP_LOGI(TAG, "Uart initialized on port %d with TX pin %d, RX pin %d at baud rate %d", UART_NUM,
             UART_TX, UART_RX, UART_BAUD_RATE);
+#if CONFIG_DESERIALIZER_UART_HW_FLOW_CONTROL
+    ESP_LOGI(TAG, "RTS/CTS flow control on RTS pin %d, CTS pin %d, RX threshold %d bytes", UART_RTS,
+            UART_CTS, UART_RX_FLOW_CTRL_THRESH);
+#endif
 
+#if OUTPUT_TASK
+    output_ring = xRingbufferCreate(OUTPUT_BUFFER, RINGBUF_TYPE_NOSPLIT);
+    if (output_ring == NULL) {
+        ESP_LOGE(TAG, "Failed to create the output ring buffer");
+        return;
+    }
+#if CONFIG_DESERIALIZER_PIPELINE && CONFIG_DESERIALIZER_OUTPUT_BINARY
+    record_lock = xSemaphoreCreateMutex();
+    if (record_lock == NULL) {
+        ESP_LOGE(TAG, "Failed to create the record lock");
+        return;
+    }
+#endif
+    xTaskCreatePinnedToCore(output_task, "output_task", TASK_MEM, NULL, OUTPUT_TASK_PRIORITY, NULL,
+            OUTPUT_TASK_CORE);
+#endif
+#if CONFIG_DESERIALIZER_PIPELINE
+    frame_ring_init(&frame_ring, frame_ring_buffer, sizeof(frame_ring_buffer));
+    xTaskCreatePinnedToCore(decode_task, "decode_task", TASK_MEM, NULL, DECODE_TASK_PRIORITY,
+            &decode_task_handle, DECODE_TASK_CORE);
+    xTaskCreatePinnedToCore(uart_task, "uart_task", TASK_MEM, NULL, RX_TASK_PRIORITY, NULL,
+            RX_TASK_CORE);
+#else
     xTaskCreate(uart_task, "uart_task", TASK_MEM, NULL, 5, NULL);
+#endif
 }
 
 /**
@@ -115,18 +455,22 @@ void uart_init(void) {
  * @brief UART data processing task for protobuf deserialization
  *
  * This FreeRTOS task continuously monitors the UART queue for incoming data
- * events and processes them accordingly. When protobuf data is received,
- * it deserializes the binary data into a Payload structure and converts
- * it to JSON format for logging and further processing.
+ * events and processes them accordingly. Incoming bytes are treated as a
+ * continuous stream of varint length-prefixed protobuf messages: they are fed to
+ * the deserializer pipeline which keeps partial messages across events and
+ * decodes and renders every complete message, so several messages arriving in
+ * one event or a message split across events are both decoded correctly.
+ *
+ * With COBS framing, data events are ignored and the bytes stay in the driver
+ * buffer until a pattern detection event reports a frame delimiter; the frame is
+ * then read and decoded in one go by read_cobs_frame().
  *
  * The task performs the following operations:
  * 1. Clears any residual data from previous operations.
- * 2. Initializes a buffer for incoming data.
+ * 2. Initializes a buffer for incoming data and the deserializer pipeline.
  * 3. Waits for UART events from the queue.
- * 4. Reads binary data from UART buffer.
- * 5. Deserializes protobuf data.
- * 6. Converts deserialized data to JSON format.
- * 7. Logs the results, cleans up memory and flushes UART buffer.
+ * 4. Reads all available binary data from UART buffer.
+ * 5. Splits the data into frames, then deserializes and logs every complete message.
  *
  * @param arg Pointer to task parameters (unused, set to NULL)
  *
@@ -135,55 +479,192 @@ void uart_init(void) {
  * @note This task allocates BUFF_SIZE bytes for incoming data buffer
  * @note Task will log errors if memory allocation or deserialization fails
  * @note Task will also handle UART the unlikely events of FIFO overflow and RX buffer full
- *       logging the error and flushing the UART buffer and resetting the queue.
+ *       logging the error, flushing the UART buffer, resetting the queue and
+ *       dropping the partially received frame (with RTS/CTS flow control a full buffer
+ *       only holds the sender back, see relieve_backpressure()). Senders using sequenced
+ *       frames get a NACK for the first lost frame once the next one arrives, and resend
+ *       them.
+ * @note With credit-based flow control the task also wakes up every
+ *       CONFIG_DESERIALIZER_CREDIT_INTERVAL_MS to advertise a Credit when idle.
+ * @note With CONFIG_DESERIALIZER_PIPELINE the task runs at a higher priority and only
+ *       delimits frames, queuing them for decode_task without ever waiting for the
+ *       decoding or the log output.
  */
 void uart_task(void* arg) {
     // Clear any residual data in UART buffer before starting
     uart_flush(UART_NUM);
     xQueueReset(uart_queue);
     uart_event_t evt;
-    int len;
-    Payload* payload = NULL;
     uint8_t* data = (uint8_t*)malloc(BUFF_SIZE);  // Allocate buffer for incoming data
     if (data == NULL) {
         ESP_LOGE(TAG, "Error creating incoming data buffer");
+        vTaskDelete(NULL);
         return;
     }
+    arena_init(&arena, arena_buffer, ARENA_SIZE);
+    deserializer_config_t config = {
+#if CONFIG_DESERIALIZER_FRAMING_COBS
+        .framing = DESERIALIZER_FRAMING_COBS,
+#else
+        .framing = DESERIALIZER_FRAMING_LENGTH_PREFIX,
+#endif
+#if CONFIG_DESERIALIZER_FRAME_CRC
+        .frame_crc = true,
+#endif
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY
+        .output = DESERIALIZER_OUTPUT_BINARY,
+#endif
+        .frame_buf = frame_buffer,
+        .frame_size = FRAME_SIZE,
+        .max_message_size = MAX_MESSAGE_SIZE,
+        .json_buf = json_buffer,
+        .json_size = JSON_SIZE,
+#if CONFIG_DESERIALIZER_CHUNKED_TRANSFER
+        .chunk_buf = chunk_buffer,
+        .chunk_slot_size = CHUNK_SLOT_SIZE,
+        .chunk_slots = CHUNK_SLOTS,
+        .chunk_timeout_ms = CONFIG_DESERIALIZER_CHUNK_TIMEOUT_MS,
+#endif
+#if CONFIG_DESERIALIZER_COMPRESSION
+        .decompress_buf = decompress_buffer,
+        .decompress_size = DECOMPRESS_SIZE,
+        .dict = &lzss_telemetry_dict,
+#endif
+#if BAUD_CONTROL
+        .baud_rate = UART_BAUD_RATE,
+#endif
+#if CONFIG_DESERIALIZER_BAUD_NEGOTIATION
+        .max_baud_rate = CONFIG_DESERIALIZER_MAX_BAUD_RATE,
+        .baud_timeout_ms = CONFIG_DESERIALIZER_BAUD_TIMEOUT_MS,
+#endif
+#if CONFIG_DESERIALIZER_AUTOBAUD
+        .autobaud_errors = CONFIG_DESERIALIZER_AUTOBAUD_ERRORS,
+#endif
+#if CONFIG_DESERIALIZER_STAGE_STATS
+        .stage_hists = stage_hists,
+#endif
+        .callbacks = {
+#if OUTPUT_TASK
+            .on_payload = queue_payload,
+            .on_error = queue_error,
+            .on_payload_chunk = queue_payload_chunk,
+#elif CONFIG_DESERIALIZER_OUTPUT_BINARY
+            .on_payload = show_record,
+            .on_error = log_deserializer_error,
+            .on_payload_chunk = show_record,
+#else
+            .on_payload = show_payload_as_json,
+            .on_error = log_deserializer_error,
+            .on_payload_chunk = show_payload_chunk,
+#endif
+#if CONFIG_DESERIALIZER_PIPELINE
+            .on_frame = queue_frame,
+#endif
+            .unpack_fallback = unpack_payload,
+            .on_payload_done = release_payload,
+            .send_reply = write_reply,
+#if HAS_CLOCK
+            .now_ms = uptime_ms,
+#endif
+#if BAUD_CONTROL
+            .set_baud_rate = set_baud_rate,
+#endif
+#if CONFIG_DESERIALIZER_BAUD_NEGOTIATION
+            .can_set_baud_rate = can_set_baud_rate,
+#endif
+#if CONFIG_DESERIALIZER_AUTOBAUD
+            .measure_baud_rate = measure_baud_rate,
+#endif
+#if CONFIG_DESERIALIZER_STAGE_STATS
+            .now_us = uptime_us,
+#endif
+            .on_stats_query = fill_device_stats,
+        },
+    };
+    deserializer_init(&deserializer, &config);
 
     ESP_LOGI(TAG, "UART task started, waiting for incoming data...");
 
     while (1) {
-        if (xQueueReceive(uart_queue, (void*)&evt, (TickType_t)portMAX_DELAY)) {
-            bzero(data, BUFF_SIZE);  // Clear buffer before reading new data
+        TickType_t wait = EVENT_WAIT;
+#if BAUD_CONTROL
+        // Written by decode_task in pipeline mode, where it owns the baud rate state, and by
+        // this task otherwise
+        if (atomic_load_explicit(&deserializer.baud.probation, memory_order_relaxed)) {
+            wait = BAUD_CHECK_WAIT;
+        }
+#endif
+#if STAGE_REPORTS && !CONFIG_DESERIALIZER_PIPELINE
+        if (wait > STAGE_REPORT_WAIT) {
+            wait = STAGE_REPORT_WAIT;
+        }
+#endif
+        STAGE_START(wait_start);
+        if (xQueueReceive(uart_queue, (void*)&evt, wait)) {
+            STAGE_END(DESERIALIZER_STAGE_WAIT, wait_start);
+            track_rx_high_water();
             switch (evt.type) {
+#if CONFIG_DESERIALIZER_FRAMING_COBS
+            case UART_PATTERN_DET:
+                read_cobs_frame(data);
+                break;
+#if !CONFIG_DESERIALIZER_PIPELINE
             case UART_DATA:
-                // Read incoming data from UART and unpack protobuf message
-                len = uart_read_bytes(UART_NUM, data, evt.size, pdMS_TO_TICKS(100));
-                payload = payload__unpack(NULL, len, data);
-                if (payload == NULL) {
-                    ESP_LOGE(TAG, "Failed to unpack payload");
-                    break;
-                }
-                // Process the unpacked payload
-                ESP_LOGI(TAG, "Received payload of length %d bytes", len);
-                show_payload_as_json(payload);
-                payload__free_unpacked(payload, NULL);
-                uart_flush(UART_NUM);  // Clear UART RX buffer
+                read_cobs_stream(data);
                 break;
+#endif
+#else
+            case UART_DATA:
+                read_stream_data(data, evt.size);
+                break;
+#endif
             case UART_FIFO_OVF:
                 ESP_LOGW(TAG, "UART FIFO overflow");
-                uart_flush(UART_NUM);
+                rx_overflows++;
+                discard_input();
                 xQueueReset(uart_queue);
+                reset_framing();
                 break;
             case UART_BUFFER_FULL:
+#if CONFIG_DESERIALIZER_UART_HW_FLOW_CONTROL
+                relieve_backpressure(data);
+#else
                 ESP_LOGW(TAG, "UART buffer full");
-                uart_flush(UART_NUM);
+                rx_overflows++;
+                discard_input();
                 xQueueReset(uart_queue);
+                reset_framing();
+#endif
                 break;
             default:
                 break;
             }
         }
+#if CONFIG_DESERIALIZER_CREDIT_FLOW_CONTROL
+        advertise_credit();
+#endif
+#if CONFIG_DESERIALIZER_ASYNC_LOG && !CONFIG_DESERIALIZER_PIPELINE
+        report_log_dropped(0);
+#endif
+#if STAGE_REPORTS && !CONFIG_DESERIALIZER_PIPELINE
+        // Not in the middle of a streamed message, whose output is still coming
+        if (!deserializer_frame_pending(&deserializer)) {
+            report_stage_stats_due();
+        }
+#endif
+#if BAUD_CONTROL
+#if CONFIG_DESERIALIZER_PIPELINE
+        bool changed = atomic_exchange(&baud_changed, false);
+#else
+        bool changed = deserializer_check_baud(&deserializer);
+#endif
+        if (changed) {
+            // What arrived at the previous rate is garbage
+            discard_input();
+            xQueueReset(uart_queue);
+            reset_framing();
+        }
+#endif
     }
     // Clean up (though this point is never reached in the current design)
     free(data);
@@ -192,62 +673,1035 @@ void uart_task(void* arg) {
 }
 
 /**
- * @fn void show_payload_as_json(const Payload *payload)
- * @brief Convert protobuf Payload to JSON format and log it
+ * @fn void reset_framing(void)
+ * @brief Resynchronize the framing layer after received data was lost
  *
- * This function takes a deserialized protobuf Payload structure and converts
- * it to a JSON representation using the cJSON library. The resulting JSON
- * string is logged via ESP_LOGI and then properly cleaned up. Also logs the
- * length of the JSON string.
+ * Drops the partially received frame (length-prefix framing) or the stale
+ * delimiter positions (COBS framing), since the flushed bytes they refer to
+ * are gone.
  *
- * The JSON structure includes:
- * - "timestamp": 32-bit unsigned integer value from payload->timestamp
- * - "data": string value from payload->data
+ * @return void
+ */
+void reset_framing(void) {
+#if CONFIG_DESERIALIZER_FRAMING_COBS
+    uart_pattern_queue_reset(UART_NUM, QUEUE_SIZE);
+#endif
+    deserializer_reset(&deserializer);
+}
+
+/**
+ * @fn void discard_input(void)
+ * @brief Flush the UART receive buffer, counting the flushed bytes as consumed
+ *
+ * The sender's credits are based on rx_consumed, so bytes that leave the
+ * buffer without being read must be accounted for as well.
+ *
+ * @return void
+ */
+void discard_input(void) {
+    size_t buffered;
+    if (uart_get_buffered_data_len(UART_NUM, &buffered) == ESP_OK) {
+        rx_consumed += buffered;
+    }
+    uart_flush_input(UART_NUM);
+}
+
+/**
+ * @fn void track_rx_high_water(void)
+ * @brief Raise the receive buffer high-water mark to what the buffer holds now
  *
- * @param payload Pointer to the deserialized Payload structure to convert
- *                Must not be NULL and must be a valid Payload object
+ * Called on every UART event, when the buffer is at its fullest since the
+ * previous read.
  *
  * @return void
+ */
+void track_rx_high_water(void) {
+    size_t buffered;
+    if (uart_get_buffered_data_len(UART_NUM, &buffered) == ESP_OK && buffered > rx_high_water) {
+        rx_high_water = buffered;
+    }
+}
+
+#if CONFIG_DESERIALIZER_UART_HW_FLOW_CONTROL
+/**
+ * @fn void relieve_backpressure(uint8_t *data)
+ * @brief Make room in a full receive buffer without losing data
  *
- * @note The function checks for NULL payload and logs an error if so.
- * @note Function handles all memory allocation and cleanup internally
- * @note Logs errors if JSON creation or string conversion fails
- * @note Uses cJSON_PrintUnformatted for compact JSON output
- * @note The input payload is not modified (const parameter)
+ * With RTS/CTS the driver keeps the bytes that did not fit and RTS holds the
+ * sender back, so a full buffer is backpressure rather than loss: reading lets
+ * the driver move the held bytes in and resume reception. With COBS framing the
+ * pattern events drain the buffer, unless it holds no delimiter at all, i.e. a
+ * frame larger than the buffer: it is streamed, or in pipeline mode, where it
+ * would block the link, discarded.
+ *
+ * @param data Read buffer of BUFF_SIZE bytes
+ *
+ * @return void
  */
-void show_payload_as_json(Payload const* payload) {
-    if (payload == NULL) {
-        ESP_LOGE(TAG, "Payload is NULL, cannot convert to JSON");
+void relieve_backpressure(uint8_t* data) {
+#if CONFIG_DESERIALIZER_FRAMING_COBS && CONFIG_DESERIALIZER_PIPELINE
+    if (uart_pattern_get_pos(UART_NUM) < 0) {
+        discard_input();
+        reset_framing();
+        deserializer_drop_frame(&deserializer, DESERIALIZER_ERROR_OVERSIZED);
+    }
+#elif CONFIG_DESERIALIZER_FRAMING_COBS
+    read_cobs_stream(data);
+#else
+    size_t buffered;
+    if (uart_get_buffered_data_len(UART_NUM, &buffered) == ESP_OK) {
+        read_stream_data(data, buffered);
+    }
+#endif
+}
+#endif
+
+#if CONFIG_DESERIALIZER_CREDIT_FLOW_CONTROL
+/**
+ * @fn void advertise_credit(void)
+ * @brief Send a Credit to the PC when enough buffer space was freed or time has passed
+ *
+ * Called after every UART event and every idle interval. Credits are sent once
+ * a quarter of the receive buffer has been read since the last one, so the
+ * sender is never starved, and at least every CONFIG_DESERIALIZER_CREDIT_INTERVAL_MS
+ * so a lost Credit is soon replaced.
+ *
+ * @return void
+ */
+void advertise_credit(void) {
+    static uint32_t advertised;
+    static TickType_t advertised_at;
+    TickType_t now = xTaskGetTickCount();
+#if CONFIG_DESERIALIZER_PIPELINE
+    // Frames waiting to be decoded still take up room: only count them once released
+    uint32_t consumed = rx_consumed - (frame_bytes_in - frame_bytes_out);
+#else
+    uint32_t consumed = rx_consumed;
+#endif
+
+    if (consumed - advertised >= BUFF_SIZE / 4 || now - advertised_at >= EVENT_WAIT) {
+        deserializer_send_credit(&deserializer, consumed, BUFF_SIZE);
+        advertised = consumed;
+        advertised_at = now;
+    }
+}
+#endif
+
+#if !CONFIG_DESERIALIZER_FRAMING_COBS || !CONFIG_DESERIALIZER_PIPELINE
+/**
+ * @fn void read_stream_data(uint8_t *data, size_t size)
+ * @brief Read buffered bytes and feed them to the deserializer
+ *
+ * Drains size bytes, BUFF_SIZE bytes at a time. Complete frames are decoded
+ * and logged by the pipeline as soon as they are seen, and longer ones are
+ * streamed as they arrive.
+ *
+ * @param data Read buffer of BUFF_SIZE bytes
+ * @param size Number of bytes to read, e.g. reported by the UART_DATA event
+ *
+ * @return void
+ */
+void read_stream_data(uint8_t* data, size_t size) {
+    while (size > 0) {
+        STAGE_START(read_start);
+        int len = uart_read_bytes(UART_NUM, data, size < BUFF_SIZE ? size : BUFF_SIZE,
+                pdMS_TO_TICKS(100));
+        STAGE_END(DESERIALIZER_STAGE_READ, read_start);
+        if (len <= 0) {
+            break;
+        }
+        rx_consumed += len;
+        deserializer_feed(&deserializer, data, len);
+        size -= len;
+    }
+}
+#endif
+
+#if CONFIG_DESERIALIZER_FRAMING_COBS
+/**
+ * @fn void read_cobs_frame(uint8_t *data)
+ * @brief Read one COBS frame up to the detected delimiter and decode it in place
+ *
+ * Pops the position of the oldest detected delimiter, reads the frame and its
+ * delimiter from the driver buffer into data, decodes it in place and hands the
+ * decoded span directly to the deserializer, without any intermediate copy.
+ * In pipeline mode the frame is read and decoded straight into its slot of the
+ * frame ring instead, and data is only used to drain frames that get dropped.
+ *
+ * @param data Read buffer of BUFF_SIZE bytes
+ *
+ * @return void
+ *
+ * @note Frames longer than BUFF_SIZE - 1 bytes, and the end of frames
+ *       read_cobs_stream() already started, are fed to the deserializer's
+ *       streaming decoder instead; in pipeline mode they are read out and discarded.
+ */
+void read_cobs_frame(uint8_t* data) {
+    int pos = uart_pattern_pop_pos(UART_NUM);
+    if (pos < 0) {
+        // The pattern queue overflowed, delimiter positions are lost
+        ESP_LOGW(TAG, "UART pattern queue full");
+        discard_input();
+        uart_pattern_queue_reset(UART_NUM, QUEUE_SIZE);
         return;
     }
-    cJSON* json = cJSON_CreateObject();
-    if (json == NULL) {
-        ESP_LOGE(TAG, "Failed to create JSON object");
+
+#if !CONFIG_DESERIALIZER_PIPELINE
+    if (pos >= BUFF_SIZE || deserializer_frame_pending(&deserializer)) {
+        read_stream_data(data, pos + 1);
         return;
     }
+#else
+    if (pos >= BUFF_SIZE) {
+        // Drain the oversized frame and its delimiter
+        for (int remaining = pos + 1; remaining > 0;) {
+            int len = uart_read_bytes(UART_NUM, data,
+                    remaining < BUFF_SIZE ? remaining : BUFF_SIZE, pdMS_TO_TICKS(100));
+            if (len <= 0) {
+                break;
+            }
+            rx_consumed += len;
+            remaining -= len;
+        }
+        deserializer_drop_frame(&deserializer, DESERIALIZER_ERROR_OVERSIZED);
+        return;
+    }
+
+    // Decoding never grows the frame, so the slot only needs room for the encoded bytes
+    uint8_t* slot = frame_ring_reserve(&frame_ring, pos + 1);
+    if (slot == NULL) {
+        frames_dropped++;
+    } else {
+        data = slot;
+    }
+#endif
+
+    STAGE_START(read_start);
+    int len = uart_read_bytes(UART_NUM, data, pos + 1, pdMS_TO_TICKS(100));
+    STAGE_END(DESERIALIZER_STAGE_READ, read_start);
+    rx_consumed += len > 0 ? len : 0;
+    if (len != pos + 1) {
+        ESP_LOGE(TAG, "Short read of COBS frame");
+        return;
+    }
+
+#if CONFIG_DESERIALIZER_PIPELINE
+    if (slot == NULL) {
+        return;
+    }
+#endif
+    size_t decoded_len;
+    if (!cobs_decode_in_place(data, pos, &decoded_len)) {
+        deserializer_drop_frame(&deserializer, DESERIALIZER_ERROR_FRAMING);
+        return;
+    }
+#if CONFIG_DESERIALIZER_FRAME_CRC
+    if (!frame_crc_check(data, decoded_len)) {
+        deserializer_drop_frame(&deserializer, DESERIALIZER_ERROR_CRC);
+        return;
+    }
+    decoded_len -= FRAME_CRC_LEN;
+#endif
+#if CONFIG_DESERIALIZER_PIPELINE
+    if (decoded_len == 0) {
+        deserializer_drop_frame(&deserializer, DESERIALIZER_ERROR_UNPACK);
+        return;
+    }
+    frame_ring_commit(&frame_ring, decoded_len);
+    frame_bytes_in += decoded_len;
+    xTaskNotifyGive(decode_task_handle);
+#else
+    deserializer_handle_frame(&deserializer, data, decoded_len);
+#endif
+}
 
-    if (cJSON_AddNumberToObject(json, "timestamp", payload->timestamp) == NULL) {
-        ESP_LOGE(TAG, "Failed to add timestamp to JSON");
-        goto error;
+#if !CONFIG_DESERIALIZER_PIPELINE
+/**
+ * @fn void read_cobs_stream(uint8_t *data)
+ * @brief Start streaming a frame too large to wait for its delimiter in the receive buffer
+ *
+ * Called on data events. While the receive buffer holds no delimiter, the bytes
+ * of a frame already being streamed, or of one that has filled half the buffer,
+ * are read and fed to the deserializer, which decodes them as they arrive. Short
+ * frames are left for read_cobs_frame() and still decoded in place.
+ *
+ * @param data Read buffer of BUFF_SIZE bytes
+ *
+ * @return void
+ */
+void read_cobs_stream(uint8_t* data) {
+    size_t buffered;
+    // Measured first: if no delimiter is queued afterwards, none is in these bytes
+    if (uart_get_buffered_data_len(UART_NUM, &buffered) != ESP_OK
+            || uart_pattern_get_pos(UART_NUM) >= 0) {
+        return;
+    }
+    if (buffered >= BUFF_SIZE / 2 || deserializer_frame_pending(&deserializer)) {
+        read_stream_data(data, buffered);
     }
+}
+#endif
+#endif
 
-    if (cJSON_AddStringToObject(json, "data", payload->data) == NULL) {
-        ESP_LOGE(TAG, "Failed to add data to JSON");
-        goto error;
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY
+/**
+ * @fn void show_record(void *ctx, size_t payload_len, const char *record, size_t len)
+ * @brief Write the binary record of a decoded Payload, or the next piece of one
+ *
+ * Output callback with CONFIG_DESERIALIZER_OUTPUT_BINARY, for whole messages
+ * and for the pieces of streamed or reassembled ones alike. The bytes go to
+ * stdout, where the log lines go too, with nothing around them: the marker and
+ * length the record starts with delimit it (see binary_record.h).
+ *
+ * @param ctx Unused callback context
+ * @param payload_len Length of the protobuf-encoded Payload on the last piece, 0 before
+ * @param record Next bytes of the record
+ * @param len Number of bytes in record
+ *
+ * @return void
+ */
+void show_record(void* ctx, size_t payload_len, char const* record, size_t len) {
+    fwrite(record, 1, len, stdout);
+    if (payload_len != 0) {
+        fflush(stdout);
     }
+}
+#else
+/**
+ * @fn void show_payload_as_json(void *ctx, size_t payload_len, const char *json, size_t json_len)
+ * @brief Log a decoded Payload and its JSON rendering
+ *
+ * Output callback of the deserializer pipeline, called once per decoded
+ * message, including every entry of a Batch. The JSON was rendered straight
+ * into a preallocated buffer by the pipeline, in the same compact format
+ * cJSON_PrintUnformatted used to produce.
+ *
+ * The JSON structure includes:
+ * - "timestamp": 32-bit unsigned integer value from the Payload timestamp
+ * - "data": string value from the Payload data
+ *
+ * @param ctx Unused callback context
+ * @param payload_len Length of the protobuf-encoded Payload in bytes
+ * @param json NUL-terminated JSON rendering of the message
+ * @param json_len Length of the JSON rendering in bytes
+ *
+ * @return void
+ */
+void show_payload_as_json(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+    ESP_LOGI(TAG, "Received payload of length %zu bytes", payload_len);
+    ESP_LOGI(TAG, "JSON payload created: %s", json);
+    ESP_LOGI(TAG, "JSON payload length: %zu bytes", json_len);
+}
 
-    char* json_string = cJSON_PrintUnformatted(json);
-    if (json_string == NULL) {
+/**
+ * @fn void show_payload_chunk(void *ctx, size_t payload_len, const char *json, size_t json_len)
+ * @brief Log a piece of the JSON rendering of a streamed Payload
+ *
+ * Output callback for messages longer than the frame buffer, streamed or
+ * reassembled from a chunked transfer. The pieces are
+ * written as they are rendered, on a single "JSON payload created" line, and
+ * the lengths are logged once the last one is in.
+ *
+ * @param ctx Unused callback context
+ * @param payload_len Length of the protobuf-encoded Payload on the last piece, 0 before
+ * @param json Next characters of the rendering, NOT NUL-terminated
+ * @param json_len Number of characters in json
+ *
+ * @return void
+ */
+void show_payload_chunk(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+    if (!json_line_open) {
+        json_line_open = true;
+        json_line_len = 0;
+        esp_log_write(ESP_LOG_INFO, TAG,
+                LOG_COLOR_I "I (%" PRIu32 ") %s: JSON payload created: ", esp_log_timestamp(),
+                TAG);
+    }
+    esp_log_write(ESP_LOG_INFO, TAG, "%.*s", (int)json_len, json);
+    json_line_len += json_len;
+    if (payload_len != 0) {
+        close_json_line();
+        ESP_LOGI(TAG, "Received payload of length %zu bytes", payload_len);
+        ESP_LOGI(TAG, "JSON payload length: %zu bytes", json_line_len);
+    }
+}
+#endif
+
+/**
+ * @fn void close_json_line(void)
+ * @brief End the line of a streamed rendering, complete or cut short
+ *
+ * @return void
+ */
+void close_json_line(void) {
+    if (json_line_open) {
+        json_line_open = false;
+        esp_log_write(ESP_LOG_INFO, TAG, LOG_RESET_COLOR "\n");
+    }
+}
+
+/**
+ * @fn void log_deserializer_error(void *ctx, deserializer_error_t error)
+ * @brief Log a frame the deserializer pipeline could not turn into JSON
+ *
+ * @param ctx Unused callback context
+ * @param error Reason the frame was dropped
+ *
+ * @return void
+ */
+void log_deserializer_error(void* ctx, deserializer_error_t error) {
+    close_json_line();
+    switch (error) {
+    case DESERIALIZER_ERROR_UNPACK:
+        ESP_LOGE(TAG, "Failed to unpack payload");
+        break;
+    case DESERIALIZER_ERROR_JSON:
         ESP_LOGE(TAG, "Failed to print JSON");
-        goto error;
+        break;
+    case DESERIALIZER_ERROR_OVERSIZED:
+        ESP_LOGE(TAG, "Discarded 1 frame(s) larger than %d bytes", MAX_MESSAGE_SIZE);
+        break;
+    case DESERIALIZER_ERROR_FRAMING:
+        ESP_LOGE(TAG, "Invalid frame");
+        break;
+    case DESERIALIZER_ERROR_CRC:
+        ESP_LOGE(TAG, "Frame failed its checksum");
+        break;
+    case DESERIALIZER_ERROR_TRANSFER:
+        ESP_LOGE(TAG, "Dropped incomplete chunked transfer");
+        break;
+    case DESERIALIZER_ERROR_DICTIONARY:
+        ESP_LOGE(TAG, "Compressed with an unknown dictionary (expected version %d)",
+                LZSS_DICT_VERSION);
+        break;
+    }
+}
+
+#if HAS_CLOCK
+/**
+ * @fn uint32_t uptime_ms(void *ctx)
+ * @brief Clock of the chunked transfer and baud rate timeouts
+ *
+ * @param ctx Unused callback context
+ *
+ * @return Milliseconds since boot, wrapping at 2^32
+ */
+uint32_t uptime_ms(void* ctx) { return (uint32_t)(esp_timer_get_time() / 1000); }
+#endif
+
+#if BAUD_CONTROL
+/**
+ * @fn bool set_baud_rate(void *ctx, uint32_t baud_rate)
+ * @brief Switch the UART to the baud rate a BaudSwitch frame asked for, or the measured one
+ *
+ * Called right after the echo of a BaudSwitch was queued: waits for it to
+ * leave at the old rate, since the PC only changes its own rate once it has
+ * read the echo.
+ *
+ * @param ctx Unused callback context
+ * @param baud_rate New baud rate
+ *
+ * @return true if the UART now runs at baud_rate, false otherwise
+ */
+bool set_baud_rate(void* ctx, uint32_t baud_rate) {
+    if (uart_wait_tx_done(UART_NUM, BAUD_TX_WAIT) != ESP_OK) {
+        ESP_LOGW(TAG, "Reply still pending before the baud rate change");
+    }
+    if (uart_set_baudrate(UART_NUM, baud_rate) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set baud rate %" PRIu32, baud_rate);
+        return false;
+    }
+    ESP_LOGI(TAG, "Baud rate set to %" PRIu32, baud_rate);
+    return true;
+}
+#endif
+
+#if CONFIG_DESERIALIZER_BAUD_NEGOTIATION
+/**
+ * @fn bool can_set_baud_rate(void *ctx, uint32_t baud_rate)
+ * @brief Tell whether the UART of this chip can run at the baud rate a BaudSwitch frame asked for
+ *
+ * Checked before the BaudSwitch is echoed, so the PC is never told to switch
+ * to a rate set_baud_rate would then refuse.
+ *
+ * @param ctx Unused callback context
+ * @param baud_rate Requested baud rate
+ *
+ * @return true if set_baud_rate can switch the UART to baud_rate, false otherwise
+ */
+bool can_set_baud_rate(void* ctx, uint32_t baud_rate) {
+    if (baud_rate > SOC_UART_BITRATE_MAX) {
+        ESP_LOGW(TAG, "Baud rate %" PRIu32 " above the UART limit", baud_rate);
+        return false;
+    }
+    return true;
+}
+#endif
+
+#if CONFIG_DESERIALIZER_AUTOBAUD
+/**
+ * @fn uint32_t measure_baud_rate(void *ctx)
+ * @brief Measure the baud rate of the signal received since the last measurement
+ *
+ * The auto-baud counters of the UART keep the shortest low and high pulses
+ * seen on RX, in APB clock cycles, which are one bit long as soon as the data
+ * holds a lone 0 and a lone 1 bit, as any text does. They are restarted
+ * afterwards, so every measurement only covers recent traffic.
+ *
+ * @param ctx Unused callback context
+ *
+ * @return Measured baud rate, or 0 if too few edges were seen
+ */
+uint32_t measure_baud_rate(void* ctx) {
+    uart_dev_t* hw = UART_LL_GET_HW(UART_NUM);
+    uint32_t edges = uart_ll_get_rxd_edge_cnt(hw);
+    uint32_t low = uart_ll_get_low_pulse_cnt(hw);
+    uint32_t high = uart_ll_get_high_pulse_cnt(hw);
+
+    uart_ll_set_autobaud_en(hw, false);
+    uart_ll_set_autobaud_en(hw, true);
+    if (edges < AUTOBAUD_MIN_EDGES) {
+        return 0;
+    }
+    // Technical reference manual: f_baud = f_APB / ((LOWPULSE_MIN + HIGHPULSE_MIN + 2) / 2)
+    uint32_t rate = (uint32_t)(2ULL * esp_clk_apb_freq() / (low + high + 2));
+    ESP_LOGW(TAG, "Frames keep failing, measured %" PRIu32 " baud on RX", rate);
+    return rate;
+}
+#endif
+
+#if CONFIG_DESERIALIZER_STAGE_STATS
+/**
+ * @fn uint32_t uptime_us(void *ctx)
+ * @brief Clock of the stage histograms
+ *
+ * @param ctx Unused callback context
+ *
+ * @return Microseconds since boot, wrapping at 2^32
+ */
+uint32_t uptime_us(void* ctx) { return (uint32_t)esp_timer_get_time(); }
+#endif
+
+#if STAGE_REPORTS
+/**
+ * @fn void report_stage_stats_due(void)
+ * @brief Report the stage histograms if CONFIG_DESERIALIZER_STAGE_STATS_INTERVAL has passed
+ *
+ * @return void
+ */
+void report_stage_stats_due(void) {
+    static int64_t reported_at;
+    int64_t now = esp_timer_get_time();
+
+    if (now - reported_at >= STAGE_REPORT_INTERVAL_US) {
+        reported_at = now;
+        report_stage_stats();
+    }
+}
+
+/**
+ * @fn void report_stage_stats(void)
+ * @brief Have the stage histograms logged, in order with the messages already decoded
+ *
+ * Called by the task decoding frames and only between them, so the report
+ * never splits a streamed rendering or record. With an output task the report
+ * is queued for it, since it is the one writing the log; it is dropped and
+ * counted like a rendering when the output ring buffer is full.
+ *
+ * @return void
+ */
+void report_stage_stats(void) {
+#if OUTPUT_TASK
+    if (!report_log_dropped(0) || !queue_output(OUTPUT_STAGE_STATS, 0, 0)) {
+        atomic_fetch_add(&records_dropped, 1);
+    }
+#else
+    log_stage_stats();
+#endif
+}
+
+/**
+ * @fn void log_stage_stats(void)
+ * @brief Log one line per stage timed since boot
+ *
+ * The percentiles are bucket bounds, so within a factor of 2 (see
+ * latency_hist.h). Without an output task, the output stage includes the log
+ * write; with one, it only covers queuing, and the log stage the write.
+ *
+ * @return void
+ */
+void log_stage_stats(void) {
+    close_json_line();
+    for (int stage = 0; stage < DESERIALIZER_STAGE_COUNT; stage++) {
+        latency_hist_t const* hist = &stage_hists[stage];
+        if (hist->samples == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG,
+                "Stage %-6s %" PRIu32 " samples, mean %" PRIu32 " us, p50 <= %" PRIu32
+                " us, p90 <= %" PRIu32 " us, p99 <= %" PRIu32 " us, max %" PRIu32 " us",
+                deserializer_stage_name(stage), hist->samples, latency_hist_mean(hist),
+                latency_hist_percentile(hist, 50), latency_hist_percentile(hist, 90),
+                latency_hist_percentile(hist, 99), hist->max_us);
+    }
+}
+#endif
+
+/**
+ * @fn void fill_device_stats(void *ctx, deserializer_device_stats_t *device)
+ * @brief Fill in the counters of a Stats reply kept outside the pipeline
+ *
+ * Called for a STATS frame by the task decoding frames. The counters of the
+ * other tasks are read while they may still be updated, so the reply is a
+ * snapshot within an event or so.
+ *
+ * @param ctx Unused callback context
+ * @param device Counters to fill in, zeroed by the caller
+ *
+ * @return void
+ */
+void fill_device_stats(void* ctx, deserializer_device_stats_t* device) {
+    device->uptime_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    device->overflows = rx_overflows;
+    device->rx_high_water = rx_high_water;
+    device->min_free_heap = esp_get_minimum_free_heap_size();
+#if CONFIG_DESERIALIZER_PIPELINE
+    device->queue_dropped = frames_dropped;
+    device->frame_queue_high_water = (uint32_t)frame_ring.stats.high_water;
+#endif
+#if OUTPUT_TASK
+    device->log_dropped = atomic_load(&records_reported) + atomic_load(&records_dropped);
+    device->output_queue_high_water = atomic_load(&output_high_water);
+#endif
+}
+
+/**
+ * @fn bool unpack_payload(void *ctx, const uint8_t *frame, size_t len, payload_view_t *view)
+ * @brief Generic fallback decoder for Payloads with unknown fields
+ *
+ * The specialized decoder in the pipeline handles the two known fields only;
+ * anything else goes through the descriptor-driven payload__unpack(), which
+ * unpacks into the arena instead of the heap.
+ *
+ * @param ctx Unused callback context
+ * @param frame Pointer to the protobuf-encoded message
+ * @param len Length of the message in bytes
+ * @param view Output view, pointing into the arena
+ *
+ * @return true if the message was unpacked, false otherwise
+ */
+bool unpack_payload(void* ctx, uint8_t const* frame, size_t len, payload_view_t* view) {
+    Payload* payload = payload__unpack(&arena_allocator, len, frame);
+    if (payload == NULL) {
+        return false;
+    }
+    view->timestamp = payload->timestamp;
+    view->data = payload->data;
+    view->data_len = strlen(payload->data);
+    return true;
+}
+
+/**
+ * @fn void release_payload(void *ctx)
+ * @brief Release everything the fallback decoder unpacked for the current Payload
+ *
+ * Resetting the arena frees the unpacked Payload and its strings at once, so
+ * no payload__free_unpacked() is needed.
+ *
+ * @param ctx Unused callback context
+ *
+ * @return void
+ */
+void release_payload(void* ctx) { arena_reset(&arena); }
+
+/**
+ * @fn void write_reply(void *ctx, const uint8_t *data, size_t len)
+ * @brief Send an ACK, NACK, Credit or Stats frame back to the PC over the UART TX line
+ *
+ * Replies are a few bytes long and the driver has a TX ring buffer, so this
+ * only copies them and returns; the UART task is not held up by transmission.
+ * Only a Stats reply, sent on request, may be longer than the TX ring buffer
+ * and wait for part of it to be sent.
+ *
+ * @param ctx Unused callback context
+ * @param data Framed reply
+ * @param len Length of the framed reply
+ *
+ * @return void
+ */
+void write_reply(void* ctx, uint8_t const* data, size_t len) {
+    if (uart_write_bytes(UART_NUM, data, len) != (int)len) {
+        ESP_LOGW(TAG, "Failed to send reply");
     }
+}
+
+#if CONFIG_DESERIALIZER_PIPELINE
+/**
+ * @fn void decode_task(void *arg)
+ * @brief Pipeline task decoding the frames queued by uart_task
+ *
+ * Decodes the frames of the frame ring in order, in place, and releases each
+ * one afterwards; the renderings go to the output ring buffer through
+ * queue_payload(). Sleeps on its task notification while the ring is empty, and
+ * also reports the frames uart_task had to drop. Baud rate changes are checked
+ * here, as this task handles the BaudSwitch frames; uart_task is told to flush
+ * its input after one.
+ *
+ * @param arg Pointer to task parameters (unused, set to NULL)
+ *
+ * @return void (task runs indefinitely)
+ */
+void decode_task(void* arg) {
+    uint32_t dropped = 0;
 
-    ESP_LOGI(TAG, "JSON payload created: %s", json_string);
-    ESP_LOGI(TAG, "JSON payload length: %d bytes", strlen(json_string));
+    while (1) {
+        uint8_t const* frame;
+        size_t len;
+#if BAUD_CONTROL
+        if (deserializer_check_baud(&deserializer)) {
+            atomic_store(&baud_changed, true);
+        }
+#endif
+#if STAGE_REPORTS
+        report_stage_stats_due();
+#endif
+        if (!frame_ring_peek(&frame_ring, &frame, &len)) {
+            TickType_t wait = portMAX_DELAY;
+#if CONFIG_DESERIALIZER_AUTOBAUD
+            // uart_task counts the bad frames it cannot delimit too, atomically
+            wait = BAUD_CHECK_WAIT;
+#elif CONFIG_DESERIALIZER_BAUD_NEGOTIATION
+            if (atomic_load_explicit(&deserializer.baud.probation, memory_order_relaxed)) {
+                wait = BAUD_CHECK_WAIT;
+            }
+#endif
+#if STAGE_REPORTS
+            if (wait > STAGE_REPORT_WAIT) {
+                wait = STAGE_REPORT_WAIT;
+            }
+#endif
+            // Notifications given since the last take are counted, so none is missed
+            ulTaskNotifyTake(pdTRUE, wait);
+            continue;
+        }
+        deserializer_handle_frame(&deserializer, frame, len);
+        frame_ring_release(&frame_ring);
+        frame_bytes_out += len;
 
-    // Clean up
-    free(json_string);
-error:
-    cJSON_Delete(json);
-    return;
+        uint32_t total = frames_dropped;
+        if (total != dropped && queue_output(OUTPUT_DROPPED, total - dropped, 0)) {
+            dropped = total;
+        }
+        report_log_dropped(0);
+    }
+}
+
+/**
+ * @fn void queue_frame(void *ctx, const uint8_t *frame, size_t len)
+ * @brief Queue a complete frame for decode_task, without waiting
+ *
+ * Framing callback of uart_task, for frames reassembled by the length-prefix
+ * decoder: they are copied once into the frame ring. When the ring is full the
+ * frame is dropped and counted rather than holding up reception.
+ *
+ * @param ctx Unused callback context
+ * @param frame Complete frame
+ * @param len Length of the frame
+ *
+ * @return void
+ */
+void queue_frame(void* ctx, uint8_t const* frame, size_t len) {
+    if (len == 0) {
+        deserializer_drop_frame(&deserializer, DESERIALIZER_ERROR_UNPACK);
+    } else if (frame_ring_push(&frame_ring, frame, len)) {
+        frame_bytes_in += len;
+        xTaskNotifyGive(decode_task_handle);
+    } else {
+        frames_dropped++;
+    }
+}
+
+#endif
+
+#if OUTPUT_TASK
+/**
+ * @fn void output_task(void *arg)
+ * @brief Task logging what the decoding side rendered
+ *
+ * Lowest priority task: it is the only one that waits for the console, so a
+ * slow log write delays the output but not reception. With
+ * CONFIG_DESERIALIZER_ASYNC_LOG it does not delay decoding either, and the
+ * renderings that found no room are reported here, in their place in the log.
+ *
+ * @param arg Pointer to task parameters (unused, set to NULL)
+ *
+ * @return void (task runs indefinitely)
+ */
+void output_task(void* arg) {
+    while (1) {
+        size_t size;
+        output_header_t* item = xRingbufferReceive(output_ring, &size, portMAX_DELAY);
+        if (item == NULL) {
+            continue;
+        }
+        STAGE_START(log_start);
+        switch (item->kind) {
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY
+        case OUTPUT_CHUNK:
+            show_record(NULL, item->value, (char const*)(item + 1), size - sizeof(*item));
+            STAGE_END(DESERIALIZER_STAGE_LOG, log_start);
+            break;
+#else
+        case OUTPUT_PAYLOAD:
+            show_payload_as_json(NULL, item->value, (char const*)(item + 1),
+                    size - sizeof(*item) - 1);
+            STAGE_END(DESERIALIZER_STAGE_LOG, log_start);
+            break;
+        case OUTPUT_CHUNK:
+            show_payload_chunk(NULL, item->value, (char const*)(item + 1), size - sizeof(*item));
+            STAGE_END(DESERIALIZER_STAGE_LOG, log_start);
+            break;
+#endif
+        case OUTPUT_ERROR:
+            log_deserializer_error(NULL, (deserializer_error_t)item->value);
+            break;
+#if CONFIG_DESERIALIZER_PIPELINE
+        case OUTPUT_DROPPED:
+            // Snapshot of the stats uart_task keeps, to size the frame ring buffer
+            ESP_LOGW(TAG,
+                    "Dropped %" PRIu32 " frame(s), decoding fell behind (frame ring high water "
+                    "%zu bytes, %" PRIu32 " frames)",
+                    item->value, frame_ring.stats.high_water, frame_ring.stats.high_water_frames);
+            break;
+#endif
+        case OUTPUT_LOG_DROPPED:
+            close_json_line();
+            ESP_LOGW(TAG, "Dropped %" PRIu32 " log record(s), the console fell behind",
+                    item->value);
+            break;
+#if STAGE_REPORTS
+        case OUTPUT_STAGE_STATS:
+            log_stage_stats();
+            break;
+#endif
+        default:
+            break;
+        }
+        vRingbufferReturnItem(output_ring, item);
+    }
+}
+
+/**
+ * @fn void queue_payload(void *ctx, size_t payload_len, const char *json, size_t json_len)
+ * @brief Queue a JSON rendering for output_task
+ *
+ * Output callback of decode_task, or of uart_task with CONFIG_DESERIALIZER_ASYNC_LOG
+ * only. Waits for room in the output ring buffer, so the decode task runs at the
+ * pace of the output when the console is slower, unless
+ * CONFIG_DESERIALIZER_ASYNC_LOG is set: the rendering is then dropped and counted.
+ *
+ * @param ctx Unused callback context
+ * @param payload_len Length of the protobuf-encoded Payload in bytes
+ * @param json NUL-terminated JSON rendering of the message
+ * @param json_len Length of the JSON rendering in bytes
+ *
+ * @return void
+ */
+void queue_payload(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY
+    // A whole record, not NUL-terminated, is queued like the last piece of a streamed one
+    queue_payload_chunk(ctx, payload_len, json, json_len);
+#else
+    output_header_t* item = acquire_output(OUTPUT_PAYLOAD, payload_len, json_len + 1, OUTPUT_WAIT);
+    if (item == NULL) {
+        return;
+    }
+    memcpy(item + 1, json, json_len + 1);
+    xRingbufferSendComplete(output_ring, item);
+#endif
+}
+
+/**
+ * @fn void queue_payload_chunk(void *ctx, size_t payload_len, const char *json,
+ *                              size_t json_len)
+ * @brief Queue a piece of a JSON rendering for output_task
+ *
+ * Output callback for chunked transfers and streamed messages, too large to be
+ * rendered in one piece. Waits for room like queue_payload(); when a piece is
+ * dropped, the rest of the rendering is dropped too, so the log never shows
+ * a rendering with a hole in it.
+ *
+ * A binary record cut short would throw its reader out of step instead: once
+ * its first piece is queued, the others always wait for room, and nothing else
+ * is queued in between (with the pipeline, uart_task is kept out by
+ * record_lock).
+ *
+ * @param ctx Unused callback context
+ * @param payload_len Length of the transfer's frames on the last piece, 0 before
+ * @param json Next characters of the rendering, NOT NUL-terminated
+ * @param json_len Number of characters in json
+ *
+ * @return void
+ */
+void queue_payload_chunk(void* ctx, size_t payload_len, char const* json, size_t json_len) {
+    output_header_t* item = NULL;
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY
+    TickType_t wait = record_open ? portMAX_DELAY : OUTPUT_WAIT;
+#if CONFIG_DESERIALIZER_PIPELINE
+    if (!record_open) {
+        xSemaphoreTake(record_lock, portMAX_DELAY);
+    }
+#endif
+#else
+    TickType_t wait = OUTPUT_WAIT;
+#endif
+    if (!chunk_dropped) {
+        item = acquire_output(OUTPUT_CHUNK, payload_len, json_len, wait);
+    }
+    if (item == NULL) {
+        // Counted once: the rest of the rendering is dropped with the piece that was
+        chunk_dropped = payload_len == 0;
+    } else {
+        memcpy(item + 1, json, json_len);
+        xRingbufferSendComplete(output_ring, item);
+    }
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY
+    record_open = item != NULL && payload_len == 0;
+#if CONFIG_DESERIALIZER_PIPELINE
+    if (!record_open) {
+        xSemaphoreGive(record_lock);
+    }
+#endif
+#endif
+}
+
+/**
+ * @fn void queue_error(void *ctx, deserializer_error_t error)
+ * @brief Queue an error report for output_task, without waiting
+ *
+ * Also called from uart_task for framing errors, so it never blocks; the
+ * report is dropped and counted when the output ring buffer is full, or with
+ * the pipeline and binary records, while decode_task is queuing a record.
+ *
+ * @param ctx Unused callback context
+ * @param error Reason the frame was dropped
+ *
+ * @return void
+ */
+void queue_error(void* ctx, deserializer_error_t error) {
+#if !CONFIG_DESERIALIZER_PIPELINE
+    // Ends the streamed rendering it interrupts. decode_task renders transfers in one go, and
+    // must not have this flag cleared by uart_task
+    chunk_dropped = false;
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY
+    record_open = false;  // The record it interrupts was padded to its length
+#endif
+#elif CONFIG_DESERIALIZER_OUTPUT_BINARY
+    if (xSemaphoreTake(record_lock, 0) != pdTRUE) {
+        atomic_fetch_add(&records_dropped, 1);
+        return;
+    }
+#endif
+    output_header_t* item = acquire_output(OUTPUT_ERROR, error, 0, 0);
+    if (item != NULL) {
+        xRingbufferSendComplete(output_ring, item);
+    }
+#if CONFIG_DESERIALIZER_PIPELINE && CONFIG_DESERIALIZER_OUTPUT_BINARY
+    xSemaphoreGive(record_lock);
+#endif
+}
+
+/**
+ * @fn output_header_t *acquire_output(output_kind_t kind, uint32_t value, size_t len,
+ *                                     TickType_t wait)
+ * @brief Reserve an item in the output ring buffer and fill in its header
+ *
+ * The items dropped since the last report are reported first, so output_task
+ * logs the gap where it happened; when even that report finds no room, this
+ * item is dropped as well. Dropped items are only counted, never waited for
+ * longer than wait.
+ *
+ * @param kind Item kind
+ * @param value Item value, see output_kind_t
+ * @param len Bytes following the header
+ * @param wait Maximum time to wait for room in the output ring buffer
+ *
+ * @return Item to fill in and pass to xRingbufferSendComplete(), or NULL if it was dropped
+ */
+output_header_t* acquire_output(output_kind_t kind, uint32_t value, size_t len,
+        TickType_t wait) {
+    output_header_t* item;
+    if (!report_log_dropped(wait)
+            || xRingbufferSendAcquire(output_ring, (void**)&item, sizeof(*item) + len, wait)
+                    != pdTRUE) {
+        atomic_fetch_add(&records_dropped, 1);
+        return NULL;
+    }
+    track_output_high_water();
+    item->kind = kind;
+    item->value = value;
+    return item;
+}
+
+/**
+ * @fn bool report_log_dropped(TickType_t wait)
+ * @brief Queue the report of the items dropped since the last one, if any
+ *
+ * Also called by the decoding side once done with a frame or event, so that the
+ * report does not wait for the next item when the link goes quiet. Never goes
+ * in the middle of a binary record: it waits for the record to be complete.
+ *
+ * @param wait Maximum time to wait for room in the output ring buffer
+ *
+ * @return false if a report is still pending
+ */
+bool report_log_dropped(TickType_t wait) {
+#if CONFIG_DESERIALIZER_OUTPUT_BINARY
+    if (record_open) {
+        return true;
+    }
+#endif
+    uint32_t dropped = atomic_exchange(&records_dropped, 0);
+    if (dropped != 0 && !queue_output(OUTPUT_LOG_DROPPED, dropped, wait)) {
+        atomic_fetch_add(&records_dropped, dropped);
+        return false;
+    }
+    atomic_fetch_add(&records_reported, dropped);
+    return true;
+}
+
+/**
+ * @fn bool queue_output(output_kind_t kind, uint32_t value, TickType_t wait)
+ * @brief Queue an output item without a JSON rendering
+ *
+ * @param kind OUTPUT_DROPPED, OUTPUT_LOG_DROPPED or OUTPUT_STAGE_STATS
+ * @param value Item value, see output_kind_t
+ * @param wait Maximum time to wait for room in the output ring buffer
+ *
+ * @return true if the item was queued
+ */
+bool queue_output(output_kind_t kind, uint32_t value, TickType_t wait) {
+    output_header_t const item = { .kind = kind, .value = value };
+    if (xRingbufferSend(output_ring, &item, sizeof(item), wait) != pdTRUE) {
+        return false;
+    }
+    track_output_high_water();
+    return true;
+}
+
+/**
+ * @fn void track_output_high_water(void)
+ * @brief Raise the output ring buffer high-water mark to its use after an item was queued
+ *
+ * The use is the buffer size less the largest item that still fits, item
+ * headers of the ring buffer included, so the mark is an upper bound of the
+ * bytes queued. Items are queued by uart_task and decode_task alike.
+ *
+ * @return void
+ */
+void track_output_high_water(void) {
+    uint_least32_t used = OUTPUT_BUFFER - xRingbufferGetCurFreeSize(output_ring);
+    uint_least32_t high = atomic_load(&output_high_water);
+    while (used > high && !atomic_compare_exchange_weak(&output_high_water, &high, used)) { }
 }
+#endif
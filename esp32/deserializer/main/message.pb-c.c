@@ -52,6 +52,321 @@ void   payload__free_unpacked
   assert(message->base.descriptor == &payload__descriptor);
   protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
 }
+void   batch__init
+                     (Batch         *message)
+{
+  static const Batch init_value = BATCH__INIT;
+  *message = init_value;
+}
+size_t batch__get_packed_size
+                     (const Batch *message)
+{
+  assert(message->base.descriptor == &batch__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t batch__pack
+                     (const Batch *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &batch__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t batch__pack_to_buffer
+                     (const Batch *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &batch__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Batch *
+       batch__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Batch *)
+     protobuf_c_message_unpack (&batch__descriptor,
+                                allocator, len, data);
+}
+void   batch__free_unpacked
+                     (Batch *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &batch__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   delta_batch__init
+                     (DeltaBatch         *message)
+{
+  static const DeltaBatch init_value = DELTA_BATCH__INIT;
+  *message = init_value;
+}
+size_t delta_batch__get_packed_size
+                     (const DeltaBatch *message)
+{
+  assert(message->base.descriptor == &delta_batch__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t delta_batch__pack
+                     (const DeltaBatch *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &delta_batch__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t delta_batch__pack_to_buffer
+                     (const DeltaBatch *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &delta_batch__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+DeltaBatch *
+       delta_batch__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (DeltaBatch *)
+     protobuf_c_message_unpack (&delta_batch__descriptor,
+                                allocator, len, data);
+}
+void   delta_batch__free_unpacked
+                     (DeltaBatch *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &delta_batch__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   credit__init
+                     (Credit         *message)
+{
+  static const Credit init_value = CREDIT__INIT;
+  *message = init_value;
+}
+size_t credit__get_packed_size
+                     (const Credit *message)
+{
+  assert(message->base.descriptor == &credit__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t credit__pack
+                     (const Credit *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &credit__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t credit__pack_to_buffer
+                     (const Credit *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &credit__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Credit *
+       credit__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Credit *)
+     protobuf_c_message_unpack (&credit__descriptor,
+                                allocator, len, data);
+}
+void   credit__free_unpacked
+                     (Credit *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &credit__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   chunk__init
+                     (Chunk         *message)
+{
+  static const Chunk init_value = CHUNK__INIT;
+  *message = init_value;
+}
+size_t chunk__get_packed_size
+                     (const Chunk *message)
+{
+  assert(message->base.descriptor == &chunk__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t chunk__pack
+                     (const Chunk *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &chunk__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t chunk__pack_to_buffer
+                     (const Chunk *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &chunk__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Chunk *
+       chunk__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Chunk *)
+     protobuf_c_message_unpack (&chunk__descriptor,
+                                allocator, len, data);
+}
+void   chunk__free_unpacked
+                     (Chunk *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &chunk__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   baud_switch__init
+                     (BaudSwitch         *message)
+{
+  static const BaudSwitch init_value = BAUD_SWITCH__INIT;
+  *message = init_value;
+}
+size_t baud_switch__get_packed_size
+                     (const BaudSwitch *message)
+{
+  assert(message->base.descriptor == &baud_switch__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t baud_switch__pack
+                     (const BaudSwitch *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &baud_switch__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t baud_switch__pack_to_buffer
+                     (const BaudSwitch *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &baud_switch__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+BaudSwitch *
+       baud_switch__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (BaudSwitch *)
+     protobuf_c_message_unpack (&baud_switch__descriptor,
+                                allocator, len, data);
+}
+void   baud_switch__free_unpacked
+                     (BaudSwitch *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &baud_switch__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   stage_stats__init
+                     (StageStats         *message)
+{
+  static const StageStats init_value = STAGE_STATS__INIT;
+  *message = init_value;
+}
+size_t stage_stats__get_packed_size
+                     (const StageStats *message)
+{
+  assert(message->base.descriptor == &stage_stats__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t stage_stats__pack
+                     (const StageStats *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &stage_stats__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t stage_stats__pack_to_buffer
+                     (const StageStats *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &stage_stats__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+StageStats *
+       stage_stats__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (StageStats *)
+     protobuf_c_message_unpack (&stage_stats__descriptor,
+                                allocator, len, data);
+}
+void   stage_stats__free_unpacked
+                     (StageStats *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &stage_stats__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   stats__init
+                     (Stats         *message)
+{
+  static const Stats init_value = STATS__INIT;
+  *message = init_value;
+}
+size_t stats__get_packed_size
+                     (const Stats *message)
+{
+  assert(message->base.descriptor == &stats__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t stats__pack
+                     (const Stats *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &stats__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t stats__pack_to_buffer
+                     (const Stats *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &stats__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Stats *
+       stats__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Stats *)
+     protobuf_c_message_unpack (&stats__descriptor,
+                                allocator, len, data);
+}
+void   stats__free_unpacked
+                     (Stats *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &stats__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
 static const ProtobufCFieldDescriptor payload__field_descriptors[2] =
 {
   {
@@ -103,3 +418,659 @@ const ProtobufCMessageDescriptor payload__descriptor =
   (ProtobufCMessageInit) payload__init,
   NULL,NULL,NULL    /* reserved[123] */
 };
+static const ProtobufCFieldDescriptor batch__field_descriptors[1] =
+{
+  {
+    "payloads",
+    1,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Batch, n_payloads),
+    offsetof(Batch, payloads),
+    &payload__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned batch__field_indices_by_name[] = {
+  0,   /* field[0] = payloads */
+};
+static const ProtobufCIntRange batch__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor batch__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "Batch",
+  "Batch",
+  "Batch",
+  "",
+  sizeof(Batch),
+  1,
+  batch__field_descriptors,
+  batch__field_indices_by_name,
+  1,  batch__number_ranges,
+  (ProtobufCMessageInit) batch__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor delta_batch__field_descriptors[3] =
+{
+  {
+    "base_timestamp",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(DeltaBatch, base_timestamp),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "timestamp_deltas",
+    2,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_SINT32,
+    offsetof(DeltaBatch, n_timestamp_deltas),
+    offsetof(DeltaBatch, timestamp_deltas),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_PACKED,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "data",
+    3,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_STRING,
+    offsetof(DeltaBatch, n_data),
+    offsetof(DeltaBatch, data),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned delta_batch__field_indices_by_name[] = {
+  0,   /* field[0] = base_timestamp */
+  2,   /* field[2] = data */
+  1,   /* field[1] = timestamp_deltas */
+};
+static const ProtobufCIntRange delta_batch__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 3 }
+};
+const ProtobufCMessageDescriptor delta_batch__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "DeltaBatch",
+  "DeltaBatch",
+  "DeltaBatch",
+  "",
+  sizeof(DeltaBatch),
+  3,
+  delta_batch__field_descriptors,
+  delta_batch__field_indices_by_name,
+  1,  delta_batch__number_ranges,
+  (ProtobufCMessageInit) delta_batch__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor credit__field_descriptors[2] =
+{
+  {
+    "consumed",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Credit, consumed),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "window",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Credit, window),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned credit__field_indices_by_name[] = {
+  0,   /* field[0] = consumed */
+  1,   /* field[1] = window */
+};
+static const ProtobufCIntRange credit__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 2 }
+};
+const ProtobufCMessageDescriptor credit__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "Credit",
+  "Credit",
+  "Credit",
+  "",
+  sizeof(Credit),
+  2,
+  credit__field_descriptors,
+  credit__field_indices_by_name,
+  1,  credit__number_ranges,
+  (ProtobufCMessageInit) credit__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor chunk__field_descriptors[5] =
+{
+  {
+    "transfer_id",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Chunk, transfer_id),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "index",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Chunk, index),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "size",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Chunk, size),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "timestamp",
+    4,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Chunk, timestamp),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "data",
+    5,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_BYTES,
+    0,   /* quantifier_offset */
+    offsetof(Chunk, data),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned chunk__field_indices_by_name[] = {
+  4,   /* field[4] = data */
+  1,   /* field[1] = index */
+  2,   /* field[2] = size */
+  3,   /* field[3] = timestamp */
+  0,   /* field[0] = transfer_id */
+};
+static const ProtobufCIntRange chunk__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 5 }
+};
+const ProtobufCMessageDescriptor chunk__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "Chunk",
+  "Chunk",
+  "Chunk",
+  "",
+  sizeof(Chunk),
+  5,
+  chunk__field_descriptors,
+  chunk__field_indices_by_name,
+  1,  chunk__number_ranges,
+  (ProtobufCMessageInit) chunk__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor baud_switch__field_descriptors[1] =
+{
+  {
+    "baud_rate",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(BaudSwitch, baud_rate),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned baud_switch__field_indices_by_name[] = {
+  0,   /* field[0] = baud_rate */
+};
+static const ProtobufCIntRange baud_switch__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor baud_switch__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "BaudSwitch",
+  "BaudSwitch",
+  "BaudSwitch",
+  "",
+  sizeof(BaudSwitch),
+  1,
+  baud_switch__field_descriptors,
+  baud_switch__field_indices_by_name,
+  1,  baud_switch__number_ranges,
+  (ProtobufCMessageInit) baud_switch__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor stage_stats__field_descriptors[6] =
+{
+  {
+    "samples",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(StageStats, samples),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "mean_us",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(StageStats, mean_us),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "p50_us",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(StageStats, p50_us),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "p90_us",
+    4,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(StageStats, p90_us),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "p99_us",
+    5,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(StageStats, p99_us),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "max_us",
+    6,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(StageStats, max_us),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned stage_stats__field_indices_by_name[] = {
+  5,   /* field[5] = max_us */
+  1,   /* field[1] = mean_us */
+  2,   /* field[2] = p50_us */
+  3,   /* field[3] = p90_us */
+  4,   /* field[4] = p99_us */
+  0,   /* field[0] = samples */
+};
+static const ProtobufCIntRange stage_stats__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 6 }
+};
+const ProtobufCMessageDescriptor stage_stats__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "StageStats",
+  "StageStats",
+  "StageStats",
+  "",
+  sizeof(StageStats),
+  6,
+  stage_stats__field_descriptors,
+  stage_stats__field_indices_by_name,
+  1,  stage_stats__number_ranges,
+  (ProtobufCMessageInit) stage_stats__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor stats__field_descriptors[15] =
+{
+  {
+    "uptime_ms",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, uptime_ms),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "frames",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, frames),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "payloads",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, payloads),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "bytes",
+    4,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, bytes),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "unpack_errors",
+    5,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, unpack_errors),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "framing_errors",
+    6,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, framing_errors),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "crc_errors",
+    7,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, crc_errors),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "overflows",
+    8,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, overflows),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "queue_dropped",
+    9,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, queue_dropped),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "log_dropped",
+    10,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, log_dropped),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "rx_high_water",
+    11,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, rx_high_water),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "frame_queue_high_water",
+    12,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, frame_queue_high_water),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "output_queue_high_water",
+    13,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, output_queue_high_water),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "min_free_heap",
+    14,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Stats, min_free_heap),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "stages",
+    15,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Stats, n_stages),
+    offsetof(Stats, stages),
+    &stage_stats__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned stats__field_indices_by_name[] = {
+  3,   /* field[3] = bytes */
+  6,   /* field[6] = crc_errors */
+  11,   /* field[11] = frame_queue_high_water */
+  1,   /* field[1] = frames */
+  5,   /* field[5] = framing_errors */
+  9,   /* field[9] = log_dropped */
+  13,   /* field[13] = min_free_heap */
+  12,   /* field[12] = output_queue_high_water */
+  7,   /* field[7] = overflows */
+  2,   /* field[2] = payloads */
+  8,   /* field[8] = queue_dropped */
+  10,   /* field[10] = rx_high_water */
+  14,   /* field[14] = stages */
+  4,   /* field[4] = unpack_errors */
+  0,   /* field[0] = uptime_ms */
+};
+static const ProtobufCIntRange stats__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 15 }
+};
+const ProtobufCMessageDescriptor stats__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "Stats",
+  "Stats",
+  "Stats",
+  "",
+  sizeof(Stats),
+  15,
+  stats__field_descriptors,
+  stats__field_indices_by_name,
+  1,  stats__number_ranges,
+  (ProtobufCMessageInit) stats__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCEnumValue frame_type__enum_values_by_number[14] =
+{
+  { "FRAME_TYPE_PAYLOAD", "FRAME_TYPE__FRAME_TYPE_PAYLOAD", 0 },
+  { "FRAME_TYPE_BATCH", "FRAME_TYPE__FRAME_TYPE_BATCH", 1 },
+  { "FRAME_TYPE_DELTA_BATCH", "FRAME_TYPE__FRAME_TYPE_DELTA_BATCH", 2 },
+  { "FRAME_TYPE_SEQUENCED", "FRAME_TYPE__FRAME_TYPE_SEQUENCED", 3 },
+  { "FRAME_TYPE_SYNC", "FRAME_TYPE__FRAME_TYPE_SYNC", 4 },
+  { "FRAME_TYPE_ACK", "FRAME_TYPE__FRAME_TYPE_ACK", 5 },
+  { "FRAME_TYPE_NACK", "FRAME_TYPE__FRAME_TYPE_NACK", 6 },
+  { "FRAME_TYPE_CREDIT", "FRAME_TYPE__FRAME_TYPE_CREDIT", 7 },
+  { "FRAME_TYPE_CHUNK", "FRAME_TYPE__FRAME_TYPE_CHUNK", 8 },
+  { "FRAME_TYPE_COMPRESSED", "FRAME_TYPE__FRAME_TYPE_COMPRESSED", 9 },
+  { "FRAME_TYPE_DICT_COMPRESSED", "FRAME_TYPE__FRAME_TYPE_DICT_COMPRESSED", 10 },
+  { "FRAME_TYPE_BAUD", "FRAME_TYPE__FRAME_TYPE_BAUD", 11 },
+  { "FRAME_TYPE_BAUD_PROBE", "FRAME_TYPE__FRAME_TYPE_BAUD_PROBE", 12 },
+  { "FRAME_TYPE_STATS", "FRAME_TYPE__FRAME_TYPE_STATS", 13 },
+};
+static const ProtobufCIntRange frame_type__value_ranges[] = {
+{0, 0},{0, 14}
+};
+static const ProtobufCEnumValueIndex frame_type__enum_values_by_name[14] =
+{
+  { "FRAME_TYPE_ACK", 5 },
+  { "FRAME_TYPE_BATCH", 1 },
+  { "FRAME_TYPE_BAUD", 11 },
+  { "FRAME_TYPE_BAUD_PROBE", 12 },
+  { "FRAME_TYPE_CHUNK", 8 },
+  { "FRAME_TYPE_COMPRESSED", 9 },
+  { "FRAME_TYPE_CREDIT", 7 },
+  { "FRAME_TYPE_DELTA_BATCH", 2 },
+  { "FRAME_TYPE_DICT_COMPRESSED", 10 },
+  { "FRAME_TYPE_NACK", 6 },
+  { "FRAME_TYPE_PAYLOAD", 0 },
+  { "FRAME_TYPE_SEQUENCED", 3 },
+  { "FRAME_TYPE_STATS", 13 },
+  { "FRAME_TYPE_SYNC", 4 },
+};
+const ProtobufCEnumDescriptor frame_type__descriptor =
+{
+  PROTOBUF_C__ENUM_DESCRIPTOR_MAGIC,
+  "FrameType",
+  "FrameType",
+  "FrameType",
+  "",
+  14,
+  frame_type__enum_values_by_number,
+  14,
+  frame_type__enum_values_by_name,
+  1,
+  frame_type__value_ranges,
+  NULL,NULL,NULL,NULL   /* reserved[1234] */
+};
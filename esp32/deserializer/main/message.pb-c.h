@@ -16,10 +16,34 @@ PROTOBUF_C__BEGIN_DECLS
 
 
 typedef struct _Payload Payload;
+typedef struct _Batch Batch;
+typedef struct _DeltaBatch DeltaBatch;
+typedef struct _Credit Credit;
+typedef struct _Chunk Chunk;
+typedef struct _BaudSwitch BaudSwitch;
+typedef struct _StageStats StageStats;
+typedef struct _Stats Stats;
 
 
 /* --- enums --- */
 
+typedef enum _FrameType {
+  FRAME_TYPE__FRAME_TYPE_PAYLOAD = 0,
+  FRAME_TYPE__FRAME_TYPE_BATCH = 1,
+  FRAME_TYPE__FRAME_TYPE_DELTA_BATCH = 2,
+  FRAME_TYPE__FRAME_TYPE_SEQUENCED = 3,
+  FRAME_TYPE__FRAME_TYPE_SYNC = 4,
+  FRAME_TYPE__FRAME_TYPE_ACK = 5,
+  FRAME_TYPE__FRAME_TYPE_NACK = 6,
+  FRAME_TYPE__FRAME_TYPE_CREDIT = 7,
+  FRAME_TYPE__FRAME_TYPE_CHUNK = 8,
+  FRAME_TYPE__FRAME_TYPE_COMPRESSED = 9,
+  FRAME_TYPE__FRAME_TYPE_DICT_COMPRESSED = 10,
+  FRAME_TYPE__FRAME_TYPE_BAUD = 11,
+  FRAME_TYPE__FRAME_TYPE_BAUD_PROBE = 12,
+  FRAME_TYPE__FRAME_TYPE_STATS = 13
+    PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(FRAME_TYPE)
+} FrameType;
 
 /* --- messages --- */
 
@@ -34,6 +58,106 @@ struct  _Payload
     , 0, (char *)protobuf_c_empty_string }
 
 
+struct  _Batch
+{
+  ProtobufCMessage base;
+  size_t n_payloads;
+  Payload **payloads;
+};
+#define BATCH__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&batch__descriptor) \
+    , 0,NULL }
+
+
+struct  _DeltaBatch
+{
+  ProtobufCMessage base;
+  uint32_t base_timestamp;
+  size_t n_timestamp_deltas;
+  int32_t *timestamp_deltas;
+  size_t n_data;
+  char **data;
+};
+#define DELTA_BATCH__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&delta_batch__descriptor) \
+    , 0, 0,NULL, 0,NULL }
+
+
+struct  _Credit
+{
+  ProtobufCMessage base;
+  uint32_t consumed;
+  uint32_t window;
+};
+#define CREDIT__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&credit__descriptor) \
+    , 0, 0 }
+
+
+struct  _Chunk
+{
+  ProtobufCMessage base;
+  uint32_t transfer_id;
+  uint32_t index;
+  uint32_t size;
+  uint32_t timestamp;
+  ProtobufCBinaryData data;
+};
+#define CHUNK__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&chunk__descriptor) \
+    , 0, 0, 0, 0, {0,NULL} }
+
+
+struct  _BaudSwitch
+{
+  ProtobufCMessage base;
+  uint32_t baud_rate;
+};
+#define BAUD_SWITCH__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&baud_switch__descriptor) \
+    , 0 }
+
+
+struct  _StageStats
+{
+  ProtobufCMessage base;
+  uint32_t samples;
+  uint32_t mean_us;
+  uint32_t p50_us;
+  uint32_t p90_us;
+  uint32_t p99_us;
+  uint32_t max_us;
+};
+#define STAGE_STATS__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&stage_stats__descriptor) \
+    , 0, 0, 0, 0, 0, 0 }
+
+
+struct  _Stats
+{
+  ProtobufCMessage base;
+  uint32_t uptime_ms;
+  uint32_t frames;
+  uint32_t payloads;
+  uint32_t bytes;
+  uint32_t unpack_errors;
+  uint32_t framing_errors;
+  uint32_t crc_errors;
+  uint32_t overflows;
+  uint32_t queue_dropped;
+  uint32_t log_dropped;
+  uint32_t rx_high_water;
+  uint32_t frame_queue_high_water;
+  uint32_t output_queue_high_water;
+  uint32_t min_free_heap;
+  size_t n_stages;
+  StageStats **stages;
+};
+#define STATS__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&stats__descriptor) \
+    , 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,NULL }
+
+
 /* Payload methods */
 void   payload__init
                      (Payload         *message);
@@ -53,18 +177,180 @@ Payload *
 void   payload__free_unpacked
                      (Payload *message,
                       ProtobufCAllocator *allocator);
+/* Batch methods */
+void   batch__init
+                     (Batch         *message);
+size_t batch__get_packed_size
+                     (const Batch   *message);
+size_t batch__pack
+                     (const Batch   *message,
+                      uint8_t             *out);
+size_t batch__pack_to_buffer
+                     (const Batch   *message,
+                      ProtobufCBuffer     *buffer);
+Batch *
+       batch__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   batch__free_unpacked
+                     (Batch *message,
+                      ProtobufCAllocator *allocator);
+/* DeltaBatch methods */
+void   delta_batch__init
+                     (DeltaBatch         *message);
+size_t delta_batch__get_packed_size
+                     (const DeltaBatch   *message);
+size_t delta_batch__pack
+                     (const DeltaBatch   *message,
+                      uint8_t             *out);
+size_t delta_batch__pack_to_buffer
+                     (const DeltaBatch   *message,
+                      ProtobufCBuffer     *buffer);
+DeltaBatch *
+       delta_batch__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   delta_batch__free_unpacked
+                     (DeltaBatch *message,
+                      ProtobufCAllocator *allocator);
+/* Credit methods */
+void   credit__init
+                     (Credit         *message);
+size_t credit__get_packed_size
+                     (const Credit   *message);
+size_t credit__pack
+                     (const Credit   *message,
+                      uint8_t             *out);
+size_t credit__pack_to_buffer
+                     (const Credit   *message,
+                      ProtobufCBuffer     *buffer);
+Credit *
+       credit__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   credit__free_unpacked
+                     (Credit *message,
+                      ProtobufCAllocator *allocator);
+/* Chunk methods */
+void   chunk__init
+                     (Chunk         *message);
+size_t chunk__get_packed_size
+                     (const Chunk   *message);
+size_t chunk__pack
+                     (const Chunk   *message,
+                      uint8_t             *out);
+size_t chunk__pack_to_buffer
+                     (const Chunk   *message,
+                      ProtobufCBuffer     *buffer);
+Chunk *
+       chunk__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   chunk__free_unpacked
+                     (Chunk *message,
+                      ProtobufCAllocator *allocator);
+/* BaudSwitch methods */
+void   baud_switch__init
+                     (BaudSwitch         *message);
+size_t baud_switch__get_packed_size
+                     (const BaudSwitch   *message);
+size_t baud_switch__pack
+                     (const BaudSwitch   *message,
+                      uint8_t             *out);
+size_t baud_switch__pack_to_buffer
+                     (const BaudSwitch   *message,
+                      ProtobufCBuffer     *buffer);
+BaudSwitch *
+       baud_switch__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   baud_switch__free_unpacked
+                     (BaudSwitch *message,
+                      ProtobufCAllocator *allocator);
+/* StageStats methods */
+void   stage_stats__init
+                     (StageStats         *message);
+size_t stage_stats__get_packed_size
+                     (const StageStats   *message);
+size_t stage_stats__pack
+                     (const StageStats   *message,
+                      uint8_t             *out);
+size_t stage_stats__pack_to_buffer
+                     (const StageStats   *message,
+                      ProtobufCBuffer     *buffer);
+StageStats *
+       stage_stats__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   stage_stats__free_unpacked
+                     (StageStats *message,
+                      ProtobufCAllocator *allocator);
+/* Stats methods */
+void   stats__init
+                     (Stats         *message);
+size_t stats__get_packed_size
+                     (const Stats   *message);
+size_t stats__pack
+                     (const Stats   *message,
+                      uint8_t             *out);
+size_t stats__pack_to_buffer
+                     (const Stats   *message,
+                      ProtobufCBuffer     *buffer);
+Stats *
+       stats__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   stats__free_unpacked
+                     (Stats *message,
+                      ProtobufCAllocator *allocator);
 /* --- per-message closures --- */
 
 typedef void (*Payload_Closure)
                  (const Payload *message,
                   void *closure_data);
+typedef void (*Batch_Closure)
+                 (const Batch *message,
+                  void *closure_data);
+typedef void (*DeltaBatch_Closure)
+                 (const DeltaBatch *message,
+                  void *closure_data);
+typedef void (*Credit_Closure)
+                 (const Credit *message,
+                  void *closure_data);
+typedef void (*Chunk_Closure)
+                 (const Chunk *message,
+                  void *closure_data);
+typedef void (*BaudSwitch_Closure)
+                 (const BaudSwitch *message,
+                  void *closure_data);
+typedef void (*StageStats_Closure)
+                 (const StageStats *message,
+                  void *closure_data);
+typedef void (*Stats_Closure)
+                 (const Stats *message,
+                  void *closure_data);
 
 /* --- services --- */
 
 
 /* --- descriptors --- */
 
+extern const ProtobufCEnumDescriptor    frame_type__descriptor;
 extern const ProtobufCMessageDescriptor payload__descriptor;
+extern const ProtobufCMessageDescriptor batch__descriptor;
+extern const ProtobufCMessageDescriptor delta_batch__descriptor;
+extern const ProtobufCMessageDescriptor credit__descriptor;
+extern const ProtobufCMessageDescriptor chunk__descriptor;
+extern const ProtobufCMessageDescriptor baud_switch__descriptor;
+extern const ProtobufCMessageDescriptor stage_stats__descriptor;
+extern const ProtobufCMessageDescriptor stats__descriptor;
 
 PROTOBUF_C__END_DECLS
 
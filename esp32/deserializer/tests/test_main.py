@@ -7,6 +7,7 @@ import serial
 # Add the path to generated protobuf files
 sys.path.append(os.path.join(os.path.dirname(__file__), "..", "..", "..", "pc"))
 import message_pb2  # pyright: ignore[reportMissingImports]
+import serializer  # pyright: ignore[reportMissingImports]
 
 
 # Test to check if the UART is configured correctly based on the build configuration
@@ -45,12 +46,22 @@ def user_uart():
     ser.close()
 
 
-# Helper function to create protobuf message
+# Helper function to frame raw bytes (FrameType byte included) with a varint length prefix
+def frame_bytes(body: bytes):
+    return serializer.encode_varint(len(body)) + body
+
+
+# Helper function to frame a message: varint length prefix, FrameType byte, message
+def frame_message(message, frame_type=message_pb2.FRAME_TYPE_PAYLOAD):
+    return frame_bytes(bytes([frame_type]) + message.SerializeToString())
+
+
+# Helper function to create protobuf message, framed as a single Payload
 def create_protobuf_payload(timestamp: int, data: str):
     payload = message_pb2.Payload()
     payload.timestamp = timestamp
     payload.data = data
-    return payload.SerializeToString()
+    return frame_message(payload)
 
 
 # Test to verify the correct number of bytes are processed and logged
@@ -119,10 +130,10 @@ def test_protobuf_various_valid_sizes(
         )
 
 
-# Test to verify handling of maximum size message (112 bytes of data)
+# Test to verify handling of maximum size message (256 bytes frame: 246 bytes of data)
 def test_protobuf_max_size_message(dut, user_uart):
-    # Create a protobuf message with maximum allowed size (112 bytes of data)
-    serialized_msg = create_protobuf_payload(1727185234, "A" * 112)
+    # Create a protobuf message with maximum allowed size (246 bytes of data)
+    serialized_msg = create_protobuf_payload(1727185234, "A" * 246)
 
     time.sleep(1)  # Wait before sending
     user_uart.write(serialized_msg)
@@ -131,20 +142,243 @@ def test_protobuf_max_size_message(dut, user_uart):
 
     # Expect successful processing
     dut.expect(
-        f'JSON payload created: {{"timestamp":1727185234,"data":"{"A"*112}"}}',
+        f'JSON payload created: {{"timestamp":1727185234,"data":"{"A"*246}"}}',
         timeout=5,
     )
 
 
-# Test to verify handling of over-maximum size message (113 bytes of data or more)
+# Test to verify that a message longer than the frame buffer is streamed (3009-byte Payload)
+def test_protobuf_streamed_message(dut, user_uart: serial.Serial):
+    serialized_msg = create_protobuf_payload(1727185234, "A" * 3000)
+
+    time.sleep(1)  # Wait before sending
+    user_uart.write(serialized_msg)
+    user_uart.flush()
+
+    # The rendering is logged piece by piece on one line, then the lengths
+    dut.expect(
+        f'JSON payload created: {{"timestamp":1727185234,"data":"{"A"*3000}"}}',
+        timeout=10,
+    )
+    dut.expect("Received payload of length 3009 bytes", timeout=5)
+    dut.expect("JSON payload length: 3034 bytes", timeout=5)
+
+
+# Test to verify handling of over-maximum size message (4096 bytes frame: 4087 bytes of data)
 def test_protobuf_over_max_size_message(dut, user_uart: serial.Serial):
-    # Create and send a 200-byte message (should fail to unpack)
-    serialized_msg = create_protobuf_payload(1727185234, "A" * 113)
+    # Create and send a 4097-byte frame (over CONFIG_DESERIALIZER_MAX_MESSAGE_SIZE)
+    serialized_msg = create_protobuf_payload(1727185234, "A" * 4087)
 
     time.sleep(1)  # Wait before sending
     user_uart.write(serialized_msg)
     user_uart.flush()
-    time.sleep(1)  # Wait after sending
 
-    # Expect failure message
-    dut.expect("Failed to unpack payload", timeout=5)
+    # Expect discard message once the whole frame was received
+    dut.expect_exact("Discarded 1 frame(s) larger than 4096 bytes", timeout=10)
+
+
+# Test to verify that back-to-back messages in a single write are all decoded
+def test_back_to_back_messages(dut, user_uart: serial.Serial):
+    serialized_msgs = b"".join(
+        create_protobuf_payload(1727185240 + i, f"burst {i}") for i in range(5)
+    )
+
+    time.sleep(1)  # Wait before sending
+    user_uart.write(serialized_msgs)
+    user_uart.flush()
+
+    for i in range(5):
+        dut.expect(
+            f'JSON payload created: {{"timestamp":{1727185240 + i},"data":"burst {i}"}}',
+            timeout=5,
+        )
+
+
+# Test to verify that a message split across several writes is reassembled
+def test_split_message(dut, user_uart: serial.Serial):
+    serialized_msg = create_protobuf_payload(1727185250, "split across writes")
+    half = len(serialized_msg) // 2
+
+    time.sleep(1)  # Wait before sending
+    user_uart.write(serialized_msg[:half])
+    user_uart.flush()
+    time.sleep(0.5)  # Let the first half arrive as its own UART event
+    user_uart.write(serialized_msg[half:])
+    user_uart.flush()
+
+    dut.expect(
+        'JSON payload created: {"timestamp":1727185250,"data":"split across writes"}',
+        timeout=5,
+    )
+
+
+# Test to verify that every Payload of a Batch frame is decoded, in order
+def test_batch_message(dut, user_uart: serial.Serial):
+    batch = message_pb2.Batch()
+    for i in range(4):
+        batch.payloads.add(timestamp=1727185260 + i, data=f"batched {i}")
+
+    time.sleep(1)  # Wait before sending
+    user_uart.write(frame_message(batch, message_pb2.FRAME_TYPE_BATCH))
+    user_uart.flush()
+
+    for i in range(4):
+        dut.expect(
+            f'JSON payload created: {{"timestamp":{1727185260 + i},"data":"batched {i}"}}',
+            timeout=5,
+        )
+
+
+# Test to verify that a DeltaBatch frame is decoded with its absolute timestamps rebuilt
+def test_delta_batch_message(dut, user_uart: serial.Serial):
+    batch = message_pb2.DeltaBatch()
+    batch.base_timestamp = 1727185270
+    batch.timestamp_deltas.extend([0, 0, 3, -1])
+    batch.data.extend(f"delta {i}" for i in range(4))
+    timestamps = [1727185270, 1727185270, 1727185273, 1727185272]
+
+    time.sleep(1)  # Wait before sending
+    user_uart.write(frame_message(batch, message_pb2.FRAME_TYPE_DELTA_BATCH))
+    user_uart.flush()
+
+    for i, timestamp in enumerate(timestamps):
+        dut.expect(
+            f'JSON payload created: {{"timestamp":{timestamp},"data":"delta {i}"}}',
+            timeout=5,
+        )
+
+
+# Test to verify that a Payload split into Chunk frames is reassembled and logged whole
+def test_chunked_transfer(dut, user_uart: serial.Serial):
+    data = b"C" * 1000
+    chunks = []
+    for index, pos in enumerate(range(0, len(data), 200)):
+        chunk = message_pb2.Chunk(transfer_id=7, index=index, data=data[pos : pos + 200])
+        if index == 0:
+            chunk.size = len(data)
+            chunk.timestamp = 1727185275
+        chunks.append(frame_message(chunk, message_pb2.FRAME_TYPE_CHUNK))
+
+    time.sleep(1)  # Wait before sending
+    user_uart.write(b"".join(chunks))
+    user_uart.flush()
+
+    dut.expect(
+        f'JSON payload created: {{"timestamp":1727185275,"data":"{"C"*1000}"}}',
+        timeout=10,
+    )
+    dut.expect("JSON payload length: 1034 bytes", timeout=5)
+
+
+# Test to verify that a compressed Batch frame is decompressed and all its Payloads decoded
+def test_compressed_batch(dut, user_uart: serial.Serial):
+    batch = message_pb2.Batch()
+    for i in range(4):
+        batch.payloads.add(timestamp=1727185276, data=f"compressed sensor reading {i}")
+    frame = bytes([message_pb2.FRAME_TYPE_BATCH]) + batch.SerializeToString()
+    compressed = serializer.lzss_compress(frame)
+    assert len(compressed) < len(frame)
+
+    time.sleep(1)  # Wait before sending
+    user_uart.write(frame_bytes(bytes([message_pb2.FRAME_TYPE_COMPRESSED]) + compressed))
+    user_uart.flush()
+
+    for i in range(4):
+        dut.expect(
+            'JSON payload created: {"timestamp":1727185276,'
+            f'"data":"compressed sensor reading {i}"}}',
+            timeout=5,
+        )
+
+
+# Test to verify that short frames compressed against the built-in dictionary are decoded,
+# and that frames compressed against another dictionary version are refused
+def test_dictionary_compressed(dut, user_uart: serial.Serial):
+    payload = message_pb2.Payload(timestamp=1727185277, data="battery voltage nominal")
+    frame_type, body = serializer.compress_frame(
+        payload.SerializeToString(), message_pb2.FRAME_TYPE_PAYLOAD, dictionary=True
+    )
+    assert frame_type == message_pb2.FRAME_TYPE_DICT_COMPRESSED
+    assert body[0] == serializer.DICTIONARY_VERSION
+
+    time.sleep(1)  # Wait before sending
+    user_uart.write(frame_bytes(bytes([frame_type]) + body))
+    user_uart.flush()
+    dut.expect(
+        'JSON payload created: {"timestamp":1727185277,"data":"battery voltage nominal"}',
+        timeout=5,
+    )
+
+    other_version = bytes([(serializer.DICTIONARY_VERSION + 1) & 0xFF]) + body[1:]
+    user_uart.write(frame_bytes(bytes([frame_type]) + other_version))
+    user_uart.flush()
+    dut.expect("Compressed with an unknown dictionary", timeout=5)
+
+
+# Test to verify that sequenced frames are acknowledged over the ESP32 TX line
+def test_acknowledged_messages(dut, user_uart: serial.Serial):
+    payload = message_pb2.Payload()
+    payload.timestamp = 1727185280
+    payload.data = "acknowledged"
+    sequenced = bytes([message_pb2.FRAME_TYPE_PAYLOAD]) + payload.SerializeToString()
+
+    time.sleep(1)  # Wait before sending
+    user_uart.reset_input_buffer()
+
+    # SYNC: the ESP32 answers with an ACK for the sequence number it now expects
+    user_uart.write(frame_bytes(bytes([message_pb2.FRAME_TYPE_SYNC, 0])))
+    assert user_uart.read(3) == frame_bytes(bytes([message_pb2.FRAME_TYPE_ACK, 0]))
+
+    # In order: decoded and acknowledged
+    user_uart.write(frame_bytes(bytes([message_pb2.FRAME_TYPE_SEQUENCED, 0]) + sequenced))
+    dut.expect(
+        'JSON payload created: {"timestamp":1727185280,"data":"acknowledged"}', timeout=5
+    )
+    assert user_uart.read(3) == frame_bytes(bytes([message_pb2.FRAME_TYPE_ACK, 1]))
+
+    # Frame 1 lost: frame 2 is NACKed so the sender resends from 1
+    user_uart.write(frame_bytes(bytes([message_pb2.FRAME_TYPE_SEQUENCED, 2]) + sequenced))
+    assert user_uart.read(3) == frame_bytes(bytes([message_pb2.FRAME_TYPE_NACK, 1]))
+
+    # Duplicate of frame 0: acknowledged again, not decoded
+    user_uart.write(frame_bytes(bytes([message_pb2.FRAME_TYPE_SEQUENCED, 0]) + sequenced))
+    assert user_uart.read(3) == frame_bytes(bytes([message_pb2.FRAME_TYPE_ACK, 1]))
+
+
+# Test to verify that the baud rate is raised at runtime and lowered back
+def test_baud_negotiation(dut, user_uart: serial.Serial):
+    time.sleep(1)  # Wait before sending
+    user_uart.reset_input_buffer()
+
+    assert serializer.negotiate_baud(user_uart, "length", 115200) == 115200
+    dut.expect("Baud rate set to 115200", timeout=5)
+    user_uart.write(create_protobuf_payload(1727185290, "negotiated"))
+    dut.expect(
+        'JSON payload created: {"timestamp":1727185290,"data":"negotiated"}', timeout=5
+    )
+
+    # Back to 9600 for the other tests: a switch down needs no probing, only the confirmation
+    reader = serializer.FrameReader("length")
+    assert serializer.request_baud(user_uart, reader, "length", 9600) == 9600
+    user_uart.baudrate = 9600
+    time.sleep(serializer.BAUD_SETTLE)
+    assert serializer.request_baud(user_uart, reader, "length", 9600) == 9600
+    dut.expect("Baud rate set to 9600", timeout=5)
+
+
+# Test to verify that a STATS frame is answered with the counters over the ESP32 TX line
+def test_stats_query(dut, user_uart: serial.Serial):
+    time.sleep(1)  # Wait before sending
+    user_uart.reset_input_buffer()
+    reader = serializer.FrameReader("length")
+
+    before = serializer.query_stats(user_uart, reader, "length")
+    assert before is not None
+    user_uart.write(create_protobuf_payload(1727185300, "counted"))
+    dut.expect('JSON payload created: {"timestamp":1727185300,"data":"counted"}', timeout=5)
+
+    after = serializer.query_stats(user_uart, reader, "length")
+    assert after is not None
+    assert after.uptime_ms > before.uptime_ms
+    assert after.payloads == before.payloads + 1
+    assert after.min_free_heap > 0
@@ -24,13 +24,29 @@ _sym_db = _symbol_database.Default()
 
 
 
-DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\rmessage.proto\"*\n\x07Payload\x12\x11\n\ttimestamp\x18\x01 \x01(\r\x12\x0c\n\x04\x64\x61ta\x18\x02 \x01(\tb\x06proto3')
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\rmessage.proto\"*\n\x07Payload\x12\x11\n\ttimestamp\x18\x01 \x01(\r\x12\x0c\n\x04\x64\x61ta\x18\x02 \x01(\t\"#\n\x05\x42\x61tch\x12\x1a\n\x08payloads\x18\x01 \x03(\x0b\x32\x08.Payload\"L\n\nDeltaBatch\x12\x16\n\x0e\x62\x61se_timestamp\x18\x01 \x01(\r\x12\x18\n\x10timestamp_deltas\x18\x02 \x03(\x11\x12\x0c\n\x04\x64\x61ta\x18\x03 \x03(\t\"*\n\x06\x43redit\x12\x10\n\x08\x63onsumed\x18\x01 \x01(\r\x12\x0e\n\x06window\x18\x02 \x01(\r\"Z\n\x05\x43hunk\x12\x13\n\x0btransfer_id\x18\x01 \x01(\r\x12\r\n\x05index\x18\x02 \x01(\r\x12\x0c\n\x04size\x18\x03 \x01(\r\x12\x11\n\ttimestamp\x18\x04 \x01(\r\x12\x0c\n\x04\x64\x61ta\x18\x05 \x01(\x0c\"\x1f\n\nBaudSwitch\x12\x11\n\tbaud_rate\x18\x01 \x01(\r\"n\n\nStageStats\x12\x0f\n\x07samples\x18\x01 \x01(\r\x12\x0f\n\x07mean_us\x18\x02 \x01(\r\x12\x0e\n\x06p50_us\x18\x03 \x01(\r\x12\x0e\n\x06p90_us\x18\x04 \x01(\r\x12\x0e\n\x06p99_us\x18\x05 \x01(\r\x12\x0e\n\x06max_us\x18\x06 \x01(\r\"\xd9\x02\n\x05Stats\x12\x11\n\tuptime_ms\x18\x01 \x01(\r\x12\x0e\n\x06\x66rames\x18\x02 \x01(\r\x12\x10\n\x08payloads\x18\x03 \x01(\r\x12\r\n\x05\x62ytes\x18\x04 \x01(\r\x12\x15\n\runpack_errors\x18\x05 \x01(\r\x12\x16\n\x0e\x66raming_errors\x18\x06 \x01(\r\x12\x12\n\ncrc_errors\x18\x07 \x01(\r\x12\x11\n\toverflows\x18\x08 \x01(\r\x12\x15\n\rqueue_dropped\x18\t \x01(\r\x12\x13\n\x0blog_dropped\x18\n \x01(\r\x12\x15\n\rrx_high_water\x18\x0b \x01(\r\x12\x1e\n\x16\x66rame_queue_high_water\x18\x0c \x01(\r\x12\x1f\n\x17output_queue_high_water\x18\r \x01(\r\x12\x15\n\rmin_free_heap\x18\x0e \x01(\r\x12\x1b\n\x06stages\x18\x0f \x03(\x0b\x32\x0b.StageStats*\xdb\x02\n\tFrameType\x12\x16\n\x12\x46RAME_TYPE_PAYLOAD\x10\x00\x12\x14\n\x10\x46RAME_TYPE_BATCH\x10\x01\x12\x1a\n\x16\x46RAME_TYPE_DELTA_BATCH\x10\x02\x12\x18\n\x14\x46RAME_TYPE_SEQUENCED\x10\x03\x12\x13\n\x0f\x46RAME_TYPE_SYNC\x10\x04\x12\x12\n\x0e\x46RAME_TYPE_ACK\x10\x05\x12\x13\n\x0f\x46RAME_TYPE_NACK\x10\x06\x12\x15\n\x11\x46RAME_TYPE_CREDIT\x10\x07\x12\x14\n\x10\x46RAME_TYPE_CHUNK\x10\x08\x12\x19\n\x15\x46RAME_TYPE_COMPRESSED\x10\t\x12\x1e\n\x1a\x46RAME_TYPE_DICT_COMPRESSED\x10\n\x12\x13\n\x0f\x46RAME_TYPE_BAUD\x10\x0b\x12\x19\n\x15\x46RAME_TYPE_BAUD_PROBE\x10\x0c\x12\x14\n\x10\x46RAME_TYPE_STATS\x10\rb\x06proto3')
 
 _globals = globals()
 _builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, _globals)
 _builder.BuildTopDescriptorsAndMessages(DESCRIPTOR, 'message_pb2', _globals)
 if not _descriptor._USE_C_DESCRIPTORS:
   DESCRIPTOR._loaded_options = None
+  _globals['_FRAMETYPE']._serialized_start=806
+  _globals['_FRAMETYPE']._serialized_end=1153
   _globals['_PAYLOAD']._serialized_start=17
   _globals['_PAYLOAD']._serialized_end=59
+  _globals['_BATCH']._serialized_start=61
+  _globals['_BATCH']._serialized_end=96
+  _globals['_DELTABATCH']._serialized_start=98
+  _globals['_DELTABATCH']._serialized_end=174
+  _globals['_CREDIT']._serialized_start=176
+  _globals['_CREDIT']._serialized_end=218
+  _globals['_CHUNK']._serialized_start=220
+  _globals['_CHUNK']._serialized_end=310
+  _globals['_BAUDSWITCH']._serialized_start=312
+  _globals['_BAUDSWITCH']._serialized_end=343
+  _globals['_STAGESTATS']._serialized_start=345
+  _globals['_STAGESTATS']._serialized_end=455
+  _globals['_STATS']._serialized_start=458
+  _globals['_STATS']._serialized_end=803
 # @@protoc_insertion_point(module_scope)
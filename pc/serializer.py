@@ -5,6 +5,40 @@
          transmitting protobuf-encoded messages to embedded devices such as ESP32.
          Features include automatic port detection, configurable baud rates, and
          timestamped message transmission with binary protobuf serialization.
+         Every message is framed, either with a varint length prefix or with COBS
+         and a 0x00 delimiter, so the receiver can split a continuous byte stream
+         back into individual messages. Frames start with a FrameType byte and carry
+         either a single Payload or, in batching mode, several messages in a
+         DeltaBatch (delta-encoded timestamps) or a Batch.
+         With --window, frames are sequence-numbered and acknowledged by the ESP32
+         over its TX line: up to N frames are kept in flight and lost ones are sent
+         again, so no message is lost when the board falls behind.
+         With --credits, frames are only written while they fit in the free space
+         the ESP32 advertises for its UART receive buffer, so it never overflows.
+         Messages longer than the ESP32 frame buffer are streamed by the firmware, up
+         to the frame size given with --max-message-size. With --chunked they are
+         split into Chunk frames that fit in the frame buffer instead, and reassembled
+         by the ESP32; this also works with the pipelined firmware and lets a windowed
+         link resend a lost piece rather than the whole message.
+         With --compress, every frame that gets smaller with LZSS is sent compressed
+         (decision made frame by frame), and batches may hold as many messages as fit
+         in one frame once compressed, which raises the message rate of slow links.
+         With --dictionary, frames are compressed against a dictionary of common
+         telemetry words built into the firmware too, so that short messages sent
+         one per frame also shrink; its version travels in every frame and the
+         ESP32 refuses frames compressed against another one.
+         With --negotiate, the link is moved to the fastest rate both ends carry
+         reliably once connected: each faster rate the ESP32 accepts is probed with
+         a known pattern and only kept if every probe arrives intact, otherwise
+         both ends fall back to the starting rate.
+         With the "-crc" framings, every frame ends with the CRC-32 of its body, so
+         a frame hit by a bit error is dropped instead of decoded, and the ESP32
+         finds the next intact frame right after it.
+         With --stats, no message is sent: the ESP32 is asked for its counters every
+         few seconds over the same link, and answers on its TX line with frames and
+         bytes received, errors, overflows, queue high-water marks, its lowest free
+         heap and, when the firmware times them, the latency of every stage, which
+         are printed along with the rates since the previous answer.
 
 @author Juan Ignacio Giorgetti
 @date 2025
@@ -19,36 +53,366 @@
 @usage
 Command line execution:
     uv run serializer.py [--port PORT] [--baudrate RATE]
+                         [--framing {length,cobs,length-crc,cobs-crc}] [--batch N]
+                         [--batch-encoding {delta,plain}] [--linger MS]
+                         [--window N] [--ack-timeout MS] [--credits] [--rtscts]
+                         [--max-message-size BYTES] [--chunked] [--compress]
+                         [--dictionary] [--negotiate [MAX_RATE]] [--stats SECONDS]
 
 Examples:
     uv run serializer.py --port COM3 --baudrate 115200
+    uv run serializer.py --port /dev/ttyUSB0 --baudrate 3000000 --rtscts
     uv run serializer.py --port /dev/ttyUSB0
     uv run serializer.py --baudrate 300
+    uv run serializer.py --framing cobs
+    uv run serializer.py --framing cobs-crc
+    producer | uv run serializer.py --batch 16 --linger 20
+    producer | uv run serializer.py --window 8 --batch 16
+    producer | uv run serializer.py --credits --batch 16
+    producer | uv run serializer.py --framing cobs --window 8 --chunked
+    producer | uv run serializer.py --batch 32 --compress
+    producer | uv run serializer.py --dictionary
+    uv run serializer.py --port /dev/ttyUSB0 --baudrate 115200 --negotiate 921600
+    uv run serializer.py --port /dev/ttyUSB0 --baudrate 115200 --stats 10
 
 @note Requires message_pb2.py generated from message.proto protobuf schema
-@warning Ensure target device matches the configured baud rate for proper communication
+@warning Ensure target device matches the configured baud rate and framing for proper communication
 """
 
 from time import timezone
 import serial
 import serial.tools.list_ports
 import argparse
+import collections
+import itertools
+import random
+import threading
+import time
+import zlib
 from datetime import datetime, timezone
+from google.protobuf.message import DecodeError
 
 import message_pb2  # Generated protobuf classes
 
 TIMEOUT = 1  #!< Timeout in seconds for serial read/write operations
+FRAMINGS = ("length", "cobs", "length-crc", "cobs-crc")  #!< Must match the firmware Kconfig
+CRC_SIZE = 4  #!< CRC-32 ending every frame of the "-crc" framings (FRAME_CRC_LEN)
+COBS_DELIMITER = 0x00  #!< Byte terminating every COBS frame
+MAX_FRAME_SIZE = 256  #!< Largest frame the firmware decodes whole (type byte included)
+MAX_MESSAGE_SIZE = 4096  #!< Largest frame the firmware accepts, streamed beyond MAX_FRAME_SIZE
+BITS_PER_BYTE = 10  #!< 8N1: start bit, 8 data bits, stop bit
+SEQUENCED_HEADER_SIZE = 2  #!< FrameType and sequence number bytes added in windowed mode
+MAX_WINDOW = 127  #!< Largest window the 8-bit sequence numbers allow (DESERIALIZER_MAX_WINDOW)
+MAX_RETRIES = 10  #!< Consecutive unanswered retransmissions before the link is given up
+CHUNK_LEN_BYTES = 2  #!< Length prefix of a Chunk data field up to MAX_FRAME_SIZE bytes
+COBS_OVERHEAD = 2  #!< COBS code bytes of a frame up to MAX_FRAME_SIZE bytes once encoded
+DECOMPRESS_SIZE = 1024  #!< Largest frame the firmware decompresses (its decompression buffer)
+LZSS_DISTANCE_BITS = 11  #!< Back-reference bits holding the distance (see lzss.h)
+LZSS_LENGTH_BITS = 5  #!< Back-reference bits holding the length
+LZSS_MIN_MATCH = 3  #!< Shortest back-reference
+LZSS_MAX_MATCH = LZSS_MIN_MATCH + (1 << LZSS_LENGTH_BITS) - 1
+LZSS_MAX_DISTANCE = 1 << LZSS_DISTANCE_BITS
+LZSS_CHAIN = 32  #!< Earlier positions tried per match search
+BAUD_RATES = (921600, 460800, 230400, 115200, 57600, 38400, 19200, 9600)  #!< Fastest first
+BAUD_PROBE_LEN = 32  #!< Bytes of a probe pattern (DESERIALIZER_BAUD_PROBE_LEN)
+BAUD_PROBES = 4  #!< Probes that must all arrive intact for a rate to be kept
+BAUD_REPLY_TIMEOUT = 0.2  #!< Time in seconds to wait for the answer to a BaudSwitch or probe
+BAUD_SETTLE = 0.05  #!< Time in seconds left to both UARTs to change rate
+BAUD_TIMEOUT = 1.0  #!< CONFIG_DESERIALIZER_BAUD_TIMEOUT_MS of the ESP32, in seconds
+STATS_TIMEOUT = 1.0  #!< Time in seconds to wait for a Stats reply, up to MAX_REPLY_SIZE bytes long
+STAGE_NAMES = ("wait", "read", "decode", "render", "output", "log")  #!< deserializer_stage_t
+MAX_REPLY_SIZE = 1 + 14 * 6 + len(STAGE_NAMES) * (2 + 6 * 6)  #!< A Stats, all fields at 6 bytes
+DICTIONARY_VERSION = 1  #!< Version of DICTIONARY, LZSS_DICT_VERSION in the firmware
+DICTIONARY = (
+    b"Hello world! device firmware version uptime signal rssi dBm current mA power mW "
+    b"value min max avg count error warning update node gateway level % battery voltage mV "
+    b"pressure hPa humidity %RH temperature C alarm cleared status ok nominal sensor reading "
+)  #!< Must stay byte-identical to lzss_dict.c, and bump DICTIONARY_VERSION when changed
 
 
-def setup_uart(port: str, baud_rate: int) -> serial.Serial | None:
+def encode_varint(value: int) -> bytes:
+    """
+    @fn encode_varint
+    @brief Encode a non-negative integer as a protobuf base-128 varint
+    @param value Integer to encode
+    @return Encoded bytes (least significant group first)
+    """
+    out = bytearray()
+    while value > 0x7F:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def cobs_encode(data: bytes) -> bytes:
+    """
+    @fn cobs_encode
+    @brief Encode data with Consistent Overhead Byte Stuffing
+    @details Replaces every 0x00 byte with the distance to the next one, so the
+             output contains no 0x00 and can be terminated by COBS_DELIMITER.
+             Costs one byte per started block of 254 non-zero bytes.
+    @param data Bytes to encode
+    @return Encoded bytes, without the trailing delimiter
+    """
+    out = bytearray()
+    block = bytearray()
+    for byte in data:
+        if byte == 0:
+            out.append(len(block) + 1)
+            out += block
+            block.clear()
+        else:
+            block.append(byte)
+            if len(block) == 254:
+                out.append(0xFF)
+                out += block
+                block.clear()
+    out.append(len(block) + 1)
+    out += block
+    return bytes(out)
+
+
+def decode_varint(data: bytes, pos: int = 0) -> tuple[int, int] | None:
+    """
+    @fn decode_varint
+    @brief Decode a protobuf base-128 varint
+    @param data Buffer holding the varint
+    @param pos Offset of the first varint byte in data
+    @return Tuple of the value and the offset after the varint, or None if it is incomplete
+    """
+    value = 0
+    shift = 0
+    while pos < len(data):
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+    return None
+
+
+def cobs_decode(data: bytes) -> bytes | None:
+    """
+    @fn cobs_decode
+    @brief Decode a COBS frame (without its delimiter)
+    @param data Encoded frame
+    @return Decoded bytes, or None if data is not valid COBS
+    """
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        if code == 0 or pos + code > len(data):
+            return None
+        out += data[pos + 1 : pos + code]
+        pos += code
+        if code != 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def lzss_compress(data: bytes, dictionary: bytes = b"") -> bytes:
+    """
+    @fn lzss_compress
+    @brief Compress data with the LZSS encoding the firmware decompresses
+    @details Greedy longest match over the last LZSS_MAX_DISTANCE bytes, found through
+             a chain of the earlier positions of every 3-byte prefix. Each group starts
+             with a flag byte, least significant bit first: 0 for a literal byte, 1 for
+             a big-endian 2-byte back-reference (distance - 1, then length - 3).
+             With a dictionary, matches may also be found in it, as if it had been
+             sent just before data.
+    @param data Bytes to compress
+    @param dictionary Bytes the decompressor holds before its output, see DICTIONARY
+    @return Compressed stream, at most len(data) / 8 + 1 bytes longer than data
+    """
+    start = len(dictionary)
+    data = dictionary + data
+    out = bytearray()
+    chains = {}
+    for i in range(max(0, start - LZSS_MAX_DISTANCE), start):
+        chain = chains.setdefault(data[i : i + LZSS_MIN_MATCH], [])
+        chain.append(i)
+        if len(chain) > LZSS_CHAIN:
+            del chain[0]
+    flags_pos = 0
+    bit = 8
+    pos = start
+    while pos < len(data):
+        if bit == 8:
+            flags_pos = len(out)
+            out.append(0)
+            bit = 0
+        best_len, best_dist = 0, 0
+        limit = min(LZSS_MAX_MATCH, len(data) - pos)
+        if limit >= LZSS_MIN_MATCH:
+            for start in reversed(chains.get(data[pos : pos + LZSS_MIN_MATCH], ())):
+                if pos - start > LZSS_MAX_DISTANCE:
+                    break
+                length = LZSS_MIN_MATCH
+                while length < limit and data[start + length] == data[pos + length]:
+                    length += 1
+                if length > best_len:
+                    best_len, best_dist = length, pos - start
+                    if length == limit:
+                        break
+        if best_len >= LZSS_MIN_MATCH:
+            token = (best_dist - 1) << LZSS_LENGTH_BITS | (best_len - LZSS_MIN_MATCH)
+            out += token.to_bytes(2, "big")
+            out[flags_pos] |= 1 << bit
+        else:
+            best_len = 1
+            out.append(data[pos])
+        for i in range(pos, pos + best_len):
+            chain = chains.setdefault(data[i : i + LZSS_MIN_MATCH], [])
+            chain.append(i)
+            if len(chain) > LZSS_CHAIN:
+                del chain[0]
+        pos += best_len
+        bit += 1
+    return bytes(out)
+
+
+def compress_frame(
+    message_bytes: bytes, frame_type: int, dictionary: bool = False
+) -> tuple[int, bytes]:
+    """
+    @fn compress_frame
+    @brief Compress a frame when that makes it shorter
+    @details The FrameType byte and the message are compressed together and sent in
+             a FRAME_TYPE_COMPRESSED frame, or with dictionary against DICTIONARY in
+             a FRAME_TYPE_DICT_COMPRESSED frame that starts with DICTIONARY_VERSION.
+             Frames longer than DECOMPRESS_SIZE, or that do not shrink, are left as
+             they are.
+    @param message_bytes Serialized protobuf message
+    @param frame_type FrameType value matching message_bytes
+    @param dictionary Compress against DICTIONARY
+    @return Tuple of the FrameType and the message to send in its place
+    """
+    frame = bytes([frame_type]) + message_bytes
+    if len(frame) > DECOMPRESS_SIZE:
+        return frame_type, message_bytes
+    if dictionary:
+        compressed_type = message_pb2.FRAME_TYPE_DICT_COMPRESSED
+        packed = bytes([DICTIONARY_VERSION]) + lzss_compress(frame, DICTIONARY)
+    else:
+        compressed_type = message_pb2.FRAME_TYPE_COMPRESSED
+        packed = lzss_compress(frame)
+    if len(packed) >= len(message_bytes):
+        return frame_type, message_bytes
+    return compressed_type, packed
+
+
+def split_framing(framing: str) -> tuple[str, bool]:
+    """
+    @fn split_framing
+    @brief Split a framing mode into its delimiting method and whether frames carry a CRC
+    @param framing Framing mode, one of FRAMINGS
+    @return ("length" or "cobs", True for the "-crc" variants)
+    @exception ValueError Raised for an unknown framing mode
+    """
+    if framing not in FRAMINGS:
+        raise ValueError(f"Unknown framing mode: {framing}")
+    method, _, crc = framing.partition("-")
+    return method, crc == "crc"
+
+
+def frame_message(
+    message_bytes: bytes,
+    framing: str = "length",
+    frame_type: int = message_pb2.FRAME_TYPE_PAYLOAD,
+) -> bytes:
+    """
+    @fn frame_message
+    @brief Frame a serialized protobuf message for transmission
+    @details The message is preceded by its FrameType byte, which tells the ESP32
+             which message follows. Protobuf messages are not self-delimiting, so the
+             framing is what allows the ESP32 to find message boundaries when several
+             messages arrive back-to-back or a message is split across UART reads.
+             - "length": the frame is prefixed with its varint-encoded length.
+             - "cobs": the frame is COBS-encoded and terminated with 0x00, which lets
+               the firmware use the UART pattern detection interrupt.
+             The "-crc" variants append the CRC-32 of the frame, least significant
+             byte first, before the length prefix or COBS encoding is applied.
+    @param message_bytes Serialized protobuf message
+    @param framing Framing mode, one of FRAMINGS
+    @param frame_type FrameType value matching message_bytes (Payload by default)
+    @return Frame ready to be written to the UART
+    @exception ValueError Raised for an unknown framing mode
+    """
+    method, crc = split_framing(framing)
+    body = bytes([frame_type]) + message_bytes
+    if crc:
+        body += zlib.crc32(body).to_bytes(CRC_SIZE, "little")
+    if method == "length":
+        return encode_varint(len(body)) + body
+    return cobs_encode(body) + bytes([COBS_DELIMITER])
+
+
+# From a random start, so that a restarted sender does not reuse the ids of the transfers it
+# left unfinished in the ESP32 pool (see chunk_pool.h)
+_transfer_ids = itertools.count(random.getrandbits(32))  #!< Id of the next chunked transfer
+
+
+def max_frame_body(framing: str, link: "ReliableLink | None" = None) -> int:
+    """
+    @fn max_frame_body
+    @brief Largest message frame, FrameType byte included, the firmware decodes whole
+    @details The firmware buffers COBS frames still encoded, which costs COBS_OVERHEAD
+             bytes, and sequenced frames wrap the message in SEQUENCED_HEADER_SIZE more.
+             The CRC of the "-crc" framings takes CRC_SIZE bytes of the buffer too.
+    @param framing Framing mode, one of FRAMINGS
+    @param link Acknowledged link the frame goes through, or None
+    @return Limit on 1 + the length of the serialized message
+    """
+    method, crc = split_framing(framing)
+    limit = MAX_FRAME_SIZE - (COBS_OVERHEAD if method == "cobs" else 0)
+    limit -= CRC_SIZE if crc else 0
+    return limit - (SEQUENCED_HEADER_SIZE if link and link.window else 0)
+
+
+def encode_chunks(data: bytes, ts: int, max_frame: int = MAX_FRAME_SIZE) -> list[bytes]:
+    """
+    @fn encode_chunks
+    @brief Split the data of a Payload into Chunk messages that each fit in one frame
+    @details The chunks share a new transfer id and are numbered from 0. Only the
+             first one carries the total size and the timestamp, so every other chunk
+             costs a few bytes of header on top of its data.
+    @param data Payload data, UTF-8 encoded
+    @param ts Integer Unix timestamp (seconds since epoch) of the Payload
+    @param max_frame Largest frame, FrameType byte included, the chunks must fit in
+    @return Serialized Chunk messages, to be sent in order as FRAME_TYPE_CHUNK frames
+    """
+    transfer_id = next(_transfer_ids) & 0xFFFFFFFF
+    chunks = []
+    pos = 0
+    while pos < len(data) or not chunks:
+        chunk = message_pb2.Chunk(transfer_id=transfer_id, index=len(chunks))
+        if not chunks:
+            chunk.size = len(data)
+            chunk.timestamp = ts
+        # FrameType byte, header fields, then the data tag and its length
+        room = max_frame - 1 - chunk.ByteSize() - 1 - CHUNK_LEN_BYTES
+        chunk.data = data[pos : pos + room]
+        pos += room
+        chunks.append(chunk.SerializeToString())
+    return chunks
+
+
+def setup_uart(port: str, baud_rate: int, rtscts: bool = False) -> serial.Serial | None:
     """
     @fn setup_uart
     @brief Initialize UART connection with the specified port and baud rate
     @details Creates a serial connection using the pyserial library with standard
              8N1 configuration (8 data bits, no parity, 1 stop bit). The function
              handles connection errors gracefully and returns None on failure.
+             With rtscts, writes pause while the ESP32 deasserts its RTS line (wired
+             to the adapter's CTS), so a busy board holds the sender back instead of
+             overflowing its receive buffer.
     @param port String containing the serial port name (e.g., "COM3", "/dev/ttyUSB0")
     @param baud_rate Integer specifying the communication baud rate (e.g., 9600, 115200)
+    @param rtscts Enable hardware RTS/CTS flow control (must match the firmware Kconfig)
     @return Serial object if connection successful, None if connection fails
     @exception serial.SerialException Raised when port cannot be opened or configured
     @note Uses global TIMEOUT constant for read/write timeout configuration
@@ -62,6 +426,7 @@ def setup_uart(port: str, baud_rate: int) -> serial.Serial | None:
             parity=serial.PARITY_NONE,
             stopbits=serial.STOPBITS_ONE,
             bytesize=serial.EIGHTBITS,
+            rtscts=rtscts,
         )
         print(f"UART connection established on {port} at {baud_rate} baud")
         return ser
@@ -70,16 +435,31 @@ def setup_uart(port: str, baud_rate: int) -> serial.Serial | None:
         return None
 
 
-def send_message(ser: serial.Serial, message: str, ts: int) -> None:
+def send_message(
+    ser: serial.Serial,
+    message: str,
+    ts: int,
+    framing: str = "length",
+    link: "ReliableLink | None" = None,
+    chunked: bool = False,
+    compress: bool = False,
+    dictionary: bool = False,
+) -> None:
     """
     @fn send_message
     @brief Send a protobuf-encoded message over UART connection
     @details Creates a protobuf Payload object containing the message and timestamp,
-             serializes it to binary format, and transmits it over the UART connection.
+             serializes it to binary format, frames it and transmits it over the UART
+             connection.
              The function validates the serial connection status before attempting transmission.
     @param ser Active serial.Serial object representing the UART connection
     @param message String containing the user message/data to be transmitted
     @param ts Integer Unix timestamp (seconds since epoch) to be included with the message
+    @param framing Framing mode, one of FRAMINGS (must match the firmware configuration)
+    @param link Acknowledged link to send the frame through, or None to write it directly
+    @param chunked Send a message too large for one frame as a chunked transfer
+    @param compress Compress the frame (or the chunks) when that makes it shorter
+    @param dictionary Compress against DICTIONARY (with compress)
     @return None
     @exception Exception Generic exception handling for serialization or transmission errors
     @note Requires message_pb2.Payload protobuf class to be available
@@ -93,7 +473,30 @@ def send_message(ser: serial.Serial, message: str, ts: int) -> None:
             payload.data = message
             message_bytes = payload.SerializeToString()
             print(f"Sending message: {ts}, {message}")
-            ser.write(message_bytes)
+            max_frame = max_frame_body(framing, link)
+            frame_type = message_pb2.FRAME_TYPE_PAYLOAD
+            if 1 + len(message_bytes) > max_frame:
+                if chunked:
+                    send_chunks(
+                        ser,
+                        message.encode(),
+                        ts,
+                        framing,
+                        link,
+                        max_frame,
+                        compress,
+                        dictionary,
+                    )
+                    return
+            elif compress:
+                # Only frames the ESP32 could decode uncompressed, it renders them alike
+                frame_type, message_bytes = compress_frame(
+                    message_bytes, frame_type, dictionary
+                )
+            if link is not None:
+                link.send(message_bytes, frame_type)
+            else:
+                ser.write(frame_message(message_bytes, framing, frame_type))
 
         except Exception as e:
             print(f"Error sending message: {e}")
@@ -101,6 +504,734 @@ def send_message(ser: serial.Serial, message: str, ts: int) -> None:
         print("UART connection not available")
 
 
+def send_chunks(
+    ser: serial.Serial,
+    data: bytes,
+    ts: int,
+    framing: str = "length",
+    link: "ReliableLink | None" = None,
+    max_frame: int = MAX_FRAME_SIZE,
+    compress: bool = False,
+    dictionary: bool = False,
+) -> None:
+    """
+    @fn send_chunks
+    @brief Send the data of a Payload as a chunked transfer
+    @details The chunks are written back-to-back as full frames, so the transfer runs
+             at nearly the raw link rate. See encode_chunks().
+    @param ser Active serial.Serial object representing the UART connection
+    @param data Payload data, UTF-8 encoded
+    @param ts Integer Unix timestamp (seconds since epoch) of the Payload
+    @param framing Framing mode, one of FRAMINGS
+    @param link Acknowledged link to send the chunks through, or None to write them directly
+    @param max_frame Largest frame the chunks must fit in
+    @param compress Compress every chunk that gets shorter
+    @param dictionary Compress against DICTIONARY (with compress)
+    """
+    chunks = [
+        compress_frame(chunk, message_pb2.FRAME_TYPE_CHUNK, dictionary)
+        if compress
+        else (message_pb2.FRAME_TYPE_CHUNK, chunk)
+        for chunk in encode_chunks(data, ts, max_frame)
+    ]
+    print(f"Sending chunked transfer of {len(data)} bytes in {len(chunks)} frames")
+    if link is not None:
+        for frame_type, chunk in chunks:
+            link.send(chunk, frame_type)
+    else:
+        ser.write(
+            b"".join(
+                frame_message(chunk, framing, frame_type) for frame_type, chunk in chunks
+            )
+        )
+
+
+BATCH_ENCODINGS = ("delta", "plain")  #!< DeltaBatch or Batch frames for batched messages
+
+
+def encode_batch(messages: list, encoding: str = "delta") -> tuple[int, bytes]:
+    """
+    @fn encode_batch
+    @brief Serialize several messages as a single frame body
+    @details A single message is sent as a plain Payload. Otherwise:
+             - "delta": a DeltaBatch, where each timestamp is stored as the zigzag
+               difference from the previous one. Messages sent in a burst usually
+               share their timestamp, so each one costs a 1-byte delta instead of
+               a 5-byte varint timestamp.
+             - "plain": a Batch of complete Payloads.
+    @param messages List of (timestamp, data) tuples, in sending order
+    @param encoding Batch encoding, one of BATCH_ENCODINGS
+    @return Tuple of the FrameType value and the serialized message
+    @exception ValueError Raised for an unknown batch encoding
+    """
+    if len(messages) == 1:
+        payload = message_pb2.Payload()
+        payload.timestamp, payload.data = messages[0]
+        return message_pb2.FRAME_TYPE_PAYLOAD, payload.SerializeToString()
+
+    if encoding == "delta":
+        batch = message_pb2.DeltaBatch()
+        batch.base_timestamp = messages[0][0]
+        previous = batch.base_timestamp
+        for ts, data in messages:
+            # uint32 arithmetic on the ESP32: keep deltas within sint32 range
+            delta = (ts - previous) & 0xFFFFFFFF
+            batch.timestamp_deltas.append(delta - (1 << 32) if delta >= 1 << 31 else delta)
+            batch.data.append(data)
+            previous = ts
+        return message_pb2.FRAME_TYPE_DELTA_BATCH, batch.SerializeToString()
+    if encoding == "plain":
+        batch = message_pb2.Batch()
+        for ts, data in messages:
+            batch.payloads.add(timestamp=ts, data=data)
+        return message_pb2.FRAME_TYPE_BATCH, batch.SerializeToString()
+    raise ValueError(f"Unknown batch encoding: {encoding}")
+
+
+class PayloadBatcher:
+    """
+    @brief Groups messages into batch frames to amortize per-frame overhead
+    @details Each frame costs framing bytes, a UART event and a decode pass on the ESP32,
+             so high-rate producers are better served by several messages per frame.
+             A batch is sent as soon as it holds max_batch messages, when the next
+             message would not fit in MAX_FRAME_SIZE, or max_linger seconds after its
+             first message was queued, whichever comes first. A message too long for
+             MAX_FRAME_SIZE on its own is sent right away as a Payload, which the ESP32
+             streams, or as a chunked transfer when chunked is set. See encode_batch()
+             for the frame contents. Batches go through link when one is given.
+             With compress, a batch is full once it no longer fits in MAX_FRAME_SIZE
+             compressed, or in DECOMPRESS_SIZE uncompressed.
+    @note add() and flush() may be called from different threads
+    """
+
+    def __init__(
+        self,
+        ser: serial.Serial,
+        framing: str = "length",
+        max_batch: int = 8,
+        max_linger: float = 0.02,
+        encoding: str = "delta",
+        link: "ReliableLink | None" = None,
+        chunked: bool = False,
+        compress: bool = False,
+        dictionary: bool = False,
+    ):
+        """
+        @param ser Active serial.Serial object representing the UART connection
+        @param framing Framing mode, one of FRAMINGS
+        @param max_batch Maximum number of messages per frame
+        @param max_linger Maximum time in seconds a message waits for others to join it
+        @param encoding Batch encoding, one of BATCH_ENCODINGS
+        @param link Acknowledged link to send batches through, or None to write them directly
+        @param chunked Send a message too large for one frame as a chunked transfer
+        @param compress Compress the frames that get shorter
+        @param dictionary Compress against DICTIONARY (with compress)
+        """
+        self.ser = ser
+        self.framing = framing
+        self.max_batch = max_batch
+        self.max_linger = max_linger
+        self.encoding = encoding
+        self.link = link
+        self.chunked = chunked
+        self.compress = compress
+        self.dictionary = dictionary
+        self.max_frame = max_frame_body(framing, link)
+        self.lock = threading.Lock()
+        self.pending = []
+        self.timer = None
+
+    def add(self, message: str, ts: int) -> None:
+        """
+        @brief Queue a message, sending the current batch if it is full
+        @param message String containing the user message/data to be transmitted
+        @param ts Integer Unix timestamp (seconds since epoch) to be included with the message
+        """
+        with self.lock:
+            if self.pending and not self._fits(self.pending + [(ts, message)]):
+                self._send_locked()
+            self.pending.append((ts, message))
+            if len(self.pending) >= self.max_batch or (
+                len(self.pending) == 1
+                and 1 + len(encode_batch(self.pending)[1]) > self.max_frame
+            ):
+                self._send_locked()
+            elif self.timer is None:
+                self.timer = threading.Timer(self.max_linger, self._linger_expired)
+                self.timer.daemon = True
+                self.timer.start()
+
+    def flush(self) -> None:
+        """
+        @brief Send the pending messages now
+        """
+        with self.lock:
+            self._send_locked()
+
+    def _fits(self, messages: list) -> bool:
+        frame_type, body = encode_batch(messages, self.encoding)
+        if 1 + len(body) <= self.max_frame:  # FrameType byte and message
+            return True
+        if not self.compress or 1 + len(body) > DECOMPRESS_SIZE:
+            return False
+        _, packed = compress_frame(body, frame_type, self.dictionary)
+        return 1 + len(packed) <= self.max_frame
+
+    def _linger_expired(self) -> None:
+        with self.lock:
+            # Ignore a timer that fired while the batch it belonged to was being sent
+            if self.timer is threading.current_thread():
+                self._send_locked()
+
+    def _send_locked(self) -> None:
+        if self.timer is not None:
+            self.timer.cancel()
+            self.timer = None
+        if not self.pending:
+            return
+
+        frame_type, body = encode_batch(self.pending, self.encoding)
+        alone_too_long = len(self.pending) == 1 and 1 + len(body) > self.max_frame
+        if self.chunked and alone_too_long:
+            ts, message = self.pending[0]
+            self.pending = []
+            try:
+                send_chunks(
+                    self.ser,
+                    message.encode(),
+                    ts,
+                    self.framing,
+                    self.link,
+                    self.max_frame,
+                    self.compress,
+                    self.dictionary,
+                )
+            except Exception as e:
+                print(f"Error sending chunked transfer: {e}")
+            return
+        # A lone message too long for a frame is streamed, which compression would prevent
+        if self.compress and not alone_too_long:
+            frame_type, body = compress_frame(body, frame_type, self.dictionary)
+        frame = frame_message(body, self.framing, frame_type)
+        print(f"Sending batch of {len(self.pending)} message(s), {len(frame)} bytes")
+        try:
+            if self.link is not None:
+                self.link.send(body, frame_type)
+            else:
+                self.ser.write(frame)
+        except Exception as e:
+            print(f"Error sending batch: {e}")
+        self.pending = []
+
+
+class FrameReader:
+    """
+    @brief Splits the byte stream received from the ESP32 back into frames
+    @details Counterpart of frame_message() for the replies sent on the ESP32 TX
+             line. Bytes can be fed in chunks of any size; incomplete frames are
+             kept until the rest arrives and invalid COBS frames are dropped.
+             With a "-crc" framing, frames failing their CRC are dropped too; in
+             length framing the reader then skips one byte at a time until a length
+             prefix is followed by a frame with a valid CRC again.
+    """
+
+    def __init__(self, framing: str = "length"):
+        """
+        @param framing Framing mode, one of FRAMINGS
+        """
+        self.framing = framing
+        self.method, self.crc = split_framing(framing)
+        self.buffer = bytearray()
+
+    def check(self, frame: bytes) -> bytes | None:
+        """
+        @brief Verify and strip the CRC of a frame when the framing has one
+        @param frame Decoded frame, CRC included
+        @return Frame body, or None if it fails its CRC
+        """
+        if not self.crc:
+            return frame
+        body, stored = frame[:-CRC_SIZE], frame[-CRC_SIZE:]
+        if len(frame) < CRC_SIZE or zlib.crc32(body).to_bytes(CRC_SIZE, "little") != stored:
+            return None
+        return body
+
+    def feed(self, data: bytes) -> list[bytes]:
+        """
+        @brief Consume received bytes
+        @param data Bytes read from the serial port
+        @return Bodies (FrameType byte and message) of the frames completed by data
+        """
+        self.buffer += data
+        frames = []
+        if self.method == "cobs":
+            while (end := self.buffer.find(COBS_DELIMITER)) >= 0:
+                frame = cobs_decode(bytes(self.buffer[:end]))
+                del self.buffer[: end + 1]
+                if frame and (frame := self.check(frame)):
+                    frames.append(frame)
+        else:
+            while (prefix := decode_varint(self.buffer)) is not None:
+                length, start = prefix
+                if self.crc and length > MAX_REPLY_SIZE + CRC_SIZE:
+                    del self.buffer[0]
+                    continue
+                if len(self.buffer) < start + length:
+                    break
+                frame = self.check(bytes(self.buffer[start : start + length]))
+                if frame is None:
+                    del self.buffer[0]
+                    continue
+                frames.append(frame)
+                del self.buffer[: start + length]
+        return frames
+
+
+class ReliableLink:
+    """
+    @brief Acknowledged transmission with a sliding window of frames in flight
+    @details Every frame is wrapped in a FRAME_TYPE_SEQUENCED frame carrying an 8-bit
+             sequence number. The ESP32 decodes them strictly in order and answers on
+             its TX line with an ACK (next expected sequence number) for each one, or
+             a NACK (first missing sequence number) when a gap shows that frames were
+             lost, e.g. to a UART buffer overflow. On a NACK, or when the oldest frame
+             is not acknowledged in time, every unacknowledged frame is sent again from
+             the first missing one (go-back-N).
+             Up to window frames are in flight and send() blocks while the window is
+             full, so the sender runs at the rate the board actually decodes instead
+             of a guessed one, without losing messages.
+             With credits, the ESP32 also advertises in Credit frames how many bytes it
+             has read out of its UART receive buffer and the size of that buffer, and
+             frames are only written while they fit in the free space, so the buffer
+             never overflows in the first place. A window of 0 sends plain frames that
+             are only held back by credits, without sequence numbers or ACKs.
+    @note The serial read timeout is shortened so retransmissions are timely
+    """
+
+    def __init__(
+        self,
+        ser: serial.Serial,
+        framing: str = "length",
+        window: int = 8,
+        timeout: float = 0.2,
+        credits: bool = False,
+    ):
+        """
+        @param ser Active serial.Serial object representing the UART connection
+        @param framing Framing mode, one of FRAMINGS
+        @param window Maximum number of unacknowledged frames, 1 to MAX_WINDOW (or 0 with
+               credits for unacknowledged frames)
+        @param timeout Time in seconds to wait for an ACK once a frame is on the wire
+        @param credits Only write frames that fit in the ESP32 receive buffer
+        @exception ValueError Raised for a window outside 1 to MAX_WINDOW
+        """
+        if not (1 if not credits else 0) <= window <= MAX_WINDOW:
+            raise ValueError(f"Window must be between 1 and {MAX_WINDOW}")
+        self.ser = ser
+        self.framing = framing
+        self.window = window
+        self.timeout = timeout
+        self.credits = credits
+        self.reader = FrameReader(framing)
+        self.cond = threading.Condition()
+        self.in_flight = collections.deque()  # [sequence number, frame, ACK deadline]
+        self.next_write = 0  # Index in in_flight of the first frame not written yet
+        self.next_seq = 0
+        self.wire_free = 0.0  # Estimated time the bytes written so far are on the wire
+        self.bytes_sent = 0  # Bytes written, counted like Credit.consumed (modulo 2^32)
+        self.consumed = None  # Last Credit.consumed received, None before the first one
+        self.rx_window = 0  # Last Credit.window received
+        self.credit_time = 0.0  # Time the last Credit was received
+        self.synced = False
+        self.failed = False
+        self.retries = 0
+        self.stats = {"sent": 0, "resent": 0, "nacks": 0, "timeouts": 0, "stalls": 0}
+        self.running = True
+        self.ser.timeout = min(TIMEOUT, timeout / 4)
+        self.thread = threading.Thread(target=self._receive, daemon=True)
+        self.thread.start()
+
+    def open(self, attempts: int = 5) -> bool:
+        """
+        @brief Synchronize sequence numbers and credits with the ESP32
+        @details With credits, waits for the first Credit frame. Then, with a window,
+                 sends a SYNC frame with the next sequence number until the ESP32
+                 acknowledges it, so frames from a previous session are not mistaken
+                 for duplicates.
+        @param attempts Number of SYNC frames to send (or timeouts to wait for a Credit)
+               before giving up
+        @return True once the ESP32 answered, False if it never did
+        """
+        with self.cond:
+            if self.credits and not self.cond.wait_for(
+                lambda: self.consumed is not None, attempts * self.timeout
+            ):
+                return False
+            if self.window == 0:
+                return True
+            sync = frame_message(
+                bytes([self.next_seq]), self.framing, message_pb2.FRAME_TYPE_SYNC
+            )
+            for _ in range(attempts):
+                self._transmit_locked(sync)
+                self.cond.wait_for(
+                    lambda: self.synced, self.timeout + self._wire_time(sync)
+                )
+                if self.synced:
+                    return True
+        return False
+
+    def send(
+        self, message_bytes: bytes, frame_type: int = message_pb2.FRAME_TYPE_PAYLOAD
+    ) -> None:
+        """
+        @brief Send a message as the next frame, waiting for room in the window
+        @details The frame is written as soon as the ESP32 has granted enough credits,
+                 until then it waits in the window (a single frame with a window of 0).
+        @param message_bytes Serialized protobuf message
+        @param frame_type FrameType value matching message_bytes
+        @exception ConnectionError Raised once the ESP32 stopped acknowledging frames
+        """
+        with self.cond:
+            self.cond.wait_for(
+                lambda: len(self.in_flight) < max(1, self.window) or self.failed
+            )
+            if self.failed:
+                raise ConnectionError("No acknowledgement from the ESP32")
+            if self.window == 0:
+                frame = frame_message(message_bytes, self.framing, frame_type)
+                self.in_flight.append([None, frame, 0.0])
+            else:
+                seq = self.next_seq
+                self.next_seq = (seq + 1) & 0xFF
+                frame = frame_message(
+                    bytes([seq, frame_type]) + message_bytes,
+                    self.framing,
+                    message_pb2.FRAME_TYPE_SEQUENCED,
+                )
+                self.in_flight.append([seq, frame, 0.0])
+            self.stats["sent"] += 1
+            self._pump_locked()
+            if len(self.in_flight) > self.next_write:
+                self.stats["stalls"] += 1  # Waiting for credits
+
+    def close(self, timeout: float = 5.0) -> bool:
+        """
+        @brief Wait for the frames in flight to be acknowledged and stop receiving
+        @param timeout Maximum time in seconds to wait for the last ACKs
+        @return True if every frame was acknowledged (or written, with a window of 0)
+        """
+        with self.cond:
+            done = self.cond.wait_for(lambda: not self.in_flight or self.failed, timeout)
+            self.running = False
+        self.thread.join()
+        return done and not self.failed
+
+    def _wire_time(self, frame: bytes) -> float:
+        return len(frame) * BITS_PER_BYTE / self.ser.baudrate
+
+    def _transmit_locked(self, frame: bytes) -> None:
+        self.wire_free = max(time.monotonic(), self.wire_free) + self._wire_time(frame)
+        self.bytes_sent = (self.bytes_sent + len(frame)) & 0xFFFFFFFF
+        self.ser.write(frame)
+
+    def _fits_locked(self, frame: bytes) -> bool:
+        if not self.credits:
+            return True
+        if self.consumed is None:
+            return False
+        outstanding = (self.bytes_sent - self.consumed) & 0xFFFFFFFF
+        # A frame larger than the whole buffer can only go when it is empty
+        return outstanding == 0 or outstanding + len(frame) <= self.rx_window
+
+    def _pump_locked(self) -> None:
+        # Write the frames of the window in order, as far as the credits allow
+        while self.next_write < len(self.in_flight):
+            entry = self.in_flight[self.next_write]
+            if not self._fits_locked(entry[1]):
+                break
+            if entry[2] > 0:
+                self.stats["resent"] += 1
+            self._transmit_locked(entry[1])
+            # The ACK can only come once the frame and everything queued before it was sent
+            entry[2] = self.wire_free + self.timeout
+            if self.window == 0:
+                self.in_flight.popleft()
+                self.cond.notify_all()
+            else:
+                self.next_write += 1
+
+    def _resend_locked(self) -> None:
+        self.retries += 1
+        if self.retries > MAX_RETRIES:
+            self.failed = True
+            self.cond.notify_all()
+            return
+        self.next_write = 0
+        self._pump_locked()
+
+    def _acknowledge_locked(self, seq: int) -> None:
+        if not self.in_flight:
+            self.synced = self.synced or seq == self.next_seq
+        else:
+            acked = (seq - self.in_flight[0][0]) & 0xFF
+            if 0 < acked <= len(self.in_flight):
+                for _ in range(acked):
+                    self.in_flight.popleft()
+                # Late ACK for frames already queued again after a resend
+                self.next_write = max(0, self.next_write - acked)
+                self.retries = 0
+        self.cond.notify_all()
+
+    def _credit_locked(self, credit: message_pb2.Credit) -> None:
+        now = time.monotonic()
+        outstanding = (self.bytes_sent - credit.consumed) & 0xFFFFFFFF
+        idle = credit.consumed == self.consumed and self.wire_free < self.credit_time
+        if outstanding > credit.window or idle:
+            # Never more than the window is outstanding: the ESP32 restarted, or bytes
+            # were lost on the line (nothing was consumed while the line was idle)
+            self.bytes_sent = credit.consumed
+        self.consumed = credit.consumed
+        self.rx_window = credit.window
+        self.credit_time = now
+        self.cond.notify_all()
+
+    def _receive(self) -> None:
+        while self.running:
+            try:
+                data = self.ser.read(max(1, self.ser.in_waiting))
+            except (serial.SerialException, OSError, TypeError):
+                break  # Port closed
+            with self.cond:
+                for frame in self.reader.feed(data):
+                    if frame[:1] == bytes([message_pb2.FRAME_TYPE_CREDIT]):
+                        try:
+                            self._credit_locked(message_pb2.Credit.FromString(frame[1:]))
+                        except DecodeError:
+                            continue
+                    elif len(frame) != 2 or self.window == 0:
+                        continue
+                    elif frame[0] == message_pb2.FRAME_TYPE_ACK:
+                        self._acknowledge_locked(frame[1])
+                    elif frame[0] == message_pb2.FRAME_TYPE_NACK:
+                        self.stats["nacks"] += 1
+                        self._acknowledge_locked(frame[1])
+                        if self.in_flight and self.in_flight[0][0] == frame[1]:
+                            self._resend_locked()
+                if self.next_write > 0 and time.monotonic() > self.in_flight[0][2]:
+                    self.stats["timeouts"] += 1
+                    self._resend_locked()
+                self._pump_locked()
+
+
+def baud_probe() -> bytes:
+    """
+    @fn baud_probe
+    @brief Pattern of a probe frame, as DESERIALIZER_BAUD_PROBE_BYTE() generates it
+    @details Starts with 0x55, alternating bits, and goes through every bit pattern
+             of a byte in 256 bytes, so a wrong sampling rate garbles some of them.
+    @return BAUD_PROBE_LEN bytes
+    """
+    return bytes((0x55 + i * 0x4B) & 0xFF for i in range(BAUD_PROBE_LEN))
+
+
+def exchange(
+    ser: serial.Serial,
+    reader: FrameReader,
+    frame: bytes,
+    reply_type: int,
+    timeout: float = BAUD_REPLY_TIMEOUT,
+) -> bytes | None:
+    """
+    @fn exchange
+    @brief Send a frame and wait for the reply of the given FrameType
+    @details Other frames received meanwhile, such as Credits, are ignored.
+    @param ser Active serial.Serial object, with a read timeout shorter than timeout
+    @param reader FrameReader of the replies, which may hold the start of the next one
+    @param frame Framed message
+    @param reply_type FrameType of the expected reply
+    @param timeout Time in seconds to wait for the reply once the frame is sent
+    @return Reply message, without its FrameType byte, or None on timeout
+    """
+    ser.write(frame)
+    deadline = time.monotonic() + timeout + len(frame) * BITS_PER_BYTE / ser.baudrate
+    while time.monotonic() < deadline:
+        for body in reader.feed(ser.read(max(1, ser.in_waiting))):
+            if body[:1] == bytes([reply_type]):
+                return body[1:]
+    return None
+
+
+def request_baud(
+    ser: serial.Serial, reader: FrameReader, framing: str, rate: int, attempts: int = 3
+) -> int | None:
+    """
+    @fn request_baud
+    @brief Send a BaudSwitch until the ESP32 echoes it
+    @param ser Active serial.Serial object
+    @param reader FrameReader of the replies
+    @param framing Framing mode, one of FRAMINGS
+    @param rate Requested baud rate
+    @param attempts Number of BaudSwitch frames to send before giving up
+    @return Rate the ESP32 echoed (rate itself if accepted), or None if it never answered
+    """
+    frame = frame_message(
+        message_pb2.BaudSwitch(baud_rate=rate).SerializeToString(),
+        framing,
+        message_pb2.FRAME_TYPE_BAUD,
+    )
+    for _ in range(attempts):
+        reply = exchange(ser, reader, frame, message_pb2.FRAME_TYPE_BAUD)
+        if reply is None:
+            continue
+        try:
+            return message_pb2.BaudSwitch.FromString(reply).baud_rate
+        except DecodeError:
+            continue
+    return None
+
+
+def negotiate_baud(
+    ser: serial.Serial, framing: str = "length", max_rate: int = BAUD_RATES[0]
+) -> int:
+    """
+    @fn negotiate_baud
+    @brief Move the link to the fastest rate of BAUD_RATES that works both ways
+    @details The rates above the current one are tried fastest first. The ESP32
+             echoes a BaudSwitch at the current rate, then both ends switch; the
+             rate is kept once BAUD_PROBES probes sent at it were answered with no
+             byte in error and a second BaudSwitch confirmed it. Otherwise the ESP32
+             falls back on its own after BAUD_TIMEOUT, and so does this end.
+             Rates the ESP32 refuses (above CONFIG_DESERIALIZER_MAX_BAUD_RATE) are
+             skipped, and nothing changes if it does not answer at all.
+    @param ser Active serial.Serial object; ser.baudrate is updated
+    @param framing Framing mode, one of FRAMINGS
+    @param max_rate Fastest rate to try
+    @return Baud rate the link now runs at
+    @warning Call before anything else uses the port, the replies are read here
+    """
+    current = ser.baudrate
+    timeout = ser.timeout
+    ser.timeout = BAUD_REPLY_TIMEOUT / 4
+    reader = FrameReader(framing)
+    probe = frame_message(baud_probe(), framing, message_pb2.FRAME_TYPE_BAUD_PROBE)
+    try:
+        if request_baud(ser, reader, framing, current) != current:
+            return current  # Negotiation disabled on the ESP32, or not at this rate
+        for rate in BAUD_RATES:
+            if not current < rate <= max_rate:
+                continue
+            if request_baud(ser, reader, framing, rate) != rate:
+                continue
+            switched = time.monotonic()
+            ser.baudrate = rate
+            time.sleep(BAUD_SETTLE)
+            ser.reset_input_buffer()
+            reader = FrameReader(framing)
+            if all(
+                exchange(ser, reader, probe, message_pb2.FRAME_TYPE_BAUD_PROBE) == bytes([0])
+                for _ in range(BAUD_PROBES)
+            ) and request_baud(ser, reader, framing, rate) == rate:
+                return rate
+            # Wait for the ESP32 to give up on the rate as well
+            ser.baudrate = current
+            time.sleep(max(0.0, switched + BAUD_TIMEOUT + BAUD_REPLY_TIMEOUT - time.monotonic()))
+            ser.reset_input_buffer()
+            reader = FrameReader(framing)
+        return current
+    finally:
+        ser.timeout = timeout
+
+
+def query_stats(
+    ser: serial.Serial, reader: FrameReader, framing: str = "length"
+) -> message_pb2.Stats | None:
+    """
+    @fn query_stats
+    @brief Ask the ESP32 for its counters with a STATS frame
+    @param ser Active serial.Serial object, with a read timeout shorter than STATS_TIMEOUT
+    @param reader FrameReader of the replies
+    @param framing Framing mode, one of FRAMINGS
+    @return Stats reply, or None if the ESP32 did not answer
+    """
+    frame = frame_message(b"", framing, message_pb2.FRAME_TYPE_STATS)
+    reply = exchange(ser, reader, frame, message_pb2.FRAME_TYPE_STATS, STATS_TIMEOUT)
+    if reply is None:
+        return None
+    try:
+        return message_pb2.Stats.FromString(reply)
+    except DecodeError:
+        return None
+
+
+def format_stats(stats: message_pb2.Stats, previous: message_pb2.Stats | None = None) -> str:
+    """
+    @fn format_stats
+    @brief Render a Stats reply as text, with the rates since the previous one
+    @details Rates are computed from the ESP32 uptime, so they do not depend on when
+             the replies arrived. None are given for the first reply, or after a
+             restart of the ESP32.
+    @param stats Stats reply
+    @param previous Previous Stats reply from the same ESP32, or None
+    @return Lines of text, without a final newline
+    """
+    summary = (
+        f"uptime {stats.uptime_ms / 1000:.1f} s: {stats.frames} frames, "
+        f"{stats.payloads} messages, {stats.bytes} bytes"
+    )
+    elapsed = (stats.uptime_ms - previous.uptime_ms) / 1000 if previous is not None else 0
+    if elapsed > 0 and stats.frames >= previous.frames:
+        summary += (
+            f" ({(stats.frames - previous.frames) / elapsed:.1f} frames/s, "
+            f"{(stats.payloads - previous.payloads) / elapsed:.1f} msgs/s, "
+            f"{(stats.bytes - previous.bytes) / elapsed:.0f} B/s)"
+        )
+    lines = [
+        summary,
+        f"  errors: {stats.unpack_errors} unpack, {stats.framing_errors} framing, "
+        f"{stats.crc_errors} CRC, {stats.overflows} overflows, "
+        f"{stats.queue_dropped} dropped from the frame queue, {stats.log_dropped} from the log",
+        f"  high water: RX buffer {stats.rx_high_water} B, frame queue "
+        f"{stats.frame_queue_high_water} B, output queue {stats.output_queue_high_water} B",
+    ]
+    if stats.min_free_heap > 0:  # Not reported by the simulator
+        lines[-1] += f"; min free heap {stats.min_free_heap} B"
+    for name, stage in zip(STAGE_NAMES, stats.stages):
+        if stage.samples > 0:
+            lines.append(
+                f"  stage {name:<6} {stage.samples} samples, mean {stage.mean_us} us, "
+                f"p50 <= {stage.p50_us} us, p90 <= {stage.p90_us} us, "
+                f"p99 <= {stage.p99_us} us, max {stage.max_us} us"
+            )
+    return "\n".join(lines)
+
+
+def monitor_stats(ser: serial.Serial, framing: str = "length", interval: float = 10.0) -> None:
+    """
+    @fn monitor_stats
+    @brief Print the counters of the ESP32 every interval seconds, until interrupted
+    @param ser Active serial.Serial object
+    @param framing Framing mode, one of FRAMINGS
+    @param interval Time in seconds between two queries
+    @exception KeyboardInterrupt Raised on Ctrl+C, which is the only way out
+    """
+    reader = FrameReader(framing)
+    timeout = ser.timeout
+    ser.timeout = STATS_TIMEOUT / 4
+    previous = None
+    try:
+        while True:
+            stats = query_stats(ser, reader, framing)
+            if stats is None:
+                print("No answer from the ESP32, check the TX line", flush=True)
+            else:
+                print(format_stats(stats, previous), flush=True)
+                previous = stats
+            time.sleep(interval)
+    finally:
+        ser.timeout = timeout
+
+
 def main():
     """
     @fn main
@@ -109,17 +1240,100 @@ def main():
              establishes UART connection, and runs the interactive message sending loop.
              Handles user input, timestamp generation, and graceful shutdown on interrupt.
     @return None
-    @exception KeyboardInterrupt Handles Ctrl+C user interruption for clean shutdown
+    @exception KeyboardInterrupt Handles Ctrl+C user interruption (or end of input) for clean shutdown
     @exception SystemExit Called when UART connection fails during initialization
     @note Defaults to first available serial port if --port not specified
     @note Defaults to 9600 baud if --baudrate not specified
+    @note Defaults to length-prefixed framing if --framing not specified
+    @note Sends every message in its own frame unless --batch is greater than 1
+    @note Frames are only acknowledged and resent when --window is greater than 0
+    @note With --credits frames are held back until the ESP32 has room for them
+    @note With --rtscts the ESP32 RTS line pauses transmission while it is busy
+    @note Messages whose frame exceeds --max-message-size (4096 by default) are refused
+    @note With --chunked, messages too large for one frame are sent as chunked transfers
+    @note With --compress, frames are LZSS-compressed whenever that makes them shorter
+    @note With --dictionary, they are compressed against the dictionary of the firmware
+    @note With --negotiate, the baud rate is raised as far as the link carries it reliably
+    @note With --stats, the ESP32 counters are polled and printed instead of sending messages
     @note Uses UTC timezone for timestamp generation
     @warning Exits with code 1 if no serial connection can be established
     """
     parser = argparse.ArgumentParser(description="Select port and baudrate")
     parser.add_argument("--port", required=False, type=str)
     parser.add_argument("--baudrate", required=False, type=int)
+    parser.add_argument(
+        "--rtscts", action="store_true", help="Hardware RTS/CTS flow control"
+    )
+    parser.add_argument("--framing", choices=FRAMINGS, default="length")
+    parser.add_argument(
+        "--batch", type=int, default=1, help="Maximum number of messages per frame"
+    )
+    parser.add_argument(
+        "--batch-encoding",
+        choices=BATCH_ENCODINGS,
+        default="delta",
+        help="Batch with delta-encoded timestamps (default) or of plain Payloads",
+    )
+    parser.add_argument(
+        "--linger",
+        type=float,
+        default=20,
+        help="Maximum time in ms a message waits for a batch to fill",
+    )
+    parser.add_argument(
+        "--window",
+        type=int,
+        default=0,
+        help="Frames in flight awaiting an ACK from the ESP32 (0: no acknowledgements)",
+    )
+    parser.add_argument(
+        "--ack-timeout",
+        type=float,
+        default=200,
+        help="Time in ms to wait for an ACK before resending",
+    )
+    parser.add_argument(
+        "--credits",
+        action="store_true",
+        help="Only send what fits in the ESP32 receive buffer (credit-based flow control)",
+    )
+    parser.add_argument(
+        "--max-message-size",
+        type=int,
+        default=MAX_MESSAGE_SIZE,
+        help="Largest frame the ESP32 accepts (CONFIG_DESERIALIZER_MAX_MESSAGE_SIZE)",
+    )
+    parser.add_argument(
+        "--chunked",
+        action="store_true",
+        help="Split messages too large for one frame into chunks the ESP32 reassembles",
+    )
+    parser.add_argument(
+        "--compress",
+        action="store_true",
+        help="Compress frames (needs CONFIG_DESERIALIZER_COMPRESSION on the ESP32)",
+    )
+    parser.add_argument(
+        "--dictionary",
+        action="store_true",
+        help="Compress frames against the dictionary built into the ESP32 (implies --compress)",
+    )
+    parser.add_argument(
+        "--negotiate",
+        type=int,
+        nargs="?",
+        const=BAUD_RATES[0],
+        metavar="MAX_RATE",
+        help="Switch to the fastest baud rate up to MAX_RATE that the link carries reliably",
+    )
+    parser.add_argument(
+        "--stats",
+        type=float,
+        metavar="SECONDS",
+        help="Print the ESP32 counters every SECONDS instead of sending messages",
+    )
     args = parser.parse_args()
+    args.compress = args.compress or args.dictionary
     if args.port is None:
         args.port = sorted(serial.tools.list_ports.comports())[0][
             0
@@ -128,27 +1342,93 @@ def main():
         args.baudrate = 9600
 
     # Initialize UART connection with selected port
-    ser = setup_uart(args.port, args.baudrate)
+    ser = setup_uart(args.port, args.baudrate, args.rtscts)
 
     if ser is None:
         print("Failed to establish UART connection. Exiting...")
         exit(1)
 
+    if args.negotiate is not None:
+        args.baudrate = negotiate_baud(ser, args.framing, args.negotiate)
+        print(f"Baud rate negotiated: {args.baudrate}")
+
+    if args.stats is not None:
+        print(f"Polling the ESP32 on {args.port} every {args.stats} s, Ctrl+C to finish")
+        try:
+            monitor_stats(ser, args.framing, args.stats)
+        except KeyboardInterrupt:
+            ser.close()
+            print("\nUART connection closed")
+        return
+
+    link = None
+    if args.window > 0 or args.credits:
+        link = ReliableLink(
+            ser, args.framing, args.window, args.ack_timeout / 1000, args.credits
+        )
+        if not link.open():
+            print("No answer from the ESP32, check the TX line. Exiting...")
+            link.close(0)
+            ser.close()
+            exit(1)
+
+    batcher = None
+    if args.batch > 1:
+        batcher = PayloadBatcher(
+            ser,
+            args.framing,
+            args.batch,
+            args.linger / 1000,
+            args.batch_encoding,
+            link,
+            args.chunked,
+            args.compress,
+            args.dictionary,
+        )
+
     try:
         print("\n=== UART Message Sender ===")
         print(f"Connected to port: {args.port} at {args.baudrate} baud \n")
 
         while True:
             msg = input("Enter a message or hit Ctrl+C to finish program: ")
-            if len(msg) >= 113:
-                print("Message too long, please limit to less than 113 characters.")
-                continue
             ts = int(
                 datetime.now(tz=timezone.utc).timestamp()
             )  # Convert to integer seconds
-            send_message(ser, msg, ts)
+            payload = message_pb2.Payload(timestamp=ts, data=msg)
+            # FrameType byte, the sequence header of windowed mode, and the checksum of the
+            # "-crc" framings, which the ESP32 counts in the length it checks
+            frame_size = (
+                1
+                + payload.ByteSize()
+                + (SEQUENCED_HEADER_SIZE if args.window else 0)
+                + (CRC_SIZE if split_framing(args.framing)[1] else 0)
+            )
+            if frame_size > args.max_message_size:
+                print(
+                    f"Message too long ({frame_size} byte frame), the ESP32 accepts "
+                    f"frames of up to {args.max_message_size} bytes."
+                )
+                continue
+            if batcher is not None:
+                batcher.add(msg, ts)
+            else:
+                send_message(
+                    ser,
+                    msg,
+                    ts,
+                    args.framing,
+                    link,
+                    args.chunked,
+                    args.compress,
+                    args.dictionary,
+                )
 
-    except KeyboardInterrupt:
+    except (KeyboardInterrupt, EOFError):
+        if batcher is not None:
+            batcher.flush()
+        if link is not None and not link.close():
+            print("\nSome messages were not acknowledged by the ESP32")
         if ser and ser.is_open:
             ser.close()
             print("\nUART connection closed")